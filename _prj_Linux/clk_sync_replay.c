@@ -0,0 +1,255 @@
+/*
+ ******************************************************************************
+ * @file    clk_sync_replay.c
+ * @author  Sensors Software Solution Team
+ * @brief   Host replay of a timestamp sync trace, or simulation of a
+ *          sensor with a skewed clock, through clk_sync.h
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2024 STMicroelectronics.
+ * All rights reserved.</center></h2>
+ *
+ * This software component is licensed by ST under BSD 3-Clause license,
+ * the "License"; You may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at:
+ *                        opensource.org/licenses/BSD-3-Clause
+ *
+ ******************************************************************************
+ */
+
+/*
+ * Usage:
+ *
+ *   clk_sync_replay [-r samples] [trace.txt]
+ *   clk_sync_replay -s ppm [-d hours] [-r samples] [-w]
+ *
+ * Replay reads the console output of lsm6dsv16x_timestamp_sync.c built
+ * with SYNC_TRACE ("sync,<mcu_hz>,<ts_lsb_ns>,<odr_hz>" once, then
+ * "y,<mcu_ticks>" per MCU capture and "x,<sensor_ts>" per sample, other
+ * lines are skipped) from the file or from stdin and feeds it through
+ * the same pairing and fit as the device, reporting every -r samples
+ * (default 1200) as the example does.
+ *
+ * -s simulates instead a sensor whose clock is off by ppm (e.g. 300)
+ * for -d hours (default 72, past the 32 bit wrap of the sensor
+ * timestamp): 120 Hz samples, 21.75 us timestamp LSB, 84 MHz MCU time
+ * base, 5 us interrupt latency with 2 us of jitter, one interrupt in 500
+ * missed. Samples are paired in FIFO batches of 16 as on the device. The
+ * report adds the largest error of the mapped time against the true
+ * capture time. With -w the simulated trace is written to stdout in the
+ * SYNC_TRACE format instead, so it can be replayed.
+ *
+ * Build: gcc -O2 -I $STDC_PATH/lsm6dsv16x_STdC/examples clk_sync_replay.c \
+ *            -lm -o clk_sync_replay
+ */
+
+#include "clk_sync.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/* Simulated sensor and MCU */
+#define SIM_MCU_HZ       84000000UL
+#define SIM_LSB_NS       21750.0
+#define SIM_ODR_HZ       120.0
+#define SIM_LAT_S        5.0e-6
+#define SIM_JITTER_S     2.0e-6
+#define SIM_MISS         500
+#define SIM_BATCH        16
+
+typedef struct {
+  uint32_t hz;
+  double b_nom, half;
+  uint32_t samples, slips;
+  uint32_t report;
+  double err_max;
+} replay_t;
+
+static clk_sync_t fit;
+static clk_sync_ring_t irq;
+
+static void replay_init(replay_t *r, uint32_t hz, double lsb_ns, double odr)
+{
+  r->hz = hz;
+  r->b_nom = (double)hz * lsb_ns / 1.0e9;
+  r->half = (double)hz / odr / 2.0;
+}
+
+static void replay_report(replay_t *r, uint64_t x)
+{
+  printf("t %" PRIu64 " us: skew %+.1f ppm, residual rms %.2f us max %.2f us, slips %lu",
+         clk_sync_ticks_to_us(clk_sync_map(&fit, x), r->hz),
+         (fit.b / r->b_nom - 1.0) * 1.0e6,
+         fit.res_n ? sqrt(fit.res_sum2 / fit.res_n) * 1.0e6 / r->hz : 0.0,
+         fit.res_max * 1.0e6 / r->hz, (unsigned long)r->slips);
+  if (r->err_max > 0.0)
+    printf(", error max %.2f us", r->err_max * 1.0e6 / r->hz);
+  printf("\n");
+
+  fit.res_sum2 = 0.0;
+  fit.res_max = 0.0;
+  fit.res_n = 0;
+  r->err_max = 0.0;
+}
+
+static void replay_sample(replay_t *r, uint64_t x)
+{
+  r->slips += clk_sync_pair(&fit, &irq, x, r->half, r->b_nom);
+  if (++r->samples % r->report == 0)
+    replay_report(r, x);
+}
+
+static int replay(replay_t *r, FILE *f)
+{
+  unsigned long long v;
+  unsigned long hz;
+  double lsb_ns, odr;
+  char line[128];
+
+  while (fgets(line, sizeof(line), f) != NULL) {
+    if (sscanf(line, "sync,%lu,%lf,%lf", &hz, &lsb_ns, &odr) == 3) {
+      if (hz == 0 || lsb_ns <= 0.0 || odr <= 0.0) {
+        fprintf(stderr, "bad sync line: %s", line);
+        return 1;
+      }
+      replay_init(r, (uint32_t)hz, lsb_ns, odr);
+      continue;
+    }
+
+    if (line[0] != 'x' && line[0] != 'y')
+      continue;
+    if (sscanf(line + 1, ",%llu", &v) != 1)
+      continue;
+
+    if (r->hz == 0) {
+      fprintf(stderr, "no sync line before the trace\n");
+      return 1;
+    }
+
+    if (line[0] == 'y')
+      clk_sync_capture(&irq, v);
+    else
+      replay_sample(r, v);
+  }
+
+  if (r->samples == 0) {
+    fprintf(stderr, "no samples (build the example with SYNC_TRACE)\n");
+    return 1;
+  }
+
+  return 0;
+}
+
+static int simulate(replay_t *r, double ppm, double hours, int write)
+{
+  double rate = 1.0 + ppm * 1.0e-6;
+  uint64_t n = (uint64_t)(hours * 3600.0 * SIM_ODR_HZ * rate);
+  uint64_t x[SIM_BATCH];
+  uint64_t k;
+  uint32_t i = 0;
+
+  replay_init(r, SIM_MCU_HZ, SIM_LSB_NS, SIM_ODR_HZ);
+  if (write)
+    printf("sync,%lu,%.1f,%.1f\n", SIM_MCU_HZ, SIM_LSB_NS, SIM_ODR_HZ);
+
+  srand(1);
+
+  for (k = 0; k < n; k++) {
+    /* sample k on the sensor clock, 0.5 s after the MCU time origin */
+    double t = 0.5 + (double)k / (SIM_ODR_HZ * rate);
+    double lat = SIM_LAT_S + SIM_JITTER_S * rand() / RAND_MAX;
+
+    x[i++] = (uint64_t)(t * rate * 1.0e9 / SIM_LSB_NS) + 1000000ULL;
+
+    if (rand() % SIM_MISS) {
+      uint64_t y = (uint64_t)llround((t + lat) * SIM_MCU_HZ);
+
+      if (write)
+        printf("y,%" PRIu64 "\n", y);
+      else
+        clk_sync_capture(&irq, y);
+    }
+
+    if (i < SIM_BATCH)
+      continue;
+
+    /* FIFO watermark: the batch is read after its captures */
+    for (i = 0; i < SIM_BATCH; i++) {
+      uint64_t kk = k + 1 - SIM_BATCH + i;
+      double ts = 0.5 + (double)kk / (SIM_ODR_HZ * rate);
+      double e;
+
+      if (write) {
+        printf("x,%" PRIu64 "\n", x[i]);
+        continue;
+      }
+
+      r->slips += clk_sync_pair(&fit, &irq, x[i], r->half, r->b_nom);
+
+      /* mapped time against the mean capture time of the sample */
+      e = fabs((double)(int64_t)(clk_sync_map(&fit, x[i]) -
+               (uint64_t)llround((ts + SIM_LAT_S + SIM_JITTER_S / 2.0) * SIM_MCU_HZ)));
+      if (fit.n > CLK_SYNC_SETTLE * 16 && e > r->err_max)
+        r->err_max = e;
+
+      if (++r->samples % r->report == 0)
+        replay_report(r, x[i]);
+    }
+    i = 0;
+  }
+
+  return 0;
+}
+
+int main(int argc, char *argv[])
+{
+  replay_t r = { 0 };
+  double ppm = 0.0, hours = 72.0;
+  int sim = 0, write = 0, opt, ret;
+  FILE *f = stdin;
+
+  while ((opt = getopt(argc, argv, "r:s:d:w")) != -1) {
+    switch (opt) {
+    case 'r':
+      r.report = (uint32_t)strtoul(optarg, NULL, 0);
+      break;
+    case 's':
+      ppm = strtod(optarg, NULL);
+      sim = 1;
+      break;
+    case 'd':
+      hours = strtod(optarg, NULL);
+      break;
+    case 'w':
+      write = 1;
+      break;
+    default:
+      fprintf(stderr, "usage: %s [-r samples] [trace.txt]\n"
+              "       %s -s ppm [-d hours] [-r samples] [-w]\n", argv[0], argv[0]);
+      return 1;
+    }
+  }
+
+  if (r.report == 0)
+    r.report = sim ? (uint32_t)(SIM_ODR_HZ * 3600.0) : 1200;
+
+  if (sim)
+    return simulate(&r, ppm, hours, write);
+
+  if (optind < argc) {
+    f = fopen(argv[optind], "r");
+    if (f == NULL) {
+      perror(argv[optind]);
+      return 1;
+    }
+  }
+
+  ret = replay(&r, f);
+
+  if (f != stdin)
+    fclose(f);
+
+  return ret;
+}
@@ -0,0 +1,544 @@
+/*
+ ******************************************************************************
+ * @file    fifo_capture.c
+ * @author  Sensors Software Solution Team
+ * @brief   Raw FIFO capture file: append-only writer and mmap based reader
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2024 STMicroelectronics.
+ * All rights reserved.</center></h2>
+ *
+ * This software component is licensed by ST under BSD 3-Clause license,
+ * the "License"; You may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at:
+ *                        opensource.org/licenses/BSD-3-Clause
+ *
+ ******************************************************************************
+ */
+
+#include "fifo_capture.h"
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+
+#define PAD8(__LEN__) (((__LEN__) + 7U) & ~7U)
+
+/*
+ * @brief  Check that a chunk lies within [off, end) of the mapping
+ *
+ * All the values come from the file: sums are done on 64 bit, where
+ * they cannot overflow (size_t offsets, 32 bit lengths).
+ *
+ * @param  r         reader
+ * @param  off       chunk offset
+ * @param  end       end of the chunk area
+ * @param  magic     expected chunk magic
+ * @retval           chunk header, NULL if not valid
+ *
+ */
+static const fifo_capture_chunk_t *replay_chunk_check(const fifo_replay_t *r,
+                                                      uint64_t off, uint64_t end,
+                                                      uint32_t magic)
+{
+  const fifo_capture_chunk_t *ch;
+
+  if (off % 8U != 0U || off < r->hdr->hdr_len || end > r->size ||
+      off > end || end - off < sizeof(*ch))
+    return NULL;
+
+  ch = (const void *)(r->map + off);
+  if (ch->magic != magic || ch->len > end - off - sizeof(*ch))
+    return NULL;
+
+  if (magic == FIFO_CAPTURE_CHUNK &&
+      (uint64_t)ch->slots * FIFO_CAPTURE_SLOT_LEN > ch->len)
+    return NULL;
+
+  return ch;
+}
+
+uint64_t fifo_capture_time_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_REALTIME, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static int32_t write_all(int fd, struct iovec *iov, int iovcnt, size_t len)
+{
+  return (writev(fd, iov, iovcnt) == (ssize_t)len) ? 0 : -1;
+}
+
+/*
+ * @brief  Create a capture file and write its header
+ *
+ * @param  c         writer
+ * @param  path      file name
+ * @param  part      part name
+ * @param  device_id WHO_AM_I value
+ * @param  reg_base  address of the first register of the snapshot
+ * @param  regs      register snapshot (configuration at capture start)
+ * @param  reg_num   snapshot length, up to FIFO_CAPTURE_REG_MAX
+ * @retval           0 on success, -1 on error
+ *
+ */
+int32_t fifo_capture_open(fifo_capture_t *c, const char *path,
+                          const char *part, uint8_t device_id,
+                          uint8_t reg_base, const uint8_t *regs,
+                          uint8_t reg_num)
+{
+  fifo_capture_hdr_t hdr;
+  struct iovec iov = { &hdr, sizeof(hdr) };
+
+  memset(c, 0, sizeof(*c));
+  memset(&hdr, 0, sizeof(hdr));
+
+  memcpy(hdr.magic, FIFO_CAPTURE_MAGIC, sizeof(hdr.magic));
+  hdr.version = FIFO_CAPTURE_VERSION;
+  hdr.hdr_len = sizeof(hdr);
+  hdr.device_id = device_id;
+  hdr.slot_len = FIFO_CAPTURE_SLOT_LEN;
+  hdr.reg_base = reg_base;
+  hdr.reg_num = (reg_num > FIFO_CAPTURE_REG_MAX) ? FIFO_CAPTURE_REG_MAX : reg_num;
+  hdr.t0_ns = fifo_capture_time_ns();
+  strncpy(hdr.part, part, sizeof(hdr.part) - 1);
+  memcpy(hdr.regs, regs, hdr.reg_num);
+
+  c->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (c->fd < 0)
+    return -1;
+
+  if (write_all(c->fd, &iov, 1, sizeof(hdr)) != 0) {
+    close(c->fd);
+    return -1;
+  }
+
+  c->offset = sizeof(hdr);
+  return 0;
+}
+
+/*
+ * @brief  Append the slots of one FIFO drain (single write)
+ *
+ * @param  c         writer
+ * @param  slots     slots as read from FIFO_DATA_OUT_TAG
+ * @param  num       number of slots
+ * @param  t_ns      host time of the drain (fifo_capture_time_ns)
+ * @retval           0 on success, -1 on error
+ *
+ */
+int32_t fifo_capture_append(fifo_capture_t *c, const uint8_t *slots,
+                            uint32_t num, uint64_t t_ns)
+{
+  static const uint8_t pad[8];
+  fifo_capture_chunk_t ch;
+  uint32_t len = num * FIFO_CAPTURE_SLOT_LEN;
+  struct iovec iov[3] = {
+    { &ch, sizeof(ch) },
+    { (void *)slots, len },
+    { (void *)pad, PAD8(len) - len },
+  };
+
+  if (c->chunks == c->index_len) {
+    uint32_t n = c->index_len ? 2 * c->index_len : 1024;
+    fifo_capture_index_t *idx = realloc(c->index, n * sizeof(*idx));
+
+    if (idx == NULL)
+      return -1;
+    c->index = idx;
+    c->index_len = n;
+  }
+
+  ch.magic = FIFO_CAPTURE_CHUNK;
+  ch.seq = c->chunks;
+  ch.t_ns = t_ns;
+  ch.slots = num;
+  ch.len = PAD8(len);
+
+  if (write_all(c->fd, iov, 3, sizeof(ch) + ch.len) != 0)
+    return -1;
+
+  c->index[c->chunks].offset = c->offset;
+  c->index[c->chunks].first_slot = c->slots;
+  c->chunks++;
+  c->offset += sizeof(ch) + ch.len;
+  c->slots += num;
+
+  return 0;
+}
+
+/*
+ * @brief  Write index and trailer, then close the file
+ *
+ * @param  c         writer
+ * @retval           0 on success, -1 on error
+ *
+ */
+int32_t fifo_capture_close(fifo_capture_t *c)
+{
+  fifo_capture_chunk_t ch;
+  fifo_capture_trailer_t tr;
+  uint32_t len = c->chunks * sizeof(fifo_capture_index_t);
+  struct iovec iov[3] = {
+    { &ch, sizeof(ch) },
+    { c->index, len },
+    { &tr, sizeof(tr) },
+  };
+  int32_t ret;
+
+  ch.magic = FIFO_CAPTURE_INDEX;
+  ch.seq = c->chunks;
+  ch.t_ns = fifo_capture_time_ns();
+  ch.slots = c->chunks;
+  ch.len = len;
+
+  tr.magic = FIFO_CAPTURE_TRAILER;
+  tr.reserved = 0;
+  tr.index_offset = c->offset;
+
+  ret = write_all(c->fd, iov, 3, sizeof(ch) + len + sizeof(tr));
+  if (close(c->fd) != 0)
+    ret = -1;
+  free(c->index);
+  c->index = NULL;
+
+  return ret;
+}
+
+/*
+ * @brief  Find the chunks of a file without index (writer not closed)
+ *
+ * @param  r         reader
+ * @retval           0 on success, -1 on error
+ *
+ */
+static int32_t replay_scan(fifo_replay_t *r)
+{
+  uint64_t off = r->hdr->hdr_len;
+  uint32_t len = 0;
+
+  while (r->chunks < UINT32_MAX) {
+    const fifo_capture_chunk_t *ch =
+      replay_chunk_check(r, off, r->size, FIFO_CAPTURE_CHUNK);
+
+    /* A partially written chunk ends the file */
+    if (ch == NULL)
+      break;
+
+    if (r->chunks == len) {
+      fifo_capture_index_t *idx;
+
+      /* Entries are smaller than chunks: no size_t overflow below */
+      if (len > UINT32_MAX / 2U)
+        return -1;
+      len = len ? 2 * len : 1024;
+      idx = realloc(r->index, (size_t)len * sizeof(*idx));
+      if (idx == NULL)
+        return -1;
+      r->index = idx;
+    }
+
+    r->index[r->chunks].offset = off;
+    r->index[r->chunks].first_slot = r->slots;
+    r->chunks++;
+    r->slots += ch->slots;
+    off += sizeof(*ch) + ch->len;
+  }
+
+  return 0;
+}
+
+/*
+ * @brief  Load the chunk index written on close
+ *
+ * Every entry is checked against the chunks it points to, so that a
+ * damaged index falls back to the scan.
+ *
+ * @param  r         reader
+ * @retval           0 on success, -1 if no valid index
+ *
+ */
+static int32_t replay_index(fifo_replay_t *r)
+{
+  const fifo_capture_trailer_t *tr;
+  const fifo_capture_chunk_t *ix;
+  uint64_t end, len, slots = 0;
+  uint32_t i;
+
+  if (r->size < r->hdr->hdr_len + sizeof(*tr))
+    return -1;
+
+  tr = (const void *)(r->map + r->size - sizeof(*tr));
+  end = r->size - sizeof(*tr);
+  if (tr->magic != FIFO_CAPTURE_TRAILER || tr->index_offset > end)
+    return -1;
+
+  ix = replay_chunk_check(r, tr->index_offset, end, FIFO_CAPTURE_INDEX);
+  if (ix == NULL)
+    return -1;
+
+  len = (uint64_t)ix->slots * sizeof(fifo_capture_index_t);
+  if (ix->len != len)
+    return -1;
+
+  r->index = malloc(len ? (size_t)len : 1);
+  if (r->index == NULL)
+    return -1;
+  memcpy(r->index, ix + 1, (size_t)len);
+
+  for (i = 0; i < ix->slots; i++) {
+    const fifo_capture_chunk_t *ch =
+      replay_chunk_check(r, r->index[i].offset, tr->index_offset,
+                         FIFO_CAPTURE_CHUNK);
+
+    if (ch == NULL || r->index[i].first_slot != slots) {
+      free(r->index);
+      r->index = NULL;
+      return -1;
+    }
+    slots += ch->slots;
+  }
+
+  r->chunks = ix->slots;
+  r->slots = slots;
+
+  return 0;
+}
+
+/*
+ * @brief  Map a capture file and load its chunk index
+ *
+ * The FIFO registers emulated by fifo_replay_read default to the ones
+ * of the LSM6DSV family (FIFO_STATUS1 0x1B, FIFO_DATA_OUT_TAG 0x78) and
+ * the replay runs at capture rate: change status_reg, data_reg and
+ * speed after opening if needed.
+ *
+ * @param  r         reader
+ * @param  path      file name
+ * @retval           0 on success, -1 on error
+ *
+ */
+int32_t fifo_replay_open(fifo_replay_t *r, const char *path)
+{
+  struct stat st;
+  int fd;
+
+  memset(r, 0, sizeof(*r));
+  r->status_reg = 0x1B;
+  r->data_reg = 0x78;
+  r->speed = 1.0;
+
+  fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    return -1;
+
+  if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(fifo_capture_hdr_t)) {
+    close(fd);
+    return -1;
+  }
+
+  r->size = (size_t)st.st_size;
+  r->map = mmap(NULL, r->size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (r->map == MAP_FAILED)
+    return -1;
+
+  r->hdr = (const void *)r->map;
+  if (memcmp(r->hdr->magic, FIFO_CAPTURE_MAGIC, sizeof(r->hdr->magic)) != 0 ||
+      r->hdr->version != FIFO_CAPTURE_VERSION ||
+      r->hdr->slot_len != FIFO_CAPTURE_SLOT_LEN ||
+      r->hdr->hdr_len < sizeof(fifo_capture_hdr_t) ||
+      r->hdr->hdr_len % 8U != 0U || r->hdr->hdr_len > r->size ||
+      r->hdr->reg_num > FIFO_CAPTURE_REG_MAX) {
+    fifo_replay_close(r);
+    return -1;
+  }
+
+  /* Index written on close, else scan the chunks */
+  if (replay_index(r) == 0)
+    return 0;
+
+  if (replay_scan(r) != 0) {
+    fifo_replay_close(r);
+    return -1;
+  }
+
+  return 0;
+}
+
+void fifo_replay_close(fifo_replay_t *r)
+{
+  if (r->map && r->map != MAP_FAILED)
+    munmap((void *)r->map, r->size);
+  free(r->index);
+  memset(r, 0, sizeof(*r));
+}
+
+/*
+ * @brief  Get a chunk; its slots follow the chunk header
+ *
+ * @param  r         reader
+ * @param  i         chunk number
+ * @retval           chunk header
+ *
+ */
+const fifo_capture_chunk_t *fifo_replay_chunk(const fifo_replay_t *r,
+                                              uint32_t i)
+{
+  return (const void *)(r->map + r->index[i].offset);
+}
+
+/*
+ * @brief  Move the FIFO emulation to a slot (binary search on the index)
+ *
+ * @param  r         reader
+ * @param  slot      slot number from the start of the capture
+ * @retval           chunk holding the slot, r->chunks if past the end
+ *
+ */
+uint32_t fifo_replay_seek(fifo_replay_t *r, uint64_t slot)
+{
+  uint32_t lo = 0, hi = r->chunks;
+
+  if (slot >= r->slots) {
+    r->chunk = r->chunks;
+    r->slot = 0;
+    return r->chunk;
+  }
+
+  while (hi - lo > 1) {
+    uint32_t mid = lo + (hi - lo) / 2;
+
+    if (r->index[mid].first_slot <= slot)
+      lo = mid;
+    else
+      hi = mid;
+  }
+
+  r->chunk = lo;
+  r->slot = (uint32_t)(slot - r->index[lo].first_slot);
+  r->start_ns = 0;
+
+  return lo;
+}
+
+/*
+ * @brief  Wait until the capture time of the current chunk
+ *
+ * @param  r         reader
+ *
+ */
+static void replay_pace(fifo_replay_t *r)
+{
+  const fifo_capture_chunk_t *ch = fifo_replay_chunk(r, r->chunk);
+  uint64_t now = fifo_capture_time_ns();
+  uint64_t due;
+
+  if (r->start_ns == 0) {
+    r->start_ns = now;
+    r->start_t_ns = ch->t_ns;
+    return;
+  }
+
+  due = r->start_ns + (uint64_t)((double)(ch->t_ns - r->start_t_ns) / r->speed);
+  if (due > now) {
+    struct timespec ts = {
+      (time_t)((due - now) / 1000000000ULL), (long)((due - now) % 1000000000ULL)
+    };
+
+    nanosleep(&ts, NULL);
+  }
+}
+
+/*
+ * @brief  stmdev_ctx_t read_reg emulating the device FIFO from a capture
+ *
+ * One FIFO drain is replayed per chunk: reading FIFO_STATUS1/2 reports
+ * the chunk slots (watermark flag set), reading FIFO_DATA_OUT_TAG
+ * returns them in order. Chunks without slots are skipped, so a level
+ * of 0 is the end of the capture. Other registers are read from the snapshot of
+ * the file header, so that e.g. the device ID check works. With
+ * speed > 0 a new chunk is not reported before its capture time.
+ *
+ * @param  handle    fifo_replay_t
+ * @param  reg       register to read
+ * @param  bufp      pointer to buffer that store the data read
+ * @param  len       number of consecutive register to read
+ *
+ */
+int32_t fifo_replay_read(void *handle, uint8_t reg, uint8_t *bufp,
+                         uint16_t len)
+{
+  fifo_replay_t *r = handle;
+  const fifo_capture_chunk_t *ch;
+  uint16_t i;
+
+  memset(bufp, 0, len);
+
+  if (reg == r->status_reg) {
+    uint32_t level;
+
+    while (r->chunk < r->chunks &&
+           r->slot == fifo_replay_chunk(r, r->chunk)->slots) {
+      r->chunk++;
+      r->slot = 0;
+    }
+    if (r->chunk >= r->chunks)
+      return 0;
+
+    ch = fifo_replay_chunk(r, r->chunk);
+    if (r->slot == 0 && r->speed > 0.0)
+      replay_pace(r);
+
+    level = ch->slots - r->slot;
+    bufp[0] = (uint8_t)level;
+    if (len > 1)
+      bufp[1] = (uint8_t)(((level >> 8) & 0x03U) | (level ? 0x80U : 0x00U));
+    return 0;
+  }
+
+  if (reg == r->data_reg) {
+    const uint8_t *slots;
+
+    if (r->chunk >= r->chunks)
+      return 0;
+
+    ch = fifo_replay_chunk(r, r->chunk);
+    slots = (const uint8_t *)(ch + 1);
+    for (i = 0; i + FIFO_CAPTURE_SLOT_LEN <= len && r->slot < ch->slots;
+         i += FIFO_CAPTURE_SLOT_LEN, r->slot++)
+      memcpy(&bufp[i], &slots[r->slot * FIFO_CAPTURE_SLOT_LEN],
+             FIFO_CAPTURE_SLOT_LEN);
+    return 0;
+  }
+
+  for (i = 0; i < len; i++) {
+    uint8_t a = (uint8_t)(reg + i);
+
+    if (a >= r->hdr->reg_base && a - r->hdr->reg_base < r->hdr->reg_num)
+      bufp[i] = r->hdr->regs[a - r->hdr->reg_base];
+  }
+
+  return 0;
+}
+
+/*
+ * @brief  stmdev_ctx_t write_reg of the replay: writes are ignored
+ */
+int32_t fifo_replay_write(void *handle, uint8_t reg, const uint8_t *bufp,
+                          uint16_t len)
+{
+  (void)handle;
+  (void)reg;
+  (void)bufp;
+  (void)len;
+
+  return 0;
+}
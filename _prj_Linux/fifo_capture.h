@@ -0,0 +1,133 @@
+/*
+ ******************************************************************************
+ * @file    fifo_capture.h
+ * @author  Sensors Software Solution Team
+ * @brief   Raw FIFO capture file: append-only writer and mmap based reader
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2024 STMicroelectronics.
+ * All rights reserved.</center></h2>
+ *
+ * This software component is licensed by ST under BSD 3-Clause license,
+ * the "License"; You may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at:
+ *                        opensource.org/licenses/BSD-3-Clause
+ *
+ ******************************************************************************
+ */
+
+#ifndef FIFO_CAPTURE_H
+#define FIFO_CAPTURE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * File layout, little endian, every record 8 bytes aligned:
+ *
+ *   fifo_capture_hdr_t      part, device ID, register snapshot
+ *   chunk                   fifo_capture_chunk_t + slots * 7 bytes
+ *   chunk                   (one per FIFO drain, host time stamped)
+ *   ...
+ *   index                   fifo_capture_chunk_t ('INDX') +
+ *                           fifo_capture_index_t per chunk
+ *   fifo_capture_trailer_t  offset of the index
+ *
+ * Slots are stored as read from FIFO_DATA_OUT_TAG (TAG + 6 bytes).
+ * Index and trailer are written on close: a file cut short (e.g. power
+ * loss) is still readable, chunks are then found by scanning.
+ */
+
+#define FIFO_CAPTURE_MAGIC       "STFIFOC1"
+#define FIFO_CAPTURE_VERSION     1
+#define FIFO_CAPTURE_SLOT_LEN    7
+#define FIFO_CAPTURE_REG_MAX     128
+
+#define FIFO_CAPTURE_CHUNK       0x4B4E4843UL /* 'CHNK' */
+#define FIFO_CAPTURE_INDEX       0x58444E49UL /* 'INDX' */
+#define FIFO_CAPTURE_TRAILER     0x524C5254UL /* 'TRLR' */
+
+typedef struct {
+  char magic[8];
+  uint32_t version;
+  uint32_t hdr_len;
+  uint8_t device_id;          /* WHO_AM_I */
+  uint8_t slot_len;           /* FIFO_CAPTURE_SLOT_LEN */
+  uint8_t reg_base;           /* address of regs[0] */
+  uint8_t reg_num;            /* valid bytes in regs */
+  uint32_t reserved;
+  uint64_t t0_ns;             /* capture start, CLOCK_REALTIME */
+  char part[16];              /* e.g. "lsm6dsv16x" */
+  uint8_t regs[FIFO_CAPTURE_REG_MAX];
+} fifo_capture_hdr_t;
+
+typedef struct {
+  uint32_t magic;
+  uint32_t seq;
+  uint64_t t_ns;              /* host time of the drain, CLOCK_REALTIME */
+  uint32_t slots;
+  uint32_t len;               /* payload bytes, padding included */
+} fifo_capture_chunk_t;
+
+typedef struct {
+  uint64_t offset;            /* chunk offset in the file */
+  uint64_t first_slot;        /* slots in the chunks before */
+} fifo_capture_index_t;
+
+typedef struct {
+  uint32_t magic;
+  uint32_t reserved;
+  uint64_t index_offset;
+} fifo_capture_trailer_t;
+
+/* Writer */
+typedef struct {
+  int fd;
+  uint64_t offset;
+  uint64_t slots;
+  uint32_t chunks;
+  uint32_t index_len;
+  fifo_capture_index_t *index;
+} fifo_capture_t;
+
+/* Reader, on a read only mapping of the file */
+typedef struct {
+  const uint8_t *map;
+  size_t size;
+  const fifo_capture_hdr_t *hdr;
+  fifo_capture_index_t *index;
+  uint32_t chunks;
+  uint64_t slots;
+
+  /* FIFO register emulation (fifo_replay_read) */
+  uint8_t status_reg;         /* FIFO_STATUS1 address */
+  uint8_t data_reg;           /* FIFO_DATA_OUT_TAG address */
+  double speed;               /* 1.0: capture rate, 0: no wait */
+  uint32_t chunk;             /* chunk being read */
+  uint32_t slot;              /* next slot in the chunk */
+  uint64_t start_ns;          /* host time of the replay start */
+  uint64_t start_t_ns;        /* capture time of the replay start */
+} fifo_replay_t;
+
+int32_t fifo_capture_open(fifo_capture_t *c, const char *path,
+                          const char *part, uint8_t device_id,
+                          uint8_t reg_base, const uint8_t *regs,
+                          uint8_t reg_num);
+int32_t fifo_capture_append(fifo_capture_t *c, const uint8_t *slots,
+                            uint32_t num, uint64_t t_ns);
+int32_t fifo_capture_close(fifo_capture_t *c);
+
+int32_t fifo_replay_open(fifo_replay_t *r, const char *path);
+void fifo_replay_close(fifo_replay_t *r);
+const fifo_capture_chunk_t *fifo_replay_chunk(const fifo_replay_t *r,
+                                              uint32_t i);
+uint32_t fifo_replay_seek(fifo_replay_t *r, uint64_t slot);
+int32_t fifo_replay_read(void *handle, uint8_t reg, uint8_t *bufp,
+                         uint16_t len);
+int32_t fifo_replay_write(void *handle, uint8_t reg, const uint8_t *bufp,
+                          uint16_t len);
+
+uint64_t fifo_capture_time_ns(void);
+
+#endif /* FIFO_CAPTURE_H */
@@ -0,0 +1,349 @@
+/*
+ ******************************************************************************
+ * @file    fifo_demux_bench.c
+ * @author  Sensors Software Solution Team
+ * @brief   Host throughput benchmark of the ILPS28QSW FIFO demultiplexer on
+ *          recorded or generated FIFO captures
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2024 STMicroelectronics.
+ * All rights reserved.</center></h2>
+ *
+ * This software component is licensed by ST under BSD 3-Clause license,
+ * the "License"; You may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at:
+ *                        opensource.org/licenses/BSD-3-Clause
+ *
+ ******************************************************************************
+ */
+
+/*
+ * Usage:
+ *
+ *   fifo_demux_bench [-r rounds] capture.txt
+ *   fifo_demux_bench [-r rounds] -s bursts [-o overrun_pct] [-w]
+ *
+ * The capture is the console output of ilps28qsw_fifo_demux.c built with
+ * DEMUX_TRACE: every burst is a "burst,<ovr>,<hex slots>" line, other
+ * lines are skipped. -s generates the given number of full FIFO bursts
+ * of interleaved pressure and AH/QVAR slots instead, dropping a random
+ * number of slots before -o percent of them (default 10) as an overrun
+ * does; -w prints the generated capture in the DEMUX_TRACE format.
+ *
+ * The bursts are loaded in memory and run -r times (default 1000)
+ * through fifo_demux() of fifo_demux.h, the code run on the device. The
+ * slots per second, the time per burst and the segments found are
+ * reported, and every view is checked: slots accounted for, flag of the
+ * stream in each slot, stride of 2 slots inside a segment. The exit
+ * status is 1 if a check fails.
+ *
+ * Build: gcc -O2 -I $STDC_PATH/ilps28qsw_STdC/examples fifo_demux_bench.c
+ *        -o fifo_demux_bench
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "fifo_demux.h"
+
+/* Slot rate of the example (only scales the segment timestamps) */
+#define ODR_HZ            200
+
+typedef struct {
+  uint8_t *buf;               /* num * FIFO_DEPTH * FIFO_SLOT_LEN */
+  uint16_t *level;
+  uint8_t *ovr;
+  uint32_t num;
+  uint32_t cap;
+} capture_t;
+
+static int capture_add(capture_t *c, const uint8_t *slots, uint16_t level,
+                       uint8_t ovr)
+{
+  if (c->num == c->cap) {
+    uint32_t cap = c->cap ? c->cap * 2U : 256U;
+    uint8_t *buf = realloc(c->buf, (size_t)cap * FIFO_DEPTH * FIFO_SLOT_LEN);
+    uint16_t *lvl;
+    uint8_t *o;
+
+    if (buf == NULL)
+      return -1;
+    c->buf = buf;
+    lvl = realloc(c->level, cap * sizeof(*lvl));
+    if (lvl == NULL)
+      return -1;
+    c->level = lvl;
+    o = realloc(c->ovr, cap);
+    if (o == NULL)
+      return -1;
+    c->ovr = o;
+    c->cap = cap;
+  }
+
+  memcpy(&c->buf[(size_t)c->num * FIFO_DEPTH * FIFO_SLOT_LEN], slots,
+         (size_t)level * FIFO_SLOT_LEN);
+  c->level[c->num] = level;
+  c->ovr[c->num] = ovr;
+  c->num++;
+
+  return 0;
+}
+
+static int hex_digit(char c)
+{
+  if (c >= '0' && c <= '9')
+    return c - '0';
+  if (c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F')
+    return c - 'A' + 10;
+  return -1;
+}
+
+static int capture_load(capture_t *c, const char *path)
+{
+  uint8_t slots[FIFO_DEPTH * FIFO_SLOT_LEN];
+  char line[4 * FIFO_DEPTH * FIFO_SLOT_LEN];
+  uint32_t lineno = 0;
+  FILE *f;
+
+  f = fopen(path, "r");
+  if (f == NULL) {
+    perror(path);
+    return -1;
+  }
+
+  while (fgets(line, sizeof(line), f) != NULL) {
+    unsigned int ovr;
+    size_t n = 0;
+    char *p;
+    int hi, lo;
+
+    lineno++;
+    if (strncmp(line, "burst,", 6) != 0)
+      continue;
+
+    p = strchr(line + 6, ',');
+    if (p == NULL || sscanf(line + 6, "%u", &ovr) != 1)
+      goto bad;
+
+    for (p++; (hi = hex_digit(p[0])) >= 0; p += 2) {
+      lo = hex_digit(p[1]);
+      if (lo < 0 || n == sizeof(slots))
+        goto bad;
+      slots[n++] = (uint8_t)(hi << 4 | lo);
+    }
+    if (n == 0 || n % FIFO_SLOT_LEN != 0)
+      goto bad;
+
+    if (capture_add(c, slots, (uint16_t)(n / FIFO_SLOT_LEN), ovr != 0) != 0) {
+      fprintf(stderr, "out of memory\n");
+      fclose(f);
+      return -1;
+    }
+  }
+
+  fclose(f);
+  return 0;
+
+bad:
+  fprintf(stderr, "%s:%lu: bad burst line\n", path, (unsigned long)lineno);
+  fclose(f);
+  return -1;
+}
+
+/*
+ * Interleaved stream of the sensor: slots alternate pressure (flag 0)
+ * and AH/QVAR (flag 1); an overrun loses a random number of slots, which
+ * can shift the interleave phase in the burst.
+ */
+static int capture_sim(capture_t *c, uint32_t bursts, uint32_t ovr_pct)
+{
+  uint8_t slots[FIFO_DEPTH * FIFO_SLOT_LEN];
+  uint64_t seq = 0;
+  uint32_t n;
+  uint16_t i;
+
+  srand(1);
+
+  for (n = 0; n < bursts; n++) {
+    uint8_t ovr = 0;
+
+    for (i = 0; i < FIFO_DEPTH; i++) {
+      uint32_t val = (uint32_t)rand() & 0xFFFFFEU;
+
+      if (i > 0 && (uint32_t)(rand() % (100 * FIFO_DEPTH)) < ovr_pct) {
+        seq += 1U + (uint32_t)rand() % FIFO_DEPTH;
+        ovr = 1;
+      }
+
+      val |= (uint32_t)(seq & 1U);
+      slots[i * FIFO_SLOT_LEN] = (uint8_t)val;
+      slots[i * FIFO_SLOT_LEN + 1] = (uint8_t)(val >> 8);
+      slots[i * FIFO_SLOT_LEN + 2] = (uint8_t)(val >> 16);
+      seq++;
+    }
+
+    if (capture_add(c, slots, FIFO_DEPTH, ovr) != 0) {
+      fprintf(stderr, "out of memory\n");
+      return -1;
+    }
+  }
+
+  return 0;
+}
+
+static void capture_write(const capture_t *c)
+{
+  uint32_t n, i;
+
+  for (n = 0; n < c->num; n++) {
+    const uint8_t *p = &c->buf[(size_t)n * FIFO_DEPTH * FIFO_SLOT_LEN];
+
+    printf("burst,%d,", c->ovr[n]);
+    for (i = 0; i < (uint32_t)c->level[n] * FIFO_SLOT_LEN; i++)
+      printf("%02x", p[i]);
+    printf("\n");
+  }
+}
+
+/* Check the views of one burst, returns the number of errors */
+static uint32_t view_check(const uint8_t *buf, uint16_t level,
+                           const stream_view_t *v)
+{
+  uint32_t err = 0;
+  uint16_t seen = 0;
+  uint8_t type, n;
+  uint16_t k;
+
+  for (type = 0; type < 2U; type++) {
+    uint16_t len = 0;
+
+    for (n = 0; n < v[type].nseg; n++) {
+      const uint8_t *p = v[type].seg[n].base;
+
+      if (p < buf || p + (2U * (v[type].seg[n].len - 1U) + 1U) *
+          FIFO_SLOT_LEN > buf + (size_t)level * FIFO_SLOT_LEN) {
+        err++;
+        continue;
+      }
+
+      for (k = 0; k < v[type].seg[n].len; k++, p += 2 * FIFO_SLOT_LEN)
+        if ((p[0] & 0x01U) != type)
+          err++;
+
+      len += v[type].seg[n].len;
+    }
+
+    if (len != v[type].len)
+      err++;
+    seen += len + v[type].dropped;
+  }
+
+  return err + (seen != level);
+}
+
+static double now_s(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main(int argc, char *argv[])
+{
+  uint64_t slots = 0, seg = 0, dropped = 0, first = 0;
+  uint32_t rounds = 1000, bursts = 0, ovr_pct = 10, err = 0, ovr = 0;
+  stream_view_t v[2];
+  capture_t c = { 0 };
+  int opt, wr = 0;
+  uint32_t r, n;
+  double t;
+
+  while ((opt = getopt(argc, argv, "r:s:o:w")) != -1) {
+    switch (opt) {
+    case 'r':
+      rounds = (uint32_t)strtoul(optarg, NULL, 0);
+      break;
+    case 's':
+      bursts = (uint32_t)strtoul(optarg, NULL, 0);
+      break;
+    case 'o':
+      ovr_pct = (uint32_t)strtoul(optarg, NULL, 0);
+      break;
+    case 'w':
+      wr = 1;
+      break;
+    default:
+      goto usage;
+    }
+  }
+
+  if (bursts > 0U && optind == argc) {
+    if (capture_sim(&c, bursts, ovr_pct) != 0)
+      return 1;
+  } else if (bursts == 0U && optind == argc - 1) {
+    if (capture_load(&c, argv[optind]) != 0)
+      return 1;
+  } else {
+    goto usage;
+  }
+
+  if (wr) {
+    capture_write(&c);
+    return 0;
+  }
+
+  if (c.num == 0U || rounds == 0U) {
+    fprintf(stderr, "no bursts (build the example with DEMUX_TRACE)\n");
+    return 1;
+  }
+
+  /* One checked pass, then the timed ones */
+  for (n = 0; n < c.num; n++) {
+    const uint8_t *buf = &c.buf[(size_t)n * FIFO_DEPTH * FIFO_SLOT_LEN];
+
+    fifo_demux(buf, c.level[n], first, ODR_HZ, v);
+    err += view_check(buf, c.level[n], v);
+    slots += c.level[n];
+    seg += v[STREAM_PRESS].nseg + v[STREAM_QVAR].nseg;
+    dropped += v[STREAM_PRESS].dropped + v[STREAM_QVAR].dropped;
+    ovr += c.ovr[n];
+    first += c.level[n];
+  }
+
+  t = now_s();
+  for (r = 0; r < rounds; r++) {
+    for (n = 0; n < c.num; n++) {
+      fifo_demux(&c.buf[(size_t)n * FIFO_DEPTH * FIFO_SLOT_LEN], c.level[n],
+                 first, ODR_HZ, v);
+      /* Keep the views live across calls */
+      __asm__ __volatile__("" : : "r"(v) : "memory");
+    }
+  }
+  t = now_s() - t;
+
+  printf("%lu bursts (%lu overrun), %llu slots, %.2f segments/burst, "
+         "%llu dropped\n", (unsigned long)c.num, (unsigned long)ovr,
+         (unsigned long long)slots, (double)seg / c.num,
+         (unsigned long long)dropped);
+  printf("%.1f Mslot/s, %.1f ns/burst (%lu rounds)\n",
+         slots * rounds / t / 1e6, t * 1e9 / ((double)c.num * rounds),
+         (unsigned long)rounds);
+  if (err)
+    printf("%lu view errors  FAIL\n", (unsigned long)err);
+
+  return err != 0;
+
+usage:
+  fprintf(stderr, "usage: %s [-r rounds] capture.txt\n"
+          "       %s [-r rounds] -s bursts [-o overrun_pct] [-w]\n",
+          argv[0], argv[0]);
+  return 1;
+}
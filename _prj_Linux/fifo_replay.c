@@ -0,0 +1,221 @@
+/*
+ ******************************************************************************
+ * @file    fifo_replay.c
+ * @author  Sensors Software Solution Team
+ * @brief   Raw FIFO capture file tool: info, columnar / CSV conversion and
+ *          replay speed benchmark
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2024 STMicroelectronics.
+ * All rights reserved.</center></h2>
+ *
+ * This software component is licensed by ST under BSD 3-Clause license,
+ * the "License"; You may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at:
+ *                        opensource.org/licenses/BSD-3-Clause
+ *
+ ******************************************************************************
+ */
+
+/*
+ * Usage:
+ *
+ *   fifo_replay info capture.bin
+ *   fifo_replay columns capture.bin outdir
+ *   fifo_replay csv capture.bin
+ *   fifo_replay bench capture.bin
+ *
+ * "columns" writes one little endian array per field, one element per
+ * slot: t_ns.u64 (host time of the drain), tag.u8, cnt.u8, and the
+ * three 16-bit words of the slot x.i16, y.i16, z.i16 (for timestamp
+ * slots x and y are the low and high halves of the timestamp).
+ *
+ * "bench" replays the file through fifo_replay_read with no pacing, as a
+ * driver based decoder would read it, and reports the replay rate.
+ *
+ * Build: gcc -O2 fifo_replay.c fifo_capture.c -o fifo_replay
+ */
+
+#include "fifo_capture.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Columns written by "columns" */
+enum {
+  COL_T,
+  COL_TAG,
+  COL_CNT,
+  COL_X,
+  COL_Y,
+  COL_Z,
+  COL_NUM,
+};
+
+static const char *col_name[COL_NUM] = {
+  "t_ns.u64", "tag.u8", "cnt.u8", "x.i16", "y.i16", "z.i16",
+};
+
+static int16_t word_get(const uint8_t *d)
+{
+  return (int16_t)((uint16_t)d[0] | ((uint16_t)d[1] << 8));
+}
+
+static int replay_info(fifo_replay_t *r)
+{
+  uint64_t tags[32] = { 0 };
+  uint64_t t_first = 0, t_last = 0;
+  uint32_t i, k;
+
+  for (i = 0; i < r->chunks; i++) {
+    const fifo_capture_chunk_t *ch = fifo_replay_chunk(r, i);
+    const uint8_t *s = (const uint8_t *)(ch + 1);
+
+    for (k = 0; k < ch->slots; k++)
+      tags[s[k * FIFO_CAPTURE_SLOT_LEN] >> 3]++;
+    if (i == 0)
+      t_first = ch->t_ns;
+    t_last = ch->t_ns;
+  }
+
+  printf("part %.16s, device id 0x%02X, %u registers from 0x%02X\n",
+         r->hdr->part, r->hdr->device_id, r->hdr->reg_num, r->hdr->reg_base);
+  printf("%u chunks, %llu slots, %.3f s\n", r->chunks,
+         (unsigned long long)r->slots, (t_last - t_first) / 1e9);
+  for (i = 0; i < 32; i++)
+    if (tags[i])
+      printf("  tag 0x%02X: %llu slots\n", i, (unsigned long long)tags[i]);
+
+  return 0;
+}
+
+static int replay_columns(fifo_replay_t *r, const char *dir)
+{
+  FILE *col[COL_NUM];
+  char path[512];
+  uint32_t i, k, c;
+
+  for (c = 0; c < COL_NUM; c++) {
+    snprintf(path, sizeof(path), "%s/%s", dir, col_name[c]);
+    col[c] = fopen(path, "wb");
+    if (col[c] == NULL) {
+      perror(path);
+      return 1;
+    }
+  }
+
+  for (i = 0; i < r->chunks; i++) {
+    const fifo_capture_chunk_t *ch = fifo_replay_chunk(r, i);
+    const uint8_t *s = (const uint8_t *)(ch + 1);
+
+    for (k = 0; k < ch->slots; k++, s += FIFO_CAPTURE_SLOT_LEN) {
+      uint8_t tag = s[0] >> 3;
+      uint8_t cnt = (s[0] >> 1) & 0x03U;
+      int16_t w[3] = { word_get(&s[1]), word_get(&s[3]), word_get(&s[5]) };
+
+      /* Host and device are little endian here */
+      fwrite(&ch->t_ns, sizeof(ch->t_ns), 1, col[COL_T]);
+      fwrite(&tag, 1, 1, col[COL_TAG]);
+      fwrite(&cnt, 1, 1, col[COL_CNT]);
+      fwrite(&w[0], 2, 1, col[COL_X]);
+      fwrite(&w[1], 2, 1, col[COL_Y]);
+      fwrite(&w[2], 2, 1, col[COL_Z]);
+    }
+  }
+
+  for (c = 0; c < COL_NUM; c++)
+    fclose(col[c]);
+
+  printf("%llu slots written to %s\n", (unsigned long long)r->slots, dir);
+  return 0;
+}
+
+static int replay_csv(fifo_replay_t *r)
+{
+  uint32_t i, k;
+
+  printf("t_ns,tag,cnt,x,y,z\n");
+  for (i = 0; i < r->chunks; i++) {
+    const fifo_capture_chunk_t *ch = fifo_replay_chunk(r, i);
+    const uint8_t *s = (const uint8_t *)(ch + 1);
+
+    for (k = 0; k < ch->slots; k++, s += FIFO_CAPTURE_SLOT_LEN)
+      printf("%llu,%u,%u,%d,%d,%d\n", (unsigned long long)ch->t_ns,
+             s[0] >> 3, (s[0] >> 1) & 0x03U, word_get(&s[1]),
+             word_get(&s[3]), word_get(&s[5]));
+  }
+
+  return 0;
+}
+
+static int replay_bench(fifo_replay_t *r)
+{
+  uint64_t slots = 0, sum = 0, t;
+  uint8_t st[2], slot[FIFO_CAPTURE_SLOT_LEN];
+  double dur;
+
+  r->speed = 0.0;
+  fifo_replay_seek(r, 0);
+  t = fifo_capture_time_ns();
+
+  /* Same accesses as a driver FIFO loop: status, then slot by slot */
+  while (1) {
+    uint16_t level;
+
+    fifo_replay_read(r, r->status_reg, st, 2);
+    level = (uint16_t)(st[0] | ((st[1] & 0x03U) << 8));
+    /* Chunks without slots are skipped: 0 is the end of the capture */
+    if (level == 0)
+      break;
+
+    while (level--) {
+      fifo_replay_read(r, r->data_reg, slot, sizeof(slot));
+      sum += (uint16_t)word_get(&slot[1]);
+      slots++;
+    }
+  }
+
+  t = fifo_capture_time_ns() - t;
+  dur = r->chunks > 1 ?
+        (fifo_replay_chunk(r, r->chunks - 1)->t_ns -
+         fifo_replay_chunk(r, 0)->t_ns) / 1e9 : 0.0;
+
+  printf("%llu slots replayed in %.3f ms, %.1f Mslots/s (%.0fx capture rate, sum %llx)\n",
+         (unsigned long long)slots, t / 1e6, slots * 1e3 / (double)t,
+         (dur > 0.0 && t) ? dur * 1e9 / (double)t : 0.0,
+         (unsigned long long)sum);
+
+  return 0;
+}
+
+int main(int argc, char *argv[])
+{
+  fifo_replay_t r;
+  int ret;
+
+  if (argc < 3 || (strcmp(argv[1], "columns") == 0 && argc < 4)) {
+    fprintf(stderr, "usage: %s info|csv|bench capture.bin\n"
+            "       %s columns capture.bin outdir\n", argv[0], argv[0]);
+    return 1;
+  }
+
+  if (fifo_replay_open(&r, argv[2]) != 0) {
+    fprintf(stderr, "%s: not a FIFO capture file\n", argv[2]);
+    return 1;
+  }
+
+  if (strcmp(argv[1], "info") == 0)
+    ret = replay_info(&r);
+  else if (strcmp(argv[1], "columns") == 0)
+    ret = replay_columns(&r, argv[3]);
+  else if (strcmp(argv[1], "csv") == 0)
+    ret = replay_csv(&r);
+  else if (strcmp(argv[1], "bench") == 0)
+    ret = replay_bench(&r);
+  else
+    ret = 1;
+
+  fifo_replay_close(&r);
+  return ret;
+}
@@ -0,0 +1,256 @@
+/*
+ ******************************************************************************
+ * @file    fixed_point_check.c
+ * @author  Sensors Software Solution Team
+ * @brief   Host check of the fixed-point conversions of the HTS221, STTS22H
+ *          and STTS751 *_read_data_fixed_point.c examples over the whole
+ *          raw range
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2024 STMicroelectronics.
+ * All rights reserved.</center></h2>
+ *
+ * This software component is licensed by ST under BSD 3-Clause license,
+ * the "License"; You may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at:
+ *                        opensource.org/licenses/BSD-3-Clause
+ *
+ ******************************************************************************
+ */
+
+/*
+ * Usage:
+ *
+ *   fixed_point_check [-n calibrations]
+ *
+ * Every int16 raw value is converted with the integer code of the
+ * examples (copied below, keep in sync) and compared with the
+ * floating-point conversion, computed in double. STTS22H and STTS751 have
+ * a fixed sensitivity; HTS221 is checked on -n pseudo-random calibrations
+ * (default 1000) in the range of the factory ones, plus the extreme
+ * ones. The largest error is reported in Q16 LSB and in the output unit;
+ * the exit status is 1 if it exceeds ERR_MAX.
+ *
+ * Build: gcc -O2 fixed_point_check.c -lm -o fixed_point_check
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/*
+ * Largest error accepted [%RH or degC]: the Q8.24 slope is rounded to
+ * 2^-25 unit/LSB, i.e. 2^-9 over the 2^16 raw span, plus the final
+ * rounding to Q16
+ */
+#define ERR_MAX           (1.0 / 512.0 + 1.0 / 65536.0)
+
+/* Code under test: hts221_read_data_fixed_point.c -----------------------*/
+typedef struct {
+  int32_t y0;
+  int32_t slope;
+  int16_t x0;
+} lin_q16_t;
+
+static void lin_q16_init(lin_q16_t *lin, int16_t x0, int16_t y0,
+                         int16_t x1, int16_t y1, uint8_t frac)
+{
+  int32_t dx = (int32_t)x1 - x0;
+  int64_t dy = ((int64_t)y1 - y0) * (1LL << (24 - frac));
+
+  /* Round to nearest: divide by a positive dx */
+  if (dx < 0) {
+    dx = -dx;
+    dy = -dy;
+  }
+
+  lin->x0 = x0;
+  lin->y0 = (int32_t)y0 * (1L << (16 - frac));
+  lin->slope = (dx != 0) ?
+               (int32_t)((dy + ((dy < 0) ? -(dx / 2) : (dx / 2))) / dx) : 0;
+}
+
+static void lin_q16_apply(const lin_q16_t *lin, const int16_t *x,
+                          int32_t *y, uint16_t len, int32_t min, int32_t max)
+{
+  int64_t val;
+  uint16_t i;
+
+  /* Clamped on 64 bit: steep calibrations exceed the Q16.16 range */
+  for (i = 0; i < len; i++) {
+    val = lin->y0 + ((((int64_t)x[i] - lin->x0) * lin->slope + (1 << 7)) >> 8);
+    y[i] = (val < min) ? min : (val > max) ? max : (int32_t)val;
+  }
+}
+
+/* Code under test: stts22h_read_data_fixed_point.c ----------------------*/
+static void stts22h_raw_to_q16(const int16_t *x, int32_t *y, uint16_t len)
+{
+  uint16_t i;
+
+  for (i = 0; i < len; i++)
+    y[i] = ((int32_t)x[i] * 41943L + 32L) >> 6;
+}
+
+/* Code under test: stts751_read_data_fixed_point.c ----------------------*/
+static void stts751_raw_to_q16(const int16_t *x, int32_t *y, uint16_t len)
+{
+  uint16_t i;
+
+  for (i = 0; i < len; i++)
+    y[i] = (int32_t)x[i] * 256L;
+}
+
+/* ------------------------------------------------------------------------*/
+typedef struct {
+  const char *name;
+  double max;                 /* largest error [Q16 LSB] */
+  int16_t at;                 /* raw value of the largest error */
+} check_t;
+
+static int16_t raw[65536];
+static int32_t out[65536];
+
+static void check_update(check_t *c, const int32_t *y, const double *ref)
+{
+  uint32_t i;
+
+  for (i = 0; i < 65536U; i++) {
+    double err = fabs((double)y[i] - ref[i] * 65536.0);
+
+    if (err > c->max) {
+      c->max = err;
+      c->at = raw[i];
+    }
+  }
+}
+
+static int check_report(const check_t *c, const char *unit)
+{
+  double err = c->max / 65536.0;
+
+  printf("%-16s max error %8.2f Q16 LSB = %.6f %s (raw %d)%s\n", c->name,
+         c->max, err, unit, c->at, err > ERR_MAX ? "  FAIL" : "");
+
+  return err > ERR_MAX;
+}
+
+/* Reference of the driver: line through the two calibration points */
+static void hts221_ref(double *ref, int16_t x0, double y0, int16_t x1,
+                       double y1, double min, double max)
+{
+  uint32_t i;
+
+  for (i = 0; i < 65536U; i++) {
+    double y = ((y1 - y0) * raw[i] + (x1 * y0 - x0 * y1)) / (x1 - x0);
+
+    ref[i] = (y < min) ? min : (y > max) ? max : y;
+  }
+}
+
+static int16_t rnd(int32_t lo, int32_t hi)
+{
+  return (int16_t)(lo + rand() % (hi - lo + 1));
+}
+
+static void hts221_check(check_t *hum, check_t *temp, uint32_t num)
+{
+  static double ref[65536];
+  lin_q16_t lin;
+  uint32_t n;
+
+  srand(1);
+
+  for (n = 0; n < num + 2U; n++) {
+    int16_t h0, h1, h0_out, h1_out, t0, t1, t0_out, t1_out;
+
+    if (n == num) {
+      /* Steepest calibrations: smallest ADC span, largest output span */
+      h0 = 0; h1 = 255; h0_out = 0; h1_out = 1;
+      t0 = 0; t1 = 1023; t0_out = 0; t1_out = 1;
+    } else if (n == num + 1U) {
+      /* Flattest: largest ADC span, smallest output span */
+      h0 = 0; h1 = 1; h0_out = -32768; h1_out = 32767;
+      t0 = 0; t1 = 1; t0_out = -32768; t1_out = 32767;
+    } else {
+      /* H0_rH_x2, H1_rH_x2 (8 bit), T0/T1_degC_x8 (10 bit) and outputs */
+      h0 = rnd(30, 80);
+      h1 = rnd(120, 200);
+      h0_out = rnd(-4000, 4000);
+      h1_out = (int16_t)(h0_out + rnd(-16000, -4000));
+      t0 = rnd(80, 240);
+      t1 = rnd(240, 400);
+      t0_out = rnd(-1000, 1000);
+      t1_out = (int16_t)(t0_out + rnd(200, 1200));
+    }
+
+    /* Humidity: %RH x2, clamped in [0, 100] %RH */
+    lin_q16_init(&lin, h0_out, h0, h1_out, h1, 1);
+    lin_q16_apply(&lin, raw, out, 32768U, 0, 100L << 16);
+    lin_q16_apply(&lin, raw + 32768, out + 32768, 32768U, 0, 100L << 16);
+    hts221_ref(ref, h0_out, h0 / 2.0, h1_out, h1 / 2.0, 0.0, 100.0);
+    check_update(hum, out, ref);
+
+    /* Temperature: degC x8, saturated to the Q16.16 range */
+    lin_q16_init(&lin, t0_out, t0, t1_out, t1, 3);
+    lin_q16_apply(&lin, raw, out, 32768U, INT32_MIN, INT32_MAX);
+    lin_q16_apply(&lin, raw + 32768, out + 32768, 32768U, INT32_MIN, INT32_MAX);
+    hts221_ref(ref, t0_out, t0 / 8.0, t1_out, t1 / 8.0,
+               INT32_MIN / 65536.0, INT32_MAX / 65536.0);
+    check_update(temp, out, ref);
+  }
+}
+
+static void fixed_sens_check(check_t *c,
+                             void (*conv)(const int16_t *, int32_t *, uint16_t),
+                             double lsb_per_degc)
+{
+  static double ref[65536];
+  uint32_t i;
+
+  conv(raw, out, 32768U);
+  conv(raw + 32768, out + 32768, 32768U);
+  for (i = 0; i < 65536U; i++)
+    ref[i] = raw[i] / lsb_per_degc;
+  check_update(c, out, ref);
+}
+
+int main(int argc, char *argv[])
+{
+  check_t hum = { "HTS221 humidity", 0.0, 0 };
+  check_t temp = { "HTS221 temp", 0.0, 0 };
+  check_t stts22h = { "STTS22H temp", 0.0, 0 };
+  check_t stts751 = { "STTS751 temp", 0.0, 0 };
+  uint32_t num = 1000, i;
+  int opt, fail = 0;
+
+  while ((opt = getopt(argc, argv, "n:")) != -1) {
+    switch (opt) {
+    case 'n':
+      num = (uint32_t)strtoul(optarg, NULL, 0);
+      break;
+    default:
+      fprintf(stderr, "usage: %s [-n calibrations]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  for (i = 0; i < 65536U; i++)
+    raw[i] = (int16_t)(i - 32768U);
+
+  hts221_check(&hum, &temp, num);
+  fixed_sens_check(&stts22h, stts22h_raw_to_q16, 100.0);
+  fixed_sens_check(&stts751, stts751_raw_to_q16, 256.0);
+
+  printf("%lu HTS221 calibrations, 65536 raw values each\n",
+         (unsigned long)num + 2UL);
+  fail |= check_report(&hum, "%RH");
+  fail |= check_report(&temp, "degC");
+  fail |= check_report(&stts22h, "degC");
+  fail |= check_report(&stts751, "degC");
+
+  return fail;
+}
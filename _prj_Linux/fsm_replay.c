@@ -0,0 +1,777 @@
+/*
+ ******************************************************************************
+ * @file    fsm_replay.c
+ * @author  Sensors Software Solution Team
+ * @brief   Host interpreter of the LSM6DSOX FSM programs of
+ *          lsm6dsox_prg_defs.h, checked against recorded traces
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2024 STMicroelectronics.
+ * All rights reserved.</center></h2>
+ *
+ * This software component is licensed by ST under BSD 3-Clause license,
+ * the "License"; You may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at:
+ *                        opensource.org/licenses/BSD-3-Clause
+ *
+ ******************************************************************************
+ */
+
+/*
+ * Usage:
+ *
+ *   fsm_replay [-j jobs] [-d delay] [-s sens_g] [-v num] trace.txt ...
+ *   fsm_replay -w [-s sens_g] trace.txt
+ *
+ * A trace is the console output of lsm6dsox_fsm_trace_record.c: one line
+ * per FSM input sample (26 Hz),
+ *
+ *   n, ax, ay, az, gx, gy, gz, fsm_status, fsm_outs1..7, long_cnt
+ *
+ * with fsm_status and fsm_outs in hex; other lines are skipped. The seven
+ * programs are loaded as the recorder does and run sample by sample on
+ * the accelerometer data (-s g/LSB, default 0.000061 for the 2 g full
+ * scale of the recorder). The interrupt status, the outputs and the long
+ * counter of every program are compared with the ones recorded from the
+ * device, -d samples later (default 0). Per trace, the number of samples,
+ * the interrupts of each program (interpreter/device) and the mismatches
+ * are reported; -v prints the first num mismatches. Traces are processed
+ * in parallel by -j threads (default: the online CPUs). The exit status
+ * is 1 if any trace mismatches.
+ *
+ * A trace with only the sensor columns is run without check; -w prints
+ * it back with the columns of the interpreter, in the recorder format.
+ *
+ * The interpreter follows AN5273 "LSM6DSOX: Finite State Machine" for
+ * what the seven programs use, anything else is reported as unsupported:
+ *
+ * - layout: CONFIG_A, CONFIG_B, SIZE, SETTINGS, RP, PP, then NR_THRESH
+ *   thresholds (half float), NR_MASK mask / temporary mask pairs, TC and
+ *   the NR_TIMER 8 bit timers (TIMER3, TIMER4), DEST if CONFIG_B.DECTREE
+ * - SETTINGS: MASKSEL, SIGNED, input selection 0 (accelerometer X, Y, Z
+ *   and norm V, in g, rounded to half float as the FSM does)
+ * - conditions (reset in the high nibble, next in the low one): NOP, TI3,
+ *   TI4, GNTH1, GNTH2, LNTH1, LNTH2, GLTH1, LLTH1, GRTH1, LRTH1, PZC, NZC,
+ *   CHKDT (the recorder loads no MLC, so the tree outputs are 0)
+ * - commands: STOP, CONT, CONTREL, SRP, CRP, SELMA, SELMB, SELMC, OUTC,
+ *   SELTHR1, SELTHR3, REL
+ *
+ * One condition is evaluated per sample, on the axes of the temporary
+ * mask; a condition met narrows the temporary mask to the axes that met
+ * it and the commands that follow run in the same sample. A timer is loaded when its
+ * condition is reached and expires after TIMERx samples.
+ *
+ * Build: gcc -O2 -pthread -I $STDC_PATH/lsm6dsox_STdC/examples \
+ *            fsm_replay.c -lm -o fsm_replay
+ */
+
+#include <math.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "lsm6dsox_prg_defs.h"
+
+/* Programs in the order of the recorder (FSM1..FSM7) */
+#define FSM_PRG_NUM       7
+#define JOBS_MAX          64
+
+/* CONFIG_B */
+#define CFGB_DECTREE      0x10U
+
+/* SETTINGS */
+#define SET_MASKSEL(s)    (((s) >> 6) & 0x03U)
+#define SET_SIGNED        0x20U
+#define SET_R_TAM         0x10U
+#define SET_T_AM          0x08U
+#define SET_IN_SEL(s)     ((s) & 0x07U)
+
+/* Conditions */
+enum {
+  C_NOP, C_TI1, C_TI2, C_TI3, C_TI4, C_GNTH1, C_GNTH2, C_LNTH1, C_LNTH2,
+  C_GLTH1, C_LLTH1, C_GRTH1, C_LRTH1, C_PZC, C_NZC, C_CHKDT,
+};
+
+/* Commands */
+enum {
+  OP_STOP = 0x00, OP_CONT = 0x11, OP_CONTREL = 0x22, OP_SRP = 0x33,
+  OP_CRP = 0x44, OP_SELMA = 0x66, OP_SELMB = 0x77, OP_SELMC = 0x88,
+  OP_OUTC = 0x99, OP_SELTHR1 = 0xCC, OP_SELTHR3 = 0xDD, OP_REL = 0xFF,
+};
+
+static const struct {
+  const char *name;
+  const uint8_t *prg;
+  uint8_t len;
+} prg_list[FSM_PRG_NUM] = {
+  { "glance", lsm6sox_prg_glance, sizeof(lsm6sox_prg_glance) },
+  { "motion", lsm6sox_prg_motion, sizeof(lsm6sox_prg_motion) },
+  { "no_motion", lsm6sox_prg_no_motion, sizeof(lsm6sox_prg_no_motion) },
+  { "wakeup", lsm6sox_prg_wakeup, sizeof(lsm6sox_prg_wakeup) },
+  { "pickup", lsm6sox_prg_pickup, sizeof(lsm6sox_prg_pickup) },
+  { "orientation", lsm6sox_prg_orientation,
+    sizeof(lsm6sox_prg_orientation) },
+  { "wrist_tilt", lsm6sox_prg_wrist_tilt, sizeof(lsm6sox_prg_wrist_tilt) },
+};
+
+/* State of one program */
+typedef struct {
+  uint8_t size;
+  uint8_t code;               /* first instruction */
+  uint8_t rp, pp;
+  float th[3];
+  uint8_t mask[3];
+  uint8_t masksel;
+  uint8_t tmask;
+  uint8_t th3;                /* SELTHR3: THRESH3 used in place of THRESH1 */
+  uint8_t timer[4];
+  uint8_t tc;
+  uint8_t entered;            /* condition at pp reached, timer loaded */
+  uint8_t dest[2];
+  uint8_t dectree;
+  uint8_t sign;
+  uint8_t outs;
+  uint8_t irq;
+  uint8_t stop;
+  float prev[4];
+  uint8_t prev_ok;
+  const uint8_t *prg;
+  char err[96];
+} fsm_t;
+
+typedef struct {
+  fsm_t fsm[FSM_PRG_NUM];
+  uint16_t long_cnt;
+} fsm_dev_t;
+
+/* Options */
+static float sens = 0.000061f;
+static long delay;
+static long verbose;
+static int wr;
+
+/* ------------------------------------------------------------------------*/
+static float half_to_float(uint16_t h)
+{
+  int exp = (h >> 10) & 0x1F;
+  float m = (float)(h & 0x3FFU);
+  float v;
+
+  if (exp == 0)
+    v = ldexpf(m, -24);
+  else if (exp == 31)
+    v = INFINITY;
+  else
+    v = ldexpf(m + 1024.0f, exp - 25);
+
+  return (h & 0x8000U) ? -v : v;
+}
+
+/* Round to the nearest half float value (FSM arithmetic) */
+static float half_round(float v)
+{
+  float a = fabsf(v);
+  int exp;
+
+  if (a >= 65520.0f)
+    return copysignf(INFINITY, v);
+  if (a < ldexpf(1.0f, -14))
+    return copysignf(nearbyintf(ldexpf(a, 24)) * ldexpf(1.0f, -24), v);
+
+  frexpf(a, &exp);
+  return copysignf(ldexpf(nearbyintf(ldexpf(a, 11 - exp)), exp - 11), v);
+}
+
+/*
+ * Load a program, returns 0 or -1 with f->err set
+ */
+static int fsm_load(fsm_t *f, const uint8_t *prg, uint8_t len)
+{
+  uint8_t cfg_a = prg[0], cfg_b = prg[1];
+  uint8_t nth = cfg_a >> 6, nmask = (cfg_a >> 4) & 3U;
+  uint8_t nltimer = (cfg_a >> 2) & 3U, ntimer = cfg_a & 3U;
+  uint8_t set = prg[3];
+  unsigned int off = 6, i;
+
+  memset(f, 0, sizeof(*f));
+  f->prg = prg;
+  f->size = prg[2];
+
+  if (f->size != len || len < 6) {
+    snprintf(f->err, sizeof(f->err), "SIZE %u, program of %u byte",
+             prg[2], len);
+    return -1;
+  }
+  if (nltimer != 0U || ntimer > 2U || (cfg_b & ~CFGB_DECTREE) != 0U ||
+      (set & (SET_R_TAM | SET_T_AM)) != 0U || SET_IN_SEL(set) != 0U ||
+      SET_MASKSEL(set) == 3U) {
+    snprintf(f->err, sizeof(f->err),
+             "unsupported CONFIG_A %02x CONFIG_B %02x SETTINGS %02x",
+             cfg_a, cfg_b, set);
+    return -1;
+  }
+
+  for (i = 0; i < nth; i++, off += 2)
+    f->th[i] = half_to_float((uint16_t)(prg[off] | (prg[off + 1] << 8)));
+  for (i = 0; i < nmask; i++, off += 2)
+    f->mask[i] = prg[off];
+  if (ntimer != 0U) {
+    f->tc = prg[off++];
+    for (i = 0; i < ntimer; i++)
+      f->timer[2 + i] = prg[off++];
+  }
+  if (cfg_b & CFGB_DECTREE) {
+    f->dectree = 1;
+    f->dest[0] = prg[off++];
+    f->dest[1] = prg[off++];
+  }
+
+  f->code = (uint8_t)off;
+  f->rp = prg[4];
+  f->pp = prg[5];
+  if (f->rp == 0U && f->pp == 0U)
+    f->rp = f->pp = f->code;
+  if (f->code >= f->size || f->rp < f->code || f->pp < f->code ||
+      f->rp >= f->size || f->pp >= f->size) {
+    snprintf(f->err, sizeof(f->err), "code at %u, RP %u, PP %u, SIZE %u",
+             f->code, f->rp, f->pp, f->size);
+    return -1;
+  }
+
+  f->sign = (set & SET_SIGNED) != 0U;
+  f->masksel = SET_MASKSEL(set);
+  /* The stored temporary masks are run time state: start from MASKSEL */
+  f->tmask = f->mask[f->masksel];
+
+  return 0;
+}
+
+/*
+ * Value of the axis of mask bit b (7: +X, 6: -X, ... 1: +V, 0: -V)
+ */
+static float axis_value(const fsm_t *f, const float *in, uint8_t b)
+{
+  float v = in[(7U - b) / 2U];
+
+  if (!f->sign)
+    return fabsf(v);
+
+  return ((7U - b) & 1U) ? -v : v;
+}
+
+/*
+ * Evaluate a threshold or zero crossing condition on the temporary mask
+ * (the current mask narrowed to the axes that met the last condition),
+ * trig gets the mask bits of the axes that meet it
+ */
+static int fsm_cond(fsm_t *f, uint8_t c, const float *in, uint8_t *trig)
+{
+  uint8_t mask = f->tmask;
+  float th1 = f->th3 ? f->th[2] : f->th[0];
+  uint8_t all = 1, any = 0;
+  uint8_t b;
+
+  *trig = 0;
+
+  if (c == C_CHKDT)
+    /* No MLC loaded: every decision tree output is 0 */
+    return f->dectree && f->dest[1] == 0U;
+
+  for (b = 0; b < 8U; b++) {
+    float v, p;
+    int hit;
+
+    if ((mask & (1U << b)) == 0U)
+      continue;
+
+    v = axis_value(f, in, b);
+    p = axis_value(f, f->prev, b);
+
+    switch (c) {
+    case C_GNTH1: case C_GLTH1: hit = v > th1; break;
+    case C_GNTH2: hit = v > f->th[1]; break;
+    case C_LNTH1: case C_LLTH1: hit = v <= th1; break;
+    case C_LNTH2: hit = v <= f->th[1]; break;
+    case C_GRTH1: hit = v > -th1; break;
+    case C_LRTH1: hit = v <= -th1; break;
+    case C_PZC: hit = f->prev_ok && p < 0.0f && v >= 0.0f; break;
+    case C_NZC: hit = f->prev_ok && p >= 0.0f && v < 0.0f; break;
+    default: hit = 0; break;
+    }
+
+    if (hit) {
+      *trig |= (uint8_t)(1U << b);
+      any = 1;
+    } else {
+      all = 0;
+    }
+  }
+
+  if (c == C_GLTH1 || c == C_LLTH1)
+    return mask != 0U && all;
+
+  return any;
+}
+
+static int is_timer(uint8_t c)
+{
+  return c >= C_TI1 && c <= C_TI4;
+}
+
+/*
+ * Run one program on one input sample (X, Y, Z, V in g)
+ */
+static void fsm_step(fsm_t *f, const float *in)
+{
+  uint8_t evaluated = 0, trig;
+  unsigned int steps;
+
+  f->irq = 0;
+  if (f->stop || f->err[0] != '\0')
+    goto done;
+
+  for (steps = 0; steps < f->size; steps++) {
+    uint8_t op = f->prg[f->pp];
+    uint8_t rst = op >> 4, next = op & 0x0FU;
+
+    if (rst != next) {
+      /* Condition: one per sample */
+      if (evaluated)
+        break;
+      evaluated = 1;
+
+      if (!f->entered) {
+        f->entered = 1;
+        if (is_timer(rst) || is_timer(next)) {
+          uint8_t t = is_timer(next) ? next : rst;
+
+          /* TI1, TI2 count on the 16 bit timers, not loaded */
+          if (t == C_TI1 || t == C_TI2) {
+            snprintf(f->err, sizeof(f->err), "condition %02x at %u: TI%u "
+                     "unsupported", op, f->pp, t);
+            break;
+          }
+          f->tc = f->timer[t - 1];
+        }
+      }
+      if ((is_timer(rst) || is_timer(next)) && f->tc > 0U)
+        f->tc--;
+
+      if ((is_timer(rst) && f->tc == 0U) ||
+          (!is_timer(rst) && rst != C_NOP && fsm_cond(f, rst, in, &trig))) {
+        f->pp = f->rp;
+        f->tmask = f->mask[f->masksel];
+        f->entered = 0;
+        break;
+      }
+
+      if ((is_timer(next) && f->tc == 0U) ||
+          (!is_timer(next) && next != C_NOP &&
+           fsm_cond(f, next, in, &trig))) {
+        if (!is_timer(next) && next != C_CHKDT)
+          f->tmask = trig;
+        f->pp++;
+        f->entered = 0;
+        continue;
+      }
+      break;
+    }
+
+    /* Command */
+    switch (op) {
+    case OP_STOP:
+      f->stop = 1;
+      goto done;
+    case OP_CONT:
+    case OP_CONTREL:
+      if (op == OP_CONTREL)
+        f->tmask = f->mask[f->masksel];
+      f->irq = 1;
+      f->pp = f->rp;
+      f->entered = 0;
+      goto done;
+    case OP_SRP:
+      f->rp = f->pp + 1U;
+      break;
+    case OP_CRP:
+      f->rp = f->code;
+      break;
+    case OP_SELMA:
+    case OP_SELMB:
+    case OP_SELMC:
+      f->masksel = (uint8_t)((op - OP_SELMA) / 0x11);
+      f->tmask = f->mask[f->masksel];
+      break;
+    case OP_OUTC:
+      f->outs = f->tmask;
+      f->irq = 1;
+      break;
+    case OP_SELTHR1:
+      f->th3 = 0;
+      break;
+    case OP_SELTHR3:
+      f->th3 = 1;
+      break;
+    case OP_REL:
+      f->outs = 0;
+      break;
+    default:
+      snprintf(f->err, sizeof(f->err), "command %02x at %u unsupported", op,
+               f->pp);
+      goto done;
+    }
+
+    if (++f->pp >= f->size) {
+      snprintf(f->err, sizeof(f->err), "PP past the end of the program");
+      goto done;
+    }
+  }
+
+done:
+  memcpy(f->prev, in, sizeof(f->prev));
+  f->prev_ok = 1;
+}
+
+static void dev_init(fsm_dev_t *d)
+{
+  uint8_t i;
+
+  for (i = 0; i < FSM_PRG_NUM; i++)
+    fsm_load(&d->fsm[i], prg_list[i].prg, prg_list[i].len);
+  d->long_cnt = 0;
+}
+
+static void dev_step(fsm_dev_t *d, const int16_t *xl)
+{
+  float in[4];
+  uint8_t i;
+
+  for (i = 0; i < 3U; i++)
+    in[i] = half_round(xl[i] * sens);
+  in[3] = half_round(sqrtf(in[0] * in[0] + in[1] * in[1] + in[2] * in[2]));
+
+  for (i = 0; i < FSM_PRG_NUM; i++)
+    fsm_step(&d->fsm[i], in);
+}
+
+/* ------------------------------------------------------------------------*/
+typedef struct {
+  int16_t xl[3];
+  int16_t gy[3];
+  uint16_t status;
+  uint8_t outs[FSM_PRG_NUM];
+  uint16_t long_cnt;
+  uint8_t has_fsm;
+  unsigned long lineno;
+} sample_t;
+
+typedef struct {
+  const char *path;
+  unsigned long samples;
+  unsigned long irq[FSM_PRG_NUM][2];    /* interpreter, device */
+  unsigned long miss_status, miss_outs, miss_lc;
+  unsigned long checked;
+  char *log;                            /* mismatch lines (-v) */
+  size_t log_len;
+  int err;
+} result_t;
+
+static void log_add(result_t *r, const char *fmt, ...)
+{
+  char line[256];
+  va_list ap;
+  int n;
+  char *p;
+
+  va_start(ap, fmt);
+  n = vsnprintf(line, sizeof(line), fmt, ap);
+  va_end(ap);
+  if (n < 0)
+    return;
+  if ((size_t)n >= sizeof(line))
+    n = sizeof(line) - 1;
+
+  p = realloc(r->log, r->log_len + (size_t)n + 1U);
+  if (p == NULL)
+    return;
+  memcpy(p + r->log_len, line, (size_t)n + 1U);
+  r->log = p;
+  r->log_len += (size_t)n;
+}
+
+static int sample_parse(const char *line, sample_t *s)
+{
+  unsigned int st, o[FSM_PRG_NUM], lc;
+  int xl[3], gy[3], n, i;
+  unsigned long idx;
+
+  n = sscanf(line, "%lu , %d , %d , %d , %d , %d , %d , %x , %x , %x , %x , "
+             "%x , %x , %x , %x , %u", &idx, &xl[0], &xl[1], &xl[2], &gy[0],
+             &gy[1], &gy[2], &st, &o[0], &o[1], &o[2], &o[3], &o[4], &o[5],
+             &o[6], &lc);
+  if (n != 7 && n != 16)
+    return -1;
+
+  for (i = 0; i < 3; i++) {
+    s->xl[i] = (int16_t)xl[i];
+    s->gy[i] = (int16_t)gy[i];
+  }
+  s->has_fsm = (n == 16);
+  if (s->has_fsm) {
+    s->status = (uint16_t)st;
+    for (i = 0; i < FSM_PRG_NUM; i++)
+      s->outs[i] = (uint8_t)o[i];
+    s->long_cnt = (uint16_t)lc;
+  }
+
+  return 0;
+}
+
+static sample_t *trace_load(const char *path, unsigned long *num)
+{
+  sample_t *s = NULL, *p;
+  unsigned long cap = 0, lineno = 0;
+  char line[512];
+  FILE *f;
+
+  *num = 0;
+  f = fopen(path, "r");
+  if (f == NULL) {
+    perror(path);
+    return NULL;
+  }
+
+  while (fgets(line, sizeof(line), f) != NULL) {
+    sample_t smp;
+
+    lineno++;
+    memset(&smp, 0, sizeof(smp));
+    if (sample_parse(line, &smp) != 0)
+      continue;
+    smp.lineno = lineno;
+
+    if (*num == cap) {
+      cap = cap ? cap * 2U : 4096U;
+      p = realloc(s, cap * sizeof(*s));
+      if (p == NULL) {
+        fprintf(stderr, "%s: out of memory\n", path);
+        free(s);
+        fclose(f);
+        return NULL;
+      }
+      s = p;
+    }
+    s[(*num)++] = smp;
+  }
+
+  fclose(f);
+  if (*num == 0U)
+    fprintf(stderr, "%s: no samples\n", path);
+
+  return s;
+}
+
+static void trace_run(result_t *r)
+{
+  unsigned long num, n, logged = 0;
+  fsm_dev_t dev;
+  sample_t *s;
+  uint8_t i;
+
+  s = trace_load(r->path, &num);
+  if (s == NULL) {
+    r->err = 1;
+    return;
+  }
+
+  dev_init(&dev);
+
+  for (n = 0; n < num; n++) {
+    const sample_t *ref = (n + delay < num && (long)n + delay >= 0) ?
+                          &s[n + delay] : NULL;
+    uint16_t status = 0;
+
+    dev_step(&dev, s[n].xl);
+
+    for (i = 0; i < FSM_PRG_NUM; i++) {
+      status |= (uint16_t)(dev.fsm[i].irq << i);
+      r->irq[i][0] += dev.fsm[i].irq;
+    }
+
+    if (wr) {
+      printf("%lu, %d, %d, %d, %d, %d, %d, %04x", n, s[n].xl[0], s[n].xl[1],
+             s[n].xl[2], s[n].gy[0], s[n].gy[1], s[n].gy[2], status);
+      for (i = 0; i < FSM_PRG_NUM; i++)
+        printf(", %02x", dev.fsm[i].outs);
+      printf(", %u\n", dev.long_cnt);
+    }
+
+    if (ref == NULL || !ref->has_fsm)
+      continue;
+
+    r->checked++;
+    for (i = 0; i < FSM_PRG_NUM; i++) {
+      uint8_t irq = (ref->status >> i) & 1U;
+
+      r->irq[i][1] += irq;
+      if (irq != dev.fsm[i].irq) {
+        r->miss_status++;
+        if (logged++ < (unsigned long)verbose)
+          log_add(r, "  line %lu: %s interrupt %u, device %u\n", ref->lineno,
+                  prg_list[i].name, dev.fsm[i].irq, irq);
+      }
+      if (ref->outs[i] != dev.fsm[i].outs) {
+        r->miss_outs++;
+        if (logged++ < (unsigned long)verbose)
+          log_add(r, "  line %lu: %s outs %02x, device %02x\n", ref->lineno,
+                  prg_list[i].name, dev.fsm[i].outs, ref->outs[i]);
+      }
+    }
+    if (ref->long_cnt != dev.long_cnt) {
+      r->miss_lc++;
+      if (logged++ < (unsigned long)verbose)
+        log_add(r, "  line %lu: long_cnt %u, device %u\n", ref->lineno,
+                dev.long_cnt, ref->long_cnt);
+    }
+  }
+
+  for (i = 0; i < FSM_PRG_NUM; i++)
+    if (dev.fsm[i].err[0] != '\0') {
+      log_add(r, "  %s: %s\n", prg_list[i].name, dev.fsm[i].err);
+      r->err = 1;
+    }
+
+  r->samples = num;
+  free(s);
+}
+
+/* ------------------------------------------------------------------------*/
+static result_t *res;
+static int res_num;
+static int res_next;
+static pthread_mutex_t res_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void *worker(void *arg)
+{
+  (void)arg;
+
+  for (;;) {
+    int n;
+
+    pthread_mutex_lock(&res_lock);
+    n = res_next++;
+    pthread_mutex_unlock(&res_lock);
+    if (n >= res_num)
+      return NULL;
+
+    trace_run(&res[n]);
+  }
+}
+
+static int report(const result_t *r)
+{
+  int fail = r->err || r->miss_status || r->miss_outs || r->miss_lc;
+  uint8_t i;
+
+  printf("%s: %lu samples, %lu checked", r->path, r->samples, r->checked);
+  if (r->checked)
+    printf(", mismatches: status %lu outs %lu long_cnt %lu",
+           r->miss_status, r->miss_outs, r->miss_lc);
+  printf("%s\n", fail ? "  FAIL" : "");
+
+  for (i = 0; i < FSM_PRG_NUM; i++) {
+    printf("  %-12s %6lu interrupts", prg_list[i].name, r->irq[i][0]);
+    if (r->checked)
+      printf(" (device %lu)", r->irq[i][1]);
+    printf("\n");
+  }
+  if (r->log != NULL)
+    fputs(r->log, stdout);
+
+  return fail;
+}
+
+int main(int argc, char *argv[])
+{
+  pthread_t tid[JOBS_MAX];
+  long jobs = sysconf(_SC_NPROCESSORS_ONLN);
+  int opt, i, fail = 0;
+  fsm_t f;
+
+  while ((opt = getopt(argc, argv, "j:d:s:v:w")) != -1) {
+    switch (opt) {
+    case 'j':
+      jobs = strtol(optarg, NULL, 0);
+      break;
+    case 'd':
+      delay = strtol(optarg, NULL, 0);
+      break;
+    case 's':
+      sens = strtof(optarg, NULL);
+      break;
+    case 'v':
+      verbose = strtol(optarg, NULL, 0);
+      break;
+    case 'w':
+      wr = 1;
+      break;
+    default:
+      goto usage;
+    }
+  }
+
+  if (optind == argc || (wr && optind != argc - 1))
+    goto usage;
+
+  /* Programs the interpreter cannot run are reported once, up front */
+  for (i = 0; i < FSM_PRG_NUM; i++)
+    if (fsm_load(&f, prg_list[i].prg, prg_list[i].len) != 0) {
+      fprintf(stderr, "%s: %s\n", prg_list[i].name, f.err);
+      return 1;
+    }
+
+  res_num = argc - optind;
+  res = calloc((size_t)res_num, sizeof(*res));
+  if (res == NULL)
+    return 1;
+  for (i = 0; i < res_num; i++)
+    res[i].path = argv[optind + i];
+
+  if (wr) {
+    trace_run(&res[0]);
+    return res[0].err;
+  }
+
+  if (jobs < 1)
+    jobs = 1;
+  if (jobs > JOBS_MAX)
+    jobs = JOBS_MAX;
+  if (jobs > res_num)
+    jobs = res_num;
+
+  for (i = 0; i < jobs; i++)
+    if (pthread_create(&tid[i], NULL, worker, NULL) != 0) {
+      jobs = i;
+      break;
+    }
+  if (jobs == 0)
+    worker(NULL);
+  for (i = 0; i < jobs; i++)
+    pthread_join(tid[i], NULL);
+
+  for (i = 0; i < res_num; i++)
+    fail |= report(&res[i]);
+
+  return fail;
+
+usage:
+  fprintf(stderr, "usage: %s [-j jobs] [-d delay] [-s sens_g] [-v num] "
+          "trace.txt ...\n       %s -w [-s sens_g] trace.txt\n",
+          argv[0], argv[0]);
+  return 1;
+}
@@ -0,0 +1,169 @@
+/*
+ ******************************************************************************
+ * @file    ispu_norm_ref.c
+ * @author  Sensors Software Solution Team
+ * @brief   Host replay of the ISM330IS ISPU norm outputs against the
+ *          reference build of the algorithm
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2024 STMicroelectronics.
+ * All rights reserved.</center></h2>
+ *
+ * This software component is licensed by ST under BSD 3-Clause license,
+ * the "License"; You may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at:
+ *                        opensource.org/licenses/BSD-3-Clause
+ *
+ ******************************************************************************
+ */
+
+/*
+ * Usage:
+ *
+ *   ispu_norm_ref [log.txt]
+ *
+ * Reads the console output of ism330is_ispu_norm_check.c built with
+ * NORM_LOG (one "norm,<fs>,<x>,<y>,<z>,<norm>" line per ISPU output, other
+ * lines are skipped) from the file or from stdin, runs the reference
+ * build of the norm algorithm on the logged samples and reports the
+ * largest difference with the ISPU output and the host time per sample.
+ *
+ * The reference converts the samples with the driver sensitivity of the
+ * full scale in use, so it is built together with the driver:
+ *
+ * Build: gcc -O2 -I $STDC_PATH/ism330is_STdC/driver ispu_norm_ref.c \
+ *            $STDC_PATH/ism330is_STdC/driver/ism330is_reg.c -lm -o ispu_norm_ref
+ */
+
+#include "ism330is_reg.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* Replays of the log used for the host timing */
+#define REF_BENCH_RUNS  100
+
+typedef struct {
+  int16_t x, y, z;
+  uint8_t fs;
+  float norm;
+} norm_rec_t;
+
+/* Same as norm_ref() in ism330is_ispu_norm_check.c */
+static float_t norm_ref(ism330is_xl_full_scale_t fs, int16_t x, int16_t y,
+                        int16_t z)
+{
+  float_t (*to_mg)(int16_t);
+  float_t fx, fy, fz;
+
+  switch (fs) {
+  case ISM330IS_4g:  to_mg = ism330is_from_fs4g_to_mg;  break;
+  case ISM330IS_8g:  to_mg = ism330is_from_fs8g_to_mg;  break;
+  case ISM330IS_16g: to_mg = ism330is_from_fs16g_to_mg; break;
+  default:           to_mg = ism330is_from_fs2g_to_mg;  break;
+  }
+
+  fx = to_mg(x) / 1000.0f;
+  fy = to_mg(y) / 1000.0f;
+  fz = to_mg(z) / 1000.0f;
+
+  return sqrtf(fx * fx + fy * fy + fz * fz);
+}
+
+static uint64_t time_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static size_t log_load(FILE *f, norm_rec_t **out)
+{
+  norm_rec_t *rec = NULL, *tmp;
+  size_t num = 0, size = 0;
+  char line[256];
+  int fs, x, y, z;
+  float norm;
+
+  while (fgets(line, sizeof(line), f) != NULL) {
+    if (sscanf(line, "norm,%d,%d,%d,%d,%e", &fs, &x, &y, &z, &norm) != 5)
+      continue;
+
+    if (num == size) {
+      size = (size != 0) ? size * 2 : 1024;
+      tmp = realloc(rec, size * sizeof(*rec));
+      if (tmp == NULL) {
+        free(rec);
+        return 0;
+      }
+      rec = tmp;
+    }
+
+    rec[num].fs = (uint8_t)fs;
+    rec[num].x = (int16_t)x;
+    rec[num].y = (int16_t)y;
+    rec[num].z = (int16_t)z;
+    rec[num++].norm = norm;
+  }
+
+  *out = rec;
+  return num;
+}
+
+int main(int argc, char *argv[])
+{
+  norm_rec_t *rec = NULL;
+  volatile float_t sink = 0.0f;
+  float_t ref, err, err_max = 0.0f;
+  size_t num, i, i_max = 0;
+  uint64_t t0, t1;
+  FILE *f = stdin;
+  int run;
+
+  if (argc > 1) {
+    f = fopen(argv[1], "r");
+    if (f == NULL) {
+      perror(argv[1]);
+      return 1;
+    }
+  }
+
+  num = log_load(f, &rec);
+  if (f != stdin)
+    fclose(f);
+
+  if (num == 0) {
+    fprintf(stderr, "no norm samples (build the example with NORM_LOG)\n");
+    return 1;
+  }
+
+  for (i = 0; i < num; i++) {
+    ref = norm_ref((ism330is_xl_full_scale_t)rec[i].fs, rec[i].x, rec[i].y,
+                   rec[i].z);
+    err = fabsf(rec[i].norm - ref);
+    if (err > err_max) {
+      err_max = err;
+      i_max = i;
+    }
+  }
+
+  t0 = time_ns();
+  for (run = 0; run < REF_BENCH_RUNS; run++)
+    for (i = 0; i < num; i++)
+      sink += norm_ref((ism330is_xl_full_scale_t)rec[i].fs, rec[i].x,
+                       rec[i].y, rec[i].z);
+  t1 = time_ns();
+
+  printf("%zu samples: max |ispu - reference| %e g (sample %zu: %d %d %d)\n",
+         num, err_max, i_max, rec[i_max].x, rec[i_max].y, rec[i_max].z);
+  printf("reference on host: %.1f ns/sample\n",
+         (double)(t1 - t0) / ((double)num * REF_BENCH_RUNS));
+
+  (void)sink;
+  free(rec);
+  return 0;
+}
@@ -0,0 +1,296 @@
+/*
+ ******************************************************************************
+ * @file    linux_platform.c
+ * @author  Sensors Software Solution Team
+ * @brief   Linux user space platform of the examples: i2c-dev / spidev
+ *          bus, console, delay, monotonic time and GPIO line events
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2024 STMicroelectronics.
+ * All rights reserved.</center></h2>
+ *
+ * This software component is licensed by ST under BSD 3-Clause license,
+ * the "License"; You may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at:
+ *                        opensource.org/licenses/BSD-3-Clause
+ *
+ ******************************************************************************
+ */
+
+#include "linux_platform.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/ioctl.h>
+#include <linux/gpio.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+#include <linux/spi/spidev.h>
+
+/* Plain I2C writes up to this length use a stack buffer */
+#define I2C_WR_STACK   64
+
+void linux_i2c_open(linux_bus_t *bus)
+{
+  unsigned long funcs = 0;
+
+  bus->fd = open(bus->dev, O_RDWR);
+  if (bus->fd < 0 || ioctl(bus->fd, I2C_FUNCS, &funcs) < 0) {
+    perror(bus->dev);
+    exit(1);
+  }
+
+  bus->smbus = (funcs & I2C_FUNC_I2C) ? 0 : 1;
+  if (bus->smbus &&
+      (!(funcs & I2C_FUNC_SMBUS_I2C_BLOCK) ||
+       ioctl(bus->fd, I2C_SLAVE, bus->i2c_add) < 0)) {
+    perror(bus->dev);
+    exit(1);
+  }
+}
+
+void linux_spi_open(linux_bus_t *bus)
+{
+  uint8_t mode = SPI_MODE_3;
+  uint8_t bits = 8;
+  uint32_t speed = bus->spi_hz;
+
+  bus->fd = open(bus->dev, O_RDWR);
+  if (bus->fd < 0 ||
+      ioctl(bus->fd, SPI_IOC_WR_MODE, &mode) < 0 ||
+      ioctl(bus->fd, SPI_IOC_WR_BITS_PER_WORD, &bits) < 0 ||
+      ioctl(bus->fd, SPI_IOC_WR_MAX_SPEED_HZ, &speed) < 0) {
+    perror(bus->dev);
+    exit(1);
+  }
+}
+
+/*
+ * @brief  Write registers on i2c-dev
+ *
+ * Plain I2C: register address and data in one message, any length.
+ * SMBus: I2C block writes of up to 32 bytes, address incremented.
+ *
+ */
+int32_t linux_i2c_write(void *handle, uint8_t reg, const uint8_t *bufp,
+                        uint16_t len)
+{
+  linux_bus_t *bus = handle;
+  int32_t ret = 0;
+  uint16_t n;
+
+  if (!bus->smbus) {
+    uint8_t stack[I2C_WR_STACK + 1];
+    uint8_t *tmp = stack;
+    struct i2c_msg msg = { bus->i2c_add, 0, (uint16_t)(len + 1U), NULL };
+    struct i2c_rdwr_ioctl_data xfer = { &msg, 1 };
+
+    /* i2c_msg length is 16 bit, register address included */
+    if (len == UINT16_MAX)
+      return -1;
+    if (len > I2C_WR_STACK) {
+      tmp = malloc(len + 1U);
+      if (tmp == NULL)
+        return -1;
+    }
+    msg.buf = tmp;
+
+    tmp[0] = reg;
+    memcpy(&tmp[1], bufp, len);
+    ret = (ioctl(bus->fd, I2C_RDWR, &xfer) < 0) ? -1 : 0;
+    bus->xfers++;
+
+    if (tmp != stack)
+      free(tmp);
+    return ret;
+  }
+
+  for (; len > 0 && ret == 0; len -= n, bufp += n, reg += n) {
+    union i2c_smbus_data data;
+    struct i2c_smbus_ioctl_data args = {
+      I2C_SMBUS_WRITE, reg, I2C_SMBUS_I2C_BLOCK_DATA, &data
+    };
+
+    n = (len > I2C_SMBUS_BLOCK_MAX) ? I2C_SMBUS_BLOCK_MAX : len;
+    data.block[0] = (uint8_t)n;
+    memcpy(&data.block[1], bufp, n);
+    ret = (ioctl(bus->fd, I2C_SMBUS, &args) < 0) ? -1 : 0;
+    bus->xfers++;
+  }
+
+  return ret;
+}
+
+/*
+ * @brief  Read registers on i2c-dev
+ *
+ * Plain I2C: register address write + repeated start read, one ioctl().
+ * SMBus: I2C block reads of up to 32 bytes.
+ *
+ */
+int32_t linux_i2c_read(void *handle, uint8_t reg, uint8_t *bufp,
+                       uint16_t len)
+{
+  linux_bus_t *bus = handle;
+  uint8_t fifo = (bus->fifo_slot != 0U && reg == bus->fifo_reg);
+  uint16_t max, n;
+  int32_t ret = 0;
+
+  if (!bus->smbus) {
+    struct i2c_msg msg[2] = {
+      { bus->i2c_add, 0, 1, &reg },
+      { bus->i2c_add, I2C_M_RD, len, bufp },
+    };
+    struct i2c_rdwr_ioctl_data xfer = { msg, 2 };
+
+    ret = (ioctl(bus->fd, I2C_RDWR, &xfer) < 0) ? -1 : 0;
+    bus->xfers++;
+    return ret;
+  }
+
+  /* FIFO chunks are whole slots restarting at the same address */
+  max = fifo ? (I2C_SMBUS_BLOCK_MAX / bus->fifo_slot) * bus->fifo_slot :
+        I2C_SMBUS_BLOCK_MAX;
+
+  for (; len > 0 && ret == 0; len -= n, bufp += n) {
+    union i2c_smbus_data data;
+    struct i2c_smbus_ioctl_data args = {
+      I2C_SMBUS_READ, reg, I2C_SMBUS_I2C_BLOCK_DATA, &data
+    };
+
+    n = (len > max) ? max : len;
+    data.block[0] = (uint8_t)n;
+    ret = (ioctl(bus->fd, I2C_SMBUS, &args) < 0) ? -1 : 0;
+    memcpy(bufp, &data.block[1], n);
+    bus->xfers++;
+
+    if (!fifo)
+      reg += n;
+  }
+
+  return ret;
+}
+
+int32_t linux_spi_write(void *handle, uint8_t reg, const uint8_t *bufp,
+                        uint16_t len)
+{
+  linux_bus_t *bus = handle;
+  struct spi_ioc_transfer xfer[2];
+
+  memset(xfer, 0, sizeof(xfer));
+  xfer[0].tx_buf = (uintptr_t)&reg;
+  xfer[0].len = 1;
+  xfer[1].tx_buf = (uintptr_t)bufp;
+  xfer[1].len = len;
+  bus->xfers++;
+
+  return (ioctl(bus->fd, SPI_IOC_MESSAGE(2), xfer) < 0) ? -1 : 0;
+}
+
+int32_t linux_spi_read(void *handle, uint8_t reg, uint8_t *bufp,
+                       uint16_t len)
+{
+  linux_bus_t *bus = handle;
+  struct spi_ioc_transfer xfer[2];
+
+  reg |= 0x80;
+  memset(xfer, 0, sizeof(xfer));
+  xfer[0].tx_buf = (uintptr_t)&reg;
+  xfer[0].len = 1;
+  xfer[1].rx_buf = (uintptr_t)bufp;
+  xfer[1].len = len;
+  bus->xfers++;
+
+  return (ioctl(bus->fd, SPI_IOC_MESSAGE(2), xfer) < 0) ? -1 : 0;
+}
+
+void linux_irq_open(linux_irq_t *irq, const char *chip, uint32_t line,
+                    const char *consumer)
+{
+  struct gpio_v2_line_request req;
+  struct epoll_event ev;
+  int chip_fd = open(chip, O_RDWR);
+
+  memset(irq, 0, sizeof(linux_irq_t));
+  memset(&req, 0, sizeof(req));
+  req.offsets[0] = line;
+  req.num_lines = 1;
+  req.config.flags = GPIO_V2_LINE_FLAG_INPUT | GPIO_V2_LINE_FLAG_EDGE_RISING;
+  strncpy(req.consumer, consumer, sizeof(req.consumer) - 1);
+
+  if (chip_fd < 0 || ioctl(chip_fd, GPIO_V2_GET_LINE_IOCTL, &req) < 0) {
+    perror(chip);
+    exit(1);
+  }
+  close(chip_fd);
+  irq->fd = req.fd;
+
+  memset(&ev, 0, sizeof(ev));
+  ev.events = EPOLLIN;
+  ev.data.fd = irq->fd;
+  irq->epoll_fd = epoll_create1(0);
+  if (irq->epoll_fd < 0 ||
+      epoll_ctl(irq->epoll_fd, EPOLL_CTL_ADD, irq->fd, &ev) < 0) {
+    perror("epoll");
+    exit(1);
+  }
+}
+
+/*
+ * @brief  Wait for rising edges on the line
+ *
+ * All the edges queued are read: irq->ns is the time of the last one,
+ * kernel sequence numbers reveal edges dropped by its buffer.
+ *
+ * @param  irq           line
+ * @param  timeout_ms    max time to wait for an edge
+ * @retval               0 on edge, -1 on timeout or error
+ *
+ */
+int32_t linux_irq_wait(linux_irq_t *irq, uint32_t timeout_ms)
+{
+  struct gpio_v2_line_event ev[16];
+  struct epoll_event ep;
+  ssize_t n;
+  int i;
+
+  if (epoll_wait(irq->epoll_fd, &ep, 1, (int)timeout_ms) <= 0)
+    return -1;
+
+  n = read(irq->fd, ev, sizeof(ev));
+  if (n < (ssize_t)sizeof(ev[0]))
+    return -1;
+
+  for (i = 0; i < n / (ssize_t)sizeof(ev[0]); i++) {
+    if (irq->seqno && ev[i].line_seqno > irq->seqno + 1)
+      irq->lost += ev[i].line_seqno - irq->seqno - 1;
+    irq->seqno = ev[i].line_seqno;
+    irq->ns = ev[i].timestamp_ns;
+  }
+
+  return 0;
+}
+
+void linux_tx_com(const uint8_t *buf, uint16_t len)
+{
+  fwrite(buf, 1, len, stdout);
+  fflush(stdout);
+}
+
+void linux_delay(uint32_t ms)
+{
+  usleep(ms * 1000U);
+}
+
+uint64_t linux_time_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000U + (uint64_t)ts.tv_nsec;
+}
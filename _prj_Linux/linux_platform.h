@@ -0,0 +1,79 @@
+/*
+ ******************************************************************************
+ * @file    linux_platform.h
+ * @author  Sensors Software Solution Team
+ * @brief   Linux user space platform of the examples: i2c-dev / spidev
+ *          bus, console, delay, monotonic time and GPIO line events
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2024 STMicroelectronics.
+ * All rights reserved.</center></h2>
+ *
+ * This software component is licensed by ST under BSD 3-Clause license,
+ * the "License"; You may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at:
+ *                        opensource.org/licenses/BSD-3-Clause
+ *
+ ******************************************************************************
+ */
+
+#ifndef LINUX_PLATFORM_H
+#define LINUX_PLATFORM_H
+
+#include <stdint.h>
+
+/*
+ * Linux character device bus. On I2C, adapters without plain I2C
+ * support (e.g. SMBus only controllers, i2c-stub) are driven with
+ * SMBus I2C block transfers, up to 32 bytes per ioctl(). Reads of
+ * fifo_reg are split in whole slots restarting at the same address,
+ * as the FIFO output rolls back to its first register.
+ */
+typedef struct {
+  const char *dev;            /* e.g. "/dev/i2c-1", "/dev/spidev0.0" */
+  uint8_t i2c_add;            /* 7 bit I2C address */
+  uint32_t spi_hz;            /* SPI clock, mode 3 */
+  uint8_t fifo_reg;           /* FIFO output register */
+  uint8_t fifo_slot;          /* FIFO slot length [bytes] */
+
+  int fd;
+  uint8_t smbus;
+  uint32_t xfers;             /* ioctl() on the bus, never cleared */
+} linux_bus_t;
+
+#define LINUX_BUS_INIT(__DEV__, __I2C_ADD__, __SPI_HZ__, __FIFO_REG__, \
+                       __FIFO_SLOT__) \
+  { (__DEV__), (__I2C_ADD__), (__SPI_HZ__), (__FIFO_REG__), (__FIFO_SLOT__), \
+    -1, 0, 0 }
+
+/* GPIO line requested for rising edge events, waited on with epoll */
+typedef struct {
+  int fd;
+  int epoll_fd;
+  uint32_t seqno;
+  uint64_t ns;                /* last edge, CLOCK_MONOTONIC */
+  uint32_t lost;              /* edges dropped by the kernel buffer */
+} linux_irq_t;
+
+/* The open functions print the error and exit(1) on failure */
+void linux_i2c_open(linux_bus_t *bus);
+void linux_spi_open(linux_bus_t *bus);
+int32_t linux_i2c_write(void *handle, uint8_t reg, const uint8_t *bufp,
+                        uint16_t len);
+int32_t linux_i2c_read(void *handle, uint8_t reg, uint8_t *bufp,
+                       uint16_t len);
+int32_t linux_spi_write(void *handle, uint8_t reg, const uint8_t *bufp,
+                        uint16_t len);
+int32_t linux_spi_read(void *handle, uint8_t reg, uint8_t *bufp,
+                       uint16_t len);
+
+void linux_irq_open(linux_irq_t *irq, const char *chip, uint32_t line,
+                    const char *consumer);
+int32_t linux_irq_wait(linux_irq_t *irq, uint32_t timeout_ms);
+
+void linux_tx_com(const uint8_t *buf, uint16_t len);
+void linux_delay(uint32_t ms);
+uint64_t linux_time_ns(void);
+
+#endif /* LINUX_PLATFORM_H */
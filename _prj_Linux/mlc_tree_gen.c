@@ -0,0 +1,337 @@
+/*
+ ******************************************************************************
+ * @file    mlc_tree_gen.c
+ * @author  Sensors Software Solution Team
+ * @brief   Generate the node table of mlc_tree_eval.h from the decision
+ *          tree file of the MLC tool
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2024 STMicroelectronics.
+ * All rights reserved.</center></h2>
+ *
+ * This software component is licensed by ST under BSD 3-Clause license,
+ * the "License"; You may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at:
+ *                        opensource.org/licenses/BSD-3-Clause
+ *
+ ******************************************************************************
+ */
+
+/*
+ * Usage:
+ *
+ *   mlc_tree_gen -n name -w window [-c class=code ...] dectree.txt > name_tree.h
+ *
+ * The decision tree file is the text file written by the MLC tool next
+ * to the UCF, one test per line with "|   " per level of depth:
+ *
+ *   F4_PeakToPeak_on_ACC_V <= 0.047: no_vibration (120.0)
+ *   F4_PeakToPeak_on_ACC_V > 0.047
+ *   |   F2_VAR_on_ACC_V <= 0.015: low_vibration (40.0/1.0)
+ *   |   F2_VAR_on_ACC_V > 0.015: high_vibration (50.0)
+ *
+ * Features on ACC_V supported by mlc_tree_eval.h are mean, variance,
+ * energy and peak to peak; any other feature is reported as an error.
+ * Classes are mapped to their mlc_out code with -c (the values set in
+ * the tool results), numeric class names are used as they are.
+ *
+ * The header holds <name>_tree[] and <NAME>_TREE_WINDOW (the window
+ * length of the MLC configuration, in samples).
+ *
+ * Build: gcc -O2 mlc_tree_gen.c -o mlc_tree_gen
+ */
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define NODE_MAX    255
+#define LINE_LEN   256
+#define LINES_MAX   1024
+#define CLASS_MAX   32
+
+/* Same codes as mlc_feat_t in mlc_tree_eval.h */
+static const char *const feat_enum[] = {
+  "MLC_FEAT_MEAN", "MLC_FEAT_VARIANCE", "MLC_FEAT_ENERGY",
+  "MLC_FEAT_PEAK_TO_PEAK",
+};
+
+typedef struct {
+  int depth;
+  int le;                  /* 1: "<=" test, 0: ">" test */
+  int feat;
+  char th[32];
+  char leaf[64];           /* class if the branch ends here */
+} line_t;
+
+typedef struct {
+  int feat;                /* -1 for a leaf */
+  double th;
+  int left, right;
+  int code;
+} node_t;
+
+static line_t line[LINES_MAX];
+static int line_num, line_pos;
+static node_t node[NODE_MAX];
+static int node_num;
+
+static char class_name[CLASS_MAX][64];
+static int class_code[CLASS_MAX];
+static int class_num;
+
+static int feat_get(const char *name)
+{
+  char up[64];
+  size_t i;
+
+  for (i = 0; name[i] != '\0' && i < sizeof(up) - 1; i++)
+    up[i] = (char)toupper((unsigned char)name[i]);
+  up[i] = '\0';
+
+  if (strstr(up, "ACC_V") == NULL || strstr(up, "ACC_V2") != NULL)
+    return -1;
+  if (strstr(up, "PEAKTOPEAK") || strstr(up, "PEAK_TO_PEAK"))
+    return 3;
+  if (strstr(up, "ENERGY"))
+    return 2;
+  if (strstr(up, "VAR"))
+    return 1;
+  if (strstr(up, "MEAN") && strstr(up, "ABS") == NULL)
+    return 0;
+
+  return -1;
+}
+
+static int class_get(const char *name)
+{
+  char *end;
+  long v;
+  int i;
+
+  for (i = 0; i < class_num; i++)
+    if (strcmp(class_name[i], name) == 0)
+      return class_code[i];
+
+  v = strtol(name, &end, 0);
+  if (*end == '\0' && end != name && v >= 0 && v <= 255)
+    return (int)v;
+
+  fprintf(stderr, "class \"%s\" has no code (use -c %s=<code>)\n", name, name);
+  return -1;
+}
+
+static int line_parse(char *s, int n)
+{
+  line_t *l = &line[line_num];
+  char name[64], *op, *colon;
+  size_t len;
+
+  memset(l, 0, sizeof(*l));
+
+  len = strcspn(s, "\r\n");
+  s[len] = '\0';
+
+  while (strncmp(s, "|", 1) == 0) {
+    l->depth++;
+    s++;
+    while (*s == ' ' || *s == '\t')
+      s++;
+  }
+  while (*s == ' ' || *s == '\t')
+    s++;
+  if (*s == '\0')
+    return 0;
+
+  /* Single leaf tree */
+  if (*s == ':') {
+    l->feat = -1;
+    sscanf(s + 1, " %63s", l->leaf);
+    line_num++;
+    return 0;
+  }
+
+  op = strstr(s, "<=");
+  if (op != NULL) {
+    l->le = 1;
+  } else {
+    op = strchr(s, '>');
+    if (op == NULL) {
+      fprintf(stderr, "line %d: no test\n", n);
+      return -1;
+    }
+  }
+
+  if (sscanf(s, "%63s", name) != 1 || sscanf(op + (l->le ? 2 : 1), " %31[^: ]",
+                                             l->th) != 1) {
+    fprintf(stderr, "line %d: malformed test\n", n);
+    return -1;
+  }
+
+  l->feat = feat_get(name);
+  if (l->feat < 0) {
+    fprintf(stderr, "line %d: feature %s not supported by mlc_tree_eval.h\n",
+            n, name);
+    return -1;
+  }
+
+  colon = strchr(op, ':');
+  if (colon != NULL)
+    sscanf(colon + 1, " %63s", l->leaf);
+
+  if (++line_num == LINES_MAX) {
+    fprintf(stderr, "too many lines\n");
+    return -1;
+  }
+
+  return 0;
+}
+
+static int node_new(void)
+{
+  if (node_num == NODE_MAX - 1) {
+    fprintf(stderr, "tree larger than %d nodes\n", NODE_MAX - 1);
+    exit(1);
+  }
+
+  return node_num++;
+}
+
+static int leaf_new(const char *cls)
+{
+  int n = node_new();
+  int code = class_get(cls);
+
+  if (code < 0)
+    exit(1);
+
+  node[n].feat = -1;
+  node[n].code = code;
+  return n;
+}
+
+/* Parse the "<=" / ">" pair of lines of a test at depth */
+static int tree_parse(int depth)
+{
+  const line_t *l;
+  int n;
+
+  if (line_pos >= line_num || line[line_pos].depth != depth) {
+    fprintf(stderr, "test expected at depth %d\n", depth);
+    exit(1);
+  }
+
+  l = &line[line_pos++];
+  if (l->feat < 0)
+    return leaf_new(l->leaf);
+
+  if (!l->le) {
+    fprintf(stderr, "\"<=\" test expected at depth %d\n", depth);
+    exit(1);
+  }
+
+  n = node_new();
+  node[n].feat = l->feat;
+  node[n].th = strtod(l->th, NULL);
+  node[n].left = (l->leaf[0] != '\0') ? leaf_new(l->leaf) :
+                 tree_parse(depth + 1);
+
+  if (line_pos >= line_num || line[line_pos].depth != depth ||
+      line[line_pos].le || line[line_pos].feat != l->feat ||
+      strcmp(line[line_pos].th, l->th) != 0) {
+    fprintf(stderr, "\">\" test on %s expected at depth %d\n",
+            feat_enum[l->feat], depth);
+    exit(1);
+  }
+
+  l = &line[line_pos++];
+  node[n].right = (l->leaf[0] != '\0') ? leaf_new(l->leaf) :
+                  tree_parse(depth + 1);
+
+  return n;
+}
+
+int main(int argc, char *argv[])
+{
+  const char *name = NULL;
+  char buf[LINE_LEN], guard[128];
+  long window = 0;
+  FILE *f;
+  int opt, n, i;
+
+  while ((opt = getopt(argc, argv, "n:w:c:")) != -1) {
+    switch (opt) {
+    case 'n':
+      name = optarg;
+      break;
+    case 'w':
+      window = strtol(optarg, NULL, 0);
+      break;
+    case 'c':
+      if (class_num == CLASS_MAX ||
+          sscanf(optarg, "%63[^=]=%i", class_name[class_num],
+                 &class_code[class_num]) != 2) {
+        fprintf(stderr, "bad class %s\n", optarg);
+        return 1;
+      }
+      class_num++;
+      break;
+    default:
+      return 1;
+    }
+  }
+
+  if (name == NULL || window <= 0 || window > 65535 || optind != argc - 1) {
+    fprintf(stderr, "usage: %s -n name -w window [-c class=code ...] dectree.txt\n",
+            argv[0]);
+    return 1;
+  }
+
+  f = fopen(argv[optind], "r");
+  if (f == NULL) {
+    perror(argv[optind]);
+    return 1;
+  }
+
+  for (n = 1; fgets(buf, sizeof(buf), f) != NULL; n++)
+    if (line_parse(buf, n) != 0) {
+      fclose(f);
+      return 1;
+    }
+  fclose(f);
+
+  if (line_num == 0) {
+    fprintf(stderr, "%s: empty tree\n", argv[optind]);
+    return 1;
+  }
+
+  tree_parse(0);
+  if (line_pos != line_num) {
+    fprintf(stderr, "trailing lines after the tree\n");
+    return 1;
+  }
+
+  for (i = 0; name[i] != '\0' && i < (int)sizeof(guard) - 1; i++)
+    guard[i] = (char)toupper((unsigned char)name[i]);
+  guard[i] = '\0';
+
+  printf("/* Generated by mlc_tree_gen from %s, do not edit */\n\n",
+         argv[optind]);
+  printf("#ifndef %s_TREE_H\n#define %s_TREE_H\n\n", guard, guard);
+  printf("#include \"mlc_tree_eval.h\"\n\n");
+  printf("#define %s_TREE_WINDOW %ld\n\n", guard, window);
+  printf("static const mlc_node_t %s_tree[] = {\n", name);
+  for (i = 0; i < node_num; i++) {
+    if (node[i].feat < 0)
+      printf("  /* %2d */ { MLC_LEAF, 0.0f, 0, 0, %d },\n", i, node[i].code);
+    else
+      printf("  /* %2d */ { %s, %.8ef, %d, %d, 0 },\n", i, feat_enum[node[i].feat],
+             node[i].th, node[i].left, node[i].right);
+  }
+  printf("};\n\n#endif /* %s_TREE_H */\n", guard);
+
+  return 0;
+}
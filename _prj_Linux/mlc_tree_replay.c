@@ -0,0 +1,149 @@
+/*
+ ******************************************************************************
+ * @file    mlc_tree_replay.c
+ * @author  Sensors Software Solution Team
+ * @brief   Host replay of a recording through the MLC decision tree
+ *          evaluator, compared with the on-chip mlc_out
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2024 STMicroelectronics.
+ * All rights reserved.</center></h2>
+ *
+ * This software component is licensed by ST under BSD 3-Clause license,
+ * the "License"; You may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at:
+ *                        opensource.org/licenses/BSD-3-Clause
+ *
+ ******************************************************************************
+ */
+
+/*
+ * Usage:
+ *
+ *   mlc_tree_replay [-s sens_g] [log.txt]
+ *
+ * Reads the console output of lsm6dsox_mlc_tree_eval.c built with
+ * MLC_LOG ("xl,<x>,<y>,<z>" per sample and "mlc,<code>" per window, other
+ * lines are skipped) from the file or from stdin, runs mlc_tree_eval.h on
+ * the samples and compares each window result with the mlc_out read from
+ * the device at the end of the same window. The MLC may report a window
+ * late, so the match rate is given with the device one window behind too.
+ *
+ * -s sets the accelerometer sensitivity in g/LSB (default 0.000122, 4 g).
+ *
+ * The tree is the header generated by mlc_tree_gen; by default the
+ * vibration monitoring one committed in lsm6dsox_STdC/examples (see
+ * MLC_TREE_HEADER), add -I <tree dir> for another one:
+ *
+ * Build: gcc -O2 -I $STDC_PATH/lsm6dsox_STdC/examples \
+ *            mlc_tree_replay.c -lm -o mlc_tree_replay
+ */
+
+#ifndef MLC_TREE_HEADER
+#define MLC_TREE_HEADER   "lsm6dsox_vibration_monitoring_tree.h"
+#define MLC_TREE          lsm6dsox_vibration_monitoring_tree
+#define MLC_TREE_WINDOW   LSM6DSOX_VIBRATION_MONITORING_TREE_WINDOW
+#endif
+
+#include "mlc_tree_eval.h"
+#include MLC_TREE_HEADER
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/* Classes counted in the confusion matrix */
+#define CODE_NUM  8
+
+int main(int argc, char *argv[])
+{
+  static uint32_t conf[CODE_NUM][CODE_NUM];
+  uint32_t windows = 0, match = 0, match_lag = 0;
+  uint8_t out_prev = 0, have_prev = 0, done = 0;
+  char line[128];
+  mlc_eval_t eval = { 0 };
+  FILE *f = stdin;
+  int x, y, z, code, opt;
+  uint32_t i, k;
+
+  eval.tree = MLC_TREE;
+  eval.window = MLC_TREE_WINDOW;
+  eval.sens = 0.000122f;
+
+  while ((opt = getopt(argc, argv, "s:")) != -1) {
+    if (opt != 's') {
+      fprintf(stderr, "usage: %s [-s sens_g] [log.txt]\n", argv[0]);
+      return 1;
+    }
+    eval.sens = strtof(optarg, NULL);
+  }
+
+  if (optind < argc) {
+    f = fopen(argv[optind], "r");
+    if (f == NULL) {
+      perror(argv[optind]);
+      return 1;
+    }
+  }
+
+  while (fgets(line, sizeof(line), f) != NULL) {
+    if (sscanf(line, "xl,%d,%d,%d", &x, &y, &z) == 3) {
+      int16_t raw[3] = { (int16_t)x, (int16_t)y, (int16_t)z };
+
+      if (mlc_eval_push(&eval, raw)) {
+        if (done)
+          fprintf(stderr, "window %lu: no mlc_out logged\n",
+                  (unsigned long)windows);
+        done = 1;
+      }
+      continue;
+    }
+
+    if (sscanf(line, "mlc,%d", &code) != 1)
+      continue;
+
+    /* mlc_out is logged right after the sample closing a window */
+    if (!done) {
+      fprintf(stderr, "mlc_out logged out of a window, skipped\n");
+      continue;
+    }
+    done = 0;
+
+    windows++;
+    if ((uint8_t)code == eval.out)
+      match++;
+    if (have_prev && (uint8_t)code == out_prev)
+      match_lag++;
+    if ((uint8_t)code < CODE_NUM && eval.out < CODE_NUM)
+      conf[(uint8_t)code][eval.out]++;
+
+    out_prev = eval.out;
+    have_prev = 1;
+  }
+
+  if (f != stdin)
+    fclose(f);
+
+  if (windows == 0) {
+    fprintf(stderr, "no windows (build the example with MLC_LOG)\n");
+    return 1;
+  }
+
+  printf("%lu windows: match %lu (%.1f %%), device one window late %lu (%.1f %%)\n",
+         (unsigned long)windows, (unsigned long)match, 100.0 * match / windows,
+         (unsigned long)match_lag,
+         windows > 1 ? 100.0 * match_lag / (windows - 1) : 0.0);
+
+  printf("device \\ eval");
+  for (k = 0; k < CODE_NUM; k++)
+    printf("%6lu", (unsigned long)k);
+  printf("\n");
+  for (i = 0; i < CODE_NUM; i++) {
+    printf("%13lu", (unsigned long)i);
+    for (k = 0; k < CODE_NUM; k++)
+      printf("%6lu", (unsigned long)conf[i][k]);
+    printf("\n");
+  }
+
+  return 0;
+}
@@ -0,0 +1,668 @@
+/*
+ ******************************************************************************
+ * @file    tty_ingest.c
+ * @author  Sensors Software Solution Team
+ * @brief   Host daemon collecting the output of many boards running the
+ *          examples (UART / USB CDC ttys) into a single time stamped sink
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2024 STMicroelectronics.
+ * All rights reserved.</center></h2>
+ *
+ * This software component is licensed by ST under BSD 3-Clause license,
+ * the "License"; You may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at:
+ *                        opensource.org/licenses/BSD-3-Clause
+ *
+ ******************************************************************************
+ */
+
+/*
+ * One thread waits on all the ttys with epoll, splits the incoming bytes
+ * in lines ("\r\n" terminated, as sent by tx_com) and time stamps each
+ * read on arrival. Lines are passed in batches to a pool of worker
+ * threads, which decode the numeric fields and append CSV records to the
+ * sink. Each node is served by a fixed worker, so the records of a node
+ * reach the sink in arrival order:
+ *
+ *   arrival_ns,node,label,value,value,...
+ *
+ * Usage:
+ *
+ *   tty_ingest [-j workers] [-o sink] [-s baud] tty...
+ *   tty_ingest -b nodes [-r lines/s] [-t seconds] [-j workers] [-o sink]
+ *
+ * The second form is a benchmark: each node is a pseudo-terminal fed by
+ * an emulator thread at the given line rate, and the report gives the
+ * ingest CPU time and the sustainable nodes x rate per core.
+ *
+ * A tty that hangs up (board unplugged) or fails is closed and dropped,
+ * the other nodes go on.
+ *
+ * Build: gcc -O2 -pthread tty_ingest.c -o tty_ingest
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+
+/* Private macro -------------------------------------------------------------*/
+#define NODE_MAX          1024
+#define LINE_LEN          256
+#define FIELD_MAX         16
+
+/* Lines per batch and batches in flight between reader and workers */
+#define BATCH_LINES       256
+#define BATCH_NUM         64
+#define WORKER_MAX        32
+
+/* Private typedef -----------------------------------------------------------*/
+/* One tty and its partial line */
+typedef struct {
+  int fd;
+  const char *name;
+  char line[LINE_LEN];
+  uint16_t len;
+  uint64_t lines;
+  uint64_t overlong;
+} node_t;
+
+typedef struct {
+  uint64_t t_ns;
+  uint32_t node;
+  uint16_t len;
+  char text[LINE_LEN];
+} frame_t;
+
+typedef struct {
+  uint32_t num;
+  frame_t frame[BATCH_LINES];
+} batch_t;
+
+/* Fixed size queue of batch pointers */
+typedef struct {
+  batch_t *item[BATCH_NUM + WORKER_MAX];
+  uint32_t rd, wr, num;
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+} queue_t;
+
+/* Benchmark node emulator */
+typedef struct {
+  int *master;
+  uint32_t nodes;
+  uint32_t rate;
+  uint64_t sent;
+  uint64_t dropped;
+} emu_t;
+
+/* Private variables ---------------------------------------------------------*/
+static node_t node[NODE_MAX];
+static uint32_t node_num;
+
+/* Free batches, shared; full batches, one queue per worker */
+static queue_t free_q;
+static queue_t full_q[WORKER_MAX];
+static uint32_t worker_num = 2;
+static batch_t *batch_pool;
+
+static int sink_fd = STDOUT_FILENO;
+static volatile sig_atomic_t stop;
+static volatile sig_atomic_t emu_stop;
+static uint64_t stalls;
+static uint32_t hangups;
+
+/*
+ * @brief  Read a clock
+ *
+ * @param  clk       clock id
+ * @retval           time [ns]
+ *
+ */
+static uint64_t time_ns(clockid_t clk)
+{
+  struct timespec ts;
+
+  clock_gettime(clk, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void queue_init(queue_t *q)
+{
+  memset(q, 0, sizeof(*q));
+  pthread_mutex_init(&q->lock, NULL);
+  pthread_cond_init(&q->cond, NULL);
+}
+
+static void queue_put(queue_t *q, batch_t *b)
+{
+  pthread_mutex_lock(&q->lock);
+  q->item[q->wr] = b;
+  q->wr = (q->wr + 1) % (BATCH_NUM + WORKER_MAX);
+  q->num++;
+  pthread_cond_signal(&q->cond);
+  pthread_mutex_unlock(&q->lock);
+}
+
+/*
+ * @brief  Get a batch from a queue
+ *
+ * @param  q         queue
+ * @param  wait      1: block until a batch is available
+ * @retval           batch, NULL if none (wait == 0) or end of stream
+ *
+ */
+static batch_t *queue_get(queue_t *q, uint8_t wait)
+{
+  batch_t *b = NULL;
+
+  pthread_mutex_lock(&q->lock);
+  while (wait && q->num == 0)
+    pthread_cond_wait(&q->cond, &q->lock);
+  if (q->num) {
+    b = q->item[q->rd];
+    q->rd = (q->rd + 1) % (BATCH_NUM + WORKER_MAX);
+    q->num--;
+  }
+  pthread_mutex_unlock(&q->lock);
+
+  return b;
+}
+
+static uint32_t queue_num(queue_t *q)
+{
+  uint32_t num;
+
+  pthread_mutex_lock(&q->lock);
+  num = q->num;
+  pthread_mutex_unlock(&q->lock);
+
+  return num;
+}
+
+/*
+ * @brief  Open a tty in raw, non blocking mode
+ *
+ * @param  name      device
+ * @param  baud      termios speed, 0 to keep the current one
+ * @retval           file descriptor, -1 on error
+ *
+ */
+static int tty_open(const char *name, speed_t baud)
+{
+  struct termios tio;
+  int fd = open(name, O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+
+  if (fd < 0)
+    return -1;
+
+  if (tcgetattr(fd, &tio) == 0) {
+    cfmakeraw(&tio);
+    if (baud) {
+      cfsetispeed(&tio, baud);
+      cfsetospeed(&tio, baud);
+    }
+    tio.c_cflag |= CLOCAL | CREAD;
+    tcsetattr(fd, TCSANOW, &tio);
+  }
+
+  return fd;
+}
+
+/*
+ * @brief  Split the bytes read from a node into lines
+ *
+ * @param  n         node index
+ * @param  buf       bytes read
+ * @param  len       number of bytes
+ * @param  t_ns      arrival time of the read
+ * @param  b         current batch of the node worker, replaced when full
+ * @param  q         full queue of the node worker
+ *
+ */
+static void node_feed(uint32_t n, const char *buf, ssize_t len, uint64_t t_ns,
+                      batch_t **b, queue_t *q)
+{
+  node_t *nd = &node[n];
+  ssize_t i;
+
+  for (i = 0; i < len; i++) {
+    char c = buf[i];
+    frame_t *f;
+
+    if (c != '\n') {
+      if (c == '\r')
+        continue;
+      if (nd->len < LINE_LEN - 1)
+        nd->line[nd->len++] = c;
+      else
+        nd->overlong++;
+      continue;
+    }
+
+    if (nd->len == 0)
+      continue;
+
+    if ((*b)->num == BATCH_LINES) {
+      queue_put(q, *b);
+      *b = queue_get(&free_q, 0);
+      if (*b == NULL) {
+        /* Workers behind: the ttys buffer meanwhile */
+        stalls++;
+        *b = queue_get(&free_q, 1);
+      }
+      (*b)->num = 0;
+    }
+
+    f = &(*b)->frame[(*b)->num++];
+    f->t_ns = t_ns;
+    f->node = n;
+    f->len = nd->len;
+    memcpy(f->text, nd->line, nd->len);
+    f->text[nd->len] = '\0';
+    nd->len = 0;
+    nd->lines++;
+  }
+}
+
+/*
+ * @brief  Close a node that hung up or failed, its partial line is lost
+ *
+ * @param  n         node index
+ * @param  epfd      epoll instance
+ * @param  err       errno of the failed read, 0 on hang up
+ *
+ */
+static void node_close(uint32_t n, int epfd, int err)
+{
+  node_t *nd = &node[n];
+
+  epoll_ctl(epfd, EPOLL_CTL_DEL, nd->fd, NULL);
+  close(nd->fd);
+  nd->fd = -1;
+  nd->len = 0;
+  hangups++;
+
+  fprintf(stderr, "%s: %s, closed\n", nd->name, err ? strerror(err) : "hang up");
+}
+
+/*
+ * @brief  Reader thread: epoll on all the ttys
+ *
+ */
+static void *reader_thread(void *arg)
+{
+  struct epoll_event ev[64];
+  char buf[4096];
+  batch_t *b[WORKER_MAX];
+  int epfd = *(int *)arg;
+  uint32_t w;
+
+  for (w = 0; w < worker_num; w++) {
+    b[w] = queue_get(&free_q, 1);
+    b[w]->num = 0;
+  }
+
+  while (!stop) {
+    int i, n = epoll_wait(epfd, ev, 64, 100);
+    uint64_t t_ns = time_ns(CLOCK_REALTIME);
+    uint8_t flush;
+
+    for (i = 0; i < n; i++) {
+      uint32_t nd = ev[i].data.u32;
+      ssize_t len;
+
+      w = nd % worker_num;
+      while (1) {
+        len = read(node[nd].fd, buf, sizeof(buf));
+        if (len > 0)
+          node_feed(nd, buf, len, t_ns, &b[w], &full_q[w]);
+        else if (len == 0 || errno != EINTR)
+          break;
+      }
+
+      /* EOF or EIO on hang up; EAGAIN only means drained */
+      if (len == 0 || errno != EAGAIN ||
+          (ev[i].events & (EPOLLHUP | EPOLLERR)))
+        node_close(nd, epfd, len < 0 && errno != EAGAIN ? errno : 0);
+    }
+
+    /* Partial batches: do not hold lines while the ttys are idle */
+    flush = (n <= 0 || queue_num(&free_q) > BATCH_NUM / 2);
+    for (w = 0; w < worker_num && flush; w++) {
+      if (b[w]->num == 0)
+        continue;
+      queue_put(&full_q[w], b[w]);
+      b[w] = queue_get(&free_q, 1);
+      b[w]->num = 0;
+    }
+  }
+
+  /* Last batch and end of stream marker of each worker */
+  for (w = 0; w < worker_num; w++) {
+    queue_put(&full_q[w], b[w]);
+    queue_put(&full_q[w], NULL);
+  }
+
+  return NULL;
+}
+
+/*
+ * @brief  Decode a line into CSV
+ *
+ * Text up to the first ':' or tab is the label, then every field that
+ * parses as a number is a value (units in brackets are skipped).
+ *
+ * @param  f         line
+ * @param  out       output buffer
+ * @param  size      output buffer size
+ * @retval           number of characters written
+ *
+ */
+static int frame_decode(const frame_t *f, char *out, size_t size)
+{
+  const char *p = f->text;
+  const char *lab_end = strpbrk(p, ":\t");
+  int len, nf = 0;
+
+  if (lab_end == NULL)
+    lab_end = p + f->len;
+
+  len = snprintf(out, size, "%llu,%u,%.*s", (unsigned long long)f->t_ns,
+                 f->node, (int)(lab_end - p), p);
+  p = lab_end;
+
+  while (*p && nf < FIELD_MAX && len < (int)size) {
+    char *end;
+    double v;
+
+    while (*p == ':' || *p == '\t' || *p == ' ')
+      p++;
+    v = strtod(p, &end);
+    if (end == p) {
+      /* Not a number: skip the token */
+      while (*p && *p != '\t' && *p != ' ')
+        p++;
+      continue;
+    }
+    len += snprintf(out + len, size - len, ",%g", v);
+    nf++;
+    p = end;
+  }
+
+  if (len < (int)size - 1)
+    out[len++] = '\n';
+
+  return len;
+}
+
+/*
+ * @brief  Worker thread: decode batches and append them to the sink
+ *
+ */
+static void *worker_thread(void *arg)
+{
+  static char out_buf[WORKER_MAX][BATCH_LINES * 128];
+  char *out = out_buf[(uintptr_t)arg];
+  queue_t *q = &full_q[(uintptr_t)arg];
+  batch_t *b;
+
+  while ((b = queue_get(q, 1)) != NULL) {
+    size_t len = 0;
+    uint32_t i;
+
+    for (i = 0; i < b->num; i++) {
+      if (len > sizeof(out_buf[0]) - 2 * LINE_LEN) {
+        if (write(sink_fd, out, len) < 0)
+          break;
+        len = 0;
+      }
+      len += frame_decode(&b->frame[i], out + len, sizeof(out_buf[0]) - len);
+    }
+
+    /* One write per batch: O_APPEND keeps the records of a batch whole */
+    if (len && write(sink_fd, out, len) < 0)
+      perror("sink");
+
+    queue_put(&free_q, b);
+  }
+
+  return NULL;
+}
+
+/*
+ * @brief  Benchmark node emulator: each pseudo-terminal master receives
+ *         lines formatted as the examples output, at emu->rate lines/s
+ *
+ */
+static void *emu_thread(void *arg)
+{
+  emu_t *emu = arg;
+  uint64_t t0 = time_ns(CLOCK_MONOTONIC);
+  uint64_t *sent = calloc(emu->nodes, sizeof(uint64_t));
+  char line[LINE_LEN];
+
+  while (!emu_stop) {
+    uint64_t due = (time_ns(CLOCK_MONOTONIC) - t0) * emu->rate / 1000000000ULL;
+    uint32_t n;
+
+    for (n = 0; n < emu->nodes; n++) {
+      while (sent[n] < due) {
+        int len = snprintf(line, sizeof(line),
+                           "ACC [mg]:\t%4.2f\t%4.2f\t%4.2f\r\n",
+                           (double)(sent[n] % 100), -15.25, 1000.5);
+
+        if (write(emu->master[n], line, len) != len)
+          emu->dropped++;
+        else
+          emu->sent++;
+        sent[n]++;
+      }
+    }
+    usleep(1000);
+  }
+
+  free(sent);
+  return NULL;
+}
+
+/*
+ * @brief  Create a pseudo-terminal pair, the slave is a node
+ *
+ * @param  name      slave device name, written
+ * @param  size      name size
+ * @retval           master file descriptor, -1 on error
+ *
+ */
+static int pty_create(char *name, size_t size)
+{
+  int fd = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+
+  if (fd < 0 || grantpt(fd) < 0 || unlockpt(fd) < 0 ||
+      ptsname_r(fd, name, size) != 0) {
+    if (fd >= 0)
+      close(fd);
+    return -1;
+  }
+
+  return fd;
+}
+
+static speed_t baud_get(long baud)
+{
+  switch (baud) {
+  case 9600:
+    return B9600;
+  case 115200:
+    return B115200;
+  case 230400:
+    return B230400;
+  case 460800:
+    return B460800;
+  case 921600:
+    return B921600;
+  default:
+    return 0;
+  }
+}
+
+static void on_signal(int sig)
+{
+  (void)sig;
+  stop = 1;
+}
+
+int main(int argc, char *argv[])
+{
+  pthread_t reader, worker[WORKER_MAX], emu_tid;
+  clockid_t clk;
+  emu_t emu;
+  uint32_t bench = 0, seconds = 10, i;
+  uint64_t cpu_ns = 0, lines = 0, overlong = 0, t;
+  speed_t baud = 0;
+  int epfd, opt;
+
+  memset(&emu, 0, sizeof(emu));
+  emu.rate = 100;
+
+  while ((opt = getopt(argc, argv, "j:o:s:b:r:t:")) != -1) {
+    switch (opt) {
+    case 'j':
+      worker_num = (uint32_t)atoi(optarg);
+      break;
+    case 'o':
+      sink_fd = open(optarg, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+      break;
+    case 's':
+      baud = baud_get(atol(optarg));
+      break;
+    case 'b':
+      bench = (uint32_t)atoi(optarg);
+      break;
+    case 'r':
+      emu.rate = (uint32_t)atoi(optarg);
+      break;
+    case 't':
+      seconds = (uint32_t)atoi(optarg);
+      break;
+    default:
+      fprintf(stderr, "usage: %s [-j workers] [-o sink] [-s baud] tty...\n"
+              "       %s -b nodes [-r lines/s] [-t seconds] [-j workers] [-o sink]\n",
+              argv[0], argv[0]);
+      return 1;
+    }
+  }
+
+  if (worker_num == 0 || worker_num > WORKER_MAX || sink_fd < 0 ||
+      bench > NODE_MAX || (bench == 0 && optind == argc)) {
+    fprintf(stderr, "%s: bad arguments\n", argv[0]);
+    return 1;
+  }
+
+  epfd = epoll_create1(EPOLL_CLOEXEC);
+  emu.master = calloc(bench ? bench : 1, sizeof(int));
+  emu.nodes = bench;
+
+  /* Nodes: ttys from the command line, or emulated ones */
+  for (i = 0; bench ? i < bench : (int)i < argc - optind; i++) {
+    static char pts_name[NODE_MAX][32];
+    struct epoll_event ev;
+    const char *name = argv[optind + (bench ? 0 : i)];
+
+    if (bench) {
+      emu.master[i] = pty_create(pts_name[i], sizeof(pts_name[i]));
+      if (emu.master[i] < 0) {
+        perror("pty");
+        return 1;
+      }
+      name = pts_name[i];
+    }
+
+    if (node_num == NODE_MAX)
+      break;
+    node[node_num].name = name;
+    node[node_num].fd = tty_open(name, baud);
+    if (node[node_num].fd < 0) {
+      perror(name);
+      continue;
+    }
+
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.u32 = node_num;
+    epoll_ctl(epfd, EPOLL_CTL_ADD, node[node_num].fd, &ev);
+    node_num++;
+  }
+
+  signal(SIGINT, on_signal);
+  signal(SIGTERM, on_signal);
+
+  queue_init(&free_q);
+  for (i = 0; i < worker_num; i++)
+    queue_init(&full_q[i]);
+  batch_pool = calloc(BATCH_NUM, sizeof(batch_t));
+  for (i = 0; i < BATCH_NUM; i++)
+    queue_put(&free_q, &batch_pool[i]);
+
+  for (i = 0; i < worker_num; i++)
+    pthread_create(&worker[i], NULL, worker_thread, (void *)(uintptr_t)i);
+  pthread_create(&reader, NULL, reader_thread, &epfd);
+  if (bench)
+    pthread_create(&emu_tid, NULL, emu_thread, &emu);
+
+  t = time_ns(CLOCK_MONOTONIC);
+  if (bench) {
+    sleep(seconds);
+    /* Let the lines still in the ptys be ingested */
+    emu_stop = 1;
+    pthread_join(emu_tid, NULL);
+    usleep(500000);
+  } else {
+    while (!stop)
+      pause();
+  }
+
+  /* Ingest CPU time: reader and workers, emulator excluded */
+  if (pthread_getcpuclockid(reader, &clk) == 0)
+    cpu_ns += time_ns(clk);
+  for (i = 0; i < worker_num; i++)
+    if (pthread_getcpuclockid(worker[i], &clk) == 0)
+      cpu_ns += time_ns(clk);
+  t = time_ns(CLOCK_MONOTONIC) - t;
+
+  stop = 1;
+  pthread_join(reader, NULL);
+  for (i = 0; i < worker_num; i++)
+    pthread_join(worker[i], NULL);
+
+  for (i = 0; i < node_num; i++) {
+    lines += node[i].lines;
+    overlong += node[i].overlong;
+  }
+
+  fprintf(stderr, "%u nodes, %llu lines in %.1f s (%.0f lines/s), "
+          "%llu overlong bytes, %llu stalls, %u hang ups, ingest CPU %.2f s\n",
+          node_num, (unsigned long long)lines, t / 1e9, lines * 1e9 / t,
+          (unsigned long long)overlong, (unsigned long long)stalls,
+          hangups, cpu_ns / 1e9);
+
+  if (bench)
+    fprintf(stderr, "emulator: %llu lines sent, %llu dropped (%u nodes x %u lines/s)\n"
+            "sustainable: %.0f nodes x %u lines/s per core\n",
+            (unsigned long long)emu.sent, (unsigned long long)emu.dropped,
+            bench, emu.rate,
+            cpu_ns ? (lines * 1e9 / cpu_ns) / emu.rate : 0.0, emu.rate);
+
+  return 0;
+}
@@ -0,0 +1,403 @@
+/*
+ ******************************************************************************
+ * @file    read_data_burst.c
+ * @author  MEMS Software Solution Team
+ * @brief   This file shows how to read status and data in a single
+ *          bus transaction.
+ *
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2020 STMicroelectronics.
+ * All rights reserved.</center></h2>
+ *
+ * This software component is licensed by ST under BSD 3-Clause license,
+ * the "License"; You may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at:
+ *                        opensource.org/licenses/BSD-3-Clause
+ *
+ ******************************************************************************
+ */
+
+/*
+ * This example was developed using the following STMicroelectronics
+ * evaluation boards:
+ *
+ * - STEVAL_MKI109V3 + STEVAL-MKI141V2
+ * - NUCLEO_F401RE + STEVAL-MKI141V2
+ * - DISCOVERY_SPC584B + STEVAL-MKI141V2
+ *
+ * and STM32CubeMX tool with STM32CubeF4 MCU Package
+ *
+ * Used interfaces:
+ *
+ * STEVAL_MKI109V3    - Host side:   USB (Virtual COM)
+ *                    - Sensor side: SPI(Default) / I2C(supported)
+ *
+ * NUCLEO_STM32F401RE - Host side: UART(COM) to USB bridge
+ *                    - I2C(Default) / SPI(N/A)
+ *
+ * DISCOVERY_SPC584B  - Host side: UART(COM) to USB bridge
+ *                    - Sensor side: I2C(Default) / SPI(supported)
+ *
+ * If you need to run this example on a different hardware platform a
+ * modification of the functions: `platform_write`, `platform_read`,
+ * `tx_com` and 'platform_init' is required.
+ *
+ */
+
+/* STMicroelectronics evaluation boards definition
+ *
+ * Please uncomment ONLY the evaluation boards in use.
+ * If a different hardware is used please comment all
+ * following target board and redefine yours.
+ */
+
+//#define STEVAL_MKI109V3  /* little endian */
+//#define NUCLEO_F401RE    /* little endian */
+//#define SPC584B_DIS      /* big endian */
+
+/* ATTENTION: By default the driver is little endian. If you need switch
+ *            to big endian please see "Endianness definitions" in the
+ *            header file of the driver (_reg.h).
+ */
+
+#if defined(STEVAL_MKI109V3)
+/* MKI109V3: Define communication interface */
+#define SENSOR_BUS hspi2
+/* MKI109V3: Vdd and Vddio power supply values */
+#define PWM_3V3 915
+
+#elif defined(NUCLEO_F401RE)
+/* NUCLEO_F401RE: Define communication interface */
+#define SENSOR_BUS hi2c1
+
+#elif defined(SPC584B_DIS)
+/* DISCOVERY_SPC584B: Define communication interface */
+#define SENSOR_BUS I2CD1
+
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include <stdio.h>
+#include "hts221_reg.h"
+
+#if defined(NUCLEO_F401RE)
+#include "stm32f4xx_hal.h"
+#include "usart.h"
+#include "gpio.h"
+#include "i2c.h"
+
+#elif defined(STEVAL_MKI109V3)
+#include "stm32f4xx_hal.h"
+#include "usbd_cdc_if.h"
+#include "gpio.h"
+#include "spi.h"
+#include "tim.h"
+
+#elif defined(SPC584B_DIS)
+#include "components.h"
+#endif
+
+/* Private macro -------------------------------------------------------------*/
+/* Status and outputs: STATUS_REG (0x27) up to TEMP_OUT_H (0x2B) */
+#define    BURST_LEN        5
+
+/* Number of samples between two bus transaction reports */
+#define    REPORT_SAMPLES   20
+
+/* Uncomment to poll with separate status and data reads (reference) */
+//#define BURST_BASELINE
+
+/* Private typedef -----------------------------------------------------------*/
+/* Status and outputs read in one transaction, only flagged channels
+ * are fresh */
+typedef struct {
+  hts221_status_reg_t status;
+  int16_t humidity;
+  int16_t temperature;
+} data_burst_t;
+
+/*
+ *  Function used to apply coefficient
+ */
+typedef struct {
+  float_t x0;
+  float_t y0;
+  float_t x1;
+  float_t y1;
+} lin_t;
+
+/* Private variables ---------------------------------------------------------*/
+static data_burst_t burst;
+static float_t humidity_perc;
+static float_t temperature_degC;
+static uint8_t whoamI;
+static uint8_t tx_buffer[1000];
+static uint32_t bus_reads = 0;
+
+/* Extern variables ----------------------------------------------------------*/
+
+/* Private functions ---------------------------------------------------------*/
+/*
+ *   WARNING:
+ *   Functions declare in this section are defined at the end of this file
+ *   and are strictly related to the hardware platform used.
+ *
+ */
+static int32_t platform_write(void *handle, uint8_t reg, const uint8_t *bufp,
+                              uint16_t len);
+static int32_t platform_read(void *handle, uint8_t reg, uint8_t *bufp,
+                             uint16_t len);
+static void tx_com(uint8_t *tx_buffer, uint16_t len);
+static void platform_delay(uint32_t ms);
+static void platform_init(void);
+
+
+float_t linear_interpolation(lin_t *lin, int16_t x)
+{
+  return ((lin->y1 - lin->y0) * x + ((lin->x1 * lin->y0) -
+                                     (lin->x0 * lin->y1)))
+         / (lin->x1 - lin->x0);
+}
+
+#if !defined(BURST_BASELINE)
+/*
+ * @brief  Read status and all outputs in one auto-increment transaction
+ *
+ * @param  ctx       read / write interface definitions
+ * @param  val       status and raw outputs
+ * @retval           interface status (MANDATORY: return 0 -> no Error)
+ *
+ */
+static int32_t data_burst_get(stmdev_ctx_t *ctx, data_burst_t *val)
+{
+  uint8_t buff[BURST_LEN];
+  int32_t ret;
+
+  ret = hts221_read_reg(ctx, HTS221_STATUS_REG, buff, BURST_LEN);
+  if (ret != 0)
+    return ret;
+
+  memcpy(&val->status, &buff[0], 1);
+
+  /* HUMIDITY_OUT_L (0x28) */
+  val->humidity = (int16_t)buff[2];
+  val->humidity = (val->humidity * 256) + (int16_t)buff[1];
+
+  /* TEMP_OUT_L (0x2A) */
+  val->temperature = (int16_t)buff[4];
+  val->temperature = (val->temperature * 256) + (int16_t)buff[3];
+
+  return ret;
+}
+#endif
+
+/* Main Example --------------------------------------------------------------*/
+void hts221_read_data_burst(void)
+{
+  uint32_t samples = 0, data_reads = 0;
+  /* Initialize platform specific hardware */
+  platform_init();
+  /* Initialize mems driver interface */
+  stmdev_ctx_t dev_ctx;
+  dev_ctx.write_reg = platform_write;
+  dev_ctx.read_reg = platform_read;
+  dev_ctx.mdelay = platform_delay;
+  dev_ctx.handle = &SENSOR_BUS;
+  /* Check device ID */
+  whoamI = 0;
+  hts221_device_id_get(&dev_ctx, &whoamI);
+
+  if ( whoamI != HTS221_ID )
+    while (1); /*manage here device not found */
+
+  /* Read humidity calibration coefficient */
+  lin_t lin_hum;
+  hts221_hum_adc_point_0_get(&dev_ctx, &lin_hum.x0);
+  hts221_hum_rh_point_0_get(&dev_ctx, &lin_hum.y0);
+  hts221_hum_adc_point_1_get(&dev_ctx, &lin_hum.x1);
+  hts221_hum_rh_point_1_get(&dev_ctx, &lin_hum.y1);
+  /* Read temperature calibration coefficient */
+  lin_t lin_temp;
+  hts221_temp_adc_point_0_get(&dev_ctx, &lin_temp.x0);
+  hts221_temp_deg_point_0_get(&dev_ctx, &lin_temp.y0);
+  hts221_temp_adc_point_1_get(&dev_ctx, &lin_temp.x1);
+  hts221_temp_deg_point_1_get(&dev_ctx, &lin_temp.y1);
+  /* Enable Block Data Update */
+  hts221_block_data_update_set(&dev_ctx, PROPERTY_ENABLE);
+  /* Set Output Data Rate */
+  hts221_data_rate_set(&dev_ctx, HTS221_ODR_1Hz);
+  /* Device power on */
+  hts221_power_on_set(&dev_ctx, PROPERTY_ENABLE);
+
+  /* Read samples in polling mode */
+  while (1) {
+    uint32_t reads = bus_reads;
+
+#if defined(BURST_BASELINE)
+    hts221_status_get(&dev_ctx, &burst.status);
+    if (burst.status.h_da)
+      hts221_humidity_raw_get(&dev_ctx, &burst.humidity);
+    if (burst.status.t_da)
+      hts221_temperature_raw_get(&dev_ctx, &burst.temperature);
+#else
+    data_burst_get(&dev_ctx, &burst);
+#endif
+
+    if (!burst.status.h_da && !burst.status.t_da)
+      continue;
+
+    data_reads += bus_reads - reads;
+
+    if (burst.status.h_da) {
+      humidity_perc = linear_interpolation(&lin_hum, burst.humidity);
+
+      if (humidity_perc < 0) {
+        humidity_perc = 0;
+      }
+
+      if (humidity_perc > 100) {
+        humidity_perc = 100;
+      }
+
+      snprintf((char *)tx_buffer, sizeof(tx_buffer), "Humidity [%%]:%3.2f\r\n", humidity_perc);
+      tx_com( tx_buffer, strlen( (char const *)tx_buffer ) );
+    }
+
+    if (burst.status.t_da) {
+      temperature_degC = linear_interpolation(&lin_temp, burst.temperature);
+      snprintf((char *)tx_buffer, sizeof(tx_buffer), "Temperature [degC]:%6.2f\r\n",
+              temperature_degC );
+      tx_com( tx_buffer, strlen( (char const *)tx_buffer ) );
+    }
+
+    if (++samples == REPORT_SAMPLES) {
+      snprintf((char *)tx_buffer, sizeof(tx_buffer),
+               "%lu samples: %lu.%02lu bus reads per sample\r\n",
+               (unsigned long)samples,
+               (unsigned long)(data_reads / samples),
+               (unsigned long)((data_reads * 100U / samples) % 100U));
+      tx_com( tx_buffer, strlen( (char const *)tx_buffer ) );
+      samples = 0;
+      data_reads = 0;
+    }
+  }
+}
+
+/*
+ * @brief  Write generic device register (platform dependent)
+ *
+ * @param  handle    customizable argument. In this examples is used in
+ *                   order to select the correct sensor bus handler.
+ * @param  reg       register to write
+ * @param  bufp      pointer to data to write in register reg
+ * @param  len       number of consecutive register to write
+ *
+ */
+static int32_t platform_write(void *handle, uint8_t reg, const uint8_t *bufp,
+                              uint16_t len)
+{
+#if defined(NUCLEO_F401RE)
+  /* Write multiple command */
+  reg |= 0x80;
+  HAL_I2C_Mem_Write(handle, HTS221_I2C_ADDRESS, reg,
+                    I2C_MEMADD_SIZE_8BIT, (uint8_t*) bufp, len, 1000);
+#elif defined(STEVAL_MKI109V3)
+  /* Write multiple command */
+  reg |= 0x40;
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_RESET);
+  HAL_SPI_Transmit(handle, &reg, 1, 1000);
+  HAL_SPI_Transmit(handle, (uint8_t*) bufp, len, 1000);
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_SET);
+#elif defined(SPC584B_DIS)
+  /* Write multiple command */
+  reg |= 0x80;
+  i2c_lld_write(handle,  HTS221_I2C_ADDRESS & 0xFE, reg,
+               (uint8_t*) bufp, len);
+#endif
+  return 0;
+}
+
+/*
+ * @brief  Read generic device register (platform dependent)
+ *
+ * @param  handle    customizable argument. In this examples is used in
+ *                   order to select the correct sensor bus handler.
+ * @param  reg       register to read
+ * @param  bufp      pointer to buffer that store the data read
+ * @param  len       number of consecutive register to read
+ *
+ */
+static int32_t platform_read(void *handle, uint8_t reg, uint8_t *bufp,
+                             uint16_t len)
+{
+  bus_reads++;
+
+#if defined(NUCLEO_F401RE)
+  /* Read multiple command */
+  reg |= 0x80;
+  HAL_I2C_Mem_Read(handle, HTS221_I2C_ADDRESS, reg,
+                   I2C_MEMADD_SIZE_8BIT, bufp, len, 1000);
+#elif defined(STEVAL_MKI109V3)
+  /* Read multiple command */
+  reg |= 0xC0;
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_RESET);
+  HAL_SPI_Transmit(handle, &reg, 1, 1000);
+  HAL_SPI_Receive(handle, bufp, len, 1000);
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_SET);
+#elif defined(SPC584B_DIS)
+  /* Read multiple command */
+  reg |= 0x80;
+  i2c_lld_read(handle, HTS221_I2C_ADDRESS & 0xFE, reg, bufp, len);
+#endif
+  return 0;
+}
+
+/*
+ * @brief  Write generic device register (platform dependent)
+ *
+ * @param  tx_buffer     buffer to transmit
+ * @param  len           number of byte to send
+ *
+ */
+static void tx_com(uint8_t *tx_buffer, uint16_t len)
+{
+#if defined(NUCLEO_F401RE)
+  HAL_UART_Transmit(&huart2, tx_buffer, len, 1000);
+#elif defined(STEVAL_MKI109V3)
+  CDC_Transmit_FS(tx_buffer, len);
+#elif defined(SPC584B_DIS)
+  sd_lld_write(&SD2, tx_buffer, len);
+#endif
+}
+
+/*
+ * @brief  platform specific delay (platform dependent)
+ *
+ * @param  ms        delay in ms
+ *
+ */
+static void platform_delay(uint32_t ms)
+{
+#if defined(NUCLEO_F401RE) | defined(STEVAL_MKI109V3)
+  HAL_Delay(ms);
+#elif defined(SPC584B_DIS)
+  osalThreadDelayMilliseconds(ms);
+#endif
+}
+
+/*
+ * @brief  platform specific initialization (platform dependent)
+ */
+static void platform_init(void)
+{
+#if defined(STEVAL_MKI109V3)
+  TIM3->CCR1 = PWM_3V3;
+  TIM3->CCR2 = PWM_3V3;
+  HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_1);
+  HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_2);
+  platform_delay(1000);
+#endif
+}
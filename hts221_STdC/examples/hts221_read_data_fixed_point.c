@@ -0,0 +1,479 @@
+/*
+ ******************************************************************************
+ * @file    read_data_fixed_point.c
+ * @author  MEMS Software Solution Team
+ * @brief   This file shows how to convert data with fixed-point math only.
+ *
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2020 STMicroelectronics.
+ * All rights reserved.</center></h2>
+ *
+ * This software component is licensed by ST under BSD 3-Clause license,
+ * the "License"; You may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at:
+ *                        opensource.org/licenses/BSD-3-Clause
+ *
+ ******************************************************************************
+ */
+
+/*
+ * This example was developed using the following STMicroelectronics
+ * evaluation boards:
+ *
+ * - STEVAL_MKI109V3 + STEVAL-MKI141V2
+ * - NUCLEO_F401RE + STEVAL-MKI141V2
+ * - DISCOVERY_SPC584B + STEVAL-MKI141V2
+ *
+ * and STM32CubeMX tool with STM32CubeF4 MCU Package
+ *
+ * Used interfaces:
+ *
+ * STEVAL_MKI109V3    - Host side:   USB (Virtual COM)
+ *                    - Sensor side: SPI(Default) / I2C(supported)
+ *
+ * NUCLEO_STM32F401RE - Host side: UART(COM) to USB bridge
+ *                    - I2C(Default) / SPI(N/A)
+ *
+ * DISCOVERY_SPC584B  - Host side: UART(COM) to USB bridge
+ *                    - Sensor side: I2C(Default) / SPI(supported)
+ *
+ * If you need to run this example on a different hardware platform a
+ * modification of the functions: `platform_write`, `platform_read`,
+ * `tx_com` and 'platform_init' is required.
+ *
+ */
+
+/* STMicroelectronics evaluation boards definition
+ *
+ * Please uncomment ONLY the evaluation boards in use.
+ * If a different hardware is used please comment all
+ * following target board and redefine yours.
+ */
+
+//#define STEVAL_MKI109V3  /* little endian */
+//#define NUCLEO_F401RE    /* little endian */
+//#define SPC584B_DIS      /* big endian */
+
+/* ATTENTION: By default the driver is little endian. If you need switch
+ *            to big endian please see "Endianness definitions" in the
+ *            header file of the driver (_reg.h).
+ */
+
+#if defined(STEVAL_MKI109V3)
+/* MKI109V3: Define communication interface */
+#define SENSOR_BUS hspi2
+/* MKI109V3: Vdd and Vddio power supply values */
+#define PWM_3V3 915
+
+#elif defined(NUCLEO_F401RE)
+/* NUCLEO_F401RE: Define communication interface */
+#define SENSOR_BUS hi2c1
+
+#elif defined(SPC584B_DIS)
+/* DISCOVERY_SPC584B: Define communication interface */
+#define SENSOR_BUS I2CD1
+
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include <stdio.h>
+#include "hts221_reg.h"
+
+#if defined(NUCLEO_F401RE)
+#include "stm32f4xx_hal.h"
+#include "usart.h"
+#include "gpio.h"
+#include "i2c.h"
+
+#elif defined(STEVAL_MKI109V3)
+#include "stm32f4xx_hal.h"
+#include "usbd_cdc_if.h"
+#include "gpio.h"
+#include "spi.h"
+#include "tim.h"
+
+#elif defined(SPC584B_DIS)
+#include "components.h"
+#endif
+
+/* Private macro -------------------------------------------------------------*/
+/* Number of samples converted in one batch */
+#define    BATCH_LEN         10
+
+/* Uncomment to compare fixed-point results with the float reference */
+//#define CONV_CHECK
+
+/* Private typedef -----------------------------------------------------------*/
+/*
+ * Linear calibration with output in Q16.16 fixed-point:
+ * y = y0 + (x - x0) * slope, with slope in Q8.24 to keep the error
+ * negligible (< 0.002) on the whole raw range (_prj_Linux/fixed_point_check.c
+ * checks it against float on any raw value).
+ */
+typedef struct {
+  int32_t y0;
+  int32_t slope;
+  int16_t x0;
+} lin_q16_t;
+
+/* Private variables ---------------------------------------------------------*/
+static int16_t raw_humidity[BATCH_LEN];
+static int16_t raw_temperature[BATCH_LEN];
+static int32_t humidity_q16[BATCH_LEN];
+static int32_t temperature_q16[BATCH_LEN];
+static lin_q16_t lin_hum_q16;
+static lin_q16_t lin_temp_q16;
+static uint8_t whoamI;
+static uint8_t tx_buffer[1000];
+
+/* Extern variables ----------------------------------------------------------*/
+
+/* Private functions ---------------------------------------------------------*/
+/*
+ *   WARNING:
+ *   Functions declare in this section are defined at the end of this file
+ *   and are strictly related to the hardware platform used.
+ *
+ */
+static int32_t platform_write(void *handle, uint8_t reg, const uint8_t *bufp,
+                              uint16_t len);
+static int32_t platform_read(void *handle, uint8_t reg, uint8_t *bufp,
+                             uint16_t len);
+static void tx_com(uint8_t *tx_buffer, uint16_t len);
+static void platform_delay(uint32_t ms);
+static void platform_init(void);
+
+/*
+ *  Float reference used to check the fixed-point conversion
+ */
+typedef struct {
+  float_t x0;
+  float_t y0;
+  float_t x1;
+  float_t y1;
+} lin_t;
+
+float_t linear_interpolation(lin_t *lin, int16_t x)
+{
+  return ((lin->y1 - lin->y0) * x + ((lin->x1 * lin->y0) -
+                                     (lin->x0 * lin->y1)))
+         / (lin->x1 - lin->x0);
+}
+
+/*
+ * Precompute slope and offset from two calibration points (done once).
+ * y values are given with 'frac' fractional bits (1 for %RH x2,
+ * 3 for degC x8).
+ */
+static void lin_q16_init(lin_q16_t *lin, int16_t x0, int16_t y0,
+                         int16_t x1, int16_t y1, uint8_t frac)
+{
+  int32_t dx = (int32_t)x1 - x0;
+  int64_t dy = ((int64_t)y1 - y0) * (1LL << (24 - frac));
+
+  /* Round to nearest: divide by a positive dx */
+  if (dx < 0) {
+    dx = -dx;
+    dy = -dy;
+  }
+
+  lin->x0 = x0;
+  lin->y0 = (int32_t)y0 * (1L << (16 - frac));
+  lin->slope = (dx != 0) ?
+               (int32_t)((dy + ((dy < 0) ? -(dx / 2) : (dx / 2))) / dx) : 0;
+}
+
+/*
+ * Convert a batch of raw samples with integer math only and clamp
+ * the result in [min, max].
+ */
+static void lin_q16_apply(const lin_q16_t *lin, const int16_t *x,
+                          int32_t *y, uint16_t len, int32_t min, int32_t max)
+{
+  int64_t val;
+  uint16_t i;
+
+  /* Clamped on 64 bit: steep calibrations exceed the Q16.16 range */
+  for (i = 0; i < len; i++) {
+    val = lin->y0 + ((((int64_t)x[i] - lin->x0) * lin->slope + (1 << 7)) >> 8);
+    y[i] = (val < min) ? min : (val > max) ? max : (int32_t)val;
+  }
+}
+
+#if defined(CONV_CHECK)
+/*
+ * Return max distance (in Q16 LSB) between fixed-point and float reference
+ */
+static int32_t conv_check(lin_t *lin, const int16_t *x, const int32_t *y,
+                          uint16_t len, float_t min, float_t max)
+{
+  int32_t err, max_err = 0;
+  float_t ref;
+  uint16_t i;
+
+  for (i = 0; i < len; i++) {
+    ref = linear_interpolation(lin, x[i]);
+    ref = (ref < min) ? min : (ref > max) ? max : ref;
+    err = y[i] - (int32_t)(ref * 65536.0f);
+    err = (err < 0) ? -err : err;
+    max_err = (err > max_err) ? err : max_err;
+  }
+
+  return max_err;
+}
+#endif /* CONV_CHECK */
+
+#if defined(NUCLEO_F401RE) || defined(STEVAL_MKI109V3)
+/* Cycle counter used to benchmark the conversion (Cortex-M DWT) */
+static void cycles_init(void)
+{
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+static uint32_t cycles_get(void)
+{
+  return DWT->CYCCNT;
+}
+#else
+static void cycles_init(void) {}
+static uint32_t cycles_get(void) { return 0; }
+#endif
+
+/* Main Example --------------------------------------------------------------*/
+void hts221_read_data_fixed_point(void)
+{
+  uint8_t calib[16];
+  uint8_t out[5];
+  uint16_t cnt = 0;
+  uint32_t cycles;
+  uint16_t i;
+
+  /* Initialize platform specific hardware */
+  platform_init();
+  /* Initialize mems driver interface */
+  stmdev_ctx_t dev_ctx;
+  dev_ctx.write_reg = platform_write;
+  dev_ctx.read_reg = platform_read;
+  dev_ctx.mdelay = platform_delay;
+  dev_ctx.handle = &SENSOR_BUS;
+  /* Check device ID */
+  whoamI = 0;
+  hts221_device_id_get(&dev_ctx, &whoamI);
+
+  if ( whoamI != HTS221_ID )
+    while (1); /*manage here device not found */
+
+  /*
+   * Read all calibration registers (0x30 - 0x3F) at once and
+   * precompute Q16 slope and offset, no float math afterwards.
+   */
+  hts221_read_reg(&dev_ctx, HTS221_H0_RH_X2, calib, 16);
+  lin_q16_init(&lin_hum_q16,
+               (int16_t)((uint16_t)calib[7] << 8 | calib[6]), calib[0],
+               (int16_t)((uint16_t)calib[11] << 8 | calib[10]), calib[1], 1);
+  lin_q16_init(&lin_temp_q16,
+               (int16_t)((uint16_t)calib[13] << 8 | calib[12]),
+               (int16_t)(((uint16_t)calib[5] & 0x03U) << 8 | calib[2]),
+               (int16_t)((uint16_t)calib[15] << 8 | calib[14]),
+               (int16_t)(((uint16_t)calib[5] & 0x0CU) << 6 | calib[3]), 3);
+
+#if defined(CONV_CHECK)
+  /* Float reference coefficients (as in hts221_read_data_polling.c) */
+  lin_t lin_hum;
+  hts221_hum_adc_point_0_get(&dev_ctx, &lin_hum.x0);
+  hts221_hum_rh_point_0_get(&dev_ctx, &lin_hum.y0);
+  hts221_hum_adc_point_1_get(&dev_ctx, &lin_hum.x1);
+  hts221_hum_rh_point_1_get(&dev_ctx, &lin_hum.y1);
+  lin_t lin_temp;
+  hts221_temp_adc_point_0_get(&dev_ctx, &lin_temp.x0);
+  hts221_temp_deg_point_0_get(&dev_ctx, &lin_temp.y0);
+  hts221_temp_adc_point_1_get(&dev_ctx, &lin_temp.x1);
+  hts221_temp_deg_point_1_get(&dev_ctx, &lin_temp.y1);
+#endif /* CONV_CHECK */
+
+  /* Enable Block Data Update */
+  hts221_block_data_update_set(&dev_ctx, PROPERTY_ENABLE);
+  /* Set Output Data Rate */
+  hts221_data_rate_set(&dev_ctx, HTS221_ODR_1Hz);
+  /* Device power on */
+  hts221_power_on_set(&dev_ctx, PROPERTY_ENABLE);
+
+  cycles_init();
+
+  /* Read samples in polling mode */
+  while (1) {
+    /*
+     * Read STATUS_REG and HUMIDITY_OUT / TEMP_OUT registers
+     * (0x27 - 0x2B) in a single transaction.
+     */
+    hts221_read_reg(&dev_ctx, HTS221_STATUS_REG, out, 5);
+
+    /* Wait both humidity and temperature new values */
+    if ((out[0] & 0x03U) != 0x03U)
+      continue;
+
+    raw_humidity[cnt] = (int16_t)((uint16_t)out[2] << 8 | out[1]);
+    raw_temperature[cnt] = (int16_t)((uint16_t)out[4] << 8 | out[3]);
+
+    if (++cnt < BATCH_LEN)
+      continue;
+
+    /* Convert the whole batch */
+    cycles = cycles_get();
+    lin_q16_apply(&lin_hum_q16, raw_humidity, humidity_q16, BATCH_LEN,
+                  0, 100L << 16);
+    lin_q16_apply(&lin_temp_q16, raw_temperature, temperature_q16, BATCH_LEN,
+                  INT32_MIN, INT32_MAX);
+    cycles = cycles_get() - cycles;
+
+    for (i = 0; i < BATCH_LEN; i++) {
+      /* Hundredths of %RH and degC */
+      int32_t hum_c = (humidity_q16[i] * 100L) >> 16;
+      int32_t temp_c = (temperature_q16[i] * 100L) >> 16;
+      int32_t temp_abs = (temp_c < 0) ? -temp_c : temp_c;
+
+      snprintf((char *)tx_buffer, sizeof(tx_buffer),
+               "Humidity [%%]:%ld.%02ld Temperature [degC]:%s%ld.%02ld\r\n",
+               (long)(hum_c / 100), (long)(hum_c % 100),
+               (temp_c < 0) ? "-" : "", (long)(temp_abs / 100),
+               (long)(temp_abs % 100));
+      tx_com( tx_buffer, strlen( (char const *)tx_buffer ) );
+    }
+
+    snprintf((char *)tx_buffer, sizeof(tx_buffer),
+             "Conversion [cycles/sample]:%lu\r\n",
+             (unsigned long)(cycles / (2 * BATCH_LEN)));
+    tx_com( tx_buffer, strlen( (char const *)tx_buffer ) );
+
+#if defined(CONV_CHECK)
+    snprintf((char *)tx_buffer, sizeof(tx_buffer),
+             "Max error vs float [Q16 LSB]: hum %ld temp %ld\r\n",
+             (long)conv_check(&lin_hum, raw_humidity, humidity_q16,
+                              BATCH_LEN, 0.0f, 100.0f),
+             (long)conv_check(&lin_temp, raw_temperature, temperature_q16,
+                              BATCH_LEN, -1000.0f, 1000.0f));
+    tx_com( tx_buffer, strlen( (char const *)tx_buffer ) );
+#endif /* CONV_CHECK */
+
+    cnt = 0;
+  }
+}
+
+/*
+ * @brief  Write generic device register (platform dependent)
+ *
+ * @param  handle    customizable argument. In this examples is used in
+ *                   order to select the correct sensor bus handler.
+ * @param  reg       register to write
+ * @param  bufp      pointer to data to write in register reg
+ * @param  len       number of consecutive register to write
+ *
+ */
+static int32_t platform_write(void *handle, uint8_t reg, const uint8_t *bufp,
+                              uint16_t len)
+{
+#if defined(NUCLEO_F401RE)
+  /* Write multiple command */
+  reg |= 0x80;
+  HAL_I2C_Mem_Write(handle, HTS221_I2C_ADDRESS, reg,
+                    I2C_MEMADD_SIZE_8BIT, (uint8_t*) bufp, len, 1000);
+#elif defined(STEVAL_MKI109V3)
+  /* Write multiple command */
+  reg |= 0x40;
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_RESET);
+  HAL_SPI_Transmit(handle, &reg, 1, 1000);
+  HAL_SPI_Transmit(handle, (uint8_t*) bufp, len, 1000);
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_SET);
+#elif defined(SPC584B_DIS)
+  /* Write multiple command */
+  reg |= 0x80;
+  i2c_lld_write(handle,  HTS221_I2C_ADDRESS & 0xFE, reg,
+               (uint8_t*) bufp, len);
+#endif
+  return 0;
+}
+
+/*
+ * @brief  Read generic device register (platform dependent)
+ *
+ * @param  handle    customizable argument. In this examples is used in
+ *                   order to select the correct sensor bus handler.
+ * @param  reg       register to read
+ * @param  bufp      pointer to buffer that store the data read
+ * @param  len       number of consecutive register to read
+ *
+ */
+static int32_t platform_read(void *handle, uint8_t reg, uint8_t *bufp,
+                             uint16_t len)
+{
+#if defined(NUCLEO_F401RE)
+  /* Read multiple command */
+  reg |= 0x80;
+  HAL_I2C_Mem_Read(handle, HTS221_I2C_ADDRESS, reg,
+                   I2C_MEMADD_SIZE_8BIT, bufp, len, 1000);
+#elif defined(STEVAL_MKI109V3)
+  /* Read multiple command */
+  reg |= 0xC0;
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_RESET);
+  HAL_SPI_Transmit(handle, &reg, 1, 1000);
+  HAL_SPI_Receive(handle, bufp, len, 1000);
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_SET);
+#elif defined(SPC584B_DIS)
+  /* Read multiple command */
+  reg |= 0x80;
+  i2c_lld_read(handle, HTS221_I2C_ADDRESS & 0xFE, reg, bufp, len);
+#endif
+  return 0;
+}
+
+/*
+ * @brief  Write generic device register (platform dependent)
+ *
+ * @param  tx_buffer     buffer to transmit
+ * @param  len           number of byte to send
+ *
+ */
+static void tx_com(uint8_t *tx_buffer, uint16_t len)
+{
+#if defined(NUCLEO_F401RE)
+  HAL_UART_Transmit(&huart2, tx_buffer, len, 1000);
+#elif defined(STEVAL_MKI109V3)
+  CDC_Transmit_FS(tx_buffer, len);
+#elif defined(SPC584B_DIS)
+  sd_lld_write(&SD2, tx_buffer, len);
+#endif
+}
+
+/*
+ * @brief  platform specific delay (platform dependent)
+ *
+ * @param  ms        delay in ms
+ *
+ */
+static void platform_delay(uint32_t ms)
+{
+#if defined(NUCLEO_F401RE) | defined(STEVAL_MKI109V3)
+  HAL_Delay(ms);
+#elif defined(SPC584B_DIS)
+  osalThreadDelayMilliseconds(ms);
+#endif
+}
+
+/*
+ * @brief  platform specific initialization (platform dependent)
+ */
+static void platform_init(void)
+{
+#if defined(STEVAL_MKI109V3)
+  TIM3->CCR1 = PWM_3V3;
+  TIM3->CCR2 = PWM_3V3;
+  HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_1);
+  HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_2);
+  platform_delay(1000);
+#endif
+}
@@ -0,0 +1,492 @@
+/*
+ ******************************************************************************
+ * @file    read_fifo_batch.c
+ * @author  Sensors Software Solution Team
+ * @brief   This file shows how to read and decode the whole FIFO in a single burst.
+ *          polling mode.
+ *
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2025 STMicroelectronics.
+ * All rights reserved.</center></h2>
+ *
+ * This software component is licensed by ST under BSD 3-Clause license,
+ * the "License"; You may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at:
+ *                        opensource.org/licenses/BSD-3-Clause
+ *
+ ******************************************************************************
+ */
+
+/*
+ * This example was developed using the following STMicroelectronics
+ * evaluation boards:
+ *
+ * - STEVAL_MKI109V3 + STEVAL-
+ * - NUCLEO_F401RE + STEVAL-
+ * - DISCOVERY_SPC584B + STEVAL-
+ *
+ * and STM32CubeMX tool with STM32CubeF4 MCU Package
+ *
+ * Used interfaces:
+ *
+ * STEVAL_MKI109V3    - Host side:   USB (Virtual COM)
+ *                    - Sensor side: SPI(Default) / I2C(supported)
+ *
+ * NUCLEO_STM32F401RE - Host side: UART(COM) to USB bridge
+ *                    - Sensor side: I2C(Default) / SPI(supported)
+ *
+ * DISCOVERY_SPC584B  - Host side: UART(COM) to USB bridge
+ *                    - Sensor side: I2C(Default) / SPI(supported)
+ *
+ * If you need to run this example on a different hardware platform a
+ * modification of the functions: `platform_write`, `platform_read`,
+ * `tx_com` and 'platform_init' is required.
+ *
+ */
+
+/* STMicroelectronics evaluation boards definition
+ *
+ * Please uncomment ONLY the evaluation boards in use.
+ * If a different hardware is used please comment all
+ * following target board and redefine yours.
+ */
+
+//#define STEVAL_MKI109V3  /* little endian */
+//#define NUCLEO_F401RE    /* little endian */
+//#define SPC584B_DIS      /* big endian */
+
+/* ATTENTION: By default the driver is little endian. If you need switch
+ *            to big endian please see "Endianness definitions" in the
+ *            header file of the driver (_reg.h).
+ */
+
+
+#if defined(STEVAL_MKI109V3)
+/* MKI109V3: Define communication interface */
+#define SENSOR_BUS hspi2
+/* MKI109V3: Vdd and Vddio power supply values */
+#define PWM_3V3 915
+
+#elif defined(NUCLEO_F401RE)
+/* NUCLEO_F401RE: Define communication interface */
+#define SENSOR_BUS hi2c1
+
+#elif defined(SPC584B_DIS)
+/* DISCOVERY_SPC584B: Define communication interface */
+#define SENSOR_BUS I2CD1
+
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include <stdio.h>
+#include "iis2dulpx_reg.h"
+
+#if defined(NUCLEO_F401RE)
+#include "stm32f4xx_hal.h"
+#include "usart.h"
+#include "gpio.h"
+#include "i2c.h"
+
+#elif defined(STEVAL_MKI109V3)
+#include "stm32f4xx_hal.h"
+#include "usbd_cdc_if.h"
+#include "gpio.h"
+#include "spi.h"
+#include "tim.h"
+
+#elif defined(SPC584B_DIS)
+#include "components.h"
+#endif
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private macro -------------------------------------------------------------*/
+#define    BOOT_TIME         10 //ms
+
+/* FIFO depth and slot size (TAG + 6 data byte) */
+#define    FIFO_DEPTH        128
+#define    FIFO_SLOT_LEN     7
+
+/* Up to two accelerometer samples per FIFO slot in 2X mode */
+#define    STREAM_LEN        (2 * FIFO_DEPTH)
+
+/* Output data rate (ODR_HZ must match md.odr) */
+#define    ODR_HZ            800
+
+/* Timestamp LSB is 10 us */
+#define    TS_TICK_PER_S     100000UL
+
+/* FIFO_STATUS1 flags */
+#define    FIFO_WTM_IA       0x80U
+#define    FIFO_OVR_IA       0x40U
+
+/* Private typedef -----------------------------------------------------------*/
+/*
+ * Accelerometer stream in Structure of Arrays layout: raw samples are
+ * left aligned on 16 bit whatever the FIFO encoding, ts is in 10 us LSB.
+ */
+typedef struct {
+  int16_t x[STREAM_LEN];
+  int16_t y[STREAM_LEN];
+  int16_t z[STREAM_LEN];
+  uint32_t ts[STREAM_LEN];
+  uint16_t len;
+  uint8_t ovr;
+} xl_stream_t;
+
+/* Private variables ---------------------------------------------------------*/
+static iis2dulpx_md_t md;
+static uint8_t tx_buffer[1000];
+static uint8_t fifo_raw[FIFO_DEPTH * FIFO_SLOT_LEN];
+static xl_stream_t stream;
+static uint32_t ts_next;
+
+/* Extern variables ----------------------------------------------------------*/
+
+/* Private functions ---------------------------------------------------------*/
+
+/*
+ *   WARNING:
+ *   Functions declare in this section are defined at the end of this file
+ *   and are strictly related to the hardware platform used.
+ *
+ */
+static int32_t platform_write(void *handle, uint8_t reg, const uint8_t *bufp,
+                              uint16_t len);
+static int32_t platform_read(void *handle, uint8_t reg, uint8_t *bufp,
+                             uint16_t len);
+static void tx_com( uint8_t *tx_buffer, uint16_t len );
+static void platform_delay(uint32_t ms);
+static void platform_init(void);
+
+#define NUM_FIFO_ENTRY  101 /* 200 samples + timestamp */
+
+static stmdev_ctx_t dev_ctx;
+static iis2dulpx_fifo_mode_t fifo_mode;
+static volatile uint8_t fifo_wtm_event = 0;
+
+static int32_t fifo_stream_get(stmdev_ctx_t *ctx, xl_stream_t *s);
+static uint16_t fifo_unpack_2x(const uint8_t *slot, uint16_t n,
+                               xl_stream_t *s);
+
+void iis2dulpx_read_fifo_batch_handler(void)
+{
+  fifo_wtm_event = 1;
+}
+
+/* Main Example --------------------------------------------------------------*/
+void iis2dulpx_read_fifo_batch(void)
+{
+  iis2dulpx_pin_int_route_t int1_route;
+  iis2dulpx_status_t status;
+  uint8_t id;
+
+  /* Initialize mems driver interface */
+  dev_ctx.write_reg = platform_write;
+  dev_ctx.read_reg = platform_read;
+  dev_ctx.mdelay = platform_delay;
+  dev_ctx.handle = &SENSOR_BUS;
+
+  /* Initialize platform specific hardware */
+  platform_init();
+
+  /* Wait sensor boot time */
+  platform_delay(BOOT_TIME);
+
+  iis2dulpx_exit_deep_power_down(&dev_ctx);
+
+  /* Check device ID */
+  iis2dulpx_device_id_get(&dev_ctx, &id);
+  if (id != IIS2DULPX_ID)
+    while(1);
+
+  /* Restore default configuration */
+  iis2dulpx_init_set(&dev_ctx, IIS2DULPX_RESET);
+  do {
+    iis2dulpx_status_get(&dev_ctx, &status);
+  } while (status.sw_reset);
+
+  /* Set bdu and if_inc recommended for driver usage */
+  iis2dulpx_init_set(&dev_ctx, IIS2DULPX_SENSOR_ONLY_ON);
+
+  /* Set FIFO watermark to 100 slot(s) (2 samples each) */
+  fifo_mode.store = IIS2DULPX_FIFO_2X;
+  fifo_mode.xl_only = 1;
+  fifo_mode.watermark = NUM_FIFO_ENTRY;
+  fifo_mode.fifo_event = IIS2DULPX_FIFO_EV_WTM;
+  fifo_mode.operation = IIS2DULPX_STREAM_MODE;
+  fifo_mode.batch.dec_ts = IIS2DULPX_DEC_TS_32;
+  fifo_mode.batch.bdr_xl = IIS2DULPX_BDR_XL_ODR;
+  iis2dulpx_fifo_mode_set(&dev_ctx, fifo_mode);
+
+  iis2dulpx_timestamp_set(&dev_ctx, PROPERTY_ENABLE);
+
+  /* Configure interrupt pins */
+  int1_route.fifo_th = PROPERTY_ENABLE;
+  iis2dulpx_pin_int1_route_set(&dev_ctx, &int1_route);
+
+  /* Set Output Data Rate */
+  md.fs =  IIS2DULPX_4g;
+  md.bw = IIS2DULPX_ODR_div_4;
+  md.odr = IIS2DULPX_800Hz_LP;
+  iis2dulpx_mode_set(&dev_ctx, &md);
+
+  /* wait forever (FIFO samples read with irq) */
+  while (1) {
+    uint16_t i;
+
+    if (fifo_wtm_event == 0)
+      continue;
+
+    fifo_wtm_event = 0;
+
+    if (fifo_stream_get(&dev_ctx, &stream) != 0)
+      continue;
+
+    snprintf((char *)tx_buffer, sizeof(tx_buffer), "-- %d samples%s\r\n",
+             stream.len, stream.ovr ? " (overrun)" : "");
+    tx_com(tx_buffer, strlen((char const *)tx_buffer));
+
+    for (i = 0; i < stream.len; i++) {
+      snprintf((char *)tx_buffer, sizeof(tx_buffer),
+               "%lu\t%d\t%d\t%d\r\n", (unsigned long)stream.ts[i],
+               stream.x[i], stream.y[i], stream.z[i]);
+      tx_com(tx_buffer, strlen((char const *)tx_buffer));
+    }
+  }
+}
+
+/*
+ * @brief  Unpack a run of consecutive XL_ONLY_2X slots
+ *
+ * Each slot carries two 3-axis samples on 8 bit (X0 Y0 Z0 X1 Y1 Z1).
+ * The loop has a fixed stride and no data dependent branch, so that
+ * the compiler can unroll / vectorize it.
+ *
+ * @param  slot      first slot of the run (TAG byte)
+ * @param  n         number of slots in the run
+ * @param  s         output stream, samples appended at s->len
+ * @retval           number of samples appended
+ *
+ */
+static uint16_t fifo_unpack_2x(const uint8_t *slot, uint16_t n,
+                               xl_stream_t *s)
+{
+  int16_t *x = &s->x[s->len];
+  int16_t *y = &s->y[s->len];
+  int16_t *z = &s->z[s->len];
+  uint16_t i;
+
+  for (i = 0; i < n; i++) {
+    const uint8_t *d = &slot[i * FIFO_SLOT_LEN + 1];
+
+    x[2 * i] = (int16_t)((uint16_t)d[0] << 8);
+    y[2 * i] = (int16_t)((uint16_t)d[1] << 8);
+    z[2 * i] = (int16_t)((uint16_t)d[2] << 8);
+    x[2 * i + 1] = (int16_t)((uint16_t)d[3] << 8);
+    y[2 * i + 1] = (int16_t)((uint16_t)d[4] << 8);
+    z[2 * i + 1] = (int16_t)((uint16_t)d[5] << 8);
+  }
+
+  return 2 * n;
+}
+
+/*
+ * @brief  Drain the whole FIFO in a single burst and decode it
+ *
+ * FIFO_STATUS1 (flags) and FIFO_STATUS2 (level) are read in a single
+ * transaction, then all the slots are read with one burst starting from
+ * FIFO_DATA_OUT_TAG (the address rolls back to FIFO_DATA_OUT_TAG after
+ * FIFO_DATA_OUT_Z_H). Runs of XL_ONLY_2X slots are unpacked at once,
+ * TIMESTAMP slots re-anchor the timebase and the other samples are
+ * timestamped 1 / ODR apart.
+ *
+ * @param  ctx       read / write interface definitions
+ * @param  s         output stream
+ * @retval           interface status (MANDATORY: return 0 -> no Error)
+ *
+ */
+static int32_t fifo_stream_get(stmdev_ctx_t *ctx, xl_stream_t *s)
+{
+  const uint32_t period = TS_TICK_PER_S / ODR_HZ;
+  uint8_t status[2];
+  uint16_t level, i, run, k, n;
+  const uint8_t *slot;
+  int32_t ret;
+
+  s->len = 0;
+
+  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_FIFO_STATUS1, status, 2);
+  if (ret != 0)
+    return ret;
+
+  s->ovr = (status[0] & FIFO_OVR_IA) ? 1 : 0;
+  level = (status[1] > FIFO_DEPTH) ? FIFO_DEPTH : status[1];
+  if (level == 0U)
+    return ret;
+
+  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_FIFO_DATA_OUT_TAG, fifo_raw,
+                           level * FIFO_SLOT_LEN);
+  if (ret != 0)
+    return ret;
+
+  i = 0;
+  while (i < level) {
+    slot = &fifo_raw[i * FIFO_SLOT_LEN];
+
+    switch (slot[0] >> 3) {
+    case IIS2DULPX_XL_ONLY_2X_TAG:
+      /* Find the end of the run of 2X slots */
+      for (run = 1; i + run < level; run++) {
+        if ((fifo_raw[(i + run) * FIFO_SLOT_LEN] >> 3) !=
+            IIS2DULPX_XL_ONLY_2X_TAG)
+          break;
+      }
+      n = fifo_unpack_2x(slot, run, s);
+      i += run;
+      break;
+    case IIS2DULPX_XL_TEMP_TAG:
+      if (fifo_mode.xl_only == 0) {
+        /* 12 bit X, Y, Z and temperature */
+        s->x[s->len] = (int16_t)(((uint16_t)slot[2] << 12) |
+                                 ((uint16_t)slot[1] << 4));
+        s->y[s->len] = (int16_t)(((uint16_t)slot[3] << 8) |
+                                 ((uint16_t)slot[2] & 0xF0U));
+        s->z[s->len] = (int16_t)(((uint16_t)slot[5] << 12) |
+                                 ((uint16_t)slot[4] << 4));
+      } else {
+        /* 16 bit X, Y, Z */
+        s->x[s->len] = (int16_t)(((uint16_t)slot[2] << 8) | slot[1]);
+        s->y[s->len] = (int16_t)(((uint16_t)slot[4] << 8) | slot[3]);
+        s->z[s->len] = (int16_t)(((uint16_t)slot[6] << 8) | slot[5]);
+      }
+      n = 1;
+      i++;
+      break;
+    case IIS2DULPX_TIMESTAMP_TAG:
+      ts_next = (uint32_t)slot[3] | ((uint32_t)slot[4] << 8) |
+                ((uint32_t)slot[5] << 16) | ((uint32_t)slot[6] << 24);
+      n = 0;
+      i++;
+      break;
+    default:
+      n = 0;
+      i++;
+      break;
+    }
+
+    /* Samples decoded from this slot (or run) are 1 / ODR apart */
+    for (k = s->len; k < s->len + n; k++) {
+      s->ts[k] = ts_next;
+      ts_next += period;
+    }
+    s->len += n;
+  }
+
+  return ret;
+}
+
+/*
+ * @brief  Write generic device register (platform dependent)
+ *
+ * @param  handle    customizable argument. In this examples is used in
+ *                   order to select the correct sensor bus handler.
+ * @param  reg       register to write
+ * @param  bufp      pointer to data to write in register reg
+ * @param  len       number of consecutive register to write
+ *
+ */
+static int32_t platform_write(void *handle, uint8_t reg,
+                              const uint8_t *bufp, uint16_t len)
+{
+#if defined(NUCLEO_F401RE)
+  HAL_I2C_Mem_Write(handle, IIS2DULPX_I2C_ADD_L, reg,
+                    I2C_MEMADD_SIZE_8BIT, (uint8_t*) bufp, len, 1000);
+#elif defined(STEVAL_MKI109V3)
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_RESET);
+  HAL_SPI_Transmit(handle, &reg, 1, 1000);
+  HAL_SPI_Transmit(handle, (uint8_t*) bufp, len, 1000);
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_SET);
+#elif defined(SPC584B_DIS)
+  i2c_lld_write(handle,  IIS2DULPX_I2C_ADD_L & 0xFE, reg, (uint8_t*) bufp, len);
+#endif
+  return 0;
+}
+
+/*
+ * @brief  Read generic device register (platform dependent)
+ *
+ * @param  handle    customizable argument. In this examples is used in
+ *                   order to select the correct sensor bus handler.
+ * @param  reg       register to read
+ * @param  bufp      pointer to buffer that store the data read
+ * @param  len       number of consecutive register to read
+ *
+ */
+static int32_t platform_read(void *handle, uint8_t reg, uint8_t *bufp,
+                             uint16_t len)
+{
+#if defined(NUCLEO_F401RE)
+  HAL_I2C_Mem_Read(handle, IIS2DULPX_I2C_ADD_L, reg,
+                   I2C_MEMADD_SIZE_8BIT, bufp, len, 1000);
+#elif defined(STEVAL_MKI109V3)
+  reg |= 0x80;
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_RESET);
+  HAL_SPI_Transmit(handle, &reg, 1, 1000);
+  HAL_SPI_Receive(handle, bufp, len, 1000);
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_SET);
+#elif defined(SPC584B_DIS)
+  i2c_lld_read(handle, IIS2DULPX_I2C_ADD_L & 0xFE, reg, bufp, len);
+#endif
+  return 0;
+}
+
+/*
+ * @brief  Send buffer to console (platform dependent)
+ *
+ * @param  tx_buffer     buffer to transmit
+ * @param  len           number of byte to send
+ *
+ */
+static void tx_com(uint8_t *tx_buffer, uint16_t len)
+{
+#if defined(NUCLEO_F401RE)
+  HAL_UART_Transmit(&huart2, tx_buffer, len, 1000);
+#elif defined(STEVAL_MKI109V3)
+  CDC_Transmit_FS(tx_buffer, len);
+#elif defined(SPC584B_DIS)
+  sd_lld_write(&SD2, tx_buffer, len);
+#endif
+}
+
+/*
+ * @brief  platform specific delay (platform dependent)
+ *
+ * @param  ms        delay in ms
+ *
+ */
+static void platform_delay(uint32_t ms)
+{
+#if defined(NUCLEO_F401RE) | defined(STEVAL_MKI109V3)
+  HAL_Delay(ms);
+#elif defined(SPC584B_DIS)
+  osalThreadDelayMilliseconds(ms);
+#endif
+}
+
+/*
+ * @brief  platform specific initialization (platform dependent)
+ */
+static void platform_init(void)
+{
+#if defined(STEVAL_MKI109V3)
+  TIM3->CCR1 = PWM_3V3;
+  TIM3->CCR2 = PWM_3V3;
+  HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_1);
+  HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_2);
+  HAL_Delay(1000);
+#endif
+}
@@ -0,0 +1,630 @@
+/*
+ ******************************************************************************
+ * @file    iis3dwb_fifo_array.c
+ * @author  Sensors Software Solution Team
+ * @brief   This file show how to acquire an array of IIS3DWB sharing one
+ *          SPI bus and merge their FIFO data in time aligned frames.
+ *
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2020 STMicroelectronics.
+ * All rights reserved.</center></h2>
+ *
+ * This software component is licensed by ST under BSD 3-Clause license,
+ * the "License"; You may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at:
+ *                        opensource.org/licenses/BSD-3-Clause
+ *
+ ******************************************************************************
+ */
+
+/*
+ * This example was developed using the following STMicroelectronics
+ * evaluation boards:
+ *
+ * - STEVAL_MKI109V3 + STEVAL-MKI208V1K (one per chip select)
+ *
+ * Used interfaces:
+ *
+ * STEVAL_MKI109V3    - Host side:   USB (Virtual COM)
+ *                    - Sensor side: SPI(Default) / I2C(supported)
+ *
+ * If you need to run this example on a different hardware platform a
+ * modification of the functions: `platform_write`, `platform_read`,
+ * `tx_com` and 'platform_init' is required.
+ *
+ */
+
+/* STMicroelectronics evaluation boards definition
+ *
+ * Please uncomment ONLY the evaluation boards in use.
+ * If a different hardware is used please comment all
+ * following target board and redefine yours.
+ */
+
+//#define STEVAL_MKI109V3  /* little endian */
+
+/* ATTENTION: By default the driver is little endian. If you need switch
+ *            to big endian please see "Endianness definitions" in the
+ *            header file of the driver (_reg.h).
+ */
+
+#if defined(STEVAL_MKI109V3)
+/* MKI109V3: Define communication interface */
+#define SENSOR_BUS hspi2
+/* MKI109V3: Vdd and Vddio power supply values */
+#define PWM_3V3 915
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include <stdio.h>
+#include "iis3dwb_reg.h"
+
+#if defined(STEVAL_MKI109V3)
+#include "stm32f4xx_hal.h"
+#include "usbd_cdc_if.h"
+#include "gpio.h"
+#include "spi.h"
+#include "tim.h"
+#endif
+
+/* Private macro -------------------------------------------------------------*/
+#define    BOOT_TIME         10 //ms
+
+/* Number of IIS3DWB sharing the SPI bus */
+#define    ARRAY_N           8
+
+/* FIFO slots read per drain, about 4.8 ms of data at 26.7 kHz */
+#define    ARRAY_CHUNK       128
+
+/* Decoded samples kept per device (power of 2) */
+#define    ARRAY_RING        256
+
+/* Output data rate and timestamp resolution */
+#define    ODR_HZ            26667
+#define    FRAME_NS          37500
+#define    TS_LSB_NS         25000
+
+/* Print one frame every ARRAY_REPORT frames */
+#define    ARRAY_REPORT      26667
+
+/* Comment to skip the SPI clock scaling benchmark at start-up */
+#define    ARRAY_BENCH
+
+/* Private typedef -----------------------------------------------------------*/
+/* Bus handle of one device: SPI shared by the array, one chip select each */
+typedef struct {
+  void *hspi;
+  void *cs_port;
+  uint16_t cs_pin;
+} array_bus_t;
+
+typedef struct {
+  int64_t t;               /* common time base [ns] */
+  int16_t xyz[3];
+} array_sample_t;
+
+/*
+ * Array device. Sample times are rebuilt from the FIFO timestamps: the
+ * k-th sample after the last TIMESTAMP slot is at t_first + k * period,
+ * the period being measured since the start of the timeline (t_ref,
+ * k_ref; ns, 16.16 fixed point). A FIFO overrun loses samples, so it
+ * starts a new timeline at the next TIMESTAMP slot. The timestamp
+ * counters are reset one after the other at start-up and t0 is the MCU
+ * time of each reset, so that all devices are on the same (MCU) time
+ * base.
+ */
+typedef struct {
+  stmdev_ctx_t ctx;
+  int64_t t0;
+  int64_t t_first;
+  int64_t t_ref;
+  uint32_t period;
+  uint32_t k;
+  uint32_t k_ref;
+  uint8_t anchored;
+  array_sample_t ring[ARRAY_RING];
+  uint16_t head;
+  uint16_t tail;
+  uint32_t overruns;
+} array_dev_t;
+
+/* Interleaved multi-channel frame */
+typedef struct {
+  int64_t t;
+  int16_t xyz[ARRAY_N][3];
+} array_frame_t;
+
+/* Private variables ---------------------------------------------------------*/
+static uint8_t tx_buffer[1000];
+static iis3dwb_fifo_out_raw_t fifo_data[ARRAY_CHUNK];
+
+/* Chip selects of the array (board wiring dependent) */
+#if defined(STEVAL_MKI109V3)
+static array_bus_t array_bus[ARRAY_N] = {
+  { &SENSOR_BUS, CS_up_GPIO_Port, CS_up_Pin },
+  { &SENSOR_BUS, GPIOB, GPIO_PIN_0 },
+  { &SENSOR_BUS, GPIOB, GPIO_PIN_1 },
+  { &SENSOR_BUS, GPIOB, GPIO_PIN_2 },
+  { &SENSOR_BUS, GPIOC, GPIO_PIN_0 },
+  { &SENSOR_BUS, GPIOC, GPIO_PIN_1 },
+  { &SENSOR_BUS, GPIOC, GPIO_PIN_2 },
+  { &SENSOR_BUS, GPIOC, GPIO_PIN_3 },
+};
+#else
+static array_bus_t array_bus[ARRAY_N];
+#endif
+
+static array_dev_t array[ARRAY_N];
+static array_frame_t frame;
+
+/* Extern variables ----------------------------------------------------------*/
+
+/* Private functions ---------------------------------------------------------*/
+
+/*
+ *   WARNING:
+ *   Functions declare in this section are defined at the end of this file
+ *   and are strictly related to the hardware platform used.
+ *
+ */
+static int32_t platform_write(void *handle, uint8_t reg, const uint8_t *bufp,
+                              uint16_t len);
+static int32_t platform_read(void *handle, uint8_t reg, uint8_t *bufp,
+                             uint16_t len);
+static void tx_com( uint8_t *tx_buffer, uint16_t len );
+static void platform_delay(uint32_t ms);
+static void platform_init(void);
+
+
+#if defined(STEVAL_MKI109V3)
+/* Cycle counter used as MCU time base (Cortex-M DWT) */
+static void cycles_init(void)
+{
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+static uint32_t cycles_get(void)
+{
+  return DWT->CYCCNT;
+}
+
+static int64_t cycles_to_ns(uint32_t cycles)
+{
+  return ((int64_t)cycles * 1000) / (SystemCoreClock / 1000000U);
+}
+#else
+static void cycles_init(void) {}
+static uint32_t cycles_get(void) { return 0; }
+static int64_t cycles_to_ns(uint32_t cycles) { return cycles; }
+#endif
+
+/*
+ * @brief  Drain up to ARRAY_CHUNK slots of a device and decode them
+ *
+ * The FIFO level is read first: a device whose level is below the
+ * chunk is skipped, so each device is read once per ARRAY_CHUNK
+ * samples, at the phase given by its start-up stagger.
+ *
+ * @param  d         array device
+ * @retval           number of slots read
+ *
+ */
+static uint16_t array_drain(array_dev_t *d)
+{
+  iis3dwb_fifo_status_t fifo_status;
+  uint16_t k;
+
+  iis3dwb_fifo_status_get(&d->ctx, &fifo_status);
+
+  if (fifo_status.fifo_ovr) {
+    /* Samples lost: drop the timeline and what the frame builder holds */
+    d->overruns++;
+    d->anchored = 0;
+    d->tail = d->head;
+  }
+
+  if (fifo_status.fifo_level < ARRAY_CHUNK)
+    return 0;
+
+  /* read out ARRAY_CHUNK FIFO entries in a single read */
+  iis3dwb_fifo_out_multi_raw_get(&d->ctx, fifo_data, ARRAY_CHUNK);
+
+  for (k = 0; k < ARRAY_CHUNK; k++) {
+    iis3dwb_fifo_out_raw_t *f_data = &fifo_data[k];
+    array_sample_t *s;
+    int64_t ts;
+
+    switch (f_data->tag >> 3) {
+    case IIS3DWB_TIMESTAMP_TAG:
+      ts = d->t0 + (int64_t)((uint32_t)f_data->data[0] |
+                             ((uint32_t)f_data->data[1] << 8) |
+                             ((uint32_t)f_data->data[2] << 16) |
+                             ((uint32_t)f_data->data[3] << 24)) * TS_LSB_NS;
+      /* Actual sample period of this device over the timeline */
+      if (!d->anchored) {
+        d->t_ref = ts;
+        d->k_ref = 0;
+        d->anchored = 1;
+      } else if (d->k_ref > 0) {
+        d->period = (uint32_t)(((uint64_t)(ts - d->t_ref) << 16) / d->k_ref);
+      }
+      /* Re-anchor the next samples on this timestamp */
+      d->t_first = ts;
+      d->k = 0;
+      break;
+
+    case IIS3DWB_XL_TAG:
+      if (!d->anchored)
+        break;
+
+      s = &d->ring[d->head & (ARRAY_RING - 1)];
+      s->t = d->t_first + (int64_t)(((uint64_t)d->k * d->period) >> 16);
+      memcpy(s->xyz, f_data->data, sizeof(s->xyz));
+      d->k++;
+      d->k_ref++;
+
+      /* Ring full: the frame builder lags, drop the oldest sample */
+      if ((uint16_t)(++d->head - d->tail) > ARRAY_RING)
+        d->tail++;
+      break;
+
+    default:
+      break;
+    }
+  }
+
+  return ARRAY_CHUNK;
+}
+
+/*
+ * @brief  Build the next interleaved frame
+ *
+ * Every channel is linearly interpolated at the frame time, so the
+ * devices contribute samples taken at the same instant even though
+ * their ODR clocks run freely.
+ *
+ * @param  f         frame, f->t is the frame time
+ * @retval           1 if the frame is complete, 0 if a device has no
+ *                   sample after f->t yet
+ *
+ */
+static uint8_t array_frame_build(array_frame_t *f)
+{
+  uint8_t i, j;
+
+  for (i = 0; i < ARRAY_N; i++) {
+    array_dev_t *d = &array[i];
+    const array_sample_t *a, *b;
+    uint32_t w = 0;
+
+    while ((uint16_t)(d->head - d->tail) >= 2 &&
+           d->ring[(d->tail + 1) & (ARRAY_RING - 1)].t <= f->t)
+      d->tail++;
+
+    if ((uint16_t)(d->head - d->tail) < 2)
+      return 0;
+
+    a = &d->ring[d->tail & (ARRAY_RING - 1)];
+    b = &d->ring[(d->tail + 1) & (ARRAY_RING - 1)];
+
+    /* Interpolation weight (1.15 fixed point), one division per device */
+    if (f->t > a->t && b->t > a->t)
+      w = ((uint32_t)(f->t - a->t) << 15) / (uint32_t)(b->t - a->t);
+
+    for (j = 0; j < 3; j++)
+      f->xyz[i][j] = (int16_t)(a->xyz[j] +
+                               (((int32_t)(b->xyz[j] - a->xyz[j]) * (int32_t)w) >> 15));
+  }
+
+  return 1;
+}
+
+#if defined(STEVAL_MKI109V3) && defined(ARRAY_BENCH)
+/*
+ * @brief  Measure the bus time of a drain at each SPI clock and report
+ *         the number of devices the bus can sustain at 26.7 kHz
+ *
+ * Each device needs one status read plus one ARRAY_CHUNK slots read
+ * every ARRAY_CHUNK samples (timestamps are batched every 32 samples),
+ * so the bus load of N devices is N * t_drain * ODR_eff / ARRAY_CHUNK.
+ *
+ */
+static void array_bench(void)
+{
+  static const uint32_t presc[] = {
+    SPI_BAUDRATEPRESCALER_8, SPI_BAUDRATEPRESCALER_16,
+    SPI_BAUDRATEPRESCALER_32, SPI_BAUDRATEPRESCALER_64,
+  };
+  SPI_HandleTypeDef *hspi = &SENSOR_BUS;
+  uint32_t presc_init = hspi->Init.BaudRatePrescaler;
+  iis3dwb_fifo_status_t fifo_status;
+  uint32_t c, t_ns, n_max;
+  uint8_t i;
+
+  for (i = 0; i < sizeof(presc) / sizeof(uint32_t); i++) {
+    hspi->Init.BaudRatePrescaler = presc[i];
+    HAL_SPI_Init(hspi);
+
+    c = cycles_get();
+    iis3dwb_fifo_status_get(&array[0].ctx, &fifo_status);
+    iis3dwb_fifo_out_multi_raw_get(&array[0].ctx, fifo_data, ARRAY_CHUNK);
+    t_ns = (uint32_t)cycles_to_ns(cycles_get() - c);
+
+    /* ODR_eff = ODR * (1 + 1/32) FIFO slots per second */
+    n_max = (uint32_t)(((uint64_t)ARRAY_CHUNK * 1000000000ULL * 32U) /
+                       ((uint64_t)t_ns * ODR_HZ * 33U));
+
+    snprintf((char *)tx_buffer, sizeof(tx_buffer),
+             "SPI %lu kHz: drain %lu us, sustainable N %lu\r\n",
+             (unsigned long)(HAL_RCC_GetPCLK1Freq() / 1000U /
+                             (2U << (presc[i] >> SPI_CR1_BR_Pos))),
+             (unsigned long)(t_ns / 1000U), (unsigned long)n_max);
+    tx_com(tx_buffer, strlen((char const *)tx_buffer));
+  }
+
+  hspi->Init.BaudRatePrescaler = presc_init;
+  HAL_SPI_Init(hspi);
+}
+#endif
+
+/* Main Example --------------------------------------------------------------*/
+void iis3dwb_fifo_array(void)
+{
+  uint32_t c_base, c_loop, c_bus = 0;
+  uint32_t frames = 0;
+  uint32_t ovr, ovr_seen = 0;
+  uint8_t whoamI, rst;
+  uint8_t i;
+
+  /* Initialize mems driver interface, one context per chip select */
+  for (i = 0; i < ARRAY_N; i++) {
+    array[i].ctx.write_reg = platform_write;
+    array[i].ctx.read_reg = platform_read;
+    array[i].ctx.mdelay = platform_delay;
+    array[i].ctx.handle = &array_bus[i];
+    array[i].period = (uint32_t)FRAME_NS << 16;
+  }
+
+  /* Init test platform */
+  platform_init();
+  /* Wait sensor boot time */
+  platform_delay(BOOT_TIME);
+  cycles_init();
+
+  for (i = 0; i < ARRAY_N; i++) {
+    stmdev_ctx_t *ctx = &array[i].ctx;
+
+    /* Check device ID */
+    iis3dwb_device_id_get(ctx, &whoamI);
+
+    if (whoamI != IIS3DWB_ID)
+      while (1);
+
+    /* Restore default configuration */
+    iis3dwb_reset_set(ctx, PROPERTY_ENABLE);
+
+    do {
+      iis3dwb_reset_get(ctx, &rst);
+    } while (rst);
+
+    /* Enable Block Data Update */
+    iis3dwb_block_data_update_set(ctx, PROPERTY_ENABLE);
+    /* Set full scale */
+    iis3dwb_xl_full_scale_set(ctx, IIS3DWB_8g);
+    /* Stream mode, XL batched at ODR, one timestamp every 32 samples */
+    iis3dwb_fifo_xl_batch_set(ctx, IIS3DWB_XL_BATCHED_AT_26k7Hz);
+    iis3dwb_fifo_mode_set(ctx, IIS3DWB_STREAM_MODE);
+    iis3dwb_fifo_timestamp_batch_set(ctx, IIS3DWB_DEC_32);
+    iis3dwb_timestamp_set(ctx, PROPERTY_ENABLE);
+  }
+
+#if defined(STEVAL_MKI109V3) && defined(ARRAY_BENCH)
+  array_bench();
+#endif
+
+  /* Reset the timestamp counters back to back, keeping their MCU time */
+  c_base = cycles_get();
+  for (i = 0; i < ARRAY_N; i++) {
+    array[i].t0 = cycles_to_ns(cycles_get() - c_base);
+    iis3dwb_timestamp_rst(&array[i].ctx);
+  }
+
+  /*
+   * Start the devices staggered by 1/N of a chunk, so that their drains
+   * are spread evenly over time instead of colliding on the bus. The
+   * FIFO level of the first device is used as clock.
+   */
+  for (i = 0; i < ARRAY_N; i++) {
+    iis3dwb_fifo_status_t fifo_status;
+
+    do {
+      iis3dwb_fifo_status_get(&array[0].ctx, &fifo_status);
+    } while (i > 0 && fifo_status.fifo_level < (i * ARRAY_CHUNK) / ARRAY_N);
+
+    iis3dwb_xl_data_rate_set(&array[i].ctx, IIS3DWB_XL_ODR_26k7Hz);
+  }
+
+  frame.t = -1;
+
+  /* Round robin over the array, frames built as soon as all have data */
+  while (1) {
+    c_loop = cycles_get();
+    for (i = 0; i < ARRAY_N; i++)
+      array_drain(&array[i]);
+    c_bus += cycles_get() - c_loop;
+
+    /* A device lost samples: align the frames again on the new timelines */
+    for (i = 0, ovr = 0; i < ARRAY_N; i++)
+      ovr += array[i].overruns;
+    if (ovr != ovr_seen) {
+      ovr_seen = ovr;
+      frame.t = -1;
+    }
+
+    if (frame.t < 0) {
+      /* First frame at the latest first sample of the array */
+      for (i = 0; i < ARRAY_N; i++) {
+        if (array[i].head == array[i].tail)
+          break;
+        if (array[i].ring[array[i].tail & (ARRAY_RING - 1)].t > frame.t)
+          frame.t = array[i].ring[array[i].tail & (ARRAY_RING - 1)].t;
+      }
+      if (i < ARRAY_N)
+        frame.t = -1;
+      continue;
+    }
+
+    while (array_frame_build(&frame)) {
+      if (++frames % ARRAY_REPORT == 0) {
+        snprintf((char *)tx_buffer, sizeof(tx_buffer),
+                 "frame %lu t %lu us ch0 [mg] %4.2f %4.2f %4.2f ch%d [mg] %4.2f %4.2f %4.2f\r\n",
+                 (unsigned long)frames, (unsigned long)(frame.t / 1000),
+                 iis3dwb_from_fs8g_to_mg(frame.xyz[0][0]),
+                 iis3dwb_from_fs8g_to_mg(frame.xyz[0][1]),
+                 iis3dwb_from_fs8g_to_mg(frame.xyz[0][2]),
+                 ARRAY_N - 1,
+                 iis3dwb_from_fs8g_to_mg(frame.xyz[ARRAY_N - 1][0]),
+                 iis3dwb_from_fs8g_to_mg(frame.xyz[ARRAY_N - 1][1]),
+                 iis3dwb_from_fs8g_to_mg(frame.xyz[ARRAY_N - 1][2]));
+        tx_com(tx_buffer, strlen((char const *)tx_buffer));
+
+        for (i = 0; i < ARRAY_N; i++) {
+          snprintf((char *)tx_buffer, sizeof(tx_buffer),
+                   "  dev %d: period %.1f ns, overruns %lu\r\n", i,
+                   array[i].period / 65536.0f, (unsigned long)array[i].overruns);
+          tx_com(tx_buffer, strlen((char const *)tx_buffer));
+        }
+
+        snprintf((char *)tx_buffer, sizeof(tx_buffer),
+                 "  bus time per frame %lu ns\r\n",
+                 (unsigned long)(cycles_to_ns(c_bus) / ARRAY_REPORT));
+        tx_com(tx_buffer, strlen((char const *)tx_buffer));
+        c_bus = 0;
+      }
+
+      frame.t += FRAME_NS;
+    }
+  }
+}
+
+/*
+ * @brief  Write generic device register (platform dependent)
+ *
+ * @param  handle    customizable argument. In this examples is used in
+ *                   order to select the SPI handler and the chip select
+ *                   of the device in the array.
+ * @param  reg       register to write
+ * @param  bufp      pointer to data to write in register reg
+ * @param  len       number of consecutive register to write
+ *
+ */
+static int32_t platform_write(void *handle, uint8_t reg, const uint8_t *bufp,
+                              uint16_t len)
+{
+  array_bus_t *bus = handle;
+
+#if defined(STEVAL_MKI109V3)
+  HAL_GPIO_WritePin(bus->cs_port, bus->cs_pin, GPIO_PIN_RESET);
+  HAL_SPI_Transmit(bus->hspi, &reg, 1, 1000);
+  HAL_SPI_Transmit(bus->hspi, (uint8_t*) bufp, len, 1000);
+  HAL_GPIO_WritePin(bus->cs_port, bus->cs_pin, GPIO_PIN_SET);
+#else
+  (void)bus;
+#endif
+  return 0;
+}
+
+/*
+ * @brief  Read generic device register (platform dependent)
+ *
+ * @param  handle    customizable argument. In this examples is used in
+ *                   order to select the SPI handler and the chip select
+ *                   of the device in the array.
+ * @param  reg       register to read
+ * @param  bufp      pointer to buffer that store the data read
+ * @param  len       number of consecutive register to read
+ *
+ */
+static int32_t platform_read(void *handle, uint8_t reg, uint8_t *bufp,
+                             uint16_t len)
+{
+  array_bus_t *bus = handle;
+
+#if defined(STEVAL_MKI109V3)
+  reg |= 0x80;
+  HAL_GPIO_WritePin(bus->cs_port, bus->cs_pin, GPIO_PIN_RESET);
+  HAL_SPI_Transmit(bus->hspi, &reg, 1, 1000);
+  HAL_SPI_Receive(bus->hspi, bufp, len, 1000);
+  HAL_GPIO_WritePin(bus->cs_port, bus->cs_pin, GPIO_PIN_SET);
+#else
+  (void)bus;
+#endif
+  return 0;
+}
+
+/*
+ * @brief  Send buffer to console (platform dependent)
+ *
+ * @param  tx_buffer     buffer to transmit
+ * @param  len           number of byte to send
+ *
+ */
+static void tx_com(uint8_t *tx_buffer, uint16_t len)
+{
+#if defined(NUCLEO_F401RE)
+  HAL_UART_Transmit(&huart2, tx_buffer, len, 1000);
+#elif defined(STEVAL_MKI109V3)
+  CDC_Transmit_FS(tx_buffer, len);
+#elif defined(SPC584B_DIS)
+  sd_lld_write(&SD2, tx_buffer, len);
+#endif
+}
+
+/*
+ * @brief  platform specific delay (platform dependent)
+ *
+ * @param  ms        delay in ms
+ *
+ */
+static void platform_delay(uint32_t ms)
+{
+#if defined(NUCLEO_F401RE) | defined(STEVAL_MKI109V3)
+  HAL_Delay(ms);
+#elif defined(SPC584B_DIS)
+  osalThreadDelayMilliseconds(ms);
+#endif
+}
+
+/*
+ * @brief  platform specific initialization (platform dependent)
+ */
+static void platform_init(void)
+{
+#if defined(STEVAL_MKI109V3)
+  GPIO_InitTypeDef gpio = { 0 };
+  uint8_t i;
+
+  /* Chip selects of the array: push-pull outputs, deselected */
+  __HAL_RCC_GPIOB_CLK_ENABLE();
+  __HAL_RCC_GPIOC_CLK_ENABLE();
+  gpio.Mode = GPIO_MODE_OUTPUT_PP;
+  gpio.Pull = GPIO_NOPULL;
+  gpio.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
+  for (i = 0; i < ARRAY_N; i++) {
+    HAL_GPIO_WritePin(array_bus[i].cs_port, array_bus[i].cs_pin, GPIO_PIN_SET);
+    gpio.Pin = array_bus[i].cs_pin;
+    HAL_GPIO_Init(array_bus[i].cs_port, &gpio);
+  }
+
+  TIM3->CCR1 = PWM_3V3;
+  TIM3->CCR2 = PWM_3V3;
+  HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_1);
+  HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_2);
+  HAL_Delay(1000);
+#endif
+}
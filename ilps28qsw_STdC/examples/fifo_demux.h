@@ -0,0 +1,139 @@
+/*
+ ******************************************************************************
+ * @file    fifo_demux.h
+ * @author  Sensors Software Solution Team
+ * @brief   Zero-copy split of interleaved pressure and AH/QVAR FIFO data.
+ *
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2024 STMicroelectronics.
+ * All rights reserved.</center></h2>
+ *
+ * This software component is licensed by ST under BSD 3-Clause license,
+ * the "License"; You may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at:
+ *                        opensource.org/licenses/BSD-3-Clause
+ *
+ */
+
+/*
+ * The demultiplexer touches no bus: it is used on the device by
+ * ilps28qsw_fifo_demux.c and on recorded or generated FIFO captures by
+ * _prj_Linux/fifo_demux_bench.c.
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef FIFO_DEMUX_H
+#define FIFO_DEMUX_H
+
+#ifdef __cplusplus
+  extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* FIFO depth and slot size (PRESS_XL, PRESS_L, PRESS_H) */
+#define FIFO_DEPTH           128
+#define FIFO_SLOT_LEN        3
+
+/* Max number of contiguous segments per stream and per burst */
+#ifndef FIFO_DEMUX_MAX_SEG
+#define FIFO_DEMUX_MAX_SEG   4
+#endif
+
+/*
+ * Zero-copy view of one stream inside the FIFO burst buffer.
+ *
+ * In interleaved mode pressure and AH/QVAR slots alternate, so each
+ * stream is a strided array (2 * FIFO_SLOT_LEN byte apart) starting at
+ * seg[n].base. A new segment starts when alternation breaks (e.g. slots
+ * lost after FIFO overrun), and samples in a segment are 2 / ODR apart.
+ */
+typedef struct {
+  const uint8_t *base;
+  uint16_t len;
+  uint64_t ts0_us;
+} stream_seg_t;
+
+typedef struct {
+  stream_seg_t seg[FIFO_DEMUX_MAX_SEG];
+  uint8_t nseg;
+  uint16_t len;
+  uint16_t dropped;          /* slots beyond FIFO_DEMUX_MAX_SEG segments */
+} stream_view_t;
+
+enum {
+  STREAM_PRESS = 0,
+  STREAM_QVAR  = 1,
+};
+
+/*
+ * Sample value of a 24 bit FIFO slot (bit 0 is the AH/QVAR flag)
+ */
+static inline int32_t slot_value(const uint8_t *p)
+{
+  return (int32_t)(((uint32_t)p[2] << 24) | ((uint32_t)p[1] << 16) |
+                   ((uint32_t)(p[0] & 0xFEU) << 8)) >> 8;
+}
+
+/*
+ * @brief  Split a FIFO burst in pressure and AH/QVAR streams
+ *
+ * Slots are classified by the AH/QVAR flag (bit 0): each slot extends the
+ * segment of its stream if it is exactly two slots after the previous one,
+ * otherwise a new segment is opened, so that the interleave phase is
+ * recovered automatically after an overrun. No data is copied, the views
+ * point into buf and stay valid until buf is overwritten.
+ *
+ * @param  buf       burst buffer, referenced by the returned views
+ * @param  level     number of slots in buf (up to FIFO_DEPTH)
+ * @param  first     index of the first slot of buf since FIFO start
+ * @param  odr_hz    FIFO slot rate [Hz]
+ * @param  v         pressure (v[STREAM_PRESS]) and AH/QVAR views
+ *
+ */
+static inline void fifo_demux(const uint8_t *buf, uint16_t level,
+                              uint64_t first, uint32_t odr_hz,
+                              stream_view_t *v)
+{
+  int16_t last[2] = { -2, -2 };
+  stream_view_t *s;
+  uint16_t i;
+  uint8_t type;
+
+  v[STREAM_PRESS].nseg = 0;
+  v[STREAM_PRESS].len = 0;
+  v[STREAM_PRESS].dropped = 0;
+  v[STREAM_QVAR].nseg = 0;
+  v[STREAM_QVAR].len = 0;
+  v[STREAM_QVAR].dropped = 0;
+
+  for (i = 0; i < level; i++) {
+    type = buf[i * FIFO_SLOT_LEN] & 0x01U;
+    s = &v[type];
+
+    if ((int16_t)i == last[type] + 2 && s->nseg > 0U) {
+      s->seg[s->nseg - 1U].len++;
+    } else if (s->nseg < FIFO_DEMUX_MAX_SEG) {
+      s->seg[s->nseg].base = &buf[i * FIFO_SLOT_LEN];
+      s->seg[s->nseg].len = 1;
+      s->seg[s->nseg].ts0_us = ((first + i) * 1000000U) / odr_hz;
+      s->nseg++;
+    } else {
+      /* Too many discontinuities: drop the slot */
+      s->dropped++;
+      continue;
+    }
+
+    s->len++;
+    last[type] = (int16_t)i;
+  }
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FIFO_DEMUX_H */
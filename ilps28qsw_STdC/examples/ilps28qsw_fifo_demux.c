@@ -0,0 +1,523 @@
+/*
+ ******************************************************************************
+ * @file    fifo_demux.c
+ * @author  Sensors Software Solution Team
+ * @brief   This file shows how to split interleaved FIFO data without copy.
+ *
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2021 STMicroelectronics.
+ * All rights reserved.</center></h2>
+ *
+ * This software component is licensed by ST under BSD 3-Clause license,
+ * the "License"; You may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at:
+ *                        opensource.org/licenses/BSD-3-Clause
+ *
+ ******************************************************************************
+ */
+
+/*
+ * This example was developed using the following STMicroelectronics
+ * evaluation boards:
+ *
+ * - NUCLEO_F401RE
+ * - DISCOVERY_SPC584B
+ * - NUCLEO_H503RB + X-NUCLEO-IKS4A1
+ *
+ * and STM32CubeMX tool with STM32CubeF4 MCU Package
+ *
+ * Used interfaces:
+ *
+ * NUCLEO_STM32F401RE - Host side: UART(COM) to USB bridge
+ *                    - I2C(Default) / SPI(N/A)
+ *
+ * DISCOVERY_SPC584B  - Host side: UART(COM) to USB bridge
+ *                    - Sensor side: I2C(Default) / SPI(N/A)
+ *
+ * NUCLEO_STM32H503RG - Host side: UART(COM) to USB bridge
+ *                    - Sensor side: I3C(Default)
+ *
+ * If you need to run this example on a different hardware platform a
+ * modification of the functions: `platform_write`, `platform_read`,
+ * `tx_com` and 'platform_init' is required.
+ *
+ */
+
+/* STMicroelectronics evaluation boards definition
+ *
+ * Please uncomment ONLY the evaluation boards in use.
+ * If a different hardware is used please comment all
+ * following target board and redefine yours.
+ */
+
+//#define NUCLEO_F401RE    /* little endian */
+//#define SPC584B_DIS      /* big endian */
+
+/* ATTENTION: By default the driver is little endian. If you need switch
+ *            to big endian please see "Endianness definitions" in the
+ *            header file of the driver (_reg.h).
+ */
+
+
+#if defined(NUCLEO_F401RE)
+/* NUCLEO_F401RE: Define communication interface */
+#define SENSOR_BUS hi2c1
+
+#elif defined(SPC584B_DIS)
+/* DISCOVERY_SPC584B: Define communication interface */
+#define SENSOR_BUS I2CD1
+
+#elif defined(NUCLEO_H503RB)
+/* NUCLEO_H503RB: Define communication interface */
+#define SENSOR_BUS hi3c1
+
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include <stdio.h>
+#include "ilps28qsw_reg.h"
+#include "fifo_demux.h"
+
+#if defined(NUCLEO_F401RE)
+#include "stm32f4xx_hal.h"
+#include "usart.h"
+#include "gpio.h"
+#include "i2c.h"
+
+#elif defined(SPC584B_DIS)
+#include "components.h"
+
+#elif defined(NUCLEO_H503RB)
+#include "usart.h"
+#include "i3c.h"
+#include "i3c_api.h"
+#include <stdio.h>
+
+static uint8_t i3c_dyn_addr = 0x0A;
+#endif
+
+/* Private macro -------------------------------------------------------------*/
+#define    BOOT_TIME         10 //ms
+
+/* FIFO watermark and output data rate (FIFO_ODR_HZ must match md.odr) */
+#define    FIFO_WTM          64
+#define    FIFO_ODR_HZ       200
+
+/* FIFO_STATUS2 flags */
+#define    FIFO_WTM_IA       0x80U
+#define    FIFO_OVR_IA       0x40U
+
+/*
+ * Uncomment to print every burst as "burst,<ovr>,<hex slots>", the
+ * capture format read by _prj_Linux/fifo_demux_bench
+ */
+//#define    DEMUX_TRACE
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+static uint8_t tx_buffer[1000];
+
+/*
+ * One burst buffer: the consumers run before the next burst is read, so
+ * the views into it are not used after it is overwritten
+ */
+static uint8_t fifo_raw[FIFO_DEPTH * FIFO_SLOT_LEN];
+static stream_view_t view[2];
+static uint64_t slot_cnt;
+static uint32_t t0_ms;
+
+/* Extern variables ----------------------------------------------------------*/
+
+/* Private functions ---------------------------------------------------------*/
+/*
+ *   WARNING:
+ *   Functions declare in this section are defined at the end of this file
+ *   and are strictly related to the hardware platform used.
+ *
+ */
+static int32_t platform_write(void *handle, uint8_t reg, const uint8_t *bufp,
+                              uint16_t len);
+static int32_t platform_read(void *handle, uint8_t reg, uint8_t *bufp,
+                             uint16_t len);
+static void tx_com( uint8_t *tx_buffer, uint16_t len );
+static void platform_delay(uint32_t ms);
+static void platform_init(void *handle);
+static uint32_t platform_get_ms(void);
+
+static int32_t fifo_burst_get(stmdev_ctx_t *ctx, uint8_t *buf,
+                              uint16_t *level, uint8_t *ovr);
+static void press_consumer(const stream_view_t *v);
+static void qvar_consumer(const stream_view_t *v);
+#if defined(DEMUX_TRACE)
+static void demux_trace(const uint8_t *buf, uint16_t level, uint8_t ovr);
+#endif
+
+#if defined(NUCLEO_F401RE)
+/* Cycle counter used to benchmark the demultiplexer (Cortex-M DWT) */
+static void cycles_init(void)
+{
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+static uint32_t cycles_get(void)
+{
+  return DWT->CYCCNT;
+}
+#else
+static void cycles_init(void) {}
+static uint32_t cycles_get(void) { return 0; }
+#endif
+
+/* Main Example --------------------------------------------------------------*/
+void ilps28qsw_fifo_demux(void)
+{
+  ilps28qsw_fifo_md_t fifo_mode;
+  ilps28qsw_bus_mode_t bus_mode;
+  ilps28qsw_stat_t status;
+  stmdev_ctx_t dev_ctx;
+  ilps28qsw_id_t id;
+  ilps28qsw_md_t md;
+
+  /* Initialize mems driver interface */
+  dev_ctx.write_reg = platform_write;
+  dev_ctx.read_reg = platform_read;
+  dev_ctx.mdelay = platform_delay;
+  dev_ctx.handle = &SENSOR_BUS;
+
+  /* Init test platform */
+  platform_init(dev_ctx.handle);
+  /* Wait sensor boot time */
+  platform_delay(BOOT_TIME);
+
+  /* Check device ID */
+  ilps28qsw_id_get(&dev_ctx, &id);
+  if (id.whoami != ILPS28QSW_ID)
+    while(1);
+
+  /* Restore default configuration */
+  ilps28qsw_init_set(&dev_ctx, ILPS28QSW_RESET);
+  do {
+    ilps28qsw_status_get(&dev_ctx, &status);
+  } while (status.sw_reset);
+
+  /* Disable AH/QVAR to save power consumption */
+  ilps28qsw_ah_qvar_disable(&dev_ctx);
+
+  /* Set bdu and if_inc recommended for driver usage */
+  ilps28qsw_init_set(&dev_ctx, ILPS28QSW_DRV_RDY);
+
+  /* Select bus interface */
+  bus_mode.filter = ILPS28QSW_AUTO;
+  ilps28qsw_bus_mode_set(&dev_ctx, &bus_mode);
+
+  /* Enable ah_qvar/pressure data interleaved mode */
+  ilps28qsw_ah_qvar_en_set(&dev_ctx, 0);
+
+  /* Set Output Data Rate */
+  md.odr = ILPS28QSW_200Hz;
+  md.avg = ILPS28QSW_16_AVG;
+  md.lpf = ILPS28QSW_LPF_ODR_DIV_4;
+  md.fs = ILPS28QSW_1260hPa;
+  md.interleaved_mode = 1;
+  ilps28qsw_mode_set(&dev_ctx, &md);
+
+  /* Enable FIFO */
+  fifo_mode.operation = ILPS28QSW_STREAM;
+  fifo_mode.watermark = FIFO_WTM;
+  ilps28qsw_fifo_mode_set(&dev_ctx, &fifo_mode);
+
+  t0_ms = platform_get_ms();
+  cycles_init();
+
+  /* Read samples in polling mode (no int) */
+  while(1)
+  {
+    stream_view_t *v = view;
+    uint32_t cycles;
+    uint16_t level;
+    uint8_t ovr;
+
+    if (fifo_burst_get(&dev_ctx, fifo_raw, &level, &ovr) != 0 ||
+        level == 0U)
+      continue;
+
+    /*
+     * Slots lost in an overrun are not counted by the FIFO: resynchronise
+     * the timeline on the MCU time, the last slot read being the most
+     * recent sample.
+     */
+    if (ovr) {
+      uint64_t now = ((uint64_t)(platform_get_ms() - t0_ms) * FIFO_ODR_HZ) /
+                     1000U + 1U;
+
+      if (now > slot_cnt + level)
+        slot_cnt = now - level;
+    }
+
+#if defined(DEMUX_TRACE)
+    demux_trace(fifo_raw, level, ovr);
+#endif
+
+    cycles = cycles_get();
+    fifo_demux(fifo_raw, level, slot_cnt, FIFO_ODR_HZ, v);
+    cycles = cycles_get() - cycles;
+    slot_cnt += level;
+
+    snprintf((char*)tx_buffer, sizeof(tx_buffer),
+             "--- press %d qvar %d%s (demux %lu cycles)\r\n",
+             v[STREAM_PRESS].len, v[STREAM_QVAR].len,
+             ovr ? " overrun" : "", (unsigned long)cycles);
+    tx_com(tx_buffer, strlen((char const*)tx_buffer));
+
+    if (v[STREAM_PRESS].dropped || v[STREAM_QVAR].dropped) {
+      snprintf((char*)tx_buffer, sizeof(tx_buffer),
+               "dropped (too many segments): press %d qvar %d\r\n",
+               v[STREAM_PRESS].dropped, v[STREAM_QVAR].dropped);
+      tx_com(tx_buffer, strlen((char const*)tx_buffer));
+    }
+
+    press_consumer(&v[STREAM_PRESS]);
+    qvar_consumer(&v[STREAM_QVAR]);
+  }
+}
+
+/*
+ * @brief  Read whole FIFO in one burst
+ *
+ * FIFO_STATUS1/2 and STATUS are read in one transaction and the FIFO
+ * content with a single burst.
+ *
+ * @param  ctx       read / write interface definitions
+ * @param  buf       burst buffer
+ * @param  level     number of slots read (0 if watermark not reached)
+ * @param  ovr       set to 1 if FIFO overrun occurred
+ * @retval           interface status (MANDATORY: return 0 -> no Error)
+ *
+ */
+static int32_t fifo_burst_get(stmdev_ctx_t *ctx, uint8_t *buf,
+                              uint16_t *level, uint8_t *ovr)
+{
+  uint8_t status[3];
+  int32_t ret;
+
+  *level = 0;
+  *ovr = 0;
+
+  ret = ilps28qsw_read_reg(ctx, ILPS28QSW_FIFO_STATUS1, status, 3);
+  if (ret != 0 || (status[1] & FIFO_WTM_IA) == 0U)
+    return ret;
+
+  *ovr = (status[1] & FIFO_OVR_IA) ? 1 : 0;
+  *level = (status[0] > FIFO_DEPTH) ? FIFO_DEPTH : status[0];
+
+  ret = ilps28qsw_read_reg(ctx, ILPS28QSW_FIFO_DATA_OUT_PRESS_XL, buf,
+                           *level * FIFO_SLOT_LEN);
+  if (ret != 0)
+    *level = 0;
+
+  return ret;
+}
+
+#if defined(DEMUX_TRACE)
+/*
+ * @brief  Print a burst in the capture format of fifo_demux_bench
+ *
+ * @param  buf       burst buffer
+ * @param  level     number of slots in buf
+ * @param  ovr       FIFO overrun flag of the burst
+ *
+ */
+static void demux_trace(const uint8_t *buf, uint16_t level, uint8_t ovr)
+{
+  static const char hex[] = "0123456789abcdef";
+  uint16_t i, n;
+
+  n = (uint16_t)snprintf((char*)tx_buffer, sizeof(tx_buffer), "burst,%d,", ovr);
+  for (i = 0; i < level * FIFO_SLOT_LEN; i++) {
+    tx_buffer[n++] = (uint8_t)hex[buf[i] >> 4];
+    tx_buffer[n++] = (uint8_t)hex[buf[i] & 0x0FU];
+  }
+  tx_buffer[n++] = '\r';
+  tx_buffer[n++] = '\n';
+  tx_com(tx_buffer, n);
+}
+#endif
+
+/*
+ * @brief  Example of pressure stream consumer (reads the burst buffer)
+ *
+ * @param  v         pressure stream view
+ *
+ */
+static void press_consumer(const stream_view_t *v)
+{
+  const uint8_t *p;
+  uint64_t ts;
+  int32_t pa_q8;
+  uint16_t k;
+  uint8_t n;
+
+  for (n = 0; n < v->nseg; n++) {
+    p = v->seg[n].base;
+
+    for (k = 0; k < v->seg[n].len; k++) {
+      /* 4096 LSB/hPa (1260 hPa full scale): Pa * 256 = lsb * 25 / 4 */
+      pa_q8 = (slot_value(p) * 25) >> 2;
+      ts = v->seg[n].ts0_us + ((uint64_t)k * 2000000U) / FIFO_ODR_HZ;
+
+      snprintf((char*)tx_buffer, sizeof(tx_buffer),
+               "t [ms]:%lu pressure [Pa]:%ld.%02ld\r\n",
+               (unsigned long)(ts / 1000U), (long)(pa_q8 >> 8),
+               (long)(((pa_q8 & 0xFF) * 100) >> 8));
+      tx_com(tx_buffer, strlen((char const*)tx_buffer));
+
+      p += 2 * FIFO_SLOT_LEN;
+    }
+  }
+}
+
+/*
+ * @brief  Example of AH/QVAR stream consumer (reads the burst buffer)
+ *
+ * @param  v         AH/QVAR stream view
+ *
+ */
+static void qvar_consumer(const stream_view_t *v)
+{
+  const uint8_t *p;
+  uint64_t ts;
+  uint16_t k;
+  uint8_t n;
+
+  for (n = 0; n < v->nseg; n++) {
+    p = v->seg[n].base;
+
+    for (k = 0; k < v->seg[n].len; k++) {
+      ts = v->seg[n].ts0_us + ((uint64_t)k * 2000000U) / FIFO_ODR_HZ;
+
+      snprintf((char*)tx_buffer, sizeof(tx_buffer),
+               "t [ms]:%lu AH_QVAR lsb %ld\r\n",
+               (unsigned long)(ts / 1000U), (long)slot_value(p));
+      tx_com(tx_buffer, strlen((char const*)tx_buffer));
+
+      p += 2 * FIFO_SLOT_LEN;
+    }
+  }
+}
+
+/*
+ * @brief  Write generic device register (platform dependent)
+ *
+ * @param  handle    customizable argument. In this examples is used in
+ *                   order to select the correct sensor bus handler.
+ * @param  reg       register to write
+ * @param  bufp      pointer to data to write in register reg
+ * @param  len       number of consecutive register to write
+ *
+ */
+static int32_t platform_write(void *handle, uint8_t reg, const uint8_t *bufp,
+                              uint16_t len)
+{
+#if defined(NUCLEO_F401RE)
+  HAL_I2C_Mem_Write(handle, ILPS28QSW_I2C_ADD, reg,
+                    I2C_MEMADD_SIZE_8BIT, (uint8_t*) bufp, len, 1000);
+#elif defined(SPC584B_DIS)
+  i2c_lld_write(handle,  ILPS28QSW_I2C_ADD & 0xFE, reg, (uint8_t*) bufp, len);
+#elif defined(NUCLEO_H503RB)
+  i3c_write(handle, i3c_dyn_addr, reg, (uint8_t*) bufp, len);
+#endif
+  return 0;
+}
+
+/*
+ * @brief  Read generic device register (platform dependent)
+ *
+ * @param  handle    customizable argument. In this examples is used in
+ *                   order to select the correct sensor bus handler.
+ * @param  reg       register to read
+ * @param  bufp      pointer to buffer that store the data read
+ * @param  len       number of consecutive register to read
+ *
+ */
+static int32_t platform_read(void *handle, uint8_t reg, uint8_t *bufp,
+                             uint16_t len)
+{
+#if defined(NUCLEO_F401RE)
+  HAL_I2C_Mem_Read(handle, ILPS28QSW_I2C_ADD, reg,
+                   I2C_MEMADD_SIZE_8BIT, bufp, len, 1000);
+#elif defined(SPC584B_DIS)
+  i2c_lld_read(handle, ILPS28QSW_I2C_ADD & 0xFE, reg, bufp, len);
+#elif defined(NUCLEO_H503RB)
+  i3c_read(handle, i3c_dyn_addr, reg, bufp, len);
+#endif
+  return 0;
+}
+
+/*
+ * @brief  Write generic device register (platform dependent)
+ *
+ * @param  tx_buffer     buffer to trasmit
+ * @param  len           number of byte to send
+ *
+ */
+static void tx_com(uint8_t *tx_buffer, uint16_t len)
+{
+#if defined(NUCLEO_F401RE)
+  HAL_UART_Transmit(&huart2, tx_buffer, len, 1000);
+#elif defined(SPC584B_DIS)
+  sd_lld_write(&SD2, tx_buffer, len);
+#elif defined(NUCLEO_H503RB)
+  HAL_UART_Transmit(&huart3, tx_buffer, len, 1000);
+#endif
+}
+
+/*
+ * @brief  platform specific delay (platform dependent)
+ *
+ * @param  ms        delay in ms
+ *
+ */
+static void platform_delay(uint32_t ms)
+{
+#if defined(NUCLEO_F401RE) || defined(NUCLEO_H503RB)
+  HAL_Delay(ms);
+#elif defined(SPC584B_DIS)
+  osalThreadDelayMilliseconds(ms);
+#endif
+}
+
+/*
+ * @brief  platform specific time (platform dependent)
+ *
+ * @retval           time [ms]
+ *
+ */
+static uint32_t platform_get_ms(void)
+{
+#if defined(NUCLEO_F401RE) || defined(NUCLEO_H503RB)
+  return HAL_GetTick();
+#elif defined(SPC584B_DIS)
+  return osalThreadGetMilliseconds();
+#else
+  return 0;
+#endif
+}
+
+/*
+ * @brief  platform specific initialization (platform dependent)
+ */
+static void platform_init(void *handle)
+{
+#if defined(NUCLEO_H503RB)
+  i3c_set_bus_frequency(handle, 1000000);
+  i3c_rstdaa(handle);
+  i3c_setdasa(handle, ILPS28QSW_I2C_ADD, &i3c_dyn_addr, 1);
+  i3c_set_bus_frequency(handle, 12500000);
+#endif
+}
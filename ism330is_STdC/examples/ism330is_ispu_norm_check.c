@@ -0,0 +1,460 @@
+/*
+ ******************************************************************************
+ * @file    ispu_norm_check.c
+ * @author  Sensors Software Solution Team
+ * @brief   This file shows how to check an ISPU algorithm against a reference build.
+ *
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2020 STMicroelectronics.
+ * All rights reserved.</center></h2>
+ *
+ * This software component is licensed by ST under BSD 3-Clause license,
+ * the "License"; You may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at:
+ *                        opensource.org/licenses/BSD-3-Clause
+ *
+ ******************************************************************************
+ */
+
+/*
+ * This example was developed using the following STMicroelectronics
+ * evaluation boards:
+ *
+ * - STEVAL_MKI109V3 + STEVAL-MKI196V1
+ * - NUCLEO_F401RE + X_NUCLEO_IKS01A3
+ * - DISCOVERY_SPC584B + STEVAL-MKI196V1
+ *
+ * Used interfaces:
+ *
+ * STEVAL_MKI109V3    - Host side:   USB (Virtual COM)
+ *                    - Sensor side: SPI(Default) / I2C(supported)
+ *
+ * NUCLEO_STM32F401RE - Host side: UART(COM) to USB bridge
+ *                    - I2C(Default) / SPI(supported)
+ *
+ * DISCOVERY_SPC584B  - Host side: UART(COM) to USB bridge
+ *                    - Sensor side: I2C(Default) / SPI(supported)
+ *
+ * If you need to run this example on a different hardware platform a
+ * modification of the functions: `platform_write`, `platform_read`,
+ * `tx_com` and 'platform_init' is required.
+ *
+ */
+
+/* STMicroelectronics evaluation boards definition
+ *
+ * Please uncomment ONLY the evaluation boards in use.
+ * If a different hardware is used please comment all
+ * following target board and redefine yours.
+ */
+
+//#define STEVAL_MKI109V3  /* little endian */
+//#define NUCLEO_F401RE    /* little endian */
+//#define SPC584B_DIS      /* big endian */
+
+/* ATTENTION: By default the driver is little endian. If you need switch
+ *            to big endian please see "Endianness definitions" in the
+ *            header file of the driver (_reg.h).
+ */
+
+#if defined(STEVAL_MKI109V3)
+/* MKI109V3: Define communication interface */
+#define SENSOR_BUS hspi2
+/* MKI109V3: Vdd and Vddio power supply values */
+#define PWM_3V3 915
+
+#elif defined(NUCLEO_F401RE)
+/* NUCLEO_F401RE: Define communication interface */
+#define SENSOR_BUS hi2c1
+
+#elif defined(SPC584B_DIS)
+/* DISCOVERY_SPC584B: Define communication interface */
+#define SENSOR_BUS I2CD1
+
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+#include "norm.h"
+#include "ism330is_reg.h"
+
+#if defined(NUCLEO_F401RE)
+#include "stm32f4xx_hal.h"
+#include "usart.h"
+#include "gpio.h"
+#include "i2c.h"
+
+#elif defined(STEVAL_MKI109V3)
+#include "stm32f4xx_hal.h"
+#include "usbd_cdc_if.h"
+#include "gpio.h"
+#include "spi.h"
+#include "tim.h"
+
+#elif defined(SPC584B_DIS)
+#include "components.h"
+#endif
+
+/* Private macro -------------------------------------------------------------*/
+#define    BOOT_TIME      10
+
+/* Uncomment to print every sample for the host replay (_prj_Linux/ispu_norm_ref.c) */
+//#define NORM_LOG
+
+/* Number of samples in a report */
+#define    REPORT_LEN     256
+
+/* Private typedef -----------------------------------------------------------*/
+/* Reference build of the ISPU algorithm vs device output */
+typedef struct {
+  uint32_t samples;
+  uint32_t missed;
+  float_t err_max;
+} ispu_check_t;
+
+/* Private variables ---------------------------------------------------------*/
+static uint8_t whoamI;
+static uint8_t tx_buffer[1000];
+static volatile uint8_t ispu_event = 0;
+static volatile uint8_t dout[10];
+static ispu_check_t check;
+
+/* Extern variables ----------------------------------------------------------*/
+
+/* Private functions ---------------------------------------------------------*/
+
+/*
+ *   WARNING:
+ *   Functions declare in this section are defined at the end of this file
+ *   and are strictly related to the hardware platform used.
+ *
+ */
+static int32_t platform_write(void *handle, uint8_t reg, const uint8_t *bufp,
+                              uint16_t len);
+static int32_t platform_read(void *handle, uint8_t reg, uint8_t *bufp,
+                             uint16_t len);
+static void tx_com( uint8_t *tx_buffer, uint16_t len );
+static void platform_delay(uint32_t ms);
+static void platform_init(void);
+static void platform_irq_disable(void);
+static void platform_irq_enable(void);
+
+
+static   stmdev_ctx_t dev_ctx;
+
+/* ISPU clock in Hz (datasheet: 5 MHz or 10 MHz, ISPU_CLK_SEL in CTRL10_C) */
+static uint32_t ispu_clock_hz(ism330is_ispu_clock_sel_t clk)
+{
+  return (clk == ISM330IS_ISPU_CLK_10MHz) ? 10000000UL : 5000000UL;
+}
+
+/* ISPU data rate in tenths of Hz (datasheet, ISPU_RATE in CTRL9_C) */
+static uint32_t ispu_odr_dhz(ism330is_ispu_data_rate_t odr)
+{
+  switch (odr) {
+  case ISM330IS_ISPU_ODR_AT_1Hz6:   return 16;
+  case ISM330IS_ISPU_ODR_AT_12Hz5:  return 125;
+  case ISM330IS_ISPU_ODR_AT_26Hz:   return 260;
+  case ISM330IS_ISPU_ODR_AT_52Hz:   return 520;
+  case ISM330IS_ISPU_ODR_AT_104Hz:  return 1040;
+  case ISM330IS_ISPU_ODR_AT_208Hz:  return 2080;
+  case ISM330IS_ISPU_ODR_AT_416Hz:  return 4160;
+  case ISM330IS_ISPU_ODR_AT_833Hz:  return 8330;
+  case ISM330IS_ISPU_ODR_AT_1667Hz: return 16670;
+  case ISM330IS_ISPU_ODR_AT_3333Hz: return 33330;
+  case ISM330IS_ISPU_ODR_AT_6667Hz: return 66670;
+  default:                          return 0;
+  }
+}
+
+/*
+ * Reference build of the ISPU "norm" algorithm: norm of the three axes
+ * in g, with the sensitivity of the accelerometer full scale in use.
+ * _prj_Linux/ispu_norm_ref.c runs the same reference on the host over
+ * the samples logged with NORM_LOG.
+ */
+static float_t norm_ref(ism330is_xl_full_scale_t fs, int16_t x, int16_t y,
+                        int16_t z)
+{
+  float_t (*to_mg)(int16_t);
+  float_t fx, fy, fz;
+
+  switch (fs) {
+  case ISM330IS_4g:  to_mg = ism330is_from_fs4g_to_mg;  break;
+  case ISM330IS_8g:  to_mg = ism330is_from_fs8g_to_mg;  break;
+  case ISM330IS_16g: to_mg = ism330is_from_fs16g_to_mg; break;
+  default:           to_mg = ism330is_from_fs2g_to_mg;  break;
+  }
+
+  fx = to_mg(x) / 1000.0f;
+  fy = to_mg(y) / 1000.0f;
+  fz = to_mg(z) / 1000.0f;
+
+  return sqrtf(fx * fx + fy * fy + fz * fz);
+}
+
+void ism330is_ispu_norm_check_handler()
+{
+  uint32_t ispu_int;
+  uint8_t buf[10];
+  uint8_t i;
+
+  ism330is_ispu_int_status_get(&dev_ctx, &ispu_int);
+
+  /* handle only ISPU INT1 interrupts */
+  if ((ispu_int & 0x1) == 0)
+    return;
+
+  ism330is_ispu_read_data_raw_get(&dev_ctx, buf, 10);
+  for (i = 0; i < 10; i++)
+    dout[i] = buf[i];
+
+  if (ispu_event < UINT8_MAX)
+    ispu_event++;
+}
+
+/*
+ * Copy the last ISPU output with the interrupt masked, so that the
+ * handler cannot overwrite it half way. Returns the number of outputs
+ * received since the previous copy (0 if none).
+ */
+static uint8_t dout_snapshot(uint8_t *buf)
+{
+  uint8_t n, i;
+
+  platform_irq_disable();
+  n = ispu_event;
+  ispu_event = 0;
+  for (i = 0; i < 10; i++)
+    buf[i] = dout[i];
+  platform_irq_enable();
+
+  return n;
+}
+
+/* Main Example --------------------------------------------------------------*/
+void ism330is_ispu_norm_check(void)
+{
+  ism330is_ispu_data_rate_t ispu_odr;
+  ism330is_ispu_clock_sel_t ispu_clk;
+  ism330is_xl_full_scale_t fs;
+  uint32_t odr_dhz;
+  uint16_t i;
+
+  /* Initialize mems driver interface */
+  dev_ctx.write_reg = platform_write;
+  dev_ctx.read_reg = platform_read;
+  dev_ctx.mdelay = platform_delay;
+  dev_ctx.handle = &SENSOR_BUS;
+  /* Init test platform */
+  platform_init();
+  /* Wait sensor boot time */
+  platform_delay(BOOT_TIME);
+  /* Check device ID */
+  ism330is_device_id_get(&dev_ctx, &whoamI);
+
+  if (whoamI != ISM330IS_ID)
+    while (1);
+
+  /* Restore default configuration */
+  ism330is_software_reset(&dev_ctx);
+
+  /* Load ISPU configuration */
+  for ( i = 0; i < (sizeof(ispu_conf) / sizeof(ucf_line_ext_t) ); i++ ) {
+    switch(ispu_conf[i].op) {
+    case MEMS_UCF_OP_DELAY:
+      platform_delay(ispu_conf[i].data);
+      break;
+    case MEMS_UCF_OP_WRITE:
+      ism330is_write_reg(&dev_ctx, ispu_conf[i].address, (uint8_t *)&ispu_conf[i].data, 1);
+      break;
+    }
+  }
+
+  /* Clock, rate and full scale as set by the ISPU configuration */
+  ism330is_ispu_data_rate_get(&dev_ctx, &ispu_odr);
+  ism330is_ispu_clock_get(&dev_ctx, &ispu_clk);
+  ism330is_xl_full_scale_get(&dev_ctx, &fs);
+  odr_dhz = ispu_odr_dhz(ispu_odr);
+
+  snprintf((char *)tx_buffer, sizeof(tx_buffer),
+           "ISPU started: at rate %lu.%lu Hz, clock %lu Hz, budget %lu ISPU cycles/sample\r\n",
+           (unsigned long)(odr_dhz / 10), (unsigned long)(odr_dhz % 10),
+           (unsigned long)ispu_clock_hz(ispu_clk),
+           (odr_dhz != 0) ? (unsigned long)(ispu_clock_hz(ispu_clk) * 10UL / odr_dhz) : 0UL);
+  tx_com(tx_buffer, strlen((char const *)tx_buffer));
+
+  /* Run the reference on every ISPU output and compare */
+  while (1) {
+    uint8_t buf[10];
+    int16_t x, y, z;
+    int32_t temp;
+    float_t norm, ref, err;
+    uint8_t n;
+
+    n = dout_snapshot(buf);
+    if (n == 0)
+      continue;
+
+    /* outputs overwritten before being copied */
+    check.missed += n - 1;
+
+    x = (int16_t)buf[1];
+    x = (x * 256) + (int16_t)buf[0];
+    y = (int16_t)buf[3];
+    y = (y * 256) + (int16_t)buf[2];
+    z = (int16_t)buf[5];
+    z = (z * 256) + (int16_t)buf[4];
+
+    temp = (buf[9] << 24) | (buf[8] << 16) | (buf[7] << 8) | buf[6];
+    memcpy(&norm, &temp, sizeof(norm));
+
+    ref = norm_ref(fs, x, y, z);
+
+#if defined(NORM_LOG)
+    snprintf((char *)tx_buffer, sizeof(tx_buffer), "norm,%d,%d,%d,%d,%.9e\r\n",
+             (int)fs, x, y, z, norm);
+    tx_com(tx_buffer, strlen((char const *)tx_buffer));
+#endif
+
+    err = fabsf(norm - ref);
+    if (err > check.err_max)
+      check.err_max = err;
+
+    if (++check.samples == REPORT_LEN) {
+      snprintf((char *)tx_buffer, sizeof(tx_buffer),
+               "%lu samples (%lu missed): max |ispu - reference| %e g\r\n",
+               (unsigned long)check.samples, (unsigned long)check.missed,
+               check.err_max);
+      tx_com(tx_buffer, strlen((char const *)tx_buffer));
+      memset(&check, 0, sizeof(check));
+    }
+  }
+}
+
+/*
+ * @brief  Write generic device register (platform dependent)
+ *
+ * @param  handle    customizable argument. In this examples is used in
+ *                   order to select the correct sensor bus handler.
+ * @param  reg       register to write
+ * @param  bufp      pointer to data to write in register reg
+ * @param  len       number of consecutive register to write
+ *
+ */
+static int32_t platform_write(void *handle, uint8_t reg, const uint8_t *bufp,
+                              uint16_t len)
+{
+#if defined(NUCLEO_F401RE)
+  HAL_I2C_Mem_Write(handle, ISM330IS_I2C_ADD_L, reg,
+                    I2C_MEMADD_SIZE_8BIT, (uint8_t*) bufp, len, 1000);
+#elif defined(STEVAL_MKI109V3)
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_RESET);
+  HAL_SPI_Transmit(handle, &reg, 1, 1000);
+  HAL_SPI_Transmit(handle, (uint8_t*) bufp, len, 1000);
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_SET);
+#elif defined(SPC584B_DIS)
+  i2c_lld_write(handle,  ISM330IS_I2C_ADD_H & 0xFE, reg, (uint8_t*) bufp, len);
+#endif
+  return 0;
+}
+
+/*
+ * @brief  Read generic device register (platform dependent)
+ *
+ * @param  handle    customizable argument. In this examples is used in
+ *                   order to select the correct sensor bus handler.
+ * @param  reg       register to read
+ * @param  bufp      pointer to buffer that store the data read
+ * @param  len       number of consecutive register to read
+ *
+ */
+static int32_t platform_read(void *handle, uint8_t reg, uint8_t *bufp,
+                             uint16_t len)
+{
+#if defined(NUCLEO_F401RE)
+  HAL_I2C_Mem_Read(handle, ISM330IS_I2C_ADD_L, reg,
+                   I2C_MEMADD_SIZE_8BIT, bufp, len, 1000);
+#elif defined(STEVAL_MKI109V3)
+  reg |= 0x80;
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_RESET);
+  HAL_SPI_Transmit(handle, &reg, 1, 1000);
+  HAL_SPI_Receive(handle, bufp, len, 1000);
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_SET);
+#elif defined(SPC584B_DIS)
+  i2c_lld_read(handle, ISM330IS_I2C_ADD_H & 0xFE, reg, bufp, len);
+#endif
+  return 0;
+}
+
+/*
+ * @brief  Send buffer to console (platform dependent)
+ *
+ * @param  tx_buffer     buffer to transmit
+ * @param  len           number of byte to send
+ *
+ */
+static void tx_com(uint8_t *tx_buffer, uint16_t len)
+{
+#if defined(NUCLEO_F401RE)
+  HAL_UART_Transmit(&huart2, tx_buffer, len, 1000);
+#elif defined(STEVAL_MKI109V3)
+  CDC_Transmit_FS(tx_buffer, len);
+#elif defined(SPC584B_DIS)
+  sd_lld_write(&SD2, tx_buffer, len);
+#endif
+}
+
+/*
+ * @brief  platform specific delay (platform dependent)
+ *
+ * @param  ms        delay in ms
+ *
+ */
+static void platform_delay(uint32_t ms)
+{
+#if defined(NUCLEO_F401RE) | defined(STEVAL_MKI109V3)
+  HAL_Delay(ms);
+#elif defined(SPC584B_DIS)
+  osalThreadDelayMilliseconds(ms);
+#endif
+}
+
+/*
+ * @brief  mask / unmask the interrupts (platform dependent)
+ */
+static void platform_irq_disable(void)
+{
+#if defined(NUCLEO_F401RE) || defined(STEVAL_MKI109V3)
+  __disable_irq();
+#elif defined(SPC584B_DIS)
+  osalSysLock();
+#endif
+}
+
+static void platform_irq_enable(void)
+{
+#if defined(NUCLEO_F401RE) || defined(STEVAL_MKI109V3)
+  __enable_irq();
+#elif defined(SPC584B_DIS)
+  osalSysUnlock();
+#endif
+}
+
+/*
+ * @brief  platform specific initialization (platform dependent)
+ */
+static void platform_init(void)
+{
+#if defined(STEVAL_MKI109V3)
+  TIM3->CCR1 = PWM_3V3;
+  TIM3->CCR2 = PWM_3V3;
+  HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_1);
+  HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_2);
+  HAL_Delay(1000);
+#endif
+}
@@ -0,0 +1,528 @@
+/*
+ ******************************************************************************
+ * @file    qvar_fifo_gesture.c
+ * @author  Sensors Software Solution Team
+ * @brief   This file shows how to batch AH/QVAR in FIFO and detect gestures.
+ *
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2022 STMicroelectronics.
+ * All rights reserved.</center></h2>
+ *
+ * This software component is licensed by ST under BSD 3-Clause license,
+ * the "License"; You may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at:
+ *                        opensource.org/licenses/BSD-3-Clause
+ *
+ ******************************************************************************
+ */
+
+/*
+ * This example was developed using the following STMicroelectronics
+ * evaluation boards:
+ *
+ * - STEVAL_MKI109V3
+ * - NUCLEO_F401RE
+ * - DISCOVERY_SPC584B
+ *
+ * and STM32CubeMX tool with STM32CubeF4 MCU Package
+ *
+ * Used interfaces:
+ *
+ * STEVAL_MKI109V3    - Host side:   USB (Virtual COM)
+ *                    - Sensor side: SPI(Default) / I2C(supported)
+ *
+ * NUCLEO_STM32F401RE - Host side: UART(COM) to USB bridge
+ *                    - I2C(Default) / SPI(N/A)
+ *
+ * DISCOVERY_SPC584B  - Host side: UART(COM) to USB bridge
+ *                    - Sensor side: I2C(Default) / SPI(supported)
+ *
+ * If you need to run this example on a different hardware platform a
+ * modification of the functions: `platform_write`, `platform_read`,
+ * `tx_com` and 'platform_init' is required.
+ *
+ */
+
+/* STMicroelectronics evaluation boards definition
+ *
+ * Please uncomment ONLY the evaluation boards in use.
+ * If a different hardware is used please comment all
+ * following target board and redefine yours.
+ */
+
+//#define STEVAL_MKI109V3  /* little endian */
+//#define NUCLEO_F401RE    /* little endian */
+//#define SPC584B_DIS      /* big endian */
+
+/* ATTENTION: By default the driver is little endian. If you need switch
+ *            to big endian please see "Endianness definitions" in the
+ *            header file of the driver (_reg.h).
+ */
+
+
+#if defined(STEVAL_MKI109V3)
+/* MKI109V3: Define communication interface */
+#define SENSOR_BUS hspi2
+/* MKI109V3: Vdd and Vddio power supply values */
+#define PWM_3V3 915
+
+#elif defined(NUCLEO_F401RE)
+/* NUCLEO_F401RE: Define communication interface */
+#define SENSOR_BUS hi2c1
+
+#elif defined(SPC584B_DIS)
+/* DISCOVERY_SPC584B: Define communication interface */
+#define SENSOR_BUS I2CD1
+
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include <stdio.h>
+#include "lis2duxs12_reg.h"
+
+#if defined(NUCLEO_F401RE)
+#include "stm32f4xx_hal.h"
+#include "usart.h"
+#include "gpio.h"
+#include "i2c.h"
+
+#elif defined(STEVAL_MKI109V3)
+#include "stm32f4xx_hal.h"
+#include "usbd_cdc_if.h"
+#include "gpio.h"
+#include "spi.h"
+#include "tim.h"
+
+#elif defined(SPC584B_DIS)
+#include "components.h"
+#endif
+
+/* Private macro -------------------------------------------------------------*/
+#define    BOOT_TIME         10 //ms
+
+/* FIFO depth and slot size (TAG + 6 data byte) */
+#define    FIFO_DEPTH        128
+#define    FIFO_SLOT_LEN     7
+#define    FIFO_WTM          25
+
+/* FIFO_STATUS1 flags */
+#define    FIFO_OVR_IA       0x40U
+
+/* Detector tuning (in samples at ODR = 100 Hz, and QVAR LSB) */
+#define    QVAR_BASE_SHIFT   6     /* baseline time constant 2^6 samples */
+#define    QVAR_TOUCH_TH     1500  /* touch threshold on |QVAR - baseline| */
+#define    QVAR_RELEASE_TH   750   /* release threshold (hysteresis) */
+#define    QVAR_RELEASE_N    8     /* samples below QVAR_RELEASE_TH to release */
+#define    QVAR_SWIPE_MAX    40    /* max duration of a swipe */
+#define    QVAR_DOUBLE_WIN   30    /* max gap between two touches */
+#define    QVAR_MAX_EVENTS   8
+
+/* Private typedef -----------------------------------------------------------*/
+typedef enum {
+  QVAR_EV_TOUCH,
+  QVAR_EV_DOUBLE_TOUCH,
+  QVAR_EV_SWIPE_POS,
+  QVAR_EV_SWIPE_NEG,
+} qvar_event_id_t;
+
+typedef struct {
+  qvar_event_id_t id;
+  uint16_t idx;              /* index of the sample in the batch */
+} qvar_event_t;
+
+/*
+ * Touch / gesture detector state (integer math only).
+ *
+ * Baseline is tracked with a first order IIR filter (Q4) frozen during
+ * touches. A touch producing a lobe of each polarity in a short time is a
+ * swipe (direction given by the first lobe), otherwise it is a touch;
+ * two touches closer than QVAR_DOUBLE_WIN samples are a double touch.
+ * The signal crosses the baseline between the two lobes of a swipe, so a
+ * touch is released only after QVAR_RELEASE_N samples below the release
+ * threshold.
+ */
+typedef struct {
+  int32_t base_q4;
+  uint16_t dur;
+  uint16_t idle;
+  uint8_t low;
+  int8_t first_sign;
+  uint8_t reversed;
+  uint8_t active;
+  uint8_t pending;
+  uint8_t init;
+} qvar_det_t;
+
+/* Private variables ---------------------------------------------------------*/
+static uint8_t tx_buffer[1000];
+static lis2duxs12_ah_qvar_mode_t qvar_mode;
+static stmdev_ctx_t dev_ctx;
+static lis2duxs12_status_t status;
+static lis2duxs12_fifo_mode_t fifo_mode;
+static uint8_t fifo_raw[FIFO_DEPTH * FIFO_SLOT_LEN];
+static int16_t qvar[FIFO_DEPTH];
+static qvar_event_t events[QVAR_MAX_EVENTS];
+static qvar_det_t det;
+
+static const char *const event_name[] = {
+  "touch", "double touch", "swipe +", "swipe -",
+};
+
+/* Extern variables ----------------------------------------------------------*/
+
+/* Private functions ---------------------------------------------------------*/
+/*
+ *   WARNING:
+ *   Functions declare in this section are defined at the end of this file
+ *   and are strictly related to the hardware platform used.
+ *
+ */
+static int32_t platform_write(void *handle, uint8_t reg, const uint8_t *bufp,
+                              uint16_t len);
+static int32_t platform_read(void *handle, uint8_t reg, uint8_t *bufp,
+                             uint16_t len);
+static void tx_com( uint8_t *tx_buffer, uint16_t len );
+static void platform_delay(uint32_t ms);
+static void platform_init(void);
+
+static uint16_t qvar_fifo_get(stmdev_ctx_t *ctx, int16_t *qvar, uint8_t *ovr);
+static uint8_t qvar_det_process(qvar_det_t *d, const int16_t *x, uint16_t len,
+                                qvar_event_t *ev, uint8_t max_ev);
+
+/* Main Example --------------------------------------------------------------*/
+static volatile uint8_t fifo_wtm_event = 0;
+
+void lis2duxs12_qvar_fifo_gesture_handler(void)
+{
+  fifo_wtm_event = 1;
+}
+
+void lis2duxs12_qvar_fifo_gesture(void)
+{
+  lis2duxs12_pin_int_route_t int_route;
+  uint8_t id;
+  lis2duxs12_md_t md;
+
+  /* Initialize mems driver interface */
+  dev_ctx.write_reg = platform_write;
+  dev_ctx.read_reg = platform_read;
+  dev_ctx.mdelay = platform_delay;
+  dev_ctx.handle = &SENSOR_BUS;
+
+  /* Initialize platform specific hardware */
+  platform_init();
+
+  /* Wait sensor boot time */
+  platform_delay(BOOT_TIME);
+
+  lis2duxs12_exit_deep_power_down(&dev_ctx);
+
+  /* Check device ID */
+  lis2duxs12_device_id_get(&dev_ctx, &id);
+  if (id != LIS2DUXS12_ID)
+    while(1);
+
+  /* Restore default configuration */
+  lis2duxs12_init_set(&dev_ctx, LIS2DUXS12_RESET);
+  do {
+    lis2duxs12_status_get(&dev_ctx, &status);
+  } while (status.sw_reset);
+
+  /* Set bdu and if_inc recommended for driver usage */
+  lis2duxs12_init_set(&dev_ctx, LIS2DUXS12_SENSOR_ONLY_ON);
+
+  /*
+   * Batch XL + AH/QVAR in FIFO: when AH/QVAR is enabled the temperature
+   * field of the XL_TEMP slot carries the AH/QVAR sample.
+   */
+  fifo_mode.store = LIS2DUXS12_FIFO_1X;
+  fifo_mode.xl_only = 0;
+  fifo_mode.watermark = FIFO_WTM;
+  fifo_mode.fifo_event = LIS2DUXS12_FIFO_EV_WTM;
+  fifo_mode.operation = LIS2DUXS12_STREAM_MODE;
+  fifo_mode.batch.dec_ts = LIS2DUXS12_DEC_TS_OFF;
+  fifo_mode.batch.bdr_xl = LIS2DUXS12_BDR_XL_ODR;
+  lis2duxs12_fifo_mode_set(&dev_ctx, fifo_mode);
+
+  /* Configure interrupt pins */
+  memset(&int_route, 0, sizeof(int_route));
+  int_route.fifo_th = PROPERTY_ENABLE;
+  lis2duxs12_pin_int1_route_set(&dev_ctx, &int_route);
+
+  /* Set Output Data Rate */
+  md.fs =  LIS2DUXS12_4g;
+  md.bw = LIS2DUXS12_ODR_div_4;
+  md.odr = LIS2DUXS12_100Hz_LP;
+  lis2duxs12_mode_set(&dev_ctx, &md);
+
+  /* Enable AH/QVAR function */
+  qvar_mode.ah_qvar_en = 1;
+  qvar_mode.ah_qvar_zin = LIS2DUXS12_520MOhm;
+  qvar_mode.ah_qvar_gain = LIS2DUXS12_GAIN_0_5;
+  lis2duxs12_ah_qvar_mode_set(&dev_ctx, qvar_mode);
+
+  /* Process QVAR batches on FIFO threshold event */
+  while(1)
+  {
+    uint16_t num;
+    uint8_t ovr, nev, i;
+
+    if (fifo_wtm_event == 0)
+      continue;
+
+    fifo_wtm_event = 0;
+
+    num = qvar_fifo_get(&dev_ctx, qvar, &ovr);
+    nev = qvar_det_process(&det, qvar, num, events, QVAR_MAX_EVENTS);
+
+    if (ovr) {
+      snprintf((char*)tx_buffer, sizeof(tx_buffer), "FIFO overrun\r\n");
+      tx_com(tx_buffer, strlen((char const*)tx_buffer));
+    }
+
+    for (i = 0; i < nev; i++) {
+      snprintf((char*)tx_buffer, sizeof(tx_buffer), "QVAR %s (sample %d)\r\n",
+               event_name[events[i].id], events[i].idx);
+      tx_com(tx_buffer, strlen((char const*)tx_buffer));
+    }
+  }
+}
+
+/*
+ * @brief  Drain FIFO and extract AH/QVAR samples
+ *
+ * Status and level are read in one transaction and the FIFO content
+ * with one burst (address rolls back to FIFO_DATA_OUT_TAG).
+ *
+ * @param  ctx       read / write interface definitions
+ * @param  qvar      AH/QVAR samples (left aligned on 16 bit)
+ * @param  ovr       set to 1 if FIFO overrun occurred
+ * @retval           number of samples
+ *
+ */
+static uint16_t qvar_fifo_get(stmdev_ctx_t *ctx, int16_t *qvar, uint8_t *ovr)
+{
+  uint8_t status[2];
+  uint16_t level, i, n = 0;
+  const uint8_t *slot;
+
+  *ovr = 0;
+
+  if (lis2duxs12_read_reg(ctx, LIS2DUXS12_FIFO_STATUS1, status, 2) != 0)
+    return 0;
+
+  *ovr = (status[0] & FIFO_OVR_IA) ? 1 : 0;
+  level = (status[1] > FIFO_DEPTH) ? FIFO_DEPTH : status[1];
+  if (level == 0U)
+    return 0;
+
+  if (lis2duxs12_read_reg(ctx, LIS2DUXS12_FIFO_DATA_OUT_TAG, fifo_raw,
+                          level * FIFO_SLOT_LEN) != 0)
+    return 0;
+
+  for (i = 0; i < level; i++) {
+    slot = &fifo_raw[i * FIFO_SLOT_LEN];
+
+    if ((slot[0] >> 3) == LIS2DUXS12_XL_TEMP_TAG) {
+      /* 12 bit AH/QVAR in place of temperature */
+      qvar[n++] = (int16_t)(((uint16_t)slot[6] << 8) |
+                            ((uint16_t)slot[5] & 0xF0U));
+    }
+  }
+
+  return n;
+}
+
+/*
+ * @brief  Run touch / gesture detector on a batch of AH/QVAR samples
+ *
+ * @param  d         detector state
+ * @param  x         AH/QVAR samples
+ * @param  len       number of samples
+ * @param  ev        detected events
+ * @param  max_ev    size of ev
+ * @retval           number of detected events
+ *
+ */
+static uint8_t qvar_det_process(qvar_det_t *d, const int16_t *x, uint16_t len,
+                                qvar_event_t *ev, uint8_t max_ev)
+{
+  int32_t delta, mag;
+  uint8_t nev = 0;
+  uint16_t i;
+
+  for (i = 0; i < len; i++) {
+    if (d->init == 0U) {
+      d->base_q4 = (int32_t)x[i] * 16;
+      d->init = 1;
+    }
+
+    delta = (int32_t)x[i] - (d->base_q4 / 16);
+    mag = (delta < 0) ? -delta : delta;
+
+    if (d->active == 0U) {
+      /* Track slow drift only when nothing is touching the electrode */
+      d->base_q4 += ((int32_t)x[i] * 16 - d->base_q4) >> QVAR_BASE_SHIFT;
+
+      if (d->idle < UINT16_MAX)
+        d->idle++;
+
+      /* Single touch confirmed when double touch window expires */
+      if (d->pending && d->idle > QVAR_DOUBLE_WIN && nev < max_ev) {
+        ev[nev].id = QVAR_EV_TOUCH;
+        ev[nev++].idx = i;
+        d->pending = 0;
+      }
+
+      if (mag > QVAR_TOUCH_TH) {
+        d->active = 1;
+        d->dur = 0;
+        d->first_sign = (delta > 0) ? 1 : -1;
+        d->reversed = 0;
+        d->low = 0;
+      }
+      continue;
+    }
+
+    d->dur++;
+
+    /* Opposite lobe while touching: finger moved across electrodes */
+    if (mag > QVAR_TOUCH_TH && ((delta > 0) ? 1 : -1) != d->first_sign)
+      d->reversed = 1;
+
+    if (mag >= QVAR_RELEASE_TH) {
+      d->low = 0;
+      continue;
+    }
+
+    /* Keep the touch across the zero crossing of a swipe */
+    if (++d->low < QVAR_RELEASE_N)
+      continue;
+
+    /* Release */
+    d->active = 0;
+
+    if (nev >= max_ev) {
+      d->pending = 0;
+    } else if (d->reversed && d->dur - d->low <= QVAR_SWIPE_MAX) {
+      ev[nev].id = (d->first_sign > 0) ? QVAR_EV_SWIPE_POS : QVAR_EV_SWIPE_NEG;
+      ev[nev++].idx = i;
+      d->pending = 0;
+    } else if (d->pending && d->idle <= QVAR_DOUBLE_WIN) {
+      ev[nev].id = QVAR_EV_DOUBLE_TOUCH;
+      ev[nev++].idx = i;
+      d->pending = 0;
+    } else {
+      d->pending = 1;
+    }
+
+    d->idle = d->low;
+  }
+
+  return nev;
+}
+
+/*
+ * @brief  Write generic device register (platform dependent)
+ *
+ * @param  handle    customizable argument. In this examples is used in
+ *                   order to select the correct sensor bus handler.
+ * @param  reg       register to write
+ * @param  bufp      pointer to data to write in register reg
+ * @param  len       number of consecutive register to write
+ *
+ */
+static int32_t platform_write(void *handle, uint8_t reg, const uint8_t *bufp,
+                              uint16_t len)
+{
+#if defined(NUCLEO_F401RE)
+  HAL_I2C_Mem_Write(handle, LIS2DUXS12_I2C_ADD_L, reg,
+                    I2C_MEMADD_SIZE_8BIT, (uint8_t*) bufp, len, 1000);
+#elif defined(STEVAL_MKI109V3)
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_RESET);
+  HAL_SPI_Transmit(handle, &reg, 1, 1000);
+  HAL_SPI_Transmit(handle, (uint8_t*) bufp, len, 1000);
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_SET);
+#elif defined(SPC584B_DIS)
+  i2c_lld_write(handle,  LIS2DUXS12_I2C_ADD_L & 0xFE, reg, (uint8_t*) bufp, len);
+#endif
+  return 0;
+}
+
+/*
+ * @brief  Read generic device register (platform dependent)
+ *
+ * @param  handle    customizable argument. In this examples is used in
+ *                   order to select the correct sensor bus handler.
+ * @param  reg       register to read
+ * @param  bufp      pointer to buffer that store the data read
+ * @param  len       number of consecutive register to read
+ *
+ */
+static int32_t platform_read(void *handle, uint8_t reg, uint8_t *bufp,
+                             uint16_t len)
+{
+#if defined(NUCLEO_F401RE)
+  HAL_I2C_Mem_Read(handle, LIS2DUXS12_I2C_ADD_L, reg,
+                   I2C_MEMADD_SIZE_8BIT, bufp, len, 1000);
+#elif defined(STEVAL_MKI109V3)
+  reg |= 0x80;
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_RESET);
+  HAL_SPI_Transmit(handle, &reg, 1, 1000);
+  HAL_SPI_Receive(handle, bufp, len, 1000);
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_SET);
+#elif defined(SPC584B_DIS)
+  i2c_lld_read(handle, LIS2DUXS12_I2C_ADD_L & 0xFE, reg, bufp, len);
+#endif
+  return 0;
+}
+
+/*
+ * @brief  platform specific outputs on terminal (platform dependent)
+ *
+ * @param  tx_buffer     buffer to transmit
+ * @param  len           number of byte to send
+ *
+ */
+static void tx_com(uint8_t *tx_buffer, uint16_t len)
+{
+#if defined(NUCLEO_F401RE)
+  HAL_UART_Transmit(&huart2, tx_buffer, len, 1000);
+#elif defined(STEVAL_MKI109V3)
+  CDC_Transmit_FS(tx_buffer, len);
+#elif defined(SPC584B_DIS)
+  sd_lld_write(&SD2, tx_buffer, len);
+#endif
+}
+
+/*
+ * @brief  platform specific delay (platform dependent)
+ *
+ * @param  ms        delay in ms
+ *
+ */
+static void platform_delay(uint32_t ms)
+{
+#if defined(NUCLEO_F401RE) | defined(STEVAL_MKI109V3)
+  HAL_Delay(ms);
+#elif defined(SPC584B_DIS)
+  osalThreadDelayMilliseconds(ms);
+#endif
+}
+
+/*
+ * @brief  platform specific initialization (platform dependent)
+ */
+static void platform_init(void)
+{
+#if defined(STEVAL_MKI109V3)
+  TIM3->CCR1 = PWM_3V3;
+  TIM3->CCR2 = PWM_3V3;
+  HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_1);
+  HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_2);
+  HAL_Delay(1000);
+#endif
+}
@@ -0,0 +1,386 @@
+/*
+ ******************************************************************************
+ * @file    read_data_burst.c
+ * @author  Sensors Software Solution Team
+ * @brief   This file shows how to read status and data in a single
+ *          bus transaction.
+ *
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2020 STMicroelectronics.
+ * All rights reserved.</center></h2>
+ *
+ * This software component is licensed by ST under BSD 3-Clause license,
+ * the "License"; You may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at:
+ *                        opensource.org/licenses/BSD-3-Clause
+ *
+ ******************************************************************************
+ */
+
+/*
+ * This example was developed using the following STMicroelectronics
+ * evaluation boards:
+ *
+ * - STEVAL_MKI109V3 + STEVAL-MKI181V1
+ * - NUCLEO_F401RE + X_NUCLEO_IKS01A3
+ * - DISCOVERY_SPC584B + STEVAL-MKI181V1
+ *
+ * and STM32CubeMX tool with STM32CubeF4 MCU Package
+ *
+ * Used interfaces:
+ *
+ * STEVAL_MKI109V3    - Host side:   USB (Virtual COM)
+ *                    - Sensor side: SPI(Default) / I2C(supported)
+ *
+ * NUCLEO_STM32F401RE - Host side: UART(COM) to USB bridge
+ *                    - I2C(Default) / SPI(supported)
+ *
+ * DISCOVERY_SPC584B  - Host side: UART(COM) to USB bridge
+ *                    - Sensor side: I2C(Default) / SPI(supported)
+ *
+ * If you need to run this example on a different hardware platform a
+ * modification of the functions: `platform_write`, `platform_read`,
+ * `tx_com` and 'platform_init' is required.
+ *
+ */
+
+/* STMicroelectronics evaluation boards definition
+ *
+ * Please uncomment ONLY the evaluation boards in use.
+ * If a different hardware is used please comment all
+ * following target board and redefine yours.
+ */
+
+//#define STEVAL_MKI109V3  /* little endian */
+//#define NUCLEO_F401RE    /* little endian */
+//#define SPC584B_DIS      /* big endian */
+
+/* ATTENTION: By default the driver is little endian. If you need switch
+ *            to big endian please see "Endianness definitions" in the
+ *            header file of the driver (_reg.h).
+ */
+
+#if defined(STEVAL_MKI109V3)
+/* MKI109V3: Define communication interface */
+#define SENSOR_BUS hspi2
+/* MKI109V3: Vdd and Vddio power supply values */
+#define PWM_3V3 915
+
+#elif defined(NUCLEO_F401RE)
+/* NUCLEO_F401RE: Define communication interface */
+#define SENSOR_BUS hi2c1
+
+#elif defined(SPC584B_DIS)
+/* DISCOVERY_SPC584B: Define communication interface */
+#define SENSOR_BUS I2CD1
+
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include <stdio.h>
+#include "lis2mdl_reg.h"
+
+#if defined(NUCLEO_F401RE)
+#include "stm32f4xx_hal.h"
+#include "usart.h"
+#include "gpio.h"
+#include "i2c.h"
+
+#elif defined(STEVAL_MKI109V3)
+#include "stm32f4xx_hal.h"
+#include "usbd_cdc_if.h"
+#include "gpio.h"
+#include "spi.h"
+#include "tim.h"
+
+#elif defined(SPC584B_DIS)
+#include "components.h"
+#endif
+
+/* Private macro -------------------------------------------------------------*/
+#define    BOOT_TIME        20 //ms
+
+/* Status and outputs: STATUS_REG (0x67) up to TEMP_OUT_H_REG (0x6F) */
+#define    BURST_LEN        9
+
+/* Number of samples between two bus transaction reports */
+#define    REPORT_SAMPLES   100
+
+/* Uncomment to poll with separate status and data reads (reference) */
+//#define BURST_BASELINE
+
+/* Private typedef -----------------------------------------------------------*/
+/* Status and outputs read in one transaction, magnetic field and
+ * temperature are fresh only when drdy (Zyxda) is set */
+typedef struct {
+  uint8_t drdy;
+  int16_t magnetic[3];
+  int16_t temperature;
+} data_burst_t;
+
+/* Private variables ---------------------------------------------------------*/
+static data_burst_t burst;
+static float_t magnetic_mG[3];
+static float_t temperature_degC;
+static uint8_t whoamI, rst;
+static uint8_t tx_buffer[1000];
+static uint32_t bus_reads = 0;
+
+/* Extern variables ----------------------------------------------------------*/
+
+/* Private functions ---------------------------------------------------------*/
+/*
+ *   WARNING:
+ *   Functions declare in this section are defined at the end of this file
+ *   and are strictly related to the hardware platform used.
+ *
+ */
+static int32_t platform_write(void *handle, uint8_t reg, const uint8_t *bufp,
+                              uint16_t len);
+static int32_t platform_read(void *handle, uint8_t reg, uint8_t *bufp,
+                             uint16_t len);
+static void tx_com(uint8_t *tx_buffer, uint16_t len);
+static void platform_delay(uint32_t ms);
+static void platform_init(void);
+
+
+#if !defined(BURST_BASELINE)
+/*
+ * @brief  Read status and all outputs in one auto-increment transaction
+ *
+ * @param  ctx       read / write interface definitions
+ * @param  val       data ready flag and raw outputs
+ * @retval           interface status (MANDATORY: return 0 -> no Error)
+ *
+ */
+static int32_t data_burst_get(stmdev_ctx_t *ctx, data_burst_t *val)
+{
+  uint8_t buff[BURST_LEN];
+  int32_t ret;
+  uint8_t i;
+
+  ret = lis2mdl_read_reg(ctx, LIS2MDL_STATUS_REG, buff, BURST_LEN);
+  if (ret != 0)
+    return ret;
+
+  val->drdy = (buff[0] >> 3) & 0x01U;
+
+  /* OUTX_L_REG (0x68) */
+  for (i = 0; i < 3; i++) {
+    val->magnetic[i] = (int16_t)buff[2 + 2 * i];
+    val->magnetic[i] = (val->magnetic[i] * 256) + (int16_t)buff[1 + 2 * i];
+  }
+
+  /* TEMP_OUT_L_REG (0x6E) */
+  val->temperature = (int16_t)buff[8];
+  val->temperature = (val->temperature * 256) + (int16_t)buff[7];
+
+  return ret;
+}
+#endif
+
+/* Main Example --------------------------------------------------------------*/
+void lis2mdl_read_data_burst(void)
+{
+  uint32_t samples = 0, data_reads = 0;
+  /* Initialize mems driver interface */
+  stmdev_ctx_t dev_ctx;
+  dev_ctx.write_reg = platform_write;
+  dev_ctx.read_reg = platform_read;
+  dev_ctx.mdelay = platform_delay;
+  dev_ctx.handle = &SENSOR_BUS;
+  /* Initialize platform specific hardware */
+  platform_init();
+  /* Wait sensor boot time */
+  platform_delay(BOOT_TIME);
+#if defined(STEVAL_MKI109V3)
+  /* Default SPI mode is 3 wire, so enable 4 wire mode */
+  lis2mdl_spi_mode_set(&dev_ctx, LIS2MDL_SPI_4_WIRE);
+#endif
+  /* Check device ID */
+  lis2mdl_device_id_get(&dev_ctx, &whoamI);
+
+  if (whoamI != LIS2MDL_ID)
+    while (1) {
+      /* manage here device not found */
+    }
+
+  /* Restore default configuration */
+  lis2mdl_reset_set(&dev_ctx, PROPERTY_ENABLE);
+
+  do {
+    lis2mdl_reset_get(&dev_ctx, &rst);
+  } while (rst);
+
+  /* Enable Block Data Update */
+  lis2mdl_block_data_update_set(&dev_ctx, PROPERTY_ENABLE);
+  /* Set Output Data Rate */
+  lis2mdl_data_rate_set(&dev_ctx, LIS2MDL_ODR_10Hz);
+  /* Set / Reset sensor mode */
+  lis2mdl_set_rst_mode_set(&dev_ctx, LIS2MDL_SENS_OFF_CANC_EVERY_ODR);
+  /* Enable temperature compensation */
+  lis2mdl_offset_temp_comp_set(&dev_ctx, PROPERTY_ENABLE);
+  /* Set device in continuous mode */
+  lis2mdl_operating_mode_set(&dev_ctx, LIS2MDL_CONTINUOUS_MODE);
+
+  /* Read samples in polling mode (no int) */
+  while (1) {
+    uint32_t reads = bus_reads;
+
+#if defined(BURST_BASELINE)
+    lis2mdl_mag_data_ready_get(&dev_ctx, &burst.drdy);
+    if (burst.drdy) {
+      lis2mdl_magnetic_raw_get(&dev_ctx, burst.magnetic);
+      lis2mdl_temperature_raw_get(&dev_ctx, &burst.temperature);
+    }
+#else
+    data_burst_get(&dev_ctx, &burst);
+#endif
+
+    if (!burst.drdy)
+      continue;
+
+    data_reads += bus_reads - reads;
+
+    magnetic_mG[0] = lis2mdl_from_lsb_to_mgauss(burst.magnetic[0]);
+    magnetic_mG[1] = lis2mdl_from_lsb_to_mgauss(burst.magnetic[1]);
+    magnetic_mG[2] = lis2mdl_from_lsb_to_mgauss(burst.magnetic[2]);
+    snprintf((char *)tx_buffer, sizeof(tx_buffer),
+            "Magnetic field [mG]:%4.2f\t%4.2f\t%4.2f\r\n",
+            magnetic_mG[0], magnetic_mG[1], magnetic_mG[2]);
+    tx_com(tx_buffer, strlen((char const *)tx_buffer));
+    temperature_degC = lis2mdl_from_lsb_to_celsius(burst.temperature);
+    snprintf((char *)tx_buffer, sizeof(tx_buffer), "Temperature [degC]:%6.2f\r\n",
+            temperature_degC);
+    tx_com(tx_buffer, strlen((char const *)tx_buffer));
+
+    if (++samples == REPORT_SAMPLES) {
+      snprintf((char *)tx_buffer, sizeof(tx_buffer),
+               "%lu samples: %lu.%02lu bus reads per sample\r\n",
+               (unsigned long)samples,
+               (unsigned long)(data_reads / samples),
+               (unsigned long)((data_reads * 100U / samples) % 100U));
+      tx_com(tx_buffer, strlen((char const *)tx_buffer));
+      samples = 0;
+      data_reads = 0;
+    }
+  }
+}
+
+/*
+ * @brief  Write generic device register (platform dependent)
+ *
+ * @param  handle    customizable argument. In this examples is used in
+ *                   order to select the correct sensor bus handler.
+ * @param  reg       register to write
+ * @param  bufp      pointer to data to write in register reg
+ * @param  len       number of consecutive register to write
+ *
+ */
+static int32_t platform_write(void *handle, uint8_t reg, const uint8_t *bufp,
+                              uint16_t len)
+{
+#if defined(NUCLEO_F401RE)
+  /* Write multiple command */
+  reg |= 0x80;
+  HAL_I2C_Mem_Write(handle, LIS2MDL_I2C_ADD, reg,
+                    I2C_MEMADD_SIZE_8BIT, (uint8_t*) bufp, len, 1000);
+#elif defined(STEVAL_MKI109V3)
+  /* Write multiple command */
+  reg |= 0x40;
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_RESET);
+  HAL_SPI_Transmit(handle, &reg, 1, 1000);
+  HAL_SPI_Transmit(handle, (uint8_t*) bufp, len, 1000);
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_SET);
+#elif defined(SPC584B_DIS)
+  /* Write multiple command */
+  reg |= 0x80;
+  i2c_lld_write(handle,  LIS2MDL_I2C_ADD & 0xFE, reg, (uint8_t*) bufp, len);
+#endif
+  return 0;
+}
+
+/*
+ * @brief  Read generic device register (platform dependent)
+ *
+ * @param  handle    customizable argument. In this examples is used in
+ *                   order to select the correct sensor bus handler.
+ * @param  reg       register to read
+ * @param  bufp      pointer to buffer that store the data read
+ * @param  len       number of consecutive register to read
+ *
+ */
+static int32_t platform_read(void *handle, uint8_t reg, uint8_t *bufp,
+                             uint16_t len)
+{
+  bus_reads++;
+
+#if defined(NUCLEO_F401RE)
+  /* Read multiple command */
+  reg |= 0x80;
+  HAL_I2C_Mem_Read(handle, LIS2MDL_I2C_ADD, reg,
+                   I2C_MEMADD_SIZE_8BIT, bufp, len, 1000);
+#elif defined(STEVAL_MKI109V3)
+  /* Read multiple command */
+  reg |= 0xC0;
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_RESET);
+  HAL_SPI_Transmit(handle, &reg, 1, 1000);
+  HAL_SPI_Receive(handle, bufp, len, 1000);
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_SET);
+#elif defined(SPC584B_DIS)
+  /* Read multiple command */
+  reg |= 0x80;
+  i2c_lld_read(handle, LIS2MDL_I2C_ADD & 0xFE, reg, bufp, len);
+#endif
+  return 0;
+}
+
+/*
+ * @brief  Send buffer to console (platform dependent)
+ *
+ * @param  tx_buffer     buffer to transmit
+ * @param  len           number of byte to send
+ *
+ */
+static void tx_com(uint8_t *tx_buffer, uint16_t len)
+{
+#if defined(NUCLEO_F401RE)
+  HAL_UART_Transmit(&huart2, tx_buffer, len, 1000);
+#elif defined(STEVAL_MKI109V3)
+  CDC_Transmit_FS(tx_buffer, len);
+#elif defined(SPC584B_DIS)
+  sd_lld_write(&SD2, tx_buffer, len);
+#endif
+}
+
+/*
+ * @brief  platform specific delay (platform dependent)
+ *
+ * @param  ms        delay in ms
+ *
+ */
+static void platform_delay(uint32_t ms)
+{
+#if defined(NUCLEO_F401RE) | defined(STEVAL_MKI109V3)
+  HAL_Delay(ms);
+#elif defined(SPC584B_DIS)
+  osalThreadDelayMilliseconds(ms);
+#endif
+}
+
+/*
+ * @brief  platform specific initialization (platform dependent)
+ */
+static void platform_init(void)
+{
+#ifdef STEVAL_MKI109V3
+  TIM3->CCR1 = PWM_3V3;
+  TIM3->CCR2 = PWM_3V3;
+  HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_1);
+  HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_2);
+  HAL_Delay(1000);
+#endif
+}
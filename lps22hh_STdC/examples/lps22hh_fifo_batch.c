@@ -0,0 +1,457 @@
+/*
+ ******************************************************************************
+ * @file    fifo_batch.c
+ * @author  MEMS Software Solution Team
+ * @brief   This file shows how to read the whole FIFO in a single burst.
+ *
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2022 STMicroelectronics.
+ * All rights reserved.</center></h2>
+ *
+ * This software component is licensed by ST under BSD 3-Clause license,
+ * the "License"; You may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at:
+ *                        opensource.org/licenses/BSD-3-Clause
+ *
+ ******************************************************************************
+ */
+
+/*
+ * This example was developed using the following STMicroelectronics
+ * evaluation boards:
+ *
+ * - STEVAL_MKI109V3 + STEVAL-MKI192V1
+ * - NUCLEO_F401RE + X_NUCLEO_IKS01A3
+ * - DISCOVERY_SPC584B + STEVAL-MKI192V1
+ *
+ * and STM32CubeMX tool with STM32CubeF4 MCU Package
+ *
+ * Used interfaces:
+ *
+ * STEVAL_MKI109V3    - Host side:   USB (Virtual COM)
+ *                    - Sensor side: SPI(Default) / I2C(supported)
+ *
+ * NUCLEO_STM32F401RE - Host side: UART(COM) to USB bridge
+ *                    - I2C(Default) / SPI(supported)
+ *
+ * DISCOVERY_SPC584B  - Host side: UART(COM) to USB bridge
+ *                    - Sensor side: I2C(Default) / SPI(supported)
+ *
+ * If you need to run this example on a different hardware platform a
+ * modification of the functions: `platform_write`, `platform_read`,
+ * `tx_com` and 'platform_init' is required.
+ *
+ */
+
+/* STMicroelectronics evaluation boards definition
+ *
+ * Please uncomment ONLY the evaluation boards in use.
+ * If a different hardware is used please comment all
+ * following target board and redefine yours.
+ */
+
+//#define STEVAL_MKI109V3  /* little endian */
+//#define NUCLEO_F401RE    /* little endian */
+//#define SPC584B_DIS      /* big endian */
+
+/* ATTENTION: By default the driver is little endian. If you need switch
+ *            to big endian please see "Endianness definitions" in the
+ *            header file of the driver (_reg.h).
+ */
+
+#if defined(STEVAL_MKI109V3)
+/* MKI109V3: Define communication interface */
+#define SENSOR_BUS hspi2
+/* MKI109V3: Vdd and Vddio power supply values */
+#define PWM_3V3 915
+
+#elif defined(NUCLEO_F401RE)
+/* NUCLEO_F401RE: Define communication interface */
+#define SENSOR_BUS hi2c1
+
+#elif defined(SPC584B_DIS)
+/* DISCOVERY_SPC584B: Define communication interface */
+#define SENSOR_BUS I2CD1
+
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include <stdio.h>
+#include "lps22hh_reg.h"
+
+#if defined(NUCLEO_F401RE)
+#include "stm32f4xx_hal.h"
+#include "usart.h"
+#include "gpio.h"
+#include "i2c.h"
+
+#elif defined(STEVAL_MKI109V3)
+#include "stm32f4xx_hal.h"
+#include "usbd_cdc_if.h"
+#include "gpio.h"
+#include "spi.h"
+#include "tim.h"
+
+#elif defined(SPC584B_DIS)
+#include "components.h"
+#endif
+
+/* Private macro -------------------------------------------------------------*/
+#define    BOOT_TIME         5 //ms
+
+/* FIFO watermark and output data rate (FIFO_ODR_HZ must match data rate) */
+#define    FIFO_WTM          32
+#define    FIFO_ODR_HZ       10
+
+/* FIFO depth and slot size (PRESS_XL, PRESS_L, PRESS_H, TEMP_L, TEMP_H) */
+#define    FIFO_DEPTH        128
+#define    FIFO_SLOT_LEN     5
+
+/* FIFO_STATUS2 flags */
+#define    FIFO_WTM_IA       0x80U
+#define    FIFO_OVR_IA       0x40U
+
+/* Private typedef -----------------------------------------------------------*/
+/*
+ * Batch of pressure samples drained from FIFO.
+ *
+ * pa_q8 is the pressure in Pa with 8 fractional bits, cdeg the temperature
+ * in hundredths of degC, ts_us is the sample timestamp reconstructed from
+ * the configured ODR (and from the MCU time after an overrun).
+ */
+typedef struct {
+  int32_t pa_q8[FIFO_DEPTH];
+  int16_t cdeg[FIFO_DEPTH];
+  uint64_t ts_us[FIFO_DEPTH];
+  uint16_t len;
+  uint8_t ovr;
+} press_fifo_batch_t;
+
+/* Private variables ---------------------------------------------------------*/
+static uint8_t tx_buffer[1000];
+static uint8_t fifo_raw[FIFO_DEPTH * FIFO_SLOT_LEN];
+static press_fifo_batch_t batch;
+static uint64_t sample_cnt;
+static uint32_t t0_ms;
+static uint8_t whoamI, rst;
+
+/* Extern variables ----------------------------------------------------------*/
+
+/* Private functions ---------------------------------------------------------*/
+
+/*
+ *   WARNING:
+ *   Functions declare in this section are defined at the end of this file
+ *   and are strictly related to the hardware platform used.
+ *
+ */
+
+static int32_t platform_write(void *handle, uint8_t reg, const uint8_t *bufp,
+                              uint16_t len);
+static int32_t platform_read(void *handle, uint8_t reg, uint8_t *bufp,
+                             uint16_t len);
+static void tx_com( uint8_t *tx_buffer, uint16_t len );
+static void platform_delay(uint32_t ms);
+static uint32_t platform_get_ms(void);
+static void platform_init(void);
+
+static stmdev_ctx_t dev_ctx;
+static volatile uint8_t lps22hh_fifo_wtm_event;
+
+static int32_t press_fifo_batch_get(stmdev_ctx_t *ctx,
+                                    press_fifo_batch_t *batch);
+static void press_fifo_raw_to_pa(const uint8_t *raw, int32_t *pa_q8,
+                                 int16_t *cdeg, uint16_t len);
+
+/* Main Example --------------------------------------------------------------*/
+void lps22hh_fifo_batch_irq_handler(void)
+{
+  lps22hh_fifo_wtm_event = 1;
+}
+
+void lps22hh_fifo_batch(void)
+{
+  lps22hh_pin_int_route_t int_route;
+
+  /* Initialize mems driver interface */
+  dev_ctx.write_reg = platform_write;
+  dev_ctx.read_reg = platform_read;
+  dev_ctx.mdelay = platform_delay;
+  dev_ctx.handle = &SENSOR_BUS;
+  /* Initialize platform specific hardware */
+  platform_init();
+  /* Wait sensor boot time */
+  platform_delay(BOOT_TIME);
+  /* Check device ID */
+  whoamI = 0;
+  lps22hh_device_id_get(&dev_ctx, &whoamI);
+
+  if ( whoamI != LPS22HH_ID )
+    while (1); /*manage here device not found */
+
+  /* Restore default configuration */
+  lps22hh_reset_set(&dev_ctx, PROPERTY_ENABLE);
+
+  do {
+    lps22hh_reset_get(&dev_ctx, &rst);
+  } while (rst);
+
+  lps22hh_fifo_watermark_set(&dev_ctx, FIFO_WTM);
+  lps22hh_fifo_stop_on_wtm_set(&dev_ctx, PROPERTY_ENABLE);
+  lps22hh_fifo_mode_set(&dev_ctx, LPS22HH_STREAM_MODE);
+
+  lps22hh_int_notification_set(&dev_ctx, LPS22HH_INT_LATCHED);
+
+  lps22hh_pin_int_route_get(&dev_ctx, &int_route);
+  int_route.fifo_th = PROPERTY_ENABLE;
+  lps22hh_pin_int_route_set(&dev_ctx, int_route);
+
+  /* Set Output Data Rate */
+  lps22hh_data_rate_set(&dev_ctx, LPS22HH_10_Hz);
+
+  sample_cnt = 0;
+  t0_ms = platform_get_ms();
+
+  /* Drain FIFO in two bus transactions per FIFO wtm event */
+  while (1) {
+    uint16_t i;
+
+    if (lps22hh_fifo_wtm_event == 0)
+      continue;
+
+    lps22hh_fifo_wtm_event = 0;
+
+    if (press_fifo_batch_get(&dev_ctx, &batch) != 0 || batch.len == 0U)
+      continue;
+
+    snprintf((char*)tx_buffer, sizeof(tx_buffer), "--- FIFO samples (%d)%s\r\n",
+             batch.len, batch.ovr ? " overrun" : "");
+    tx_com(tx_buffer, strlen((char const*)tx_buffer));
+
+    for (i = 0; i < batch.len; i++) {
+      snprintf((char*)tx_buffer, sizeof(tx_buffer),
+               "%02d: t [ms]:%lu.%03lu pressure [Pa]:%ld.%02ld"
+               " temperature [cdegC]:%d\r\n", i,
+               (unsigned long)(batch.ts_us[i] / 1000U),
+               (unsigned long)(batch.ts_us[i] % 1000U),
+               (long)(batch.pa_q8[i] >> 8),
+               (long)(((batch.pa_q8[i] & 0xFF) * 100) >> 8), batch.cdeg[i]);
+      tx_com(tx_buffer, strlen((char const*)tx_buffer));
+    }
+
+    snprintf((char*)tx_buffer, sizeof(tx_buffer), "\r\n");
+    tx_com(tx_buffer, strlen((char const*)tx_buffer));
+  }
+}
+
+/*
+ * @brief  Drain the whole FIFO content and convert it to Pa
+ *
+ * FIFO_STATUS1 (level), FIFO_STATUS2 (flags) and STATUS are contiguous and
+ * are read in a single transaction. On watermark the FIFO content is read
+ * with a single burst: with IF_ADD_INC set the address rolls back from
+ * FIFO_DATA_OUT_TEMP_H to FIFO_DATA_OUT_PRESS_XL, so consecutive slots
+ * are returned back to back.
+ *
+ * @param  ctx       read / write interface definitions
+ * @param  batch     output batch, batch->len is 0 if watermark not reached
+ * @retval           interface status (MANDATORY: return 0 -> no Error)
+ *
+ */
+static int32_t press_fifo_batch_get(stmdev_ctx_t *ctx,
+                                    press_fifo_batch_t *batch)
+{
+  uint8_t status[3];
+  uint16_t i;
+  int32_t ret;
+
+  batch->len = 0;
+
+  ret = lps22hh_read_reg(ctx, LPS22HH_FIFO_STATUS1, status, 3);
+  if (ret != 0 || (status[1] & FIFO_WTM_IA) == 0U)
+    return ret;
+
+  batch->len = status[0];
+  batch->ovr = (status[1] & FIFO_OVR_IA) ? 1 : 0;
+  if (batch->len > FIFO_DEPTH)
+    batch->len = FIFO_DEPTH;
+
+  ret = lps22hh_read_reg(ctx, LPS22HH_FIFO_DATA_OUT_PRESS_XL,
+                         fifo_raw, batch->len * FIFO_SLOT_LEN);
+  if (ret != 0) {
+    batch->len = 0;
+    return ret;
+  }
+
+  press_fifo_raw_to_pa(fifo_raw, batch->pa_q8, batch->cdeg, batch->len);
+
+  /*
+   * Samples lost in an overrun are not counted by the FIFO: resynchronise
+   * the timeline on the MCU time, the last sample read being the most
+   * recent one.
+   */
+  if (batch->ovr) {
+    uint64_t now = ((uint64_t)(platform_get_ms() - t0_ms) * FIFO_ODR_HZ) /
+                   1000U + 1U;
+
+    if (now > sample_cnt + batch->len)
+      sample_cnt = now - batch->len;
+  }
+
+  /* Samples are equally spaced at 1 / ODR */
+  for (i = 0; i < batch->len; i++)
+    batch->ts_us[i] = ((sample_cnt + i) * 1000000U) / FIFO_ODR_HZ;
+  sample_cnt += batch->len;
+
+  return ret;
+}
+
+/*
+ * @brief  Convert FIFO raw slots in pressure [Pa] (Q24.8 fixed-point)
+ *         and temperature [cdegC]
+ *
+ * Pressure sensitivity is 4096 LSB/hPa, so Pa * 256 = lsb * 25 / 4.
+ * Temperature sensitivity is 100 LSB/degC, so raw value is in cdegC.
+ *
+ * @param  raw       FIFO content, FIFO_SLOT_LEN byte per sample
+ * @param  pa_q8     converted pressure
+ * @param  cdeg      converted temperature
+ * @param  len       number of samples
+ *
+ */
+static void press_fifo_raw_to_pa(const uint8_t *raw, int32_t *pa_q8,
+                                 int16_t *cdeg, uint16_t len)
+{
+  int32_t lsb;
+  uint16_t i;
+
+  for (i = 0; i < len; i++) {
+    lsb = (int32_t)(((uint32_t)raw[2] << 24) | ((uint32_t)raw[1] << 16) |
+                    ((uint32_t)raw[0] << 8)) >> 8;
+    pa_q8[i] = (lsb * 25) >> 2;
+    cdeg[i] = (int16_t)(((uint16_t)raw[4] << 8) | raw[3]);
+    raw += FIFO_SLOT_LEN;
+  }
+}
+
+/*
+ * @brief  Write generic device register (platform dependent)
+ *
+ * @param  handle    customizable argument. In this examples is used in
+ *                   order to select the correct sensor bus handler.
+ * @param  reg       register to write
+ * @param  bufp      pointer to data to write in register reg
+ * @param  len       number of consecutive register to write
+ *
+ */
+static int32_t platform_write(void *handle, uint8_t reg, const uint8_t *bufp,
+                              uint16_t len)
+{
+#if defined(NUCLEO_F401RE)
+  HAL_I2C_Mem_Write(handle, LPS22HH_I2C_ADD_H, reg,
+                    I2C_MEMADD_SIZE_8BIT, (uint8_t*) bufp, len, 1000);
+#elif defined(STEVAL_MKI109V3)
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_RESET);
+  HAL_SPI_Transmit(handle, &reg, 1, 1000);
+  HAL_SPI_Transmit(handle, (uint8_t*) bufp, len, 1000);
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_SET);
+#elif defined(SPC584B_DIS)
+  i2c_lld_write(handle,  LPS22HH_I2C_ADD_H & 0xFE, reg, (uint8_t*) bufp, len);
+#endif
+  return 0;
+}
+
+/*
+ * @brief  Read generic device register (platform dependent)
+ *
+ * @param  handle    customizable argument. In this examples is used in
+ *                   order to select the correct sensor bus handler.
+ * @param  reg       register to read
+ * @param  bufp      pointer to buffer that store the data read
+ * @param  len       number of consecutive register to read
+ *
+ */
+static int32_t platform_read(void *handle, uint8_t reg, uint8_t *bufp,
+                             uint16_t len)
+{
+#if defined(NUCLEO_F401RE)
+  HAL_I2C_Mem_Read(handle, LPS22HH_I2C_ADD_H, reg,
+                   I2C_MEMADD_SIZE_8BIT, bufp, len, 1000);
+#elif defined(STEVAL_MKI109V3)
+  reg |= 0x80;
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_RESET);
+  HAL_SPI_Transmit(handle, &reg, 1, 1000);
+  HAL_SPI_Receive(handle, bufp, len, 1000);
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_SET);
+#elif defined(SPC584B_DIS)
+  i2c_lld_read(handle, LPS22HH_I2C_ADD_H & 0xFE, reg, bufp, len);
+#endif
+  return 0;
+}
+
+/*
+ * @brief  Write generic device register (platform dependent)
+ *
+ * @param  tx_buffer     buffer to transmit
+ * @param  len           number of byte to send
+ *
+ */
+static void tx_com(uint8_t *tx_buffer, uint16_t len)
+{
+#if defined(NUCLEO_F401RE)
+  HAL_UART_Transmit(&huart2, tx_buffer, len, 1000);
+#elif defined(STEVAL_MKI109V3)
+  CDC_Transmit_FS(tx_buffer, len);
+#elif defined(SPC584B_DIS)
+  sd_lld_write(&SD2, tx_buffer, len);
+#endif
+}
+
+/*
+ * @brief  platform specific delay (platform dependent)
+ *
+ * @param  ms        delay in ms
+ *
+ */
+static void platform_delay(uint32_t ms)
+{
+#if defined(NUCLEO_F401RE) | defined(STEVAL_MKI109V3)
+  HAL_Delay(ms);
+#elif defined(SPC584B_DIS)
+  osalThreadDelayMilliseconds(ms);
+#endif
+}
+
+/*
+ * @brief  platform specific time (platform dependent)
+ *
+ * @retval           time [ms]
+ *
+ */
+static uint32_t platform_get_ms(void)
+{
+#if defined(NUCLEO_F401RE) | defined(STEVAL_MKI109V3)
+  return HAL_GetTick();
+#elif defined(SPC584B_DIS)
+  return osalThreadGetMilliseconds();
+#else
+  return 0;
+#endif
+}
+
+/*
+ * @brief  platform specific initialization (platform dependent)
+ */
+static void platform_init(void)
+{
+#if defined(STEVAL_MKI109V3)
+  TIM3->CCR1 = PWM_3V3;
+  TIM3->CCR2 = PWM_3V3;
+  HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_1);
+  HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_2);
+  HAL_Delay(1000);
+#endif
+}
@@ -0,0 +1,415 @@
+/*
+ ******************************************************************************
+ * @file    fifo_batch.c
+ * @author  Sensors Software Solution Team
+ * @brief   This file shows how to read the whole FIFO in a single burst.
+ *
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2021 STMicroelectronics.
+ * All rights reserved.</center></h2>
+ *
+ * This software component is licensed by ST under BSD 3-Clause license,
+ * the "License"; You may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at:
+ *                        opensource.org/licenses/BSD-3-Clause
+ *
+ ******************************************************************************
+ */
+
+/*
+ * This example was developed using the following STMicroelectronics
+ * evaluation boards:
+ *
+ * - NUCLEO_F401RE
+ * - DISCOVERY_SPC584B
+ *
+ * and STM32CubeMX tool with STM32CubeF4 MCU Package
+ *
+ * Used interfaces:
+ *
+ * NUCLEO_STM32F401RE - Host side: UART(COM) to USB bridge
+ *                    - I2C(Default) / SPI(N/A)
+ *
+ * DISCOVERY_SPC584B  - Host side: UART(COM) to USB bridge
+ *                    - Sensor side: I2C(Default) / SPI(supported)
+ *
+ * If you need to run this example on a different hardware platform a
+ * modification of the functions: `platform_write`, `platform_read`,
+ * `tx_com` and 'platform_init' is required.
+ *
+ */
+
+/* STMicroelectronics evaluation boards definition
+ *
+ * Please uncomment ONLY the evaluation boards in use.
+ * If a different hardware is used please comment all
+ * following target board and redefine yours.
+ */
+
+//#define NUCLEO_F401RE    /* little endian */
+//#define SPC584B_DIS      /* big endian */
+
+/* ATTENTION: By default the driver is little endian. If you need switch
+ *            to big endian please see "Endianness definitions" in the
+ *            header file of the driver (_reg.h).
+ */
+
+
+#if defined(NUCLEO_F401RE)
+/* NUCLEO_F401RE: Define communication interface */
+#define SENSOR_BUS hi2c1
+
+#elif defined(SPC584B_DIS)
+/* DISCOVERY_SPC584B: Define communication interface */
+#define SENSOR_BUS I2CD1
+
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include <stdio.h>
+#include "lps28dfw_reg.h"
+
+#if defined(NUCLEO_F401RE)
+#include "stm32f4xx_hal.h"
+#include "usart.h"
+#include "gpio.h"
+#include "i2c.h"
+
+#elif defined(SPC584B_DIS)
+#include "components.h"
+#endif
+
+/* Private macro -------------------------------------------------------------*/
+#define    BOOT_TIME         10 //ms
+
+/* FIFO watermark and output data rate (FIFO_ODR_HZ must match md.odr) */
+#define    FIFO_WTM          32
+#define    FIFO_ODR_HZ       10
+
+/* FIFO depth and slot size (PRESS_XL, PRESS_L, PRESS_H) */
+#define    FIFO_DEPTH        128
+#define    FIFO_SLOT_LEN     3
+
+/* FIFO_STATUS2 flags */
+#define    FIFO_WTM_IA       0x80U
+#define    FIFO_OVR_IA       0x40U
+
+/* Private typedef -----------------------------------------------------------*/
+/*
+ * Batch of pressure samples drained from FIFO.
+ *
+ * pa_q8 is the pressure in Pa with 8 fractional bits, ts_us is the sample
+ * timestamp reconstructed from the configured ODR (and from the MCU time
+ * after an overrun).
+ */
+typedef struct {
+  int32_t pa_q8[FIFO_DEPTH];
+  uint64_t ts_us[FIFO_DEPTH];
+  uint16_t len;
+  uint8_t ovr;
+} press_fifo_batch_t;
+
+/* Private variables ---------------------------------------------------------*/
+static uint8_t tx_buffer[1000];
+static uint8_t fifo_raw[FIFO_DEPTH * FIFO_SLOT_LEN];
+static press_fifo_batch_t batch;
+static uint64_t sample_cnt;
+static uint32_t t0_ms;
+static uint8_t fs_4060;
+
+/* Extern variables ----------------------------------------------------------*/
+
+/* Private functions ---------------------------------------------------------*/
+/*
+ *   WARNING:
+ *   Functions declare in this section are defined at the end of this file
+ *   and are strictly related to the hardware platform used.
+ *
+ */
+static int32_t platform_write(void *handle, uint8_t reg, const uint8_t *bufp,
+                              uint16_t len);
+static int32_t platform_read(void *handle, uint8_t reg, uint8_t *bufp,
+                             uint16_t len);
+static void tx_com( uint8_t *tx_buffer, uint16_t len );
+static void platform_delay(uint32_t ms);
+static uint32_t platform_get_ms(void);
+static void platform_init(void);
+
+static int32_t press_fifo_batch_get(stmdev_ctx_t *ctx,
+                                    press_fifo_batch_t *batch);
+static void press_fifo_raw_to_pa(const uint8_t *raw, int32_t *pa_q8,
+                                 uint16_t len, uint8_t fs_4060);
+
+/* Main Example --------------------------------------------------------------*/
+void lps28dfw_fifo_batch(void)
+{
+  lps28dfw_fifo_md_t fifo_mode;
+  lps28dfw_bus_mode_t bus_mode;
+  lps28dfw_stat_t status;
+  stmdev_ctx_t dev_ctx;
+  lps28dfw_id_t id;
+  lps28dfw_md_t md;
+
+  /* Initialize mems driver interface */
+  dev_ctx.write_reg = platform_write;
+  dev_ctx.read_reg = platform_read;
+  dev_ctx.mdelay = platform_delay;
+  dev_ctx.handle = &SENSOR_BUS;
+
+  /* Initialize platform specific hardware */
+  platform_init();
+
+  /* Wait sensor boot time */
+  platform_delay(BOOT_TIME);
+
+  /* Check device ID */
+  lps28dfw_id_get(&dev_ctx, &id);
+  if (id.whoami != LPS28DFW_ID)
+    while(1);
+
+  /* Restore default configuration */
+  lps28dfw_init_set(&dev_ctx, LPS28DFW_RESET);
+  do {
+    lps28dfw_status_get(&dev_ctx, &status);
+  } while (status.sw_reset);
+
+  /* Set bdu and if_inc recommended for driver usage */
+  lps28dfw_init_set(&dev_ctx, LPS28DFW_DRV_RDY);
+
+  /* Select bus interface */
+  bus_mode.filter = LPS28DFW_AUTO;
+  lps28dfw_bus_mode_set(&dev_ctx, &bus_mode);
+
+  /* Set Output Data Rate */
+  md.odr = LPS28DFW_10Hz;
+  md.avg = LPS28DFW_16_AVG;
+  md.lpf = LPS28DFW_LPF_ODR_DIV_4;
+  md.fs = LPS28DFW_1260hPa;
+  lps28dfw_mode_set(&dev_ctx, &md);
+
+  /* Enable FIFO */
+  fifo_mode.operation = LPS28DFW_STREAM;
+  fifo_mode.watermark = FIFO_WTM;
+  lps28dfw_fifo_mode_set(&dev_ctx, &fifo_mode);
+
+  fs_4060 = (md.fs == LPS28DFW_4060hPa);
+  sample_cnt = 0;
+  t0_ms = platform_get_ms();
+
+  /* Drain FIFO in two bus transactions per watermark event (no int) */
+  while(1)
+  {
+    uint16_t i;
+
+    if (press_fifo_batch_get(&dev_ctx, &batch) != 0 || batch.len == 0U)
+      continue;
+
+    snprintf((char*)tx_buffer, sizeof(tx_buffer), "--- FIFO samples (%d)%s\r\n",
+             batch.len, batch.ovr ? " overrun" : "");
+    tx_com(tx_buffer, strlen((char const*)tx_buffer));
+
+    for (i = 0; i < batch.len; i++) {
+      snprintf((char*)tx_buffer, sizeof(tx_buffer),
+               "%02d: t [ms]:%lu.%03lu pressure [Pa]:%ld.%02ld\r\n", i,
+               (unsigned long)(batch.ts_us[i] / 1000U),
+               (unsigned long)(batch.ts_us[i] % 1000U),
+               (long)(batch.pa_q8[i] >> 8),
+               (long)(((batch.pa_q8[i] & 0xFF) * 100) >> 8));
+      tx_com(tx_buffer, strlen((char const*)tx_buffer));
+    }
+
+    snprintf((char*)tx_buffer, sizeof(tx_buffer), "\r\n");
+    tx_com(tx_buffer, strlen((char const*)tx_buffer));
+  }
+}
+
+/*
+ * @brief  Drain the whole FIFO content and convert it to Pa
+ *
+ * FIFO_STATUS1 (level), FIFO_STATUS2 (flags) and STATUS are contiguous and
+ * are read in a single transaction. On watermark the FIFO content is read
+ * with a single burst: with IF_ADD_INC set the address rolls back from
+ * FIFO_DATA_OUT_PRESS_H to FIFO_DATA_OUT_PRESS_XL, so consecutive slots
+ * are returned back to back.
+ *
+ * @param  ctx       read / write interface definitions
+ * @param  batch     output batch, batch->len is 0 if watermark not reached
+ * @retval           interface status (MANDATORY: return 0 -> no Error)
+ *
+ */
+static int32_t press_fifo_batch_get(stmdev_ctx_t *ctx,
+                                    press_fifo_batch_t *batch)
+{
+  uint8_t status[3];
+  uint16_t i;
+  int32_t ret;
+
+  batch->len = 0;
+
+  ret = lps28dfw_read_reg(ctx, LPS28DFW_FIFO_STATUS1, status, 3);
+  if (ret != 0 || (status[1] & FIFO_WTM_IA) == 0U)
+    return ret;
+
+  batch->len = status[0];
+  batch->ovr = (status[1] & FIFO_OVR_IA) ? 1 : 0;
+  if (batch->len > FIFO_DEPTH)
+    batch->len = FIFO_DEPTH;
+
+  ret = lps28dfw_read_reg(ctx, LPS28DFW_FIFO_DATA_OUT_PRESS_XL,
+                          fifo_raw, batch->len * FIFO_SLOT_LEN);
+  if (ret != 0) {
+    batch->len = 0;
+    return ret;
+  }
+
+  press_fifo_raw_to_pa(fifo_raw, batch->pa_q8, batch->len, fs_4060);
+
+  /*
+   * Samples lost in an overrun are not counted by the FIFO: resynchronise
+   * the timeline on the MCU time, the last sample read being the most
+   * recent one.
+   */
+  if (batch->ovr) {
+    uint64_t now = ((uint64_t)(platform_get_ms() - t0_ms) * FIFO_ODR_HZ) /
+                   1000U + 1U;
+
+    if (now > sample_cnt + batch->len)
+      sample_cnt = now - batch->len;
+  }
+
+  /* Samples are equally spaced at 1 / ODR */
+  for (i = 0; i < batch->len; i++)
+    batch->ts_us[i] = ((sample_cnt + i) * 1000000U) / FIFO_ODR_HZ;
+  sample_cnt += batch->len;
+
+  return ret;
+}
+
+/*
+ * @brief  Convert FIFO raw slots in pressure [Pa] (Q24.8 fixed-point)
+ *
+ * Sensitivity is 4096 LSB/hPa in 1260 hPa full scale and 2048 LSB/hPa
+ * in 4060 hPa full scale, so Pa * 256 = lsb * 25 / 4 (or / 2).
+ *
+ * @param  raw       FIFO content, FIFO_SLOT_LEN byte per sample
+ * @param  pa_q8     converted pressure
+ * @param  len       number of samples
+ * @param  fs_4060   1 if 4060 hPa full scale is selected
+ *
+ */
+static void press_fifo_raw_to_pa(const uint8_t *raw, int32_t *pa_q8,
+                                 uint16_t len, uint8_t fs_4060)
+{
+  uint8_t shift = (fs_4060) ? 1U : 2U;
+  int32_t lsb;
+  uint16_t i;
+
+  for (i = 0; i < len; i++) {
+    lsb = (int32_t)(((uint32_t)raw[2] << 24) | ((uint32_t)raw[1] << 16) |
+                    ((uint32_t)raw[0] << 8)) >> 8;
+    pa_q8[i] = (lsb * 25) >> shift;
+    raw += FIFO_SLOT_LEN;
+  }
+}
+
+/*
+ * @brief  Write generic device register (platform dependent)
+ *
+ * @param  handle    customizable argument. In this examples is used in
+ *                   order to select the correct sensor bus handler.
+ * @param  reg       register to write
+ * @param  bufp      pointer to data to write in register reg
+ * @param  len       number of consecutive register to write
+ *
+ */
+static int32_t platform_write(void *handle, uint8_t reg, const uint8_t *bufp,
+                              uint16_t len)
+{
+#if defined(NUCLEO_F401RE)
+  HAL_I2C_Mem_Write(handle, LPS28DFW_I2C_ADD_L, reg,
+                    I2C_MEMADD_SIZE_8BIT, (uint8_t *) bufp, len, 1000);
+#elif defined(SPC584B_DIS)
+  i2c_lld_write(handle,  LPS28DFW_I2C_ADD_L & 0xFE, reg, (uint8_t*) bufp, len);
+#endif
+  return 0;
+}
+
+/*
+ * @brief  Read generic device register (platform dependent)
+ *
+ * @param  handle    customizable argument. In this examples is used in
+ *                   order to select the correct sensor bus handler.
+ * @param  reg       register to read
+ * @param  bufp      pointer to buffer that store the data read
+ * @param  len       number of consecutive register to read
+ *
+ */
+static int32_t platform_read(void *handle, uint8_t reg, uint8_t *bufp,
+                             uint16_t len)
+{
+#if defined(NUCLEO_F401RE)
+  HAL_I2C_Mem_Read(handle, LPS28DFW_I2C_ADD_L, reg,
+                   I2C_MEMADD_SIZE_8BIT, bufp, len, 1000);
+#elif defined(SPC584B_DIS)
+  i2c_lld_read(handle, LPS28DFW_I2C_ADD_L & 0xFE, reg, bufp, len);
+#endif
+  return 0;
+}
+
+/*
+ * @brief  Write generic device register (platform dependent)
+ *
+ * @param  tx_buffer     buffer to trasmit
+ * @param  len           number of byte to send
+ *
+ */
+static void tx_com(uint8_t *tx_buffer, uint16_t len)
+{
+#if defined(NUCLEO_F401RE)
+  HAL_UART_Transmit(&huart2, tx_buffer, len, 1000);
+#elif defined(SPC584B_DIS)
+  sd_lld_write(&SD2, tx_buffer, len);
+#endif
+}
+
+/*
+ * @brief  platform specific delay (platform dependent)
+ *
+ * @param  ms        delay in ms
+ *
+ */
+static void platform_delay(uint32_t ms)
+{
+#if defined(NUCLEO_F401RE)
+  HAL_Delay(ms);
+#elif defined(SPC584B_DIS)
+  osalThreadDelayMilliseconds(ms);
+#endif
+}
+
+/*
+ * @brief  platform specific time (platform dependent)
+ *
+ * @retval           time [ms]
+ *
+ */
+static uint32_t platform_get_ms(void)
+{
+#if defined(NUCLEO_F401RE)
+  return HAL_GetTick();
+#elif defined(SPC584B_DIS)
+  return osalThreadGetMilliseconds();
+#else
+  return 0;
+#endif
+}
+
+/*
+ * @brief  platform specific initialization (platform dependent)
+ */
+static void platform_init(void)
+{
+}
@@ -0,0 +1,587 @@
+/*
+ ******************************************************************************
+ * @file    ispu_fast_load.c
+ * @author  Sensors Software Solution Team
+ * @brief   This file shows how to load an ISPU image with burst writes.
+ *
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2020 STMicroelectronics.
+ * All rights reserved.</center></h2>
+ *
+ * This software component is licensed by ST under BSD 3-Clause license,
+ * the "License"; You may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at:
+ *                        opensource.org/licenses/BSD-3-Clause
+ *
+ ******************************************************************************
+ */
+
+/*
+ * This example was developed using the following STMicroelectronics
+ * evaluation boards:
+ *
+ * - STEVAL_MKI109V3 + STEVAL-MKI196V1
+ * - NUCLEO_F401RE + X_NUCLEO_IKS01A3
+ * - DISCOVERY_SPC584B + STEVAL-MKI196V1
+ *
+ * Used interfaces:
+ *
+ * STEVAL_MKI109V3    - Host side:   USB (Virtual COM)
+ *                    - Sensor side: SPI(Default) / I2C(supported)
+ *
+ * NUCLEO_STM32F401RE - Host side: UART(COM) to USB bridge
+ *                    - I2C(Default) / SPI(supported)
+ *
+ * DISCOVERY_SPC584B  - Host side: UART(COM) to USB bridge
+ *                    - Sensor side: I2C(Default) / SPI(supported)
+ *
+ * If you need to run this example on a different hardware platform a
+ * modification of the functions: `platform_write`, `platform_read`,
+ * `tx_com` and 'platform_init' is required.
+ *
+ */
+
+/* STMicroelectronics evaluation boards definition
+ *
+ * Please uncomment ONLY the evaluation boards in use.
+ * If a different hardware is used please comment all
+ * following target board and redefine yours.
+ */
+
+//#define STEVAL_MKI109V3  /* little endian */
+//#define NUCLEO_F401RE    /* little endian */
+//#define SPC584B_DIS      /* big endian */
+
+/* ATTENTION: By default the driver is little endian. If you need switch
+ *            to big endian please see "Endianness definitions" in the
+ *            header file of the driver (_reg.h).
+ */
+
+#if defined(STEVAL_MKI109V3)
+/* MKI109V3: Define communication interface */
+#define SENSOR_BUS hspi2
+/* MKI109V3: Vdd and Vddio power supply values */
+#define PWM_3V3 915
+
+#elif defined(NUCLEO_F401RE)
+/* NUCLEO_F401RE: Define communication interface */
+#define SENSOR_BUS hi2c1
+
+#elif defined(SPC584B_DIS)
+/* DISCOVERY_SPC584B: Define communication interface */
+#define SENSOR_BUS I2CD1
+
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include <stdio.h>
+#include "norm.h"
+#include "lsm6dso16is_reg.h"
+
+#if defined(NUCLEO_F401RE)
+#include "stm32f4xx_hal.h"
+#include "usart.h"
+#include "gpio.h"
+#include "i2c.h"
+
+#elif defined(STEVAL_MKI109V3)
+#include "stm32f4xx_hal.h"
+#include "usbd_cdc_if.h"
+#include "gpio.h"
+#include "spi.h"
+#include "tim.h"
+
+#elif defined(SPC584B_DIS)
+#include "components.h"
+#endif
+
+/* Private macro -------------------------------------------------------------*/
+#define    BOOT_TIME      10
+
+/* Max number of bytes written to the device in a single transaction */
+#define    BURST_MAX      256
+
+/* Max number of ISPU memory segments in an image */
+#define    SEG_MAX        8
+
+/* CTRL3_C and FUNC_CFG_ACCESS bits handled by the loader */
+#define    CTRL3_C_SW_RESET          0x01U
+#define    CTRL3_C_IF_INC            0x04U
+#define    FUNC_CFG_ISPU_REG_ACCESS  0x80U
+
+/* Private typedef -----------------------------------------------------------*/
+/* ISPU memory area written by a run of ISPU_MEM_DATA writes */
+typedef struct {
+  uint8_t mem_sel;
+  uint16_t addr;
+  uint16_t len;
+  uint32_t crc;
+} ispu_seg_t;
+
+/* Loader statistics */
+typedef struct {
+  uint32_t writes;     /* UCF write lines */
+  uint32_t xfers;      /* bus transactions */
+  uint32_t delay_ms;   /* delays required by the image */
+  uint32_t load_us;
+  uint8_t nseg;
+  ispu_seg_t seg[SEG_MAX];
+} ispu_load_t;
+
+/* Private variables ---------------------------------------------------------*/
+static uint8_t whoamI;
+static uint8_t tx_buffer[1000];
+static uint8_t burst[BURST_MAX];
+static ispu_load_t load;
+
+/* Extern variables ----------------------------------------------------------*/
+
+/* Private functions ---------------------------------------------------------*/
+
+/*
+ *   WARNING:
+ *   Functions declare in this section are defined at the end of this file
+ *   and are strictly related to the hardware platform used.
+ *
+ */
+static int32_t platform_write(void *handle, uint8_t reg, const uint8_t *bufp,
+                              uint16_t len);
+static int32_t platform_read(void *handle, uint8_t reg, uint8_t *bufp,
+                             uint16_t len);
+static void tx_com( uint8_t *tx_buffer, uint16_t len );
+static void platform_delay(uint32_t ms);
+static void platform_init(void);
+
+
+static   stmdev_ctx_t dev_ctx;
+
+static int32_t ispu_load_burst(stmdev_ctx_t *ctx, const ucf_line_ext_t *ucf,
+                               uint32_t n, ispu_load_t *l);
+static int32_t ispu_load_verify(stmdev_ctx_t *ctx, const ispu_load_t *l);
+
+#if defined(NUCLEO_F401RE) || defined(STEVAL_MKI109V3)
+/* Cycle counter used to measure the load time (Cortex-M DWT) */
+static void cycles_init(void)
+{
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+static uint32_t cycles_get(void)
+{
+  return DWT->CYCCNT;
+}
+
+static uint32_t cycles_to_us(uint32_t cycles)
+{
+  return cycles / (SystemCoreClock / 1000000U);
+}
+#else
+static void cycles_init(void) {}
+static uint32_t cycles_get(void) { return 0; }
+static uint32_t cycles_to_us(uint32_t cycles) { return cycles; }
+#endif
+
+void lsm6dso16is_ispu_fast_load_handler()
+{
+  uint32_t ispu_int;
+  uint8_t dout[10];
+  int16_t x, y, z;
+  int32_t temp;
+  float_t norm;
+
+  lsm6dso16is_ispu_int_status_get(&dev_ctx, &ispu_int);
+
+  /* handle only ISPU INT1 interrupts */
+  if ((ispu_int & 0x1) == 0)
+    return;
+
+  lsm6dso16is_ispu_read_data_raw_get(&dev_ctx, dout, 10);
+
+  x = (int16_t)dout[1];
+  x = (x * 256) + (int16_t)dout[0];
+  y = (int16_t)dout[3];
+  y = (y * 256) + (int16_t)dout[2];
+  z = (int16_t)dout[5];
+  z = (z * 256) + (int16_t)dout[4];
+
+  temp = (dout[9] << 24) | (dout[8] << 16) | (dout[7] << 8) | dout[6];
+  norm = *(float_t *)&temp;
+
+  snprintf((char *)tx_buffer, sizeof(tx_buffer), "x: %d\ty: %d\tz: %d\tnorm: %4.2f\r\n", x, y, z, norm);
+  tx_com(tx_buffer, strlen((char const *)tx_buffer));
+}
+
+/* Main Example --------------------------------------------------------------*/
+void lsm6dso16is_ispu_fast_load(void)
+{
+  lsm6dso16is_ispu_data_rate_t ispu_odr;
+  uint32_t t0;
+#if defined(LOAD_BASELINE)
+  uint16_t i;
+#endif
+
+  /* Initialize mems driver interface */
+  dev_ctx.write_reg = platform_write;
+  dev_ctx.read_reg = platform_read;
+  dev_ctx.mdelay = platform_delay;
+  dev_ctx.handle = &SENSOR_BUS;
+  /* Init test platform */
+  platform_init();
+  /* Wait sensor boot time */
+  platform_delay(BOOT_TIME);
+  /* Check device ID */
+  lsm6dso16is_device_id_get(&dev_ctx, &whoamI);
+
+  if (whoamI != LSM6DSO16IS_ID)
+    while (1);
+
+  cycles_init();
+
+#if defined(LOAD_BASELINE)
+  /* Reference: one transaction per UCF line */
+  lsm6dso16is_software_reset(&dev_ctx);
+
+  t0 = cycles_get();
+  for ( i = 0; i < (sizeof(ispu_conf) / sizeof(ucf_line_ext_t) ); i++ ) {
+    switch(ispu_conf[i].op) {
+    case MEMS_UCF_OP_DELAY:
+      platform_delay(ispu_conf[i].data);
+      break;
+    case MEMS_UCF_OP_WRITE:
+      lsm6dso16is_write_reg(&dev_ctx, ispu_conf[i].address, (uint8_t *)&ispu_conf[i].data, 1);
+      break;
+    }
+  }
+  t0 = cycles_to_us(cycles_get() - t0);
+
+  snprintf((char *)tx_buffer, sizeof(tx_buffer), "Byte per byte load: %lu us\r\n",
+           (unsigned long)t0);
+  tx_com(tx_buffer, strlen((char const *)tx_buffer));
+#endif
+
+  /* Restore default configuration */
+  lsm6dso16is_software_reset(&dev_ctx);
+
+  /* Load ISPU configuration */
+  t0 = cycles_get();
+  if (ispu_load_burst(&dev_ctx, ispu_conf,
+                      sizeof(ispu_conf) / sizeof(ucf_line_ext_t), &load) != 0)
+    while (1);
+  load.load_us = cycles_to_us(cycles_get() - t0);
+
+  snprintf((char *)tx_buffer, sizeof(tx_buffer),
+           "Burst load: %lu us (%lu writes in %lu transactions, %lu ms of delay)\r\n",
+           (unsigned long)load.load_us, (unsigned long)load.writes,
+           (unsigned long)load.xfers, (unsigned long)load.delay_ms);
+  tx_com(tx_buffer, strlen((char const *)tx_buffer));
+
+  if (ispu_load_verify(&dev_ctx, &load) != 0) {
+    snprintf((char *)tx_buffer, sizeof(tx_buffer), "ISPU load CRC mismatch\r\n");
+    tx_com(tx_buffer, strlen((char const *)tx_buffer));
+    while (1);
+  }
+
+  lsm6dso16is_ispu_data_rate_get(&dev_ctx, &ispu_odr);
+  snprintf((char *)tx_buffer, sizeof(tx_buffer), "ISPU started: at rate %d\r\n", ispu_odr);
+  tx_com(tx_buffer, strlen((char const *)tx_buffer));
+
+  /* Read norm result in interrupt handler */
+  while (1);
+}
+
+/*
+ * @brief  CRC-32 (IEEE 802.3, bitwise)
+ *
+ * @param  crc       running CRC (0 on first call)
+ * @param  buf       data
+ * @param  len       number of bytes
+ * @retval           updated CRC
+ *
+ */
+static uint32_t crc32_update(uint32_t crc, const uint8_t *buf, uint16_t len)
+{
+  uint8_t k;
+
+  crc = ~crc;
+  while (len--) {
+    crc ^= *buf++;
+    for (k = 0; k < 8; k++)
+      crc = (crc >> 1) ^ (0xEDB88320U & (0U - (crc & 1U)));
+  }
+
+  return ~crc;
+}
+
+/*
+ * @brief  Load an ISPU image, merging consecutive ISPU_MEM_DATA writes
+ *
+ * The ISPU memory address auto-increments on every ISPU_MEM_DATA write,
+ * so a run of writes to that register is sent as one multi-byte
+ * transaction with the register auto-increment (IF_INC) disabled.
+ * Any other line is written as is, and delays are only applied where
+ * the image has a MEMS_UCF_OP_DELAY line. The ISPU memory segments
+ * written (selection, start address, length, CRC) are recorded for
+ * ispu_load_verify().
+ *
+ * The image is expected to write CTRL3_C only in the main register page;
+ * IF_INC is kept cleared during the load and restored at the end.
+ *
+ * @param  ctx       read / write interface definitions
+ * @param  ucf       ISPU image
+ * @param  n         number of lines in the image
+ * @param  l         load statistics and segments
+ * @retval           interface status (MANDATORY: return 0 -> no Error)
+ *
+ */
+static int32_t ispu_load_burst(stmdev_ctx_t *ctx, const ucf_line_ext_t *ucf,
+                               uint32_t n, ispu_load_t *l)
+{
+  uint8_t ispu_page = 0;
+  uint8_t mem_sel = 0;
+  uint16_t mem_addr = 0;
+  uint8_t reset_seen = 0;
+  uint8_t ctrl3_c;
+  uint32_t i, run;
+  int32_t ret;
+
+  memset(l, 0, sizeof(ispu_load_t));
+
+  ret = lsm6dso16is_read_reg(ctx, LSM6DSO16IS_CTRL3_C, &ctrl3_c, 1);
+  ctrl3_c &= (uint8_t)~CTRL3_C_IF_INC;
+  ret += lsm6dso16is_write_reg(ctx, LSM6DSO16IS_CTRL3_C, &ctrl3_c, 1);
+  l->xfers += 2;
+
+  i = 0;
+  while (ret == 0 && i < n) {
+    const ucf_line_ext_t *line = &ucf[i];
+    uint8_t data = line->data;
+
+    if (line->op == MEMS_UCF_OP_DELAY) {
+      platform_delay(line->data);
+      l->delay_ms += line->data;
+      i++;
+      continue;
+    }
+
+    /* A software reset done by the image re-enables IF_INC */
+    if (reset_seen) {
+      ctrl3_c = 0;
+      ret = lsm6dso16is_write_reg(ctx, LSM6DSO16IS_CTRL3_C, &ctrl3_c, 1);
+      l->xfers++;
+      reset_seen = 0;
+    }
+
+    if (line->address == LSM6DSO16IS_FUNC_CFG_ACCESS) {
+      ispu_page = (data & FUNC_CFG_ISPU_REG_ACCESS) ? 1 : 0;
+    } else if (!ispu_page && line->address == LSM6DSO16IS_CTRL3_C) {
+      data &= (uint8_t)~CTRL3_C_IF_INC;
+      if (data & CTRL3_C_SW_RESET) {
+        reset_seen = 1;
+        ispu_page = 0;
+      }
+    } else if (ispu_page && line->address == LSM6DSO16IS_ISPU_MEM_SEL) {
+      mem_sel = data;
+    } else if (ispu_page && line->address == LSM6DSO16IS_ISPU_MEM_ADDR1) {
+      mem_addr = (mem_addr & 0x00FFU) | ((uint16_t)data << 8);
+    } else if (ispu_page && line->address == LSM6DSO16IS_ISPU_MEM_ADDR0) {
+      mem_addr = (mem_addr & 0xFF00U) | data;
+    } else if (ispu_page && line->address == LSM6DSO16IS_ISPU_MEM_DATA) {
+      ispu_seg_t *seg = NULL;
+
+      /* Collect the run of ISPU_MEM_DATA writes */
+      for (run = 0; i + run < n && run < BURST_MAX; run++) {
+        if (ucf[i + run].op != MEMS_UCF_OP_WRITE ||
+            ucf[i + run].address != LSM6DSO16IS_ISPU_MEM_DATA)
+          break;
+        burst[run] = ucf[i + run].data;
+      }
+
+      /* Extend the current segment or open a new one */
+      if (l->nseg > 0) {
+        seg = &l->seg[l->nseg - 1];
+        if (seg->mem_sel != mem_sel || seg->addr + seg->len != mem_addr)
+          seg = NULL;
+      }
+      if (seg == NULL && l->nseg < SEG_MAX) {
+        seg = &l->seg[l->nseg++];
+        seg->mem_sel = mem_sel;
+        seg->addr = mem_addr;
+      }
+      if (seg != NULL) {
+        seg->crc = crc32_update(seg->crc, burst, (uint16_t)run);
+        seg->len += (uint16_t)run;
+      }
+
+      ret = lsm6dso16is_write_reg(ctx, LSM6DSO16IS_ISPU_MEM_DATA, burst,
+                                  (uint16_t)run);
+      mem_addr += (uint16_t)run;
+      l->writes += run;
+      l->xfers++;
+      i += run;
+      continue;
+    }
+
+    ret = lsm6dso16is_write_reg(ctx, line->address, &data, 1);
+    l->writes++;
+    l->xfers++;
+    i++;
+  }
+
+  /* Restore register auto-increment */
+  ret += lsm6dso16is_read_reg(ctx, LSM6DSO16IS_CTRL3_C, &ctrl3_c, 1);
+  ctrl3_c |= CTRL3_C_IF_INC;
+  ret += lsm6dso16is_write_reg(ctx, LSM6DSO16IS_CTRL3_C, &ctrl3_c, 1);
+  l->xfers += 2;
+
+  return ret;
+}
+
+/*
+ * @brief  Read back the ISPU memory segments and check their CRC
+ *
+ * @param  ctx       read / write interface definitions
+ * @param  l         segments recorded by ispu_load_burst()
+ * @retval           0 if all the segments match, -1 otherwise
+ *
+ */
+static int32_t ispu_load_verify(stmdev_ctx_t *ctx, const ispu_load_t *l)
+{
+  uint16_t off, len;
+  uint32_t crc;
+  uint8_t s;
+
+  for (s = 0; s < l->nseg; s++) {
+    const ispu_seg_t *seg = &l->seg[s];
+
+    crc = 0;
+    for (off = 0; off < seg->len; off += len) {
+      len = seg->len - off;
+      if (len > BURST_MAX)
+        len = BURST_MAX;
+
+      if (lsm6dso16is_ispu_read_memory(ctx,
+                                       (lsm6dso16is_ispu_memory_type_t)(seg->mem_sel & 0x1U),
+                                       seg->addr + off, burst, len) != 0)
+        return -1;
+      crc = crc32_update(crc, burst, len);
+    }
+
+    snprintf((char *)tx_buffer, sizeof(tx_buffer),
+             "ISPU %s RAM 0x%04x, %u bytes, CRC %08lx %s\r\n",
+             (seg->mem_sel & 0x1U) ? "program" : "data", seg->addr, seg->len,
+             (unsigned long)seg->crc, (crc == seg->crc) ? "ok" : "FAIL");
+    tx_com(tx_buffer, strlen((char const *)tx_buffer));
+
+    if (crc != seg->crc)
+      return -1;
+  }
+
+  return 0;
+}
+
+/*
+ * @brief  Write generic device register (platform dependent)
+ *
+ * @param  handle    customizable argument. In this examples is used in
+ *                   order to select the correct sensor bus handler.
+ * @param  reg       register to write
+ * @param  bufp      pointer to data to write in register reg
+ * @param  len       number of consecutive register to write
+ *
+ */
+static int32_t platform_write(void *handle, uint8_t reg, const uint8_t *bufp,
+                              uint16_t len)
+{
+#if defined(NUCLEO_F401RE)
+  HAL_I2C_Mem_Write(handle, LSM6DSO16IS_I2C_ADD_L, reg,
+                    I2C_MEMADD_SIZE_8BIT, (uint8_t*) bufp, len, 1000);
+#elif defined(STEVAL_MKI109V3)
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_RESET);
+  HAL_SPI_Transmit(handle, &reg, 1, 1000);
+  HAL_SPI_Transmit(handle, (uint8_t*) bufp, len, 1000);
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_SET);
+#elif defined(SPC584B_DIS)
+  i2c_lld_write(handle,  LSM6DSO16IS_I2C_ADD_H & 0xFE, reg, (uint8_t*) bufp, len);
+#endif
+  return 0;
+}
+
+/*
+ * @brief  Read generic device register (platform dependent)
+ *
+ * @param  handle    customizable argument. In this examples is used in
+ *                   order to select the correct sensor bus handler.
+ * @param  reg       register to read
+ * @param  bufp      pointer to buffer that store the data read
+ * @param  len       number of consecutive register to read
+ *
+ */
+static int32_t platform_read(void *handle, uint8_t reg, uint8_t *bufp,
+                             uint16_t len)
+{
+#if defined(NUCLEO_F401RE)
+  HAL_I2C_Mem_Read(handle, LSM6DSO16IS_I2C_ADD_L, reg,
+                   I2C_MEMADD_SIZE_8BIT, bufp, len, 1000);
+#elif defined(STEVAL_MKI109V3)
+  reg |= 0x80;
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_RESET);
+  HAL_SPI_Transmit(handle, &reg, 1, 1000);
+  HAL_SPI_Receive(handle, bufp, len, 1000);
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_SET);
+#elif defined(SPC584B_DIS)
+  i2c_lld_read(handle, LSM6DSO16IS_I2C_ADD_H & 0xFE, reg, bufp, len);
+#endif
+  return 0;
+}
+
+/*
+ * @brief  Send buffer to console (platform dependent)
+ *
+ * @param  tx_buffer     buffer to transmit
+ * @param  len           number of byte to send
+ *
+ */
+static void tx_com(uint8_t *tx_buffer, uint16_t len)
+{
+#if defined(NUCLEO_F401RE)
+  HAL_UART_Transmit(&huart2, tx_buffer, len, 1000);
+#elif defined(STEVAL_MKI109V3)
+  CDC_Transmit_FS(tx_buffer, len);
+#elif defined(SPC584B_DIS)
+  sd_lld_write(&SD2, tx_buffer, len);
+#endif
+}
+
+/*
+ * @brief  platform specific delay (platform dependent)
+ *
+ * @param  ms        delay in ms
+ *
+ */
+static void platform_delay(uint32_t ms)
+{
+#if defined(NUCLEO_F401RE) | defined(STEVAL_MKI109V3)
+  HAL_Delay(ms);
+#elif defined(SPC584B_DIS)
+  osalThreadDelayMilliseconds(ms);
+#endif
+}
+
+/*
+ * @brief  platform specific initialization (platform dependent)
+ */
+static void platform_init(void)
+{
+#if defined(STEVAL_MKI109V3)
+  TIM3->CCR1 = PWM_3V3;
+  TIM3->CCR2 = PWM_3V3;
+  HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_1);
+  HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_2);
+  HAL_Delay(1000);
+#endif
+}
@@ -0,0 +1,527 @@
+/*
+ ******************************************************************************
+ * @file    activity_odr.c
+ * @author  Sensors Software Solution Team
+ * @brief   This file shows how to switch ODR, power mode and FIFO
+ *          settings on activity / inactivity events.
+ *
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2020 STMicroelectronics.
+ * All rights reserved.</center></h2>
+ *
+ * This software component is licensed by ST under BSD 3-Clause license,
+ * the "License"; You may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at:
+ *                        opensource.org/licenses/BSD-3-Clause
+ *
+ ******************************************************************************
+ */
+
+/*
+ * This example was developed using the following STMicroelectronics
+ * evaluation boards:
+ *
+ * - STEVAL_MKI109V3 + STEVAL-MKI197V1
+ * - NUCLEO_F401RE + STEVAL-MKI197V1
+ * - DISCOVERY_SPC584B + STEVAL-MKI197V1
+ *
+ * Used interfaces:
+ *
+ * STEVAL_MKI109V3    - Host side:   USB (Virtual COM)
+ *                    - Sensor side: SPI(Default) / I2C(supported)
+ *
+ * NUCLEO_STM32F401RE - Host side: UART(COM) to USB bridge
+ *                    - Sensor side: I2C(Default) / SPI(supported)
+ *
+ * DISCOVERY_SPC584B  - Host side: UART(COM) to USB bridge
+ *                    - Sensor side: I2C(Default) / SPI(supported)
+ *
+ * If you need to run this example on a different hardware platform a
+ * modification of the functions: `platform_write`, `platform_read`,
+ * `tx_com` and 'platform_init' is required.
+ *
+ */
+
+/* STMicroelectronics evaluation boards definition
+ *
+ * Please uncomment ONLY the evaluation boards in use.
+ * If a different hardware is used please comment all
+ * following target board and redefine yours.
+ */
+
+//#define STEVAL_MKI109V3  /* little endian */
+//#define NUCLEO_F401RE    /* little endian */
+//#define SPC584B_DIS      /* big endian */
+
+/* ATTENTION: By default the driver is little endian. If you need switch
+ *            to big endian please see "Endianness definitions" in the
+ *            header file of the driver (_reg.h).
+ */
+
+#if defined(STEVAL_MKI109V3)
+/* MKI109V3: Define communication interface */
+#define SENSOR_BUS hspi2
+/* MKI109V3: Vdd and Vddio power supply values */
+#define PWM_3V3 915
+
+#elif defined(NUCLEO_F401RE)
+/* NUCLEO_F401RE: Define communication interface */
+#define SENSOR_BUS hi2c1
+
+#elif defined(SPC584B_DIS)
+/* DISCOVERY_SPC584B: Define communication interface */
+#define SENSOR_BUS I2CD1
+
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include <stdio.h>
+#include "lsm6dsox_reg.h"
+
+#if defined(NUCLEO_F401RE)
+#include "stm32f4xx_hal.h"
+#include "usart.h"
+#include "gpio.h"
+#include "i2c.h"
+
+#elif defined(STEVAL_MKI109V3)
+#include "stm32f4xx_hal.h"
+#include "usbd_cdc_if.h"
+#include "gpio.h"
+#include "spi.h"
+#include "tim.h"
+
+#elif defined(SPC584B_DIS)
+#include "components.h"
+#endif
+
+/* Private macro -------------------------------------------------------------*/
+#define    BOOT_TIME            10 //ms
+
+/* ODR / BDR codes of CTRL1_XL, CTRL2_G and FIFO_CTRL3 */
+#define    RATE_OFF             0x0U
+#define    RATE_12Hz5           0x1U
+#define    RATE_26Hz            0x2U
+#define    RATE_52Hz            0x3U
+#define    RATE_104Hz           0x4U
+
+#define    PROFILE_ACTIVE       0
+#define    PROFILE_IDLE         1
+#define    PROFILE_NUM          2
+
+/* Registers touched by a profile switch, in address order */
+#define    PROF_REG_NUM         7
+
+/* Timestamp LSB [us] */
+#define    TS_LSB_US            25U
+
+/* Private typedef -----------------------------------------------------------*/
+typedef union {
+  int16_t i16bit[3];
+  uint8_t u8bit[6];
+} axis3bit16_t;
+
+typedef union {
+  struct {
+    uint32_t tick;
+    uint16_t unused;
+  } reg;
+  uint8_t byte[6];
+} timestamp_sample_t;
+
+/* Sensor and FIFO settings applied in a given activity state */
+typedef struct {
+  const char *name;
+  uint8_t odr_xl;           /* CTRL1_XL ODR_XL */
+  uint8_t odr_g;            /* CTRL2_G ODR_G, RATE_OFF: power-down */
+  uint8_t xl_lp;            /* CTRL6_C XL_HM_MODE: 1 -> low-power */
+  uint8_t g_lp;             /* CTRL7_G G_HM_MODE: 1 -> low-power */
+  uint8_t bdr_xl;           /* FIFO_CTRL3 BDR_XL */
+  uint8_t bdr_gy;           /* FIFO_CTRL3 BDR_GY */
+  uint16_t wtm;             /* FIFO watermark [words] */
+  uint16_t current_ua;      /* typical supply current (datasheet) */
+} odr_profile_t;
+
+/* Profile manager state and statistics */
+typedef struct {
+  uint8_t profile;
+  uint8_t shadow[PROF_REG_NUM];
+  uint32_t switch_tick;     /* timestamp of the last switch [LSB] */
+  uint32_t residency[PROFILE_NUM];
+  uint32_t drains[PROFILE_NUM];
+  uint32_t writes;          /* bus write transactions for switches */
+  uint32_t switches;
+} odr_mgr_t;
+
+/* Private variables ---------------------------------------------------------*/
+static uint8_t tx_buffer[1000];
+static stmdev_ctx_t dev_ctx;
+static odr_mgr_t mgr;
+
+static const odr_profile_t profile[PROFILE_NUM] = {
+  /* XL + gyro in high-performance, 0.5 s of data per FIFO drain */
+  { "active", RATE_104Hz, RATE_104Hz, 0, 0, RATE_104Hz, RATE_104Hz, 156, 550 },
+  /* XL only in low-power, 4 s of data per FIFO drain */
+  { "idle", RATE_12Hz5, RATE_OFF, 1, 1, RATE_12Hz5, RATE_OFF, 100, 26 },
+};
+
+static const uint8_t prof_reg[PROF_REG_NUM] = {
+  LSM6DSOX_FIFO_CTRL1, LSM6DSOX_FIFO_CTRL2, LSM6DSOX_FIFO_CTRL3,
+  LSM6DSOX_CTRL1_XL, LSM6DSOX_CTRL2_G, LSM6DSOX_CTRL6_C, LSM6DSOX_CTRL7_G,
+};
+
+/* Extern variables ----------------------------------------------------------*/
+
+/* Private functions ---------------------------------------------------------*/
+
+/*
+ *   WARNING:
+ *   Functions declare in this section are defined at the end of this file
+ *   and are strictly related to the hardware platform used.
+ *
+ */
+static int32_t platform_write(void *handle, uint8_t reg, const uint8_t *bufp,
+                              uint16_t len);
+static int32_t platform_read(void *handle, uint8_t reg, uint8_t *bufp,
+                             uint16_t len);
+static void tx_com( uint8_t *tx_buffer, uint16_t len );
+static void platform_delay(uint32_t ms);
+static void platform_init(void);
+
+
+/*
+ * @brief  Switch to a profile writing only the registers that change
+ *
+ * Register values are derived from a shadow read once at start-up, so
+ * that a switch costs no read. Changed registers with consecutive
+ * addresses are written in one transaction. Samples already in the
+ * FIFO are kept: the batched timestamps keep the stream continuous
+ * and a CFG_CHANGE tag marks the switch point.
+ *
+ * @param  m         manager
+ * @param  p         profile to apply
+ * @retval           number of write transactions
+ *
+ */
+static uint8_t odr_profile_apply(odr_mgr_t *m, uint8_t p)
+{
+  const odr_profile_t *prof = &profile[p];
+  uint8_t val[PROF_REG_NUM];
+  uint8_t i, n, writes = 0;
+
+  /* FIFO_CTRL1: WTM[7:0], FIFO_CTRL2: WTM8 */
+  val[0] = (uint8_t)prof->wtm;
+  val[1] = (m->shadow[1] & ~0x01U) | (uint8_t)((prof->wtm >> 8) & 0x01U);
+  /* FIFO_CTRL3: BDR_GY[7:4] BDR_XL[3:0] */
+  val[2] = (uint8_t)((prof->bdr_gy << 4) | prof->bdr_xl);
+  /* CTRL1_XL / CTRL2_G: ODR[7:4], full scale and filters kept */
+  val[3] = (m->shadow[3] & 0x0FU) | (uint8_t)(prof->odr_xl << 4);
+  val[4] = (m->shadow[4] & 0x0FU) | (uint8_t)(prof->odr_g << 4);
+  /* CTRL6_C: XL_HM_MODE, CTRL7_G: G_HM_MODE */
+  val[5] = (m->shadow[5] & ~0x10U) | (uint8_t)(prof->xl_lp << 4);
+  val[6] = (m->shadow[6] & ~0x80U) | (uint8_t)(prof->g_lp << 7);
+
+  for (i = 0; i < PROF_REG_NUM; i += n) {
+    n = 1;
+    if (val[i] == m->shadow[i])
+      continue;
+
+    while (i + n < PROF_REG_NUM &&
+           prof_reg[i + n] == prof_reg[i] + n &&
+           val[i + n] != m->shadow[i + n])
+      n++;
+
+    lsm6dsox_write_reg(&dev_ctx, prof_reg[i], &val[i], n);
+    memcpy(&m->shadow[i], &val[i], n);
+    writes++;
+  }
+
+  m->profile = p;
+
+  return writes;
+}
+
+/*
+ * @brief  Print residency, estimated average current and FIFO drains
+ *
+ * @param  m         manager
+ *
+ */
+static void odr_mgr_report(odr_mgr_t *m)
+{
+  uint32_t total = m->residency[PROFILE_ACTIVE] + m->residency[PROFILE_IDLE];
+  uint32_t ua;
+
+  if (total == 0)
+    return;
+
+  ua = (uint32_t)(((uint64_t)m->residency[PROFILE_ACTIVE] *
+                   profile[PROFILE_ACTIVE].current_ua +
+                   (uint64_t)m->residency[PROFILE_IDLE] *
+                   profile[PROFILE_IDLE].current_ua) / total);
+
+  snprintf((char *)tx_buffer, sizeof(tx_buffer),
+           "%lu switches (%lu writes): active %lu s / idle %lu s, "
+           "%lu uA vs %u uA always active, FIFO drains %lu / %lu\r\n",
+           (unsigned long)m->switches, (unsigned long)m->writes,
+           (unsigned long)(m->residency[PROFILE_ACTIVE] / (1000000U / TS_LSB_US)),
+           (unsigned long)(m->residency[PROFILE_IDLE] / (1000000U / TS_LSB_US)),
+           (unsigned long)ua, profile[PROFILE_ACTIVE].current_ua,
+           (unsigned long)m->drains[PROFILE_ACTIVE],
+           (unsigned long)m->drains[PROFILE_IDLE]);
+  tx_com(tx_buffer, strlen((char const *)tx_buffer));
+}
+
+/* Main Example --------------------------------------------------------------*/
+void lsm6dsox_activity_odr(void)
+{
+  lsm6dsox_pin_int1_route_t int1_route;
+  lsm6dsox_all_sources_t all_source;
+  uint32_t ts_us = 0, now;
+  uint8_t dummy, i, writes, next;
+
+  /* Initialize mems driver interface */
+  dev_ctx.write_reg = platform_write;
+  dev_ctx.read_reg = platform_read;
+  dev_ctx.mdelay = platform_delay;
+  dev_ctx.handle = &SENSOR_BUS;
+  /* Init test platform */
+  platform_init();
+  /* Wait Boot Time */
+  platform_delay(BOOT_TIME);
+  /* Check device ID */
+  lsm6dsox_device_id_get(&dev_ctx, &dummy);
+
+  if (dummy != LSM6DSOX_ID)
+    while (1);
+
+  /* Restore default configuration */
+  lsm6dsox_reset_set(&dev_ctx, PROPERTY_ENABLE);
+
+  do {
+    lsm6dsox_reset_get(&dev_ctx, &dummy);
+  } while (dummy);
+
+  /* Disable I3C interface */
+  lsm6dsox_i3c_disable_set(&dev_ctx, LSM6DSOX_I3C_DISABLE);
+  /* Enable Block Data Update */
+  lsm6dsox_block_data_update_set(&dev_ctx, PROPERTY_ENABLE);
+  /* Set 2g full XL scale and 250 dps full Gyro */
+  lsm6dsox_xl_full_scale_set(&dev_ctx, LSM6DSOX_2g);
+  lsm6dsox_gy_full_scale_set(&dev_ctx, LSM6DSOX_250dps);
+  /* Set duration for Activity detection to 2 samples */
+  lsm6dsox_wkup_dur_set(&dev_ctx, 0x02);
+  /* Set duration for Inactivity detection to 2 * 512 samples */
+  lsm6dsox_act_sleep_dur_set(&dev_ctx, 0x02);
+  /* Set Activity/Inactivity threshold to 62.5 mg */
+  lsm6dsox_wkup_threshold_set(&dev_ctx, 0x02);
+  /* Sensor ODRs are driven by the profiles, not by the inactivity logic */
+  lsm6dsox_act_mode_set(&dev_ctx, LSM6DSOX_XL_AND_GY_NOT_AFFECTED);
+  /* Enable interrupt generation on Inactivity INT1 pin */
+  lsm6dsox_pin_int1_route_get(&dev_ctx, &int1_route);
+  int1_route.sleep_change = PROPERTY_ENABLE;
+  lsm6dsox_pin_int1_route_set(&dev_ctx, int1_route);
+
+  /* Batch timestamps and configuration changes with the samples */
+  lsm6dsox_fifo_timestamp_decimation_set(&dev_ctx, LSM6DSOX_DEC_1);
+  lsm6dsox_timestamp_set(&dev_ctx, PROPERTY_ENABLE);
+  lsm6dsox_fifo_mode_set(&dev_ctx, LSM6DSOX_STREAM_MODE);
+
+  /* Shadow of the profile registers, then start in the active profile */
+  for (i = 0; i < PROF_REG_NUM; i++)
+    lsm6dsox_read_reg(&dev_ctx, prof_reg[i], &mgr.shadow[i], 1);
+
+  /* FIFO_CTRL2: ODRCHG_EN */
+  mgr.shadow[1] |= 0x10U;
+  lsm6dsox_write_reg(&dev_ctx, prof_reg[1], &mgr.shadow[1], 1);
+
+  odr_profile_apply(&mgr, PROFILE_ACTIVE);
+  lsm6dsox_timestamp_raw_get(&dev_ctx, &mgr.switch_tick);
+
+  /* Wait Events */
+  while (1) {
+    /* Check if Activity/Inactivity events */
+    lsm6dsox_all_sources_get(&dev_ctx, &all_source);
+
+    if (all_source.fifo_th) {
+      uint16_t num = 0;
+      lsm6dsox_fifo_tag_t reg_tag;
+      axis3bit16_t data_raw;
+      timestamp_sample_t ts_tick;
+
+      mgr.drains[mgr.profile]++;
+      lsm6dsox_fifo_data_level_get(&dev_ctx, &num);
+
+      while (num--) {
+        lsm6dsox_fifo_sensor_tag_get(&dev_ctx, &reg_tag);
+
+        switch (reg_tag) {
+          case LSM6DSOX_TIMESTAMP_TAG:
+            lsm6dsox_fifo_out_raw_get(&dev_ctx, ts_tick.byte);
+            ts_us = ts_tick.reg.tick * TS_LSB_US;
+            break;
+
+          case LSM6DSOX_CFG_CHANGE_TAG:
+            lsm6dsox_fifo_out_raw_get(&dev_ctx, data_raw.u8bit);
+            snprintf((char *)tx_buffer, sizeof(tx_buffer),
+                     "T %lu us: rate change\r\n", (unsigned long)ts_us);
+            tx_com(tx_buffer, strlen((char const *)tx_buffer));
+            break;
+
+          case LSM6DSOX_XL_NC_TAG:
+            lsm6dsox_fifo_out_raw_get(&dev_ctx, data_raw.u8bit);
+            snprintf((char *)tx_buffer, sizeof(tx_buffer),
+                     "T %lu us: XL %4.2f\t%4.2f\t%4.2f mg\r\n",
+                     (unsigned long)ts_us,
+                     lsm6dsox_from_fs2_to_mg(data_raw.i16bit[0]),
+                     lsm6dsox_from_fs2_to_mg(data_raw.i16bit[1]),
+                     lsm6dsox_from_fs2_to_mg(data_raw.i16bit[2]));
+            tx_com(tx_buffer, strlen((char const *)tx_buffer));
+            break;
+
+          case LSM6DSOX_GYRO_NC_TAG:
+            lsm6dsox_fifo_out_raw_get(&dev_ctx, data_raw.u8bit);
+            snprintf((char *)tx_buffer, sizeof(tx_buffer),
+                     "T %lu us: G %4.2f\t%4.2f\t%4.2f mdps\r\n",
+                     (unsigned long)ts_us,
+                     lsm6dsox_from_fs250_to_mdps(data_raw.i16bit[0]),
+                     lsm6dsox_from_fs250_to_mdps(data_raw.i16bit[1]),
+                     lsm6dsox_from_fs250_to_mdps(data_raw.i16bit[2]));
+            tx_com(tx_buffer, strlen((char const *)tx_buffer));
+            break;
+
+          default:
+            /* Flush unused samples */
+            lsm6dsox_fifo_out_raw_get(&dev_ctx, data_raw.u8bit);
+            break;
+        }
+      }
+    }
+
+    if (!all_source.sleep_change)
+      continue;
+
+    next = all_source.sleep_state ? PROFILE_IDLE : PROFILE_ACTIVE;
+    if (next == mgr.profile)
+      continue;
+
+    lsm6dsox_timestamp_raw_get(&dev_ctx, &now);
+    mgr.residency[mgr.profile] += now - mgr.switch_tick;
+    mgr.switch_tick = now;
+
+    writes = odr_profile_apply(&mgr, next);
+    mgr.writes += writes;
+    mgr.switches++;
+
+    snprintf((char *)tx_buffer, sizeof(tx_buffer),
+             "%s profile (%d write transactions)\r\n",
+             profile[next].name, writes);
+    tx_com(tx_buffer, strlen((char const *)tx_buffer));
+    odr_mgr_report(&mgr);
+  }
+}
+
+/*
+ * @brief  Write generic device register (platform dependent)
+ *
+ * @param  handle    customizable argument. In this examples is used in
+ *                   order to select the correct sensor bus handler.
+ * @param  reg       register to write
+ * @param  bufp      pointer to data to write in register reg
+ * @param  len       number of consecutive register to write
+ *
+ */
+static int32_t platform_write(void *handle, uint8_t reg, const uint8_t *bufp,
+                              uint16_t len)
+{
+#if defined(NUCLEO_F401RE)
+  HAL_I2C_Mem_Write(handle, LSM6DSOX_I2C_ADD_L, reg,
+                    I2C_MEMADD_SIZE_8BIT, (uint8_t*) bufp, len, 1000);
+#elif defined(STEVAL_MKI109V3)
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_RESET);
+  HAL_SPI_Transmit(handle, &reg, 1, 1000);
+  HAL_SPI_Transmit(handle, (uint8_t*) bufp, len, 1000);
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_SET);
+#elif defined(SPC584B_DIS)
+  i2c_lld_write(handle,  LSM6DSOX_I2C_ADD_L & 0xFE, reg, (uint8_t*) bufp, len);
+#endif
+  return 0;
+}
+
+/*
+ * @brief  Read generic device register (platform dependent)
+ *
+ * @param  handle    customizable argument. In this examples is used in
+ *                   order to select the correct sensor bus handler.
+ * @param  reg       register to read
+ * @param  bufp      pointer to buffer that store the data read
+ * @param  len       number of consecutive register to read
+ *
+ */
+static int32_t platform_read(void *handle, uint8_t reg, uint8_t *bufp,
+                             uint16_t len)
+{
+#if defined(NUCLEO_F401RE)
+  HAL_I2C_Mem_Read(handle, LSM6DSOX_I2C_ADD_L, reg,
+                   I2C_MEMADD_SIZE_8BIT, bufp, len, 1000);
+#elif defined(STEVAL_MKI109V3)
+  reg |= 0x80;
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_RESET);
+  HAL_SPI_Transmit(handle, &reg, 1, 1000);
+  HAL_SPI_Receive(handle, bufp, len, 1000);
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_SET);
+#elif defined(SPC584B_DIS)
+  i2c_lld_read(handle, LSM6DSOX_I2C_ADD_L & 0xFE, reg, bufp, len);
+#endif
+  return 0;
+}
+
+/*
+ * @brief  platform specific outputs on terminal (platform dependent)
+ *
+ * @param  tx_buffer     buffer to transmit
+ * @param  len           number of byte to send
+ *
+ */
+static void tx_com(uint8_t *tx_buffer, uint16_t len)
+{
+#if defined(NUCLEO_F401RE)
+  HAL_UART_Transmit(&huart2, tx_buffer, len, 1000);
+#elif defined(STEVAL_MKI109V3)
+  CDC_Transmit_FS(tx_buffer, len);
+#elif defined(SPC584B_DIS)
+  sd_lld_write(&SD2, tx_buffer, len);
+#endif
+}
+
+/*
+ * @brief  platform specific delay (platform dependent)
+ *
+ * @param  ms        delay in ms
+ *
+ */
+static void platform_delay(uint32_t ms)
+{
+#if defined(NUCLEO_F401RE) | defined(STEVAL_MKI109V3)
+  HAL_Delay(ms);
+#elif defined(SPC584B_DIS)
+  osalThreadDelayMilliseconds(ms);
+#endif
+}
+
+/*
+ * @brief  platform specific initialization (platform dependent)
+ */
+static void platform_init(void)
+{
+#if defined(STEVAL_MKI109V3)
+  TIM3->CCR1 = PWM_3V3;
+  TIM3->CCR2 = PWM_3V3;
+  HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_1);
+  HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_2);
+  HAL_Delay(1000);
+#endif
+}
@@ -106,73 +106,9 @@
 #include "components.h"
 #endif
 
-/*
- * Programs can be extracted from ".ucf" configuration file generated
- * by Unico / Unicleo tool.
- *
- * This example contains 7 programs of the Finite State Machine:
- *    - glance
- *    - motion
- *    - no_motion
- *    - wakeup
- *    - pickup
- *    - orientation
- *    - wrist_tilt
- *
- */
-
-/* Program: glance */
-static const uint8_t lsm6sox_prg_glance[] = {
-  0xb2, 0x10, 0x24, 0x20, 0x17, 0x17, 0x66, 0x32,
-  0x66, 0x3c, 0x20, 0x20, 0x02, 0x02, 0x08, 0x08,
-  0x00, 0x04, 0x0c, 0x00, 0xc7, 0x66, 0x33, 0x73,
-  0x77, 0x64, 0x88, 0x75, 0x99, 0x66, 0x33, 0x53,
-  0x44, 0xf5, 0x22, 0x00,
-};
-
-/* Program: motion */
-static const uint8_t lsm6sox_prg_motion[] = {
-  0x51, 0x10, 0x16, 0x00, 0x00, 0x00, 0x66, 0x3c,
-  0x02, 0x00, 0x00, 0x7d, 0x00, 0xc7, 0x05, 0x99,
-  0x33, 0x53, 0x44, 0xf5, 0x22, 0x00,
-};
-
-/* Program: no_motion */
-static const uint8_t lsm6sox_prg_no_motion[] = {
-  0x51, 0x00, 0x10, 0x00, 0x00, 0x00, 0x66, 0x3c,
-  0x02, 0x00, 0x00, 0x7d, 0xff, 0x53, 0x99, 0x50,
-};
-/* Program: wakeup */
-static const uint8_t lsm6sox_prg_wakeup[] = {
-  0xe2, 0x00, 0x1e, 0x20, 0x13, 0x15, 0x66, 0x3e,
-  0x66, 0xbe, 0xcd, 0x3c, 0xc0, 0xc0, 0x02, 0x02,
-  0x0b, 0x10, 0x05, 0x66, 0xcc, 0x35, 0x38, 0x35,
-  0x77, 0xdd, 0x03, 0x54, 0x22, 0x00,
-};
-
-/* Program: pickup */
-static const uint8_t lsm6sox_prg_pickup[] = {
-  0x51, 0x00, 0x10, 0x00, 0x00, 0x00, 0x33, 0x3c,
-  0x02, 0x00, 0x00, 0x05, 0x05, 0x99, 0x30, 0x00,
-};
-
-/* Program: orientation */
-static const uint8_t lsm6sox_prg_orientation[] = {
-  0x91, 0x10, 0x16, 0x00, 0x00, 0x00, 0x66, 0x3a,
-  0x66, 0x32, 0xf0, 0x00, 0x00, 0x0d, 0x00, 0xc7,
-  0x05, 0x73, 0x99, 0x08, 0xf5, 0x22,
-};
-
-/* Program: wrist_tilt */
-static const uint8_t lsm6sox_prg_wrist_tilt[] = {
-  0x52, 0x00, 0x14, 0x00, 0x00, 0x00, 0xae, 0xb7,
-  0x80, 0x00, 0x00, 0x06, 0x0f, 0x05, 0x73, 0x33,
-  0x07, 0x54, 0x44, 0x22,
-};
-
-/*
- * End of lsm6dsox_prg_defs.h
- */
+/* FSM programs (glance, motion, no_motion, wakeup, pickup, orientation,
+ * wrist_tilt) */
+#include "lsm6dsox_prg_defs.h"
 
 /* Private macro -------------------------------------------------------------*/
 #define    BOOT_TIME            10 //ms
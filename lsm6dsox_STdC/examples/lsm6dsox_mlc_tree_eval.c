@@ -0,0 +1,370 @@
+/*
+ ******************************************************************************
+ * @file    mlc_tree_eval.c
+ * @author  Sensors Software Solution Team
+ * @brief   This file shows how to evaluate an MLC decision tree in software
+ *          and compare it with the device output.
+ *
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2020 STMicroelectronics.
+ * All rights reserved.</center></h2>
+ *
+ * This software component is licensed by ST under BSD 3-Clause license,
+ * the "License"; You may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at:
+ *                        opensource.org/licenses/BSD-3-Clause
+ *
+ ******************************************************************************
+ */
+
+/*
+ * Some MLC examples are available at:
+ * https://github.com/STMicroelectronics/STMems_Machine_Learning_Core
+ * the same repository is linked to this repository in folder "_resources"
+ *
+ * For more information about Machine Learning Core tool please refer
+ * to AN5259 "LSM6DSOX: Machine Learning Core".
+ *
+ * This example was developed using the following STMicroelectronics
+ * evaluation boards:
+ *
+ * - STEVAL_MKI109V3 + STEVAL-MKI197V1
+ * - NUCLEO_F401RE + STEVAL-MKI197V1
+ * - DISCOVERY_SPC584B + STEVAL-MKI197V1
+ *
+ * Used interfaces:
+ *
+ * STEVAL_MKI109V3    - Host side:   USB (Virtual COM)
+ *                    - Sensor side: SPI(Default) / I2C(supported)
+ *
+ * NUCLEO_STM32F401RE - Host side: UART(COM) to USB bridge
+ *                    - Sensor side: I2C(Default) / SPI(supported)
+ *
+ * DISCOVERY_SPC584B  - Host side: UART(COM) to USB bridge
+ *                    - Sensor side: I2C(Default) / SPI(supported)
+ *
+ * If you need to run this example on a different hardware platform a
+ * modification of the functions: `platform_write`, `platform_read`,
+ * `tx_com` and 'platform_init' is required.
+ *
+ */
+
+/* STMicroelectronics evaluation boards definition
+ *
+ * Please uncomment ONLY the evaluation boards in use.
+ * If a different hardware is used please comment all
+ * following target board and redefine yours.
+ */
+
+//#define STEVAL_MKI109V3  /* little endian */
+//#define NUCLEO_F401RE    /* little endian */
+//#define SPC584B_DIS      /* big endian */
+
+/* ATTENTION: By default the driver is little endian. If you need switch
+ *            to big endian please see "Endianness definitions" in the
+ *            header file of the driver (_reg.h).
+ */
+
+#if defined(STEVAL_MKI109V3)
+/* MKI109V3: Define communication interface */
+#define SENSOR_BUS hspi2
+/* MKI109V3: Vdd and Vddio power supply values */
+#define PWM_3V3 915
+
+#elif defined(NUCLEO_F401RE)
+/* NUCLEO_F401RE: Define communication interface */
+#define SENSOR_BUS hi2c1
+
+#elif defined(SPC584B_DIS)
+/* DISCOVERY_SPC584B: Define communication interface */
+#define SENSOR_BUS I2CD1
+
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+
+#include "lsm6dsox_vibration_monitoring.h"
+#include "lsm6dsox_reg.h"
+/* Generated by _prj_Linux/mlc_tree_gen.c from lsm6dsox_vibration_monitoring_dectree.txt */
+#include "lsm6dsox_vibration_monitoring_tree.h"
+
+#if defined(NUCLEO_F401RE)
+#include "stm32f4xx_hal.h"
+#include "usart.h"
+#include "gpio.h"
+#include "i2c.h"
+
+#elif defined(STEVAL_MKI109V3)
+#include "stm32f4xx_hal.h"
+#include "usbd_cdc_if.h"
+#include "gpio.h"
+#include "spi.h"
+#include "tim.h"
+
+#elif defined(SPC584B_DIS)
+#include "components.h"
+#endif
+
+/* Private macro -------------------------------------------------------------*/
+#define    BOOT_TIME            10 //ms
+
+/* Accelerometer sensitivity at 4 g full scale [g/LSB] */
+#define    XL_SENS_G            0.000122f
+
+/* Uncomment to print samples and mlc_out for the host replay (_prj_Linux/mlc_tree_replay.c) */
+//#define MLC_LOG
+
+/* Private variables ---------------------------------------------------------*/
+static uint8_t whoamI, rst;
+static uint8_t tx_buffer[1000];
+static mlc_eval_t eval;
+
+/* Extern variables ----------------------------------------------------------*/
+
+/* Private functions ---------------------------------------------------------*/
+
+/*
+ *   WARNING:
+ *   Functions declare in this section are defined at the end of this file
+ *   and are strictly related to the hardware platform used.
+ *
+ */
+static int32_t platform_write(void *handle, uint8_t reg, const uint8_t *bufp,
+                              uint16_t len);
+static int32_t platform_read(void *handle, uint8_t reg, uint8_t *bufp,
+                             uint16_t len);
+static void platform_delay(uint32_t ms);
+static void tx_com( uint8_t *tx_buffer, uint16_t len );
+static void platform_init(void);
+
+
+#if defined(NUCLEO_F401RE) || defined(STEVAL_MKI109V3)
+/* Cycle counter used to profile the evaluator (Cortex-M DWT) */
+static void cycles_init(void)
+{
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+static uint32_t cycles_get(void)
+{
+  return DWT->CYCCNT;
+}
+
+static uint32_t cycles_per_s(void)
+{
+  return SystemCoreClock;
+}
+#else
+static void cycles_init(void) {}
+static uint32_t cycles_get(void) { return 0; }
+static uint32_t cycles_per_s(void) { return 0; }
+#endif
+
+/* Main Example --------------------------------------------------------------*/
+void lsm6dsox_mlc_tree_eval(void)
+{
+  /* Variable declaration */
+  stmdev_ctx_t dev_ctx;
+  uint8_t mlc_out[8];
+  uint32_t windows = 0, match = 0;
+  uint32_t cycles_sum = 0, samples = 0;
+  uint32_t i;
+  /* Initialize mems driver interface */
+  dev_ctx.write_reg = platform_write;
+  dev_ctx.read_reg  = platform_read;
+  dev_ctx.mdelay = platform_delay;
+  dev_ctx.handle    = &SENSOR_BUS;
+  /* Init test platform */
+  platform_init();
+  /* Wait sensor boot time */
+  platform_delay(BOOT_TIME);
+  /* Check device ID */
+  lsm6dsox_device_id_get(&dev_ctx, &whoamI);
+
+  if (whoamI != LSM6DSOX_ID)
+    while (1);
+
+  /* Restore default configuration */
+  lsm6dsox_reset_set(&dev_ctx, PROPERTY_ENABLE);
+
+  do {
+    lsm6dsox_reset_get(&dev_ctx, &rst);
+  } while (rst);
+
+  /* Start Machine Learning Core configuration */
+  for ( i = 0; i < (sizeof(lsm6dsox_vibration_monitoring) /
+                    sizeof(ucf_line_t) ); i++ ) {
+    lsm6dsox_write_reg(&dev_ctx, lsm6dsox_vibration_monitoring[i].address,
+                       (uint8_t *)&lsm6dsox_vibration_monitoring[i].data, 1);
+  }
+
+  /* End Machine Learning Core configuration */
+  /* Enable Block Data Update */
+  lsm6dsox_block_data_update_set(&dev_ctx, PROPERTY_ENABLE);
+  /* Set full scale (must match XL_SENS_G) */
+  lsm6dsox_xl_full_scale_set(&dev_ctx, LSM6DSOX_4g);
+  /* Set Output Data Rate equal to the MLC data rate */
+  lsm6dsox_xl_data_rate_set(&dev_ctx, LSM6DSOX_XL_ODR_26Hz);
+
+  eval.tree = lsm6dsox_vibration_monitoring_tree;
+  eval.window = LSM6DSOX_VIBRATION_MONITORING_TREE_WINDOW;
+  eval.sens = XL_SENS_G;
+  cycles_init();
+
+  /* Main loop: run the evaluator on the samples seen by the MLC */
+  while (1) {
+    int16_t raw[3];
+    uint32_t cycles;
+    uint8_t drdy, done;
+
+    lsm6dsox_xl_flag_data_ready_get(&dev_ctx, &drdy);
+
+    if (!drdy)
+      continue;
+
+    lsm6dsox_acceleration_raw_get(&dev_ctx, raw);
+
+#if defined(MLC_LOG)
+    snprintf((char *)tx_buffer, sizeof(tx_buffer), "xl,%d,%d,%d\r\n",
+             raw[0], raw[1], raw[2]);
+    tx_com(tx_buffer, strlen((char const *)tx_buffer));
+#endif
+
+    cycles = cycles_get();
+    done = mlc_eval_push(&eval, raw);
+    cycles_sum += cycles_get() - cycles;
+    samples++;
+
+    if (!done)
+      continue;
+
+    /* Device result of the same window (the MLC may lag one window) */
+    lsm6dsox_mlc_out_get(&dev_ctx, mlc_out);
+    windows++;
+
+#if defined(MLC_LOG)
+    snprintf((char *)tx_buffer, sizeof(tx_buffer), "mlc,%d\r\n", mlc_out[0]);
+    tx_com(tx_buffer, strlen((char const *)tx_buffer));
+#endif
+
+    if (mlc_out[0] == eval.out)
+      match++;
+
+    snprintf((char *)tx_buffer, sizeof(tx_buffer),
+             "mlc_out: device %02X eval %02X, match %lu/%lu, %lu samples/s\r\n",
+             mlc_out[0], eval.out, (unsigned long)match,
+             (unsigned long)windows,
+             (unsigned long)(cycles_sum ?
+                             ((uint64_t)cycles_per_s() * samples) / cycles_sum : 0));
+    tx_com(tx_buffer, strlen((char const *)tx_buffer));
+  }
+}
+
+/*
+ * @brief  Write generic device register (platform dependent)
+ *
+ * @param  handle    customizable argument. In this examples is used in
+ *                   order to select the correct sensor bus handler.
+ * @param  reg       register to write
+ * @param  bufp      pointer to data to write in register reg
+ * @param  len       number of consecutive register to write
+ *
+ */
+static int32_t platform_write(void *handle, uint8_t reg, const uint8_t *bufp,
+                              uint16_t len)
+{
+#if defined(NUCLEO_F401RE)
+  HAL_I2C_Mem_Write(handle, LSM6DSOX_I2C_ADD_L, reg,
+                    I2C_MEMADD_SIZE_8BIT, (uint8_t*) bufp, len, 1000);
+#elif defined(STEVAL_MKI109V3)
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_RESET);
+  HAL_SPI_Transmit(handle, &reg, 1, 1000);
+  HAL_SPI_Transmit(handle, (uint8_t*) bufp, len, 1000);
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_SET);
+#elif defined(SPC584B_DIS)
+  i2c_lld_write(handle,  LSM6DSOX_I2C_ADD_L & 0xFE, reg, (uint8_t*) bufp, len);
+#endif
+  return 0;
+}
+
+/*
+ * @brief  Read generic device register (platform dependent)
+ *
+ * @param  handle    customizable argument. In this examples is used in
+ *                   order to select the correct sensor bus handler.
+ * @param  reg       register to read
+ * @param  bufp      pointer to buffer that store the data read
+ * @param  len       number of consecutive register to read
+ *
+ */
+static int32_t platform_read(void *handle, uint8_t reg, uint8_t *bufp,
+                             uint16_t len)
+{
+#if defined(NUCLEO_F401RE)
+  HAL_I2C_Mem_Read(handle, LSM6DSOX_I2C_ADD_L, reg,
+                   I2C_MEMADD_SIZE_8BIT, bufp, len, 1000);
+#elif defined(STEVAL_MKI109V3)
+  reg |= 0x80;
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_RESET);
+  HAL_SPI_Transmit(handle, &reg, 1, 1000);
+  HAL_SPI_Receive(handle, bufp, len, 1000);
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_SET);
+#elif defined(SPC584B_DIS)
+  i2c_lld_read(handle, LSM6DSOX_I2C_ADD_L & 0xFE, reg, bufp, len);
+#endif
+  return 0;
+}
+
+/*
+ * @brief  platform specific outputs on terminal (platform dependent)
+ *
+ * @param  tx_buffer     buffer to transmit
+ * @param  len           number of byte to send
+ *
+ */
+static void tx_com(uint8_t *tx_buffer, uint16_t len)
+{
+#if defined(NUCLEO_F401RE)
+  HAL_UART_Transmit(&huart2, tx_buffer, len, 1000);
+#elif defined(STEVAL_MKI109V3)
+  CDC_Transmit_FS(tx_buffer, len);
+#elif defined(SPC584B_DIS)
+  sd_lld_write(&SD2, tx_buffer, len);
+#endif
+}
+
+/*
+ * @brief  platform specific delay (platform dependent)
+ *
+ * @param  ms        delay in ms
+ *
+ */
+static void platform_delay(uint32_t ms)
+{
+#if defined(NUCLEO_F401RE) | defined(STEVAL_MKI109V3)
+  HAL_Delay(ms);
+#elif defined(SPC584B_DIS)
+  osalThreadDelayMilliseconds(ms);
+#endif
+}
+
+/*
+ * @brief  platform specific initialization (platform dependent)
+ */
+static void platform_init(void)
+{
+#if defined(STEVAL_MKI109V3)
+  TIM3->CCR1 = PWM_3V3;
+  TIM3->CCR2 = PWM_3V3;
+  HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_1);
+  HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_2);
+  HAL_Delay(1000);
+#endif
+}
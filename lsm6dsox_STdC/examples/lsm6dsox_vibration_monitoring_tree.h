@@ -0,0 +1,18 @@
+/* Generated by mlc_tree_gen from lsm6dsox_vibration_monitoring_dectree.txt, do not edit */
+
+#ifndef LSM6DSOX_VIBRATION_MONITORING_TREE_H
+#define LSM6DSOX_VIBRATION_MONITORING_TREE_H
+
+#include "mlc_tree_eval.h"
+
+#define LSM6DSOX_VIBRATION_MONITORING_TREE_WINDOW 26
+
+static const mlc_node_t lsm6dsox_vibration_monitoring_tree[] = {
+  /*  0 */ { MLC_FEAT_PEAK_TO_PEAK, 4.70000000e-02f, 1, 2, 0 },
+  /*  1 */ { MLC_LEAF, 0.0f, 0, 0, 0 },
+  /*  2 */ { MLC_FEAT_VARIANCE, 1.50000000e-02f, 3, 4, 0 },
+  /*  3 */ { MLC_LEAF, 0.0f, 0, 0, 1 },
+  /*  4 */ { MLC_LEAF, 0.0f, 0, 0, 2 },
+};
+
+#endif /* LSM6DSOX_VIBRATION_MONITORING_TREE_H */
@@ -0,0 +1,151 @@
+/*
+ ******************************************************************************
+ * @file    mlc_tree_eval.h
+ * @author  Sensors Software Solution Team
+ * @brief   Software evaluator of an MLC decision tree on ACC_V features.
+ *
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2024 STMicroelectronics.
+ * All rights reserved.</center></h2>
+ *
+ * This software component is licensed by ST under BSD 3-Clause license,
+ * the "License"; You may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at:
+ *                        opensource.org/licenses/BSD-3-Clause
+ *
+ */
+
+/*
+ * The evaluator touches no bus: it is used on the device samples by
+ * lsm6dsox_mlc_tree_eval.c and on recorded samples by
+ * _prj_Linux/mlc_tree_replay.c. The tree table is generated from the
+ * decision tree file of the MLC tool by _prj_Linux/mlc_tree_gen.c.
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef MLC_TREE_EVAL_H
+#define MLC_TREE_EVAL_H
+
+#ifdef __cplusplus
+  extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <math.h>
+
+/* Leaf marker in the tree */
+#define MLC_LEAF             0xFFU
+
+/* Max depth walked before giving up (malformed tree) */
+#define MLC_DEPTH_MAX        64
+
+/* Features computed on the ACC_V (norm) input */
+typedef enum {
+  MLC_FEAT_MEAN,
+  MLC_FEAT_VARIANCE,
+  MLC_FEAT_ENERGY,
+  MLC_FEAT_PEAK_TO_PEAK,
+  MLC_FEAT_NUM,
+} mlc_feat_t;
+
+/*
+ * Decision tree node: "feature <= threshold" goes to left, else to
+ * right. A leaf has feat == MLC_LEAF and reports code in mlc_out.
+ */
+typedef struct {
+  uint8_t feat;
+  float_t th;
+  uint8_t left;
+  uint8_t right;
+  uint8_t code;
+} mlc_node_t;
+
+/* Evaluator state: running window accumulators */
+typedef struct {
+  const mlc_node_t *tree;
+  uint16_t window;            /* window length [samples] */
+  float_t sens;               /* accelerometer sensitivity [g/LSB] */
+  uint16_t n;
+  float_t sum, sum2, min, max;
+  float_t feat[MLC_FEAT_NUM];
+  uint8_t out;
+} mlc_eval_t;
+
+/*
+ * @brief  Evaluate the tree on the features of the last window
+ *
+ * @param  e         evaluator
+ * @retval           mlc_out code
+ *
+ */
+static inline uint8_t mlc_tree_run(const mlc_eval_t *e)
+{
+  const mlc_node_t *node = &e->tree[0];
+  uint8_t depth;
+
+  for (depth = 0; depth < MLC_DEPTH_MAX; depth++) {
+    if (node->feat == MLC_LEAF)
+      return node->code;
+
+    node = &e->tree[(e->feat[node->feat] <= node->th) ?
+                    node->left : node->right];
+  }
+
+  return 0;
+}
+
+/*
+ * @brief  Push one accelerometer sample into the evaluator
+ *
+ * Only running sums are kept, so a sample costs a few operations and
+ * the features are finalized once per window.
+ *
+ * @param  e         evaluator
+ * @param  raw       X, Y, Z raw accelerometer sample
+ * @retval           1 at the end of a window (e->out updated), 0 otherwise
+ *
+ */
+static inline uint8_t mlc_eval_push(mlc_eval_t *e, const int16_t *raw)
+{
+  float_t x = raw[0] * e->sens;
+  float_t y = raw[1] * e->sens;
+  float_t z = raw[2] * e->sens;
+  float_t v = sqrtf(x * x + y * y + z * z);
+  float_t mean;
+
+  if (e->n == 0) {
+    e->sum = 0.0f;
+    e->sum2 = 0.0f;
+    e->min = v;
+    e->max = v;
+  }
+
+  e->sum += v;
+  e->sum2 += v * v;
+  if (v < e->min)
+    e->min = v;
+  if (v > e->max)
+    e->max = v;
+
+  if (++e->n < e->window)
+    return 0;
+
+  mean = e->sum / e->window;
+  e->feat[MLC_FEAT_MEAN] = mean;
+  e->feat[MLC_FEAT_VARIANCE] = e->sum2 / e->window - mean * mean;
+  e->feat[MLC_FEAT_ENERGY] = e->sum2;
+  e->feat[MLC_FEAT_PEAK_TO_PEAK] = e->max - e->min;
+  e->out = mlc_tree_run(e);
+  e->n = 0;
+
+  return 1;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MLC_TREE_EVAL_H */
@@ -0,0 +1,277 @@
+/*
+ ******************************************************************************
+ * @file    clk_sync.h
+ * @author  Sensors Software Solution Team
+ * @brief   Mapping of sensor timestamps to the MCU time base.
+ *
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2024 STMicroelectronics.
+ * All rights reserved.</center></h2>
+ *
+ * This software component is licensed by ST under BSD 3-Clause license,
+ * the "License"; You may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at:
+ *                        opensource.org/licenses/BSD-3-Clause
+ *
+ */
+
+/*
+ * The filter touches no bus: it is used on the device by
+ * lsm6dsv16x_timestamp_sync.c and on a recorded trace or a simulated
+ * sensor by _prj_Linux/clk_sync_replay.c.
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef CLK_SYNC_H
+#define CLK_SYNC_H
+
+#ifdef __cplusplus
+  extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+/* MCU captures queued between interrupt and sample (power of 2) */
+#ifndef CLK_SYNC_RING
+#define CLK_SYNC_RING        64
+#endif
+
+/* Forgetting factor of the fit (about 1/(1 - CLK_SYNC_LAMBDA) points) */
+#ifndef CLK_SYNC_LAMBDA
+#define CLK_SYNC_LAMBDA      0.999
+#endif
+
+/*
+ * Points between two moves of the origin: keeps x - x0, y - y0 and the
+ * sums in the range where a double holds them exactly enough
+ */
+#ifndef CLK_SYNC_RECENTER
+#define CLK_SYNC_RECENTER    1024
+#endif
+
+/* Points before captures are checked against the fit */
+#define CLK_SYNC_SETTLE      16
+
+/*
+ * Clock sync of one sensor: MCU time y [MCU ticks] as a function of the
+ * sensor timestamp x [LSB], y = y0 + a + b * (x - x0), fitted by an
+ * exponentially weighted least squares over the sync points. Offset a
+ * and skew b track temperature drift of the sensor oscillator; memory
+ * and update cost are constant.
+ */
+typedef struct {
+  uint8_t init;
+  uint64_t x0, y0;
+  double s0, sx, sy, sxx, sxy;
+  double a, b;
+  uint32_t n;
+
+  /* residuals of the points against the fit before the update */
+  double res_sum2;
+  double res_max;
+  uint32_t res_n;
+} clk_sync_t;
+
+/* MCU captures of the data ready edges, written by the interrupt */
+typedef struct {
+  volatile uint64_t time[CLK_SYNC_RING];
+  volatile uint16_t head;
+  uint16_t tail;
+} clk_sync_ring_t;
+
+/*
+ * @brief  Queue the MCU capture of a data ready edge (interrupt context)
+ *
+ * @param  q         capture ring
+ * @param  y         MCU time [MCU ticks]
+ *
+ */
+static inline void clk_sync_capture(clk_sync_ring_t *q, uint64_t y)
+{
+  q->time[q->head % CLK_SYNC_RING] = y;
+  q->head++;
+}
+
+/*
+ * @brief  Map a sensor timestamp to MCU time
+ *
+ * @param  c         clock sync
+ * @param  x         sensor timestamp [LSB]
+ * @retval           MCU time [MCU ticks]
+ *
+ */
+static inline uint64_t clk_sync_map(const clk_sync_t *c, uint64_t x)
+{
+  return c->y0 + (uint64_t)llround(c->a + c->b * (double)(int64_t)(x - c->x0));
+}
+
+/*
+ * @brief  MCU ticks to microseconds, without overflow for any 64 bit time
+ *
+ * @param  t         MCU time [MCU ticks]
+ * @param  hz        MCU time base frequency [Hz]
+ * @retval           MCU time [us]
+ *
+ */
+static inline uint64_t clk_sync_ticks_to_us(uint64_t t, uint32_t hz)
+{
+  return (t / hz) * 1000000ULL + (t % hz) * 1000000ULL / hz;
+}
+
+/*
+ * @brief  Residual of a sync point against the current fit
+ *
+ * @param  c         clock sync
+ * @param  x         sensor timestamp [LSB]
+ * @param  y         MCU time [MCU ticks]
+ * @retval           y - fit(x) [MCU ticks]
+ *
+ */
+static inline double clk_sync_residual(const clk_sync_t *c, uint64_t x,
+                                       uint64_t y)
+{
+  return (double)(int64_t)(y - c->y0) -
+         (c->a + c->b * (double)(int64_t)(x - c->x0));
+}
+
+/*
+ * @brief  Move the origin of the fit to sensor time x
+ *
+ * The sums are shifted to the new origin, so the fit is unchanged:
+ * with dx' = dx - DX and dy' = dy - DY
+ *   sx'  = sx - DX s0
+ *   sy'  = sy - DY s0
+ *   sxx' = sxx - 2 DX sx + DX^2 s0
+ *   sxy' = sxy - DX sy - DY sx + DX DY s0
+ * where DY is the integer part of the fit at x.
+ *
+ * @param  c         clock sync
+ * @param  x         new origin [LSB]
+ *
+ */
+static inline void clk_sync_recenter(clk_sync_t *c, uint64_t x)
+{
+  double dx = (double)(int64_t)(x - c->x0);
+  double fit = c->a + c->b * dx;
+  int64_t iy = (int64_t)floor(fit);
+  double dy = (double)iy;
+
+  c->sxy += -dx * c->sy - dy * c->sx + dx * dy * c->s0;
+  c->sxx += -2.0 * dx * c->sx + dx * dx * c->s0;
+  c->sx -= dx * c->s0;
+  c->sy -= dy * c->s0;
+
+  c->x0 = x;
+  c->y0 += (uint64_t)iy;
+  c->a = fit - dy;
+}
+
+/*
+ * @brief  Add a sync point and update offset and skew
+ *
+ * @param  c         clock sync
+ * @param  x         sensor timestamp [LSB]
+ * @param  y         MCU time [MCU ticks]
+ * @param  b_nom     nominal skew [MCU ticks / LSB], used until two
+ *                   points are available
+ *
+ */
+static inline void clk_sync_update(clk_sync_t *c, uint64_t x, uint64_t y,
+                                   double b_nom)
+{
+  double dx, dy, det, r;
+
+  if (!c->init) {
+    memset(c, 0, sizeof(clk_sync_t));
+    c->init = 1;
+    c->x0 = x;
+    c->y0 = y;
+    c->b = b_nom;
+  }
+
+  if (c->n >= 2) {
+    r = fabs(clk_sync_residual(c, x, y));
+    c->res_sum2 += r * r;
+    if (r > c->res_max)
+      c->res_max = r;
+    c->res_n++;
+  }
+
+  dx = (double)(int64_t)(x - c->x0);
+  dy = (double)(int64_t)(y - c->y0);
+  c->s0 = CLK_SYNC_LAMBDA * c->s0 + 1.0;
+  c->sx = CLK_SYNC_LAMBDA * c->sx + dx;
+  c->sy = CLK_SYNC_LAMBDA * c->sy + dy;
+  c->sxx = CLK_SYNC_LAMBDA * c->sxx + dx * dx;
+  c->sxy = CLK_SYNC_LAMBDA * c->sxy + dx * dy;
+  c->n++;
+
+  det = c->s0 * c->sxx - c->sx * c->sx;
+  if (c->n >= 2 && det > 0.0) {
+    c->b = (c->s0 * c->sxy - c->sx * c->sy) / det;
+    c->a = (c->sy - c->b * c->sx) / c->s0;
+  } else {
+    c->a = dy - c->b * dx;
+  }
+
+  if (c->n % CLK_SYNC_RECENTER == 0)
+    clk_sync_recenter(c, x);
+}
+
+/*
+ * @brief  Pair a sample with its data ready capture and feed the fit
+ *
+ * Captures and samples are matched in order. Once the fit is settled,
+ * a capture more than half a period early belongs to a sample already
+ * lost (dropped) and one more than half a period late to a later sample
+ * (interrupt missed, kept for the next sample).
+ *
+ * @param  c         clock sync
+ * @param  q         capture ring
+ * @param  x         sensor timestamp of the sample [LSB]
+ * @param  half      half sample period [MCU ticks]
+ * @param  b_nom     nominal skew [MCU ticks / LSB]
+ * @retval           number of slips
+ *
+ */
+static inline uint32_t clk_sync_pair(clk_sync_t *c, clk_sync_ring_t *q,
+                                     uint64_t x, double half, double b_nom)
+{
+  uint32_t slips = 0;
+
+  if ((uint16_t)(q->head - q->tail) > CLK_SYNC_RING)
+    q->tail = q->head - CLK_SYNC_RING;
+
+  while (q->tail != q->head) {
+    uint64_t y = q->time[q->tail % CLK_SYNC_RING];
+    double r = c->init ? clk_sync_residual(c, x, y) : 0.0;
+
+    if (c->n > CLK_SYNC_SETTLE && r < -half) {
+      q->tail++;
+      slips++;
+      continue;
+    }
+
+    if (c->n > CLK_SYNC_SETTLE && r > half) {
+      slips++;
+      break;
+    }
+
+    clk_sync_update(c, x, y, b_nom);
+    q->tail++;
+    break;
+  }
+
+  return slips;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CLK_SYNC_H */
@@ -0,0 +1,888 @@
+/*
+ ******************************************************************************
+ * @file    lsm6dsv16x_bus_profile.c
+ * @author  Sensors Software Solution Team
+ * @brief   This file show how to profile the bus accesses of the driver
+ *          (per register counts, bytes, durations and delays).
+ *
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2020 STMicroelectronics.
+ * All rights reserved.</center></h2>
+ *
+ * This software component is licensed by ST under BSD 3-Clause license,
+ * the "License"; You may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at:
+ *                        opensource.org/licenses/BSD-3-Clause
+ *
+ ******************************************************************************
+ */
+
+/*
+ * This example was developed using the following STMicroelectronics
+ * evaluation boards:
+ *
+ * - STEVAL_MKI109V3 +
+ * - NUCLEO_F401RE + X-NUCLEO-IKS01A3
+ * - DISCOVERY_SPC584B +
+ * - NUCLEO_H503RB + X-NUCLEO-IKS4A1
+ * - Linux host (e.g. Raspberry Pi) + STEVAL-MKI227KA adapter
+ *
+ * Used interfaces:
+ *
+ * STEVAL_MKI109V3    - Host side:   USB (Virtual COM)
+ *                    - Sensor side: SPI(Default) / I2C(supported)
+ *
+ * NUCLEO_STM32F401RE - Host side: UART(COM) to USB bridge
+ *                    - Sensor side: I2C(Default) / SPI(supported)
+ *
+ * DISCOVERY_SPC584B  - Host side: UART(COM) to USB bridge
+ *                    - Sensor side: I2C(Default) / SPI(supported)
+ *
+ * NUCLEO_STM32H503RG - Host side: UART(COM) to USB bridge
+ *                    - Sensor side: I3C(Default)
+ *
+ * LINUX_I2C_DEV      - Host side:   stdout
+ *                    - Sensor side: /dev/i2c-N (I2C_RDWR, SMBus fallback)
+ *
+ * LINUX_SPIDEV       - Host side:   stdout
+ *                    - Sensor side: /dev/spidevB.C (SPI_IOC_MESSAGE)
+ *
+ * Linux builds need _prj_Linux/linux_platform.c and _prj_Linux in the
+ * include path (see _prj_Linux/README.md).
+ *
+ * If you need to run this example on a different hardware platform a
+ * modification of the functions: `platform_write`, `platform_read`,
+ * `tx_com` and 'platform_init' is required.
+ *
+ */
+
+/* STMicroelectronics evaluation boards definition
+ *
+ * Please uncomment ONLY the evaluation boards in use.
+ * If a different hardware is used please comment all
+ * following target board and redefine yours.
+ */
+
+//#define STEVAL_MKI109V3  /* little endian */
+//#define NUCLEO_F401RE    /* little endian */
+//#define SPC584B_DIS      /* big endian */
+//#define LINUX_I2C_DEV    /* little endian */
+//#define LINUX_SPIDEV     /* little endian */
+
+/* ATTENTION: By default the driver is little endian. If you need switch
+ *            to big endian please see "Endianness definitions" in the
+ *            header file of the driver (_reg.h).
+ */
+
+#if defined(STEVAL_MKI109V3)
+/* MKI109V3: Define communication interface */
+#define SENSOR_BUS hspi2
+/* MKI109V3: Vdd and Vddio power supply values */
+#define PWM_3V3 915
+
+#elif defined(NUCLEO_F401RE)
+/* NUCLEO_F401RE: Define communication interface */
+#define SENSOR_BUS hi2c1
+
+#elif defined(SPC584B_DIS)
+/* DISCOVERY_SPC584B: Define communication interface */
+#define SENSOR_BUS I2CD1
+
+#elif defined(NUCLEO_H503RB)
+/* NUCLEO_H503RB: Define communication interface */
+#define SENSOR_BUS hi3c1
+
+#elif defined(LINUX_I2C_DEV) || defined(LINUX_SPIDEV)
+/* Linux: Define communication interface (see linux_bus below) */
+#define SENSOR_BUS linux_bus
+#if defined(LINUX_I2C_DEV)
+#define LINUX_BUS_DEV "/dev/i2c-1"
+#else
+#define LINUX_BUS_DEV "/dev/spidev0.0"
+#endif
+/* Linux: SPI clock [Hz] */
+#define LINUX_SPI_HZ 10000000
+
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include <stdio.h>
+#include "lsm6dsv16x_reg.h"
+
+#if defined(NUCLEO_F401RE)
+#include "stm32f4xx_hal.h"
+#include "usart.h"
+#include "gpio.h"
+#include "i2c.h"
+
+#elif defined(STEVAL_MKI109V3)
+#include "stm32f4xx_hal.h"
+#include "usbd_cdc_if.h"
+#include "gpio.h"
+#include "spi.h"
+#include "tim.h"
+
+#elif defined(SPC584B_DIS)
+#include "components.h"
+
+#elif defined(NUCLEO_H503RB)
+#include "usart.h"
+#include "i3c.h"
+#include "i3c_api.h"
+#include <stdio.h>
+
+static uint8_t i3c_dyn_addr = 0x0A;
+
+#elif defined(LINUX_I2C_DEV) || defined(LINUX_SPIDEV)
+#include <stdlib.h>
+#include "linux_platform.h"
+
+/* Linux character device bus, FIFO slots of 7 bytes (TAG + 6 bytes) */
+static linux_bus_t linux_bus = LINUX_BUS_INIT(LINUX_BUS_DEV, LSM6DSV16X_I2C_ADD_L >> 1,
+                                               LINUX_SPI_HZ,
+                                               LSM6DSV16X_FIFO_DATA_OUT_TAG, 7);
+#endif
+
+/* Private macro -------------------------------------------------------------*/
+#define BOOT_TIME         10
+
+/*
+ * Comment to build without the profiler: the driver context then holds
+ * the platform functions, with no cost on the bus accesses.
+ */
+#define BUS_PROFILE
+
+/*
+ * Registers profiled (bank + address), power of two. Registers beyond
+ * PROF_REGS are counted together in the last row of the report.
+ */
+#define PROF_REGS         64
+
+/* Duration histogram: < 1 us, < 2 us, < 4 us, ... , >= 1024 us */
+#define PROF_BUCKETS      12
+
+/* Free entry of the profiler table */
+#define PROF_KEY_NONE     0xFFFFU
+
+/* Sensor hub target: LIS2MDL, WHO_AM_I register and value */
+#define SH_TARGET_I2C_ADD 0x3DU
+#define SH_TARGET_ID_REG  0x4FU
+#define SH_TARGET_ID      0x40U
+
+/* Accelerometer self test limits and number of samples averaged */
+#define MIN_ST_LIMIT_mg   50.0f
+#define MAX_ST_LIMIT_mg   1700.0f
+#define ST_SAMPLES        5
+
+/* Private types -------------------------------------------------------------*/
+#if defined(BUS_PROFILE)
+/*
+ * Statistics of one register. Registers are identified by bank and
+ * address: embedded functions and sensor hub registers share the
+ * addresses of the main page.
+ */
+typedef struct {
+  uint16_t key;               /* bank << 8 | address, PROF_KEY_NONE if free */
+  uint32_t reads;
+  uint32_t writes;
+  uint32_t bytes;
+  uint32_t max_ns;
+  uint64_t ns;
+  uint32_t delay_ms;          /* mdelay() following an access */
+  uint32_t hist[PROF_BUCKETS];
+} bus_prof_reg_t;
+
+/*
+ * Bus profiler: a driver context wrapping the read_reg / write_reg /
+ * mdelay of another one. Set enabled to 0 to pause it (a single test
+ * per bus access).
+ */
+typedef struct {
+  stmdev_ctx_t bus;           /* wrapped interface */
+  uint8_t enabled;
+  uint8_t bank_reg;           /* bank selection register */
+  uint8_t bank_mask;          /* bank selection bits */
+  uint8_t bank;               /* current bank */
+  bus_prof_reg_t *last;       /* last register accessed */
+  uint32_t delays;
+  uint64_t delay_ns;
+  uint64_t t_start;
+  bus_prof_reg_t reg[PROF_REGS + 1];
+} bus_prof_t;
+#endif
+
+/* Private variables ---------------------------------------------------------*/
+static uint8_t whoamI;
+static uint8_t tx_buffer[1000];
+
+#if defined(BUS_PROFILE)
+static bus_prof_t bus_prof;
+/* mdelay() has no handle: profiler in use */
+static bus_prof_t *bus_prof_active;
+#endif
+
+/* Extern variables ----------------------------------------------------------*/
+
+/* Private functions ---------------------------------------------------------*/
+
+/*
+ *   WARNING:
+ *   Functions declare in this section are defined at the end of this file
+ *   and are strictly related to the hardware platform used.
+ *
+ */
+static int32_t platform_write(void *handle, uint8_t reg, const uint8_t *bufp,
+                              uint16_t len);
+static int32_t platform_read(void *handle, uint8_t reg, uint8_t *bufp,
+                             uint16_t len);
+static void tx_com( uint8_t *tx_buffer, uint16_t len );
+static void platform_delay(uint32_t ms);
+static void platform_init(void *handle);
+
+#if defined(BUS_PROFILE)
+static uint64_t platform_time_ns(void);
+#endif
+
+/*
+ * @brief  Stop on a bus error (a failed read leaves a stale buffer)
+ *
+ * @param  what      transaction that failed
+ *
+ */
+static void bus_error(const char *what)
+{
+#if defined(LINUX_I2C_DEV) || defined(LINUX_SPIDEV)
+  fprintf(stderr, "%s: bus error\n", what);
+  exit(1);
+#else
+  (void)what;
+  while (1);
+#endif
+}
+
+#if defined(BUS_PROFILE)
+/*
+ * @brief  Clear the profiler statistics
+ *
+ * @param  p         profiler
+ *
+ */
+static void bus_prof_reset(bus_prof_t *p)
+{
+  uint16_t i;
+
+  memset(p->reg, 0, sizeof(p->reg));
+  for (i = 0; i < PROF_REGS; i++)
+    p->reg[i].key = PROF_KEY_NONE;
+
+  p->last = NULL;
+  p->delays = 0;
+  p->delay_ns = 0;
+  p->t_start = platform_time_ns();
+}
+
+/*
+ * @brief  Find (or add) the statistics of a register
+ *
+ * @param  p         profiler
+ * @param  reg       register address
+ * @retval           register statistics
+ *
+ */
+static bus_prof_reg_t *bus_prof_entry(bus_prof_t *p, uint8_t reg)
+{
+  /* The bank selection register is reachable from every bank */
+  uint16_t key = (reg == p->bank_reg) ? reg : ((uint16_t)p->bank << 8) | reg;
+  uint16_t h = (key ^ (key >> 8)) & (PROF_REGS - 1U);
+  uint16_t i;
+
+  for (i = 0; i < PROF_REGS; i++, h = (h + 1U) & (PROF_REGS - 1U)) {
+    if (p->reg[h].key == key)
+      return &p->reg[h];
+
+    if (p->reg[h].key == PROF_KEY_NONE) {
+      p->reg[h].key = key;
+      return &p->reg[h];
+    }
+  }
+
+  return &p->reg[PROF_REGS];
+}
+
+/*
+ * @brief  Account one bus access
+ *
+ * @param  p         profiler
+ * @param  reg       first register accessed
+ * @param  len       number of bytes
+ * @param  ns        duration of the access [ns]
+ * @param  write     0: read, 1: write
+ *
+ */
+static void bus_prof_add(bus_prof_t *p, uint8_t reg, uint16_t len,
+                         uint64_t ns, uint8_t write)
+{
+  bus_prof_reg_t *e = bus_prof_entry(p, reg);
+  uint32_t us = (uint32_t)(ns / 1000U);
+  uint8_t b = 0;
+
+  while (us != 0U && b < PROF_BUCKETS - 1U) {
+    us >>= 1;
+    b++;
+  }
+
+  if (write)
+    e->writes++;
+  else
+    e->reads++;
+
+  e->bytes += len;
+  e->ns += ns;
+  if (ns > e->max_ns)
+    e->max_ns = (uint32_t)ns;
+  e->hist[b]++;
+
+  p->last = e;
+}
+
+static int32_t bus_prof_read(void *handle, uint8_t reg, uint8_t *bufp,
+                             uint16_t len)
+{
+  bus_prof_t *p = handle;
+  uint64_t t;
+  int32_t ret;
+
+  if (!p->enabled)
+    return p->bus.read_reg(p->bus.handle, reg, bufp, len);
+
+  t = platform_time_ns();
+  ret = p->bus.read_reg(p->bus.handle, reg, bufp, len);
+  bus_prof_add(p, reg, len, platform_time_ns() - t, 0);
+
+  return ret;
+}
+
+static int32_t bus_prof_write(void *handle, uint8_t reg, const uint8_t *bufp,
+                              uint16_t len)
+{
+  bus_prof_t *p = handle;
+  uint64_t t;
+  int32_t ret;
+
+  if (reg == p->bank_reg && len > 0U)
+    p->bank = bufp[0] & p->bank_mask;
+
+  if (!p->enabled)
+    return p->bus.write_reg(p->bus.handle, reg, bufp, len);
+
+  t = platform_time_ns();
+  ret = p->bus.write_reg(p->bus.handle, reg, bufp, len);
+  bus_prof_add(p, reg, len, platform_time_ns() - t, 1);
+
+  return ret;
+}
+
+static void bus_prof_delay(uint32_t ms)
+{
+  bus_prof_t *p = bus_prof_active;
+  uint64_t t = platform_time_ns();
+
+  p->bus.mdelay(ms);
+
+  if (!p->enabled)
+    return;
+
+  /* Charged to the register polled before waiting */
+  p->delays++;
+  p->delay_ns += platform_time_ns() - t;
+  if (p->last != NULL)
+    p->last->delay_ms += ms;
+}
+
+/*
+ * @brief  Profile a driver context: its bus functions are wrapped
+ *
+ * One profiled context at a time: mdelay() has no handle, so
+ * bus_prof_delay charges every delay to bus_prof_active. A second
+ * profiler is refused, the context is left unwrapped.
+ *
+ * @param  p         profiler
+ * @param  ctx       read / write interface definitions, modified
+ * @param  bank_reg  bank selection register (e.g. FUNC_CFG_ACCESS)
+ * @param  bank_mask bank selection bits in bank_reg
+ * @retval           0: attached, -1: another profiler is active
+ *
+ */
+static int32_t bus_prof_attach(bus_prof_t *p, stmdev_ctx_t *ctx,
+                               uint8_t bank_reg, uint8_t bank_mask)
+{
+  if (bus_prof_active != NULL && bus_prof_active != p)
+    return -1;
+
+  p->bus = *ctx;
+  p->bank_reg = bank_reg;
+  p->bank_mask = bank_mask;
+  p->bank = 0;
+  bus_prof_reset(p);
+
+  ctx->read_reg = bus_prof_read;
+  ctx->write_reg = bus_prof_write;
+  ctx->mdelay = bus_prof_delay;
+  ctx->handle = p;
+
+  bus_prof_active = p;
+  p->enabled = 1;
+
+  return 0;
+}
+
+/*
+ * @brief  Send the profiler statistics to console, then clear them
+ *
+ * Registers are listed by bus time, the histogram columns count the
+ * accesses by duration. Durations are 0 on platforms without
+ * platform_time_ns().
+ *
+ * @param  p         profiler
+ * @param  title     name of the profiled sequence
+ *
+ */
+static void bus_prof_report(bus_prof_t *p, const char *title)
+{
+  uint8_t order[PROF_REGS + 1];
+  uint64_t elapsed = platform_time_ns() - p->t_start;
+  uint64_t ns = 0;
+  uint32_t xfers = 0, bytes = 0;
+  uint16_t num = 0, i, j, b;
+  int n;
+
+  for (i = 0; i <= PROF_REGS; i++) {
+    bus_prof_reg_t *e = &p->reg[i];
+
+    if (e->reads == 0U && e->writes == 0U)
+      continue;
+
+    /* Insertion by bus time */
+    for (j = num; j > 0U && p->reg[order[j - 1U]].ns < e->ns; j--)
+      order[j] = order[j - 1U];
+    order[j] = (uint8_t)i;
+    num++;
+
+    xfers += e->reads + e->writes;
+    bytes += e->bytes;
+    ns += e->ns;
+  }
+
+  snprintf((char *)tx_buffer, sizeof(tx_buffer),
+           "--- %s: %lu ms, %lu accesses, %lu bytes, bus %lu us, %lu delays (%lu us)\r\n"
+           "bank reg   reads writes   bytes  bus [us] max [us] delay [ms] |"
+           "    <1    <2    <4    <8   <16   <32   <64  <128  <256  <512 <1024 >=1024 us\r\n",
+           title, (unsigned long)(elapsed / 1000000U), (unsigned long)xfers,
+           (unsigned long)bytes, (unsigned long)(ns / 1000U),
+           (unsigned long)p->delays, (unsigned long)(p->delay_ns / 1000U));
+  tx_com(tx_buffer, strlen((char const *)tx_buffer));
+
+  for (i = 0; i < num; i++) {
+    bus_prof_reg_t *e = &p->reg[order[i]];
+
+    if (order[i] == PROF_REGS)
+      n = snprintf((char *)tx_buffer, sizeof(tx_buffer), "  others");
+    else
+      n = snprintf((char *)tx_buffer, sizeof(tx_buffer), "  %02X  %02X",
+                   e->key >> 8, e->key & 0xFFU);
+
+    n += snprintf((char *)&tx_buffer[n], sizeof(tx_buffer) - n,
+                  " %7lu %6lu %7lu %9lu %8lu %10lu |",
+                  (unsigned long)e->reads, (unsigned long)e->writes,
+                  (unsigned long)e->bytes, (unsigned long)(e->ns / 1000U),
+                  (unsigned long)(e->max_ns / 1000U),
+                  (unsigned long)e->delay_ms);
+
+    for (b = 0; b < PROF_BUCKETS; b++)
+      n += snprintf((char *)&tx_buffer[n], sizeof(tx_buffer) - n, " %5lu",
+                    (unsigned long)e->hist[b]);
+
+    snprintf((char *)&tx_buffer[n], sizeof(tx_buffer) - n, "\r\n");
+    tx_com(tx_buffer, strlen((char const *)tx_buffer));
+  }
+
+  bus_prof_reset(p);
+}
+
+#else
+#define bus_prof_attach(p, ctx, bank_reg, bank_mask) 0
+#define bus_prof_report(p, title)
+#endif
+
+/*
+ * @brief  Read registers of a sensor hub target (as in
+ *         lsm6dsv16x_sensor_hub.c): the sensor hub read is triggered by
+ *         the accelerometer, then data ready and end of operation flags
+ *         are polled.
+ *
+ * @param  ctx       read / write interface definitions
+ * @param  i2c_add   target I2C address (8 bit)
+ * @param  reg       first target register to read
+ * @param  data      buffer for the data read
+ * @param  len       number of registers to read
+ * @retval           interface status
+ *
+ */
+static int32_t sh_target_read(stmdev_ctx_t *ctx, uint8_t i2c_add, uint8_t reg,
+                              uint8_t *data, uint16_t len)
+{
+  lsm6dsv16x_sh_cfg_read_t sh_cfg_read;
+  lsm6dsv16x_status_master_t master_status;
+  lsm6dsv16x_data_ready_t drdy;
+  int16_t raw_xl[3];
+  int32_t ret;
+
+  /* Disable accelerometer. */
+  lsm6dsv16x_xl_data_rate_set(ctx, LSM6DSV16X_ODR_OFF);
+
+  /* Configure Sensor Hub to read the target. */
+  sh_cfg_read.slv_add = (i2c_add & 0xFEU) >> 1; /* 7bit I2C address */
+  sh_cfg_read.slv_subadd = reg;
+  sh_cfg_read.slv_len = len;
+  ret = lsm6dsv16x_sh_slv_cfg_read(ctx, 0, &sh_cfg_read);
+  lsm6dsv16x_sh_slave_connected_set(ctx, LSM6DSV16X_SLV_0_1);
+
+  /* Enable I2C Master. */
+  lsm6dsv16x_sh_master_set(ctx, PROPERTY_ENABLE);
+
+  /* Enable accelerometer to trigger Sensor Hub operation. */
+  lsm6dsv16x_xl_data_rate_set(ctx, LSM6DSV16X_ODR_AT_120Hz);
+
+  /* Wait Sensor Hub operation flag set. */
+  lsm6dsv16x_acceleration_raw_get(ctx, raw_xl);
+
+  do {
+    ctx->mdelay(20);
+    lsm6dsv16x_flag_data_ready_get(ctx, &drdy);
+  } while (!drdy.drdy_xl);
+
+  do {
+    lsm6dsv16x_sh_status_get(ctx, &master_status);
+  } while (!master_status.sens_hub_endop);
+
+  /* Disable I2C master and XL (trigger). */
+  lsm6dsv16x_sh_master_set(ctx, PROPERTY_DISABLE);
+  lsm6dsv16x_xl_data_rate_set(ctx, LSM6DSV16X_ODR_OFF);
+
+  /* Read SensorHub registers. */
+  ret += lsm6dsv16x_sh_read_data_raw_get(ctx, data, (uint8_t)len);
+
+  return ret;
+}
+
+/*
+ * @brief  Average ST_SAMPLES accelerometer samples (as in
+ *         lsm6dsv16x_self_test.c, data ready polled with no delay)
+ *
+ * @param  ctx       read / write interface definitions
+ * @param  val       average [mg]
+ *
+ */
+static void xl_average(stmdev_ctx_t *ctx, float_t *val)
+{
+  lsm6dsv16x_data_ready_t drdy;
+  int16_t data_raw[3];
+  uint8_t i, j;
+
+  /* Read dummy data and discard it */
+  do {
+    lsm6dsv16x_flag_data_ready_get(ctx, &drdy);
+  } while (!drdy.drdy_xl);
+  if (lsm6dsv16x_acceleration_raw_get(ctx, data_raw) != 0)
+    bus_error("accelerometer read");
+
+  memset(val, 0x00, 3 * sizeof(float_t));
+
+  for (i = 0; i < ST_SAMPLES; i++) {
+    do {
+      lsm6dsv16x_flag_data_ready_get(ctx, &drdy);
+    } while (!drdy.drdy_xl);
+
+    if (lsm6dsv16x_acceleration_raw_get(ctx, data_raw) != 0)
+      bus_error("accelerometer read");
+
+    for (j = 0; j < 3; j++)
+      val[j] += lsm6dsv16x_from_fs4_to_mg(data_raw[j]) / ST_SAMPLES;
+  }
+}
+
+/* Main Example --------------------------------------------------------------*/
+void lsm6dsv16x_bus_profile(void)
+{
+  lsm6dsv16x_reset_t rst;
+  stmdev_ctx_t dev_ctx;
+  float_t val_st_off[3];
+  float_t val_st_on[3];
+  float_t test_val;
+  uint8_t target_id = 0;
+  uint8_t st_pass = 1;
+  uint8_t i;
+
+  /* Initialize mems driver interface */
+  dev_ctx.write_reg = platform_write;
+  dev_ctx.read_reg = platform_read;
+  dev_ctx.mdelay = platform_delay;
+  dev_ctx.handle = &SENSOR_BUS;
+
+  /* Init test platform */
+  platform_init(dev_ctx.handle);
+  /* Wait sensor boot time */
+  platform_delay(BOOT_TIME);
+
+  /* Profile all the driver accesses from here */
+  if (bus_prof_attach(&bus_prof, &dev_ctx, LSM6DSV16X_FUNC_CFG_ACCESS,
+                      0xC0U) != 0) {
+    snprintf((char *)tx_buffer, sizeof(tx_buffer),
+             "bus profiler already in use, not profiled\r\n");
+    tx_com(tx_buffer, strlen((char const *)tx_buffer));
+  }
+
+  /* Check device ID */
+  if (lsm6dsv16x_device_id_get(&dev_ctx, &whoamI) != 0)
+    bus_error("WHO_AM_I read");
+
+  if (whoamI != LSM6DSV16X_ID) {
+#if defined(LINUX_I2C_DEV) || defined(LINUX_SPIDEV)
+    fprintf(stderr, "WHO_AM_I 0x%02X, expected 0x%02X\n", whoamI,
+            LSM6DSV16X_ID);
+    exit(1);
+#else
+    while (1);
+#endif
+  }
+
+  /* Restore default configuration */
+  lsm6dsv16x_reset_set(&dev_ctx, LSM6DSV16X_RESTORE_CTRL_REGS);
+  do {
+    lsm6dsv16x_reset_get(&dev_ctx, &rst);
+  } while (rst != LSM6DSV16X_READY);
+
+  /* Enable Block Data Update */
+  lsm6dsv16x_block_data_update_set(&dev_ctx, PROPERTY_ENABLE);
+
+  bus_prof_report(&bus_prof, "reset");
+
+  /*
+   * Sensor hub: one target register read
+   */
+  if (sh_target_read(&dev_ctx, SH_TARGET_I2C_ADD, SH_TARGET_ID_REG,
+                     &target_id, 1) != 0)
+    bus_error("sensor hub read");
+
+  snprintf((char *)tx_buffer, sizeof(tx_buffer),
+           "Sensor hub target ID 0x%02X (%s)\r\n", target_id,
+           (target_id == SH_TARGET_ID) ? "ok" : "not found");
+  tx_com(tx_buffer, strlen((char const *)tx_buffer));
+
+  bus_prof_report(&bus_prof, "sensor hub read");
+
+  /*
+   * Accelerometer self test
+   */
+  lsm6dsv16x_xl_data_rate_set(&dev_ctx, LSM6DSV16X_ODR_AT_60Hz);
+  lsm6dsv16x_xl_full_scale_set(&dev_ctx, LSM6DSV16X_4g);
+  /* Wait stable output */
+  dev_ctx.mdelay(100);
+  xl_average(&dev_ctx, val_st_off);
+
+  lsm6dsv16x_xl_self_test_set(&dev_ctx, LSM6DSV16X_XL_ST_NEGATIVE);
+  /* Wait stable output */
+  dev_ctx.mdelay(100);
+  xl_average(&dev_ctx, val_st_on);
+
+  lsm6dsv16x_xl_self_test_set(&dev_ctx, LSM6DSV16X_XL_ST_DISABLE);
+  lsm6dsv16x_xl_data_rate_set(&dev_ctx, LSM6DSV16X_ODR_OFF);
+
+  for (i = 0; i < 3; i++) {
+    test_val = fabsf(val_st_on[i] - val_st_off[i]);
+
+    if ((MIN_ST_LIMIT_mg > test_val) || (test_val > MAX_ST_LIMIT_mg))
+      st_pass = 0;
+  }
+
+  snprintf((char *)tx_buffer, sizeof(tx_buffer), "Self Test XL - %s\r\n",
+           st_pass ? "PASS" : "FAIL");
+  tx_com(tx_buffer, strlen((char const *)tx_buffer));
+
+  bus_prof_report(&bus_prof, "accelerometer self test");
+}
+
+/*
+ * @brief  Write generic device register (platform dependent)
+ *
+ * @param  handle    customizable argument. In this examples is used in
+ *                   order to select the correct sensor bus handler.
+ * @param  reg       register to write
+ * @param  bufp      pointer to data to write in register reg
+ * @param  len       number of consecutive register to write
+ *
+ */
+static int32_t platform_write(void *handle, uint8_t reg, const uint8_t *bufp,
+                              uint16_t len)
+{
+  int32_t ret = 0;
+
+#if defined(NUCLEO_F401RE)
+  HAL_I2C_Mem_Write(handle, LSM6DSV16X_I2C_ADD_L, reg,
+                    I2C_MEMADD_SIZE_8BIT, (uint8_t*) bufp, len, 1000);
+#elif defined(STEVAL_MKI109V3)
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_RESET);
+  HAL_SPI_Transmit(handle, &reg, 1, 1000);
+  HAL_SPI_Transmit(handle, (uint8_t*) bufp, len, 1000);
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_SET);
+#elif defined(SPC584B_DIS)
+  i2c_lld_write(handle,  LSM6DSV16X_I2C_ADD_H & 0xFE, reg, (uint8_t*) bufp, len);
+#elif defined(NUCLEO_H503RB)
+  i3c_write(handle, i3c_dyn_addr, reg, (uint8_t*) bufp, len);
+#elif defined(LINUX_I2C_DEV)
+  ret = linux_i2c_write(handle, reg, bufp, len);
+#elif defined(LINUX_SPIDEV)
+  ret = linux_spi_write(handle, reg, bufp, len);
+#endif
+
+  return ret;
+}
+
+/*
+ * @brief  Read generic device register (platform dependent)
+ *
+ * @param  handle    customizable argument. In this examples is used in
+ *                   order to select the correct sensor bus handler.
+ * @param  reg       register to read
+ * @param  bufp      pointer to buffer that store the data read
+ * @param  len       number of consecutive register to read
+ *
+ */
+static int32_t platform_read(void *handle, uint8_t reg, uint8_t *bufp,
+                             uint16_t len)
+{
+  int32_t ret = 0;
+
+#if defined(NUCLEO_F401RE)
+  HAL_I2C_Mem_Read(handle, LSM6DSV16X_I2C_ADD_L, reg,
+                   I2C_MEMADD_SIZE_8BIT, bufp, len, 1000);
+#elif defined(STEVAL_MKI109V3)
+  reg |= 0x80;
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_RESET);
+  HAL_SPI_Transmit(handle, &reg, 1, 1000);
+  HAL_SPI_Receive(handle, bufp, len, 1000);
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_SET);
+#elif defined(SPC584B_DIS)
+  i2c_lld_read(handle, LSM6DSV16X_I2C_ADD_H & 0xFE, reg, bufp, len);
+#elif defined(NUCLEO_H503RB)
+  i3c_read(handle, i3c_dyn_addr, reg, bufp, len);
+#elif defined(LINUX_I2C_DEV)
+  ret = linux_i2c_read(handle, reg, bufp, len);
+#elif defined(LINUX_SPIDEV)
+  ret = linux_spi_read(handle, reg, bufp, len);
+#endif
+
+  return ret;
+}
+
+/*
+ * @brief  Send buffer to console (platform dependent)
+ *
+ * @param  tx_buffer     buffer to transmit
+ * @param  len           number of byte to send
+ *
+ */
+static void tx_com(uint8_t *tx_buffer, uint16_t len)
+{
+#if defined(NUCLEO_F401RE)
+  HAL_UART_Transmit(&huart2, tx_buffer, len, 1000);
+#elif defined(STEVAL_MKI109V3)
+  CDC_Transmit_FS(tx_buffer, len);
+#elif defined(SPC584B_DIS)
+  sd_lld_write(&SD2, tx_buffer, len);
+#elif defined(NUCLEO_H503RB)
+  HAL_UART_Transmit(&huart3, tx_buffer, len, 1000);
+#elif defined(LINUX_I2C_DEV) || defined(LINUX_SPIDEV)
+  linux_tx_com(tx_buffer, len);
+#endif
+}
+
+/*
+ * @brief  platform specific delay (platform dependent)
+ *
+ * @param  ms        delay in ms
+ *
+ */
+static void platform_delay(uint32_t ms)
+{
+#if defined(NUCLEO_F401RE) || defined(STEVAL_MKI109V3) || defined(NUCLEO_H503RB)
+  HAL_Delay(ms);
+#elif defined(SPC584B_DIS)
+  osalThreadDelayMilliseconds(ms);
+#elif defined(LINUX_I2C_DEV) || defined(LINUX_SPIDEV)
+  linux_delay(ms);
+#endif
+}
+
+/*
+ * @brief  platform specific initialization (platform dependent)
+ */
+static void platform_init(void *handle)
+{
+#if defined(STEVAL_MKI109V3)
+  TIM3->CCR1 = PWM_3V3;
+  TIM3->CCR2 = PWM_3V3;
+  HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_1);
+  HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_2);
+  HAL_Delay(1000);
+
+#elif defined(NUCLEO_H503RB)
+  i3c_set_bus_frequency(handle, 1000000);
+  i3c_rstdaa(handle);
+  i3c_setdasa(handle, LSM6DSV16X_I2C_ADD_L, &i3c_dyn_addr, 1);
+  i3c_set_bus_frequency(handle, 12500000);
+
+#elif defined(LINUX_I2C_DEV)
+  linux_i2c_open(handle);
+
+#elif defined(LINUX_SPIDEV)
+  linux_spi_open(handle);
+
+#endif
+
+#if defined(NUCLEO_F401RE) || defined(STEVAL_MKI109V3)
+  /* Cycle counter used by platform_time_ns (Cortex-M DWT) */
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+}
+
+#if defined(BUS_PROFILE)
+/*
+ * @brief  platform specific monotonic time (platform dependent)
+ *
+ * @retval           time [ns], 0 if not available
+ *
+ */
+static uint64_t platform_time_ns(void)
+{
+#if defined(LINUX_I2C_DEV) || defined(LINUX_SPIDEV)
+  return linux_time_ns();
+#elif defined(NUCLEO_F401RE) || defined(STEVAL_MKI109V3)
+  /* 64-bit extension of the cycle counter, called often enough */
+  static uint64_t cycles;
+  static uint32_t last;
+  uint32_t now = DWT->CYCCNT;
+
+  cycles += now - last;
+  last = now;
+  return (cycles * 1000U) / (SystemCoreClock / 1000000U);
+#else
+  return 0;
+#endif
+}
+#endif
@@ -0,0 +1,445 @@
+/*
+ ******************************************************************************
+ * @file    lsm6dsv16x_fifo_capture.c
+ * @author  Sensors Software Solution Team
+ * @brief   This file show how to record the raw FIFO content to a capture
+ *          file and how to replay it through the driver FIFO functions.
+ *
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2020 STMicroelectronics.
+ * All rights reserved.</center></h2>
+ *
+ * This software component is licensed by ST under BSD 3-Clause license,
+ * the "License"; You may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at:
+ *                        opensource.org/licenses/BSD-3-Clause
+ *
+ ******************************************************************************
+ */
+
+/*
+ * This example was developed using the following STMicroelectronics
+ * evaluation boards:
+ *
+ * - Linux host (e.g. Raspberry Pi) + STEVAL-MKI227KA adapter
+ *
+ * Used interfaces:
+ *
+ * LINUX_I2C_DEV      - Host side:   stdout, capture file
+ *                    - Sensor side: /dev/i2c-N (I2C_RDWR, SMBus fallback)
+ *
+ * LINUX_SPIDEV       - Host side:   stdout, capture file
+ *                    - Sensor side: /dev/spidevB.C (SPI_IOC_MESSAGE)
+ *
+ * The capture file format is described in _prj_Linux/fifo_capture.h;
+ * build with _prj_Linux/fifo_capture.c, _prj_Linux/linux_platform.c and
+ * _prj_Linux in the include path. lsm6dsv16x_fifo_capture_replay needs
+ * no sensor.
+ *
+ * If you need to run this example on a different hardware platform a
+ * modification of the functions: `platform_write`, `platform_read`,
+ * `tx_com` and 'platform_init' is required.
+ *
+ */
+
+/* STMicroelectronics evaluation boards definition
+ *
+ * Please uncomment ONLY the evaluation boards in use.
+ * If a different hardware is used please comment all
+ * following target board and redefine yours.
+ */
+
+//#define LINUX_I2C_DEV    /* little endian */
+//#define LINUX_SPIDEV     /* little endian */
+
+/* ATTENTION: By default the driver is little endian. If you need switch
+ *            to big endian please see "Endianness definitions" in the
+ *            header file of the driver (_reg.h).
+ */
+
+#if defined(LINUX_I2C_DEV) || defined(LINUX_SPIDEV)
+/* Linux: Define communication interface (see linux_bus below) */
+#define SENSOR_BUS linux_bus
+#if defined(LINUX_I2C_DEV)
+#define LINUX_BUS_DEV "/dev/i2c-1"
+#else
+#define LINUX_BUS_DEV "/dev/spidev0.0"
+#endif
+/* Linux: SPI clock [Hz] */
+#define LINUX_SPI_HZ 10000000
+
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include <stdio.h>
+#include "lsm6dsv16x_reg.h"
+
+#if defined(LINUX_I2C_DEV) || defined(LINUX_SPIDEV)
+#include <stdlib.h>
+#include "linux_platform.h"
+#include "fifo_capture.h"
+
+/* Linux character device bus, FIFO slots of 7 bytes (TAG + 6 bytes) */
+static linux_bus_t linux_bus = LINUX_BUS_INIT(LINUX_BUS_DEV, LSM6DSV16X_I2C_ADD_L >> 1,
+                                               LINUX_SPI_HZ,
+                                               LSM6DSV16X_FIFO_DATA_OUT_TAG, 7);
+#endif
+
+/* Private macro -------------------------------------------------------------*/
+/*
+ * Select FIFO samples watermark, max value is 511
+ * in FIFO are stored acc, gyro and timestamp samples
+ */
+#define BOOT_TIME         10
+#define FIFO_WATERMARK    128
+
+/* FIFO slots read at most per drain, 7 bytes each (TAG + 6 bytes) */
+#define FIFO_MAX          512
+#define FIFO_SLOT_LEN     7
+
+/* Watermark polling period [ms] */
+#define POLL_MS           10
+
+/* Capture file, length and configuration registers saved in it */
+#define CAPTURE_FILE      "lsm6dsv16x_fifo.bin"
+#define CAPTURE_SECONDS   10
+#define SNAPSHOT_FIRST    LSM6DSV16X_FUNC_CFG_ACCESS
+#define SNAPSHOT_LAST     LSM6DSV16X_CTRL10
+
+/* Replay speed: 1.0 capture rate, 0 as fast as possible */
+#define REPLAY_SPEED      1.0
+
+/* Private variables ---------------------------------------------------------*/
+static uint8_t whoamI;
+static uint8_t tx_buffer[1000];
+static uint8_t fifo_buf[FIFO_MAX * FIFO_SLOT_LEN];
+
+/* Private variables ---------------------------------------------------------*/
+static int16_t *datax;
+static int16_t *datay;
+static int16_t *dataz;
+static int32_t *ts;
+
+/* Extern variables ----------------------------------------------------------*/
+
+/* Private functions ---------------------------------------------------------*/
+
+/*
+ *   WARNING:
+ *   Functions declare in this section are defined at the end of this file
+ *   and are strictly related to the hardware platform used.
+ *
+ */
+static int32_t platform_write(void *handle, uint8_t reg, const uint8_t *bufp,
+                              uint16_t len);
+static int32_t platform_read(void *handle, uint8_t reg, uint8_t *bufp,
+                             uint16_t len);
+static void tx_com( uint8_t *tx_buffer, uint16_t len );
+static void platform_delay(uint32_t ms);
+static void platform_init(void *handle);
+
+/*
+ * @brief  Stop on a bus error (a failed read leaves a stale buffer)
+ *
+ * @param  what      transaction that failed
+ *
+ */
+static void bus_error(const char *what)
+{
+  fprintf(stderr, "%s: bus error\n", what);
+  exit(1);
+}
+
+/*
+ * @brief  Stop if WHO_AM_I cannot be read or is not the expected one
+ *
+ * @param  ctx       read / write interface definitions
+ *
+ */
+static void device_id_check(stmdev_ctx_t *ctx)
+{
+  if (lsm6dsv16x_device_id_get(ctx, &whoamI) != 0)
+    bus_error("WHO_AM_I read");
+
+  if (whoamI != LSM6DSV16X_ID) {
+    fprintf(stderr, "WHO_AM_I 0x%02X, expected 0x%02X\n", whoamI,
+            LSM6DSV16X_ID);
+    exit(1);
+  }
+}
+
+/* Main Example --------------------------------------------------------------*/
+/* Record the raw FIFO content to CAPTURE_FILE */
+void lsm6dsv16x_fifo_capture(void)
+{
+  uint8_t regs[SNAPSHOT_LAST - SNAPSHOT_FIRST + 1];
+  lsm6dsv16x_fifo_status_t fifo_status;
+  stmdev_ctx_t dev_ctx;
+  lsm6dsv16x_reset_t rst;
+  fifo_capture_t cap;
+  uint64_t t_end;
+
+  /* Initialize mems driver interface */
+  dev_ctx.write_reg = platform_write;
+  dev_ctx.read_reg = platform_read;
+  dev_ctx.mdelay = platform_delay;
+  dev_ctx.handle = &SENSOR_BUS;
+
+  /* Init test platform */
+  platform_init(dev_ctx.handle);
+  /* Wait sensor boot time */
+  platform_delay(BOOT_TIME);
+
+  /* Check device ID */
+  device_id_check(&dev_ctx);
+
+  /* Restore default configuration */
+  lsm6dsv16x_reset_set(&dev_ctx, LSM6DSV16X_RESTORE_CTRL_REGS);
+  do {
+    lsm6dsv16x_reset_get(&dev_ctx, &rst);
+  } while (rst != LSM6DSV16X_READY);
+
+  /* Enable Block Data Update */
+  lsm6dsv16x_block_data_update_set(&dev_ctx, PROPERTY_ENABLE);
+
+  /* Set full scale */
+  lsm6dsv16x_xl_full_scale_set(&dev_ctx, LSM6DSV16X_2g);
+  lsm6dsv16x_gy_full_scale_set(&dev_ctx, LSM6DSV16X_2000dps);
+
+  /*
+   * Set FIFO watermark (number of unread sensor data TAG + 6 bytes
+   * stored in FIFO) to FIFO_WATERMARK samples
+   */
+  lsm6dsv16x_fifo_watermark_set(&dev_ctx, FIFO_WATERMARK);
+  /* Set FIFO batch XL/Gyro ODR to 960Hz */
+  lsm6dsv16x_fifo_xl_batch_set(&dev_ctx, LSM6DSV16X_XL_BATCHED_AT_960Hz);
+  lsm6dsv16x_fifo_gy_batch_set(&dev_ctx, LSM6DSV16X_GY_BATCHED_AT_960Hz);
+
+  /* Set FIFO mode to Stream mode (aka Continuous Mode) */
+  lsm6dsv16x_fifo_mode_set(&dev_ctx, LSM6DSV16X_STREAM_MODE);
+
+  /* Set Output Data Rate */
+  lsm6dsv16x_xl_data_rate_set(&dev_ctx, LSM6DSV16X_ODR_AT_960Hz);
+  lsm6dsv16x_gy_data_rate_set(&dev_ctx, LSM6DSV16X_ODR_AT_960Hz);
+  lsm6dsv16x_fifo_timestamp_batch_set(&dev_ctx, LSM6DSV16X_TMSTMP_DEC_8);
+  lsm6dsv16x_timestamp_set(&dev_ctx, PROPERTY_ENABLE);
+
+  /* Configuration snapshot (WHO_AM_I included) stored in the header */
+  if (lsm6dsv16x_read_reg(&dev_ctx, SNAPSHOT_FIRST, regs, sizeof(regs)) != 0)
+    bus_error("configuration read");
+  if (fifo_capture_open(&cap, CAPTURE_FILE, "lsm6dsv16x", whoamI,
+                        SNAPSHOT_FIRST, regs, sizeof(regs)) != 0)
+    exit(1);
+
+  t_end = fifo_capture_time_ns() + CAPTURE_SECONDS * 1000000000ULL;
+
+  while (fifo_capture_time_ns() < t_end) {
+    uint16_t num;
+
+    /* Read watermark flag */
+    if (lsm6dsv16x_fifo_status_get(&dev_ctx, &fifo_status) != 0)
+      bus_error("FIFO status read");
+
+    if (fifo_status.fifo_th == 0) {
+      platform_delay(POLL_MS);
+      continue;
+    }
+
+    /* Whole FIFO in one read, stored as it is */
+    num = fifo_status.fifo_level;
+    if (num > FIFO_MAX)
+      num = FIFO_MAX;
+    if (lsm6dsv16x_read_reg(&dev_ctx, LSM6DSV16X_FIFO_DATA_OUT_TAG, fifo_buf,
+                            num * FIFO_SLOT_LEN) != 0)
+      bus_error("FIFO read");
+    if (fifo_capture_append(&cap, fifo_buf, num, fifo_capture_time_ns()) != 0) {
+      /* Disk full or I/O error: keep what was written readable */
+      perror(CAPTURE_FILE);
+      fifo_capture_close(&cap);
+      exit(1);
+    }
+  }
+
+  snprintf((char *)tx_buffer, sizeof(tx_buffer),
+           "%s: %lu chunks, %llu slots\r\n", CAPTURE_FILE,
+           (unsigned long)cap.chunks, (unsigned long long)cap.slots);
+  tx_com(tx_buffer, strlen((char const *)tx_buffer));
+
+  fifo_capture_close(&cap);
+}
+
+/*
+ * Decode CAPTURE_FILE with the FIFO loop of lsm6dsv16x_fifo.c: the
+ * driver reads the capture through fifo_replay_read instead of the bus.
+ */
+void lsm6dsv16x_fifo_capture_replay(void)
+{
+  lsm6dsv16x_fifo_status_t fifo_status;
+  stmdev_ctx_t dev_ctx;
+  fifo_replay_t replay;
+
+  if (fifo_replay_open(&replay, CAPTURE_FILE) != 0)
+    exit(1);
+  replay.status_reg = LSM6DSV16X_FIFO_STATUS1;
+  replay.data_reg = LSM6DSV16X_FIFO_DATA_OUT_TAG;
+  replay.speed = REPLAY_SPEED;
+
+  /* Initialize mems driver interface on the capture */
+  dev_ctx.write_reg = fifo_replay_write;
+  dev_ctx.read_reg = fifo_replay_read;
+  dev_ctx.mdelay = platform_delay;
+  dev_ctx.handle = &replay;
+
+  /* Check device ID (from the configuration snapshot) */
+  device_id_check(&dev_ctx);
+
+  /* Wait samples */
+  while (1) {
+    uint16_t num = 0;
+
+    /* Read watermark flag */
+    if (lsm6dsv16x_fifo_status_get(&dev_ctx, &fifo_status) != 0)
+      bus_error("FIFO status read");
+
+    /* End of capture */
+    if (fifo_status.fifo_level == 0)
+      break;
+
+    if (fifo_status.fifo_th == 1) {
+      num = fifo_status.fifo_level;
+      snprintf((char *)tx_buffer, sizeof(tx_buffer), "-- FIFO num %d \r\n", num);
+      tx_com(tx_buffer, strlen((char const *)tx_buffer));
+
+      while (num--) {
+        lsm6dsv16x_fifo_out_raw_t f_data;
+        float_t ts_usec;
+
+        /* Read FIFO sensor value */
+        if (lsm6dsv16x_fifo_out_raw_get(&dev_ctx, &f_data) != 0)
+          bus_error("FIFO read");
+        datax = (int16_t *)&f_data.data[0];
+        datay = (int16_t *)&f_data.data[2];
+        dataz = (int16_t *)&f_data.data[4];
+        ts = (int32_t *)&f_data.data[0];
+
+        switch (f_data.tag) {
+        case LSM6DSV16X_XL_NC_TAG:
+          snprintf((char *)tx_buffer, sizeof(tx_buffer), "ACC [mg]:\t%4.2f\t%4.2f\t%4.2f\r\n",
+                  lsm6dsv16x_from_fs2_to_mg(*datax),
+                  lsm6dsv16x_from_fs2_to_mg(*datay),
+                  lsm6dsv16x_from_fs2_to_mg(*dataz));
+          tx_com(tx_buffer, strlen((char const *)tx_buffer));
+          break;
+        case LSM6DSV16X_GY_NC_TAG:
+          snprintf((char *)tx_buffer, sizeof(tx_buffer), "GYR [mdps]:\t%4.2f\t%4.2f\t%4.2f\r\n",
+                  lsm6dsv16x_from_fs2000_to_mdps(*datax),
+                  lsm6dsv16x_from_fs2000_to_mdps(*datay),
+                  lsm6dsv16x_from_fs2000_to_mdps(*dataz));
+          tx_com(tx_buffer, strlen((char const *)tx_buffer));
+          break;
+        case LSM6DSV16X_TIMESTAMP_TAG:
+          ts_usec = lsm6dsv16x_from_lsb_to_nsec(*ts)/1000;
+          snprintf((char *)tx_buffer, sizeof(tx_buffer), "TIMESTAMP %6.1f [us] (lsb: %d)\r\n", ts_usec, *ts);
+          tx_com(tx_buffer, strlen((char const *)tx_buffer));
+          break;
+        default:
+          break;
+        }
+      }
+    }
+  }
+
+  fifo_replay_close(&replay);
+}
+
+/*
+ * @brief  Write generic device register (platform dependent)
+ *
+ * @param  handle    customizable argument. In this examples is used in
+ *                   order to select the correct sensor bus handler.
+ * @param  reg       register to write
+ * @param  bufp      pointer to data to write in register reg
+ * @param  len       number of consecutive register to write
+ *
+ */
+static int32_t platform_write(void *handle, uint8_t reg, const uint8_t *bufp,
+                              uint16_t len)
+{
+  int32_t ret = 0;
+
+#if defined(LINUX_I2C_DEV)
+  ret = linux_i2c_write(handle, reg, bufp, len);
+#elif defined(LINUX_SPIDEV)
+  ret = linux_spi_write(handle, reg, bufp, len);
+#endif
+
+  return ret;
+}
+
+/*
+ * @brief  Read generic device register (platform dependent)
+ *
+ * @param  handle    customizable argument. In this examples is used in
+ *                   order to select the correct sensor bus handler.
+ * @param  reg       register to read
+ * @param  bufp      pointer to buffer that store the data read
+ * @param  len       number of consecutive register to read
+ *
+ */
+static int32_t platform_read(void *handle, uint8_t reg, uint8_t *bufp,
+                             uint16_t len)
+{
+  int32_t ret = 0;
+
+#if defined(LINUX_I2C_DEV)
+  ret = linux_i2c_read(handle, reg, bufp, len);
+#elif defined(LINUX_SPIDEV)
+  ret = linux_spi_read(handle, reg, bufp, len);
+#endif
+
+  return ret;
+}
+
+/*
+ * @brief  Send buffer to console (platform dependent)
+ *
+ * @param  tx_buffer     buffer to transmit
+ * @param  len           number of byte to send
+ *
+ */
+static void tx_com(uint8_t *tx_buffer, uint16_t len)
+{
+#if defined(LINUX_I2C_DEV) || defined(LINUX_SPIDEV)
+  linux_tx_com(tx_buffer, len);
+#endif
+}
+
+/*
+ * @brief  platform specific delay (platform dependent)
+ *
+ * @param  ms        delay in ms
+ *
+ */
+static void platform_delay(uint32_t ms)
+{
+#if defined(LINUX_I2C_DEV) || defined(LINUX_SPIDEV)
+  linux_delay(ms);
+#endif
+}
+
+/*
+ * @brief  platform specific initialization (platform dependent)
+ */
+static void platform_init(void *handle)
+{
+#if defined(LINUX_I2C_DEV)
+  linux_i2c_open(handle);
+
+#elif defined(LINUX_SPIDEV)
+  linux_spi_open(handle);
+
+#endif
+}
@@ -0,0 +1,617 @@
+/*
+ ******************************************************************************
+ * @file    lsm6dsv16x_fifo_cfg_change.c
+ * @author  Sensors Software Solution Team
+ * @brief   This file show how to decode FIFO data across ODR, BDR and
+ *          full scale changes using the CFG_CHANGE slots.
+ *
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2020 STMicroelectronics.
+ * All rights reserved.</center></h2>
+ *
+ * This software component is licensed by ST under BSD 3-Clause license,
+ * the "License"; You may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at:
+ *                        opensource.org/licenses/BSD-3-Clause
+ *
+ ******************************************************************************
+ */
+
+/*
+ * This example was developed using the following STMicroelectronics
+ * evaluation boards:
+ *
+ * - STEVAL_MKI109V3 +
+ * - NUCLEO_F401RE + X-NUCLEO-IKS01A3
+ * - DISCOVERY_SPC584B +
+ * - NUCLEO_H503RB + X-NUCLEO-IKS4A1
+ *
+ * Used interfaces:
+ *
+ * STEVAL_MKI109V3    - Host side:   USB (Virtual COM)
+ *                    - Sensor side: SPI(Default) / I2C(supported)
+ *
+ * NUCLEO_STM32F401RE - Host side: UART(COM) to USB bridge
+ *                    - Sensor side: I2C(Default) / SPI(supported)
+ *
+ * DISCOVERY_SPC584B  - Host side: UART(COM) to USB bridge
+ *                    - Sensor side: I2C(Default) / SPI(supported)
+ *
+ * NUCLEO_STM32H503RG - Host side: UART(COM) to USB bridge
+ *                    - Sensor side: I3C(Default)
+ *
+ * If you need to run this example on a different hardware platform a
+ * modification of the functions: `platform_write`, `platform_read`,
+ * `tx_com` and 'platform_init' is required.
+ *
+ */
+
+/* STMicroelectronics evaluation boards definition
+ *
+ * Please uncomment ONLY the evaluation boards in use.
+ * If a different hardware is used please comment all
+ * following target board and redefine yours.
+ */
+
+//#define STEVAL_MKI109V3  /* little endian */
+//#define NUCLEO_F401RE    /* little endian */
+//#define SPC584B_DIS      /* big endian */
+
+/* ATTENTION: By default the driver is little endian. If you need switch
+ *            to big endian please see "Endianness definitions" in the
+ *            header file of the driver (_reg.h).
+ */
+
+#if defined(STEVAL_MKI109V3)
+/* MKI109V3: Define communication interface */
+#define SENSOR_BUS hspi2
+/* MKI109V3: Vdd and Vddio power supply values */
+#define PWM_3V3 915
+
+#elif defined(NUCLEO_F401RE)
+/* NUCLEO_F401RE: Define communication interface */
+#define SENSOR_BUS hi2c1
+
+#elif defined(SPC584B_DIS)
+/* DISCOVERY_SPC584B: Define communication interface */
+#define SENSOR_BUS I2CD1
+
+#elif defined(NUCLEO_H503RB)
+/* NUCLEO_H503RB: Define communication interface */
+#define SENSOR_BUS hi3c1
+
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include <stdio.h>
+#include "lsm6dsv16x_reg.h"
+
+#if defined(NUCLEO_F401RE)
+#include "stm32f4xx_hal.h"
+#include "usart.h"
+#include "gpio.h"
+#include "i2c.h"
+
+#elif defined(STEVAL_MKI109V3)
+#include "stm32f4xx_hal.h"
+#include "usbd_cdc_if.h"
+#include "gpio.h"
+#include "spi.h"
+#include "tim.h"
+
+#elif defined(SPC584B_DIS)
+#include "components.h"
+
+#elif defined(NUCLEO_H503RB)
+#include "usart.h"
+#include "i3c.h"
+#include "i3c_api.h"
+#include <stdio.h>
+
+static uint8_t i3c_dyn_addr = 0x0A;
+#endif
+
+/* Private macro -------------------------------------------------------------*/
+#define    BOOT_TIME         10 //ms
+#define    FIFO_WATERMARK    64
+
+/* Number of FIFO drains between two configuration steps */
+#define    STEP_DRAINS       8
+
+/*
+ * CFG_CHANGE slot content: the configuration in effect from that slot
+ * on, as images of CTRL1 (ODR_XL), CTRL2 (ODR_G), CTRL6 (FS_G) and
+ * CTRL8 (FS_XL).
+ */
+#define    CFG_TAG_ODR_XL(d) ((uint8_t)((d)[0] & 0x0FU))
+#define    CFG_TAG_ODR_GY(d) ((uint8_t)((d)[1] & 0x0FU))
+#define    CFG_TAG_FS_GY(d)  ((uint8_t)((d)[2] & 0x0FU))
+#define    CFG_TAG_FS_XL(d)  ((uint8_t)((d)[3] & 0x03U))
+
+/* Private typedef -----------------------------------------------------------*/
+/* Accelerometer and gyroscope configuration, BDR equal to ODR */
+typedef struct {
+  lsm6dsv16x_data_rate_t odr_xl;
+  lsm6dsv16x_xl_full_scale_t fs_xl;
+  lsm6dsv16x_data_rate_t odr_gy;
+  lsm6dsv16x_gy_full_scale_t fs_gy;
+} fifo_cfg_t;
+
+typedef enum {
+  DEC_XL,
+  DEC_GY,
+  DEC_SENS_NUM,
+} fifo_dec_sens_t;
+
+/*
+ * Decoder state of one sensor. Sample times are in timestamp LSB:
+ * the n-th sample after the last TIMESTAMP slot is at anchor + n * period.
+ */
+typedef struct {
+  uint8_t odr;             /* ODR / BDR code, 0 when not batched */
+  uint8_t fs;
+  float_t sens;            /* mg/LSB or mdps/LSB */
+  float_t period;          /* [timestamp LSB] */
+  uint32_t anchor;
+  uint16_t n;
+  uint8_t cal;             /* period can be measured at next timestamp */
+} fifo_dec_state_t;
+
+/*
+ * FIFO decoder: ODR, BDR and full scale switch at CFG_CHANGE slots, as
+ * decoded from the slot. The configuration written by the application
+ * (pending) is only used to cross-check the slot content: mismatch counts
+ * the configurations that never showed up in a CFG_CHANGE slot.
+ */
+typedef struct {
+  fifo_dec_state_t sens[DEC_SENS_NUM];
+  fifo_cfg_t pending;
+  uint8_t pending_valid;
+  uint32_t changes;
+  uint32_t stray_tags;
+  uint32_t mismatch;
+} fifo_dec_t;
+
+/* Decoded sample */
+typedef struct {
+  fifo_dec_sens_t sens;
+  uint32_t t;              /* [timestamp LSB] */
+  float_t val[3];          /* [mg] or [mdps] */
+} fifo_dec_out_t;
+
+/* Private variables ---------------------------------------------------------*/
+static uint8_t whoamI;
+static uint8_t tx_buffer[1000];
+
+/* Configurations cycled while the FIFO keeps running */
+static const fifo_cfg_t cfg_step[] = {
+  { LSM6DSV16X_ODR_AT_60Hz,  LSM6DSV16X_2g, LSM6DSV16X_ODR_AT_15Hz,  LSM6DSV16X_2000dps },
+  { LSM6DSV16X_ODR_AT_240Hz, LSM6DSV16X_8g, LSM6DSV16X_ODR_AT_120Hz, LSM6DSV16X_500dps },
+  { LSM6DSV16X_ODR_AT_15Hz,  LSM6DSV16X_4g, LSM6DSV16X_ODR_AT_30Hz,  LSM6DSV16X_250dps },
+};
+
+static fifo_dec_t dec;
+
+/* Extern variables ----------------------------------------------------------*/
+
+/* Private functions ---------------------------------------------------------*/
+
+/*
+ *   WARNING:
+ *   Functions declare in this section are defined at the end of this file
+ *   and are strictly related to the hardware platform used.
+ *
+ */
+static int32_t platform_write(void *handle, uint8_t reg, const uint8_t *bufp,
+                              uint16_t len);
+static int32_t platform_read(void *handle, uint8_t reg, uint8_t *bufp,
+                             uint16_t len);
+static void tx_com( uint8_t *tx_buffer, uint16_t len );
+static void platform_delay(uint32_t ms);
+static void platform_init(void *handle);
+
+
+static stmdev_ctx_t dev_ctx;
+
+/*
+ * @brief  Nominal rate of an ODR / BDR code
+ *
+ * @param  odr       ODR / BDR code (0: off, 1: 1.875 Hz, 2: 7.5 Hz, ...)
+ * @retval           rate [Hz]
+ *
+ */
+static float_t fifo_dec_rate(uint8_t odr)
+{
+  if (odr == 0)
+    return 0.0f;
+  if (odr == 1)
+    return 1.875f;
+
+  return 7.5f * (float_t)(1U << (odr - 2U));
+}
+
+/*
+ * @brief  Load a sensor configuration in the decoder state
+ *
+ * The time of the next sample is carried over from the previous rate,
+ * so the output timebase has no step; the next TIMESTAMP slot then
+ * re-anchors it on the device clock.
+ *
+ * @param  s         sensor state
+ * @param  sens      DEC_XL or DEC_GY
+ * @param  odr       ODR / BDR code
+ * @param  fs        full scale code
+ *
+ */
+static void fifo_dec_load(fifo_dec_state_t *s, fifo_dec_sens_t sens,
+                          uint8_t odr, uint8_t fs)
+{
+  float_t rate = fifo_dec_rate(odr);
+
+  s->anchor += (uint32_t)(s->n * s->period);
+  s->n = 0;
+  s->cal = 0;
+  s->odr = odr;
+  s->fs = fs;
+  s->period = (rate > 0.0f) ?
+              1.0e9f / (rate * lsm6dsv16x_from_lsb_to_nsec(1)) : 0.0f;
+
+  if (sens == DEC_XL)
+    s->sens = 0.061f * (float_t)(1U << fs);
+  else
+    s->sens = (fs == LSM6DSV16X_4000dps) ?
+              140.0f : 4.375f * (float_t)(1U << fs);
+}
+
+/*
+ * @brief  Decode one FIFO slot
+ *
+ * TIMESTAMP slots re-anchor the sample times and, when no configuration
+ * change happened in between, give the actual sample period of each
+ * sensor. A CFG_CHANGE slot carries the configuration that takes effect
+ * at its position in the stream: samples before it are scaled with the
+ * old full scale, samples after it with the new one.
+ *
+ * @param  d         decoder
+ * @param  f_data    FIFO slot
+ * @param  out       decoded sample
+ * @retval           1 if out holds a sample, 0 otherwise
+ *
+ */
+static uint8_t fifo_dec_push(fifo_dec_t *d, lsm6dsv16x_fifo_out_raw_t *f_data,
+                             fifo_dec_out_t *out)
+{
+  fifo_dec_state_t *s;
+  uint8_t odr_xl, fs_xl, odr_gy, fs_gy;
+  int16_t raw[3];
+  uint32_t ts;
+  uint8_t i;
+
+  switch (f_data->tag) {
+  case LSM6DSV16X_TIMESTAMP_TAG:
+    ts = (uint32_t)f_data->data[0] | ((uint32_t)f_data->data[1] << 8) |
+         ((uint32_t)f_data->data[2] << 16) | ((uint32_t)f_data->data[3] << 24);
+    for (i = 0; i < DEC_SENS_NUM; i++) {
+      s = &d->sens[i];
+      if (s->cal && s->n > 0)
+        s->period = (float_t)(ts - s->anchor) / (float_t)s->n;
+      s->cal = 1;
+      s->anchor = ts;
+      s->n = 0;
+    }
+    return 0;
+
+  case LSM6DSV16X_CFG_CHANGE_TAG:
+    odr_xl = CFG_TAG_ODR_XL(f_data->data);
+    fs_xl = CFG_TAG_FS_XL(f_data->data);
+    odr_gy = CFG_TAG_ODR_GY(f_data->data);
+    fs_gy = CFG_TAG_FS_GY(f_data->data);
+
+    /* Slot of the configuration written by the application */
+    if (d->pending_valid &&
+        odr_xl == ((uint8_t)d->pending.odr_xl & 0x0FU) &&
+        fs_xl == (uint8_t)d->pending.fs_xl &&
+        odr_gy == ((uint8_t)d->pending.odr_gy & 0x0FU) &&
+        fs_gy == (uint8_t)d->pending.fs_gy)
+      d->pending_valid = 0;
+
+    if (odr_xl == d->sens[DEC_XL].odr && fs_xl == d->sens[DEC_XL].fs &&
+        odr_gy == d->sens[DEC_GY].odr && fs_gy == d->sens[DEC_GY].fs) {
+      /* Further slots of a change already applied */
+      d->stray_tags++;
+      return 0;
+    }
+
+    fifo_dec_load(&d->sens[DEC_XL], DEC_XL, odr_xl, fs_xl);
+    fifo_dec_load(&d->sens[DEC_GY], DEC_GY, odr_gy, fs_gy);
+    d->changes++;
+    return 0;
+
+  case LSM6DSV16X_XL_NC_TAG:
+    out->sens = DEC_XL;
+    break;
+
+  case LSM6DSV16X_GY_NC_TAG:
+    out->sens = DEC_GY;
+    break;
+
+  default:
+    return 0;
+  }
+
+  s = &d->sens[out->sens];
+  for (i = 0; i < 3; i++) {
+    raw[i] = (int16_t)((uint16_t)f_data->data[2 * i] |
+                       ((uint16_t)f_data->data[2 * i + 1] << 8));
+    out->val[i] = (float_t)raw[i] * s->sens;
+  }
+  out->t = s->anchor + (uint32_t)(s->n * s->period);
+  s->n++;
+
+  return 1;
+}
+
+/*
+ * @brief  Write FIFO_CTRL3 (BDR_XL, BDR_GY) in a single transaction
+ *
+ * @param  bdr_xl    accelerometer BDR code
+ * @param  bdr_gy    gyroscope BDR code
+ *
+ */
+static void fifo_bdr_write(uint8_t bdr_xl, uint8_t bdr_gy)
+{
+  lsm6dsv16x_fifo_ctrl3_t fifo_ctrl3;
+
+  fifo_ctrl3.bdr_xl = bdr_xl;
+  fifo_ctrl3.bdr_gy = bdr_gy;
+  lsm6dsv16x_write_reg(&dev_ctx, LSM6DSV16X_FIFO_CTRL3,
+                       (uint8_t *)&fifo_ctrl3, 1);
+}
+
+/*
+ * @brief  Change ODR, BDR and full scale without flushing the FIFO
+ *
+ * Batching is paused while full scale and ODR are written, so that no
+ * sample can enter the FIFO with only part of the new configuration
+ * applied. Whichever of these writes the device tags first, all samples
+ * before that CFG_CHANGE slot belong to the old configuration and all
+ * samples after it to the new one.
+ *
+ * @param  d         decoder
+ * @param  c         configuration to apply
+ *
+ */
+static void fifo_cfg_apply(fifo_dec_t *d, const fifo_cfg_t *c)
+{
+  /* Previous configuration never seen in a CFG_CHANGE slot */
+  if (d->pending_valid)
+    d->mismatch++;
+
+  d->pending = *c;
+  d->pending_valid = 1;
+
+  fifo_bdr_write(0, 0);
+  lsm6dsv16x_xl_full_scale_set(&dev_ctx, c->fs_xl);
+  lsm6dsv16x_gy_full_scale_set(&dev_ctx, c->fs_gy);
+  lsm6dsv16x_xl_data_rate_set(&dev_ctx, c->odr_xl);
+  lsm6dsv16x_gy_data_rate_set(&dev_ctx, c->odr_gy);
+  fifo_bdr_write((uint8_t)c->odr_xl, (uint8_t)c->odr_gy);
+}
+
+/* Main Example --------------------------------------------------------------*/
+void lsm6dsv16x_fifo_cfg_change(void)
+{
+  lsm6dsv16x_fifo_status_t fifo_status;
+  lsm6dsv16x_fifo_ctrl2_t fifo_ctrl2;
+  lsm6dsv16x_reset_t rst;
+  uint32_t drains = 0;
+  uint8_t step = 0;
+
+  /* Initialize mems driver interface */
+  dev_ctx.write_reg = platform_write;
+  dev_ctx.read_reg = platform_read;
+  dev_ctx.mdelay = platform_delay;
+  dev_ctx.handle = &SENSOR_BUS;
+
+  /* Init test platform */
+  platform_init(dev_ctx.handle);
+  /* Wait sensor boot time */
+  platform_delay(BOOT_TIME);
+
+  /* Check device ID */
+  lsm6dsv16x_device_id_get(&dev_ctx, &whoamI);
+
+  if (whoamI != LSM6DSV16X_ID)
+    while (1);
+
+  /* Restore default configuration */
+  lsm6dsv16x_reset_set(&dev_ctx, LSM6DSV16X_RESTORE_CTRL_REGS);
+  do {
+    lsm6dsv16x_reset_get(&dev_ctx, &rst);
+  } while (rst != LSM6DSV16X_READY);
+
+  /* Enable Block Data Update */
+  lsm6dsv16x_block_data_update_set(&dev_ctx, PROPERTY_ENABLE);
+
+  /*
+   * Set FIFO watermark (number of unread sensor data TAG + 6 bytes
+   * stored in FIFO) to FIFO_WATERMARK samples
+   */
+  lsm6dsv16x_fifo_watermark_set(&dev_ctx, FIFO_WATERMARK);
+
+  /* Batch CFG_CHANGE slots (FIFO_CTRL2: ODR_CHG_EN) */
+  lsm6dsv16x_read_reg(&dev_ctx, LSM6DSV16X_FIFO_CTRL2, (uint8_t *)&fifo_ctrl2, 1);
+  fifo_ctrl2.odr_chg_en = PROPERTY_ENABLE;
+  lsm6dsv16x_write_reg(&dev_ctx, LSM6DSV16X_FIFO_CTRL2, (uint8_t *)&fifo_ctrl2, 1);
+
+  /* Set FIFO mode to Stream mode (aka Continuous Mode) */
+  lsm6dsv16x_fifo_mode_set(&dev_ctx, LSM6DSV16X_STREAM_MODE);
+
+  lsm6dsv16x_fifo_timestamp_batch_set(&dev_ctx, LSM6DSV16X_TMSTMP_DEC_8);
+  lsm6dsv16x_timestamp_set(&dev_ctx, PROPERTY_ENABLE);
+
+  /* First configuration: the decoder picks it up at the first CFG_CHANGE */
+  fifo_cfg_apply(&dec, &cfg_step[0]);
+
+  /* Wait samples */
+  while (1) {
+    uint16_t num = 0;
+
+    /* Read watermark flag */
+    lsm6dsv16x_fifo_status_get(&dev_ctx, &fifo_status);
+
+    if (fifo_status.fifo_th == 0)
+      continue;
+
+    num = fifo_status.fifo_level;
+
+    while (num--) {
+      lsm6dsv16x_fifo_out_raw_t f_data;
+      fifo_dec_out_t out;
+      uint32_t changes = dec.changes;
+
+      /* Read FIFO sensor value */
+      lsm6dsv16x_fifo_out_raw_get(&dev_ctx, &f_data);
+
+      if (fifo_dec_push(&dec, &f_data, &out)) {
+        snprintf((char *)tx_buffer, sizeof(tx_buffer),
+                 "%10lu us %s:\t%4.2f\t%4.2f\t%4.2f\r\n",
+                 (unsigned long)(lsm6dsv16x_from_lsb_to_nsec(out.t) / 1000.0f),
+                 (out.sens == DEC_XL) ? "ACC [mg]" : "GYR [mdps]",
+                 out.val[0], out.val[1], out.val[2]);
+        tx_com(tx_buffer, strlen((char const *)tx_buffer));
+      } else if (changes != dec.changes) {
+        snprintf((char *)tx_buffer, sizeof(tx_buffer),
+                 "-- CFG_CHANGE: XL %4.1f Hz %.3f mg/LSB, GY %4.1f Hz %.3f mdps/LSB (%lu mismatch)\r\n",
+                 fifo_dec_rate(dec.sens[DEC_XL].odr), dec.sens[DEC_XL].sens,
+                 fifo_dec_rate(dec.sens[DEC_GY].odr), dec.sens[DEC_GY].sens,
+                 (unsigned long)dec.mismatch);
+        tx_com(tx_buffer, strlen((char const *)tx_buffer));
+      }
+    }
+
+    /* Next configuration */
+    if (++drains % STEP_DRAINS == 0) {
+      step = (step + 1) % (sizeof(cfg_step) / sizeof(fifo_cfg_t));
+      fifo_cfg_apply(&dec, &cfg_step[step]);
+    }
+  }
+}
+
+/*
+ * @brief  Write generic device register (platform dependent)
+ *
+ * @param  handle    customizable argument. In this examples is used in
+ *                   order to select the correct sensor bus handler.
+ * @param  reg       register to write
+ * @param  bufp      pointer to data to write in register reg
+ * @param  len       number of consecutive register to write
+ *
+ */
+static int32_t platform_write(void *handle, uint8_t reg, const uint8_t *bufp,
+                              uint16_t len)
+{
+#if defined(NUCLEO_F401RE)
+  HAL_I2C_Mem_Write(handle, LSM6DSV16X_I2C_ADD_L, reg,
+                    I2C_MEMADD_SIZE_8BIT, (uint8_t*) bufp, len, 1000);
+#elif defined(STEVAL_MKI109V3)
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_RESET);
+  HAL_SPI_Transmit(handle, &reg, 1, 1000);
+  HAL_SPI_Transmit(handle, (uint8_t*) bufp, len, 1000);
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_SET);
+#elif defined(SPC584B_DIS)
+  i2c_lld_write(handle,  LSM6DSV16X_I2C_ADD_H & 0xFE, reg, (uint8_t*) bufp, len);
+#elif defined(NUCLEO_H503RB)
+  i3c_write(handle, i3c_dyn_addr, reg, (uint8_t*) bufp, len);
+#endif
+  return 0;
+}
+
+/*
+ * @brief  Read generic device register (platform dependent)
+ *
+ * @param  handle    customizable argument. In this examples is used in
+ *                   order to select the correct sensor bus handler.
+ * @param  reg       register to read
+ * @param  bufp      pointer to buffer that store the data read
+ * @param  len       number of consecutive register to read
+ *
+ */
+static int32_t platform_read(void *handle, uint8_t reg, uint8_t *bufp,
+                             uint16_t len)
+{
+#if defined(NUCLEO_F401RE)
+  HAL_I2C_Mem_Read(handle, LSM6DSV16X_I2C_ADD_L, reg,
+                   I2C_MEMADD_SIZE_8BIT, bufp, len, 1000);
+#elif defined(STEVAL_MKI109V3)
+  reg |= 0x80;
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_RESET);
+  HAL_SPI_Transmit(handle, &reg, 1, 1000);
+  HAL_SPI_Receive(handle, bufp, len, 1000);
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_SET);
+#elif defined(SPC584B_DIS)
+  i2c_lld_read(handle, LSM6DSV16X_I2C_ADD_H & 0xFE, reg, bufp, len);
+#elif defined(NUCLEO_H503RB)
+  i3c_read(handle, i3c_dyn_addr, reg, bufp, len);
+#endif
+  return 0;
+}
+
+/*
+ * @brief  Send buffer to console (platform dependent)
+ *
+ * @param  tx_buffer     buffer to transmit
+ * @param  len           number of byte to send
+ *
+ */
+static void tx_com(uint8_t *tx_buffer, uint16_t len)
+{
+#if defined(NUCLEO_F401RE)
+  HAL_UART_Transmit(&huart2, tx_buffer, len, 1000);
+#elif defined(STEVAL_MKI109V3)
+  CDC_Transmit_FS(tx_buffer, len);
+#elif defined(SPC584B_DIS)
+  sd_lld_write(&SD2, tx_buffer, len);
+#elif defined(NUCLEO_H503RB)
+  HAL_UART_Transmit(&huart3, tx_buffer, len, 1000);
+#endif
+}
+
+/*
+ * @brief  platform specific delay (platform dependent)
+ *
+ * @param  ms        delay in ms
+ *
+ */
+static void platform_delay(uint32_t ms)
+{
+#if defined(NUCLEO_F401RE) || defined(STEVAL_MKI109V3) || defined(NUCLEO_H503RB)
+  HAL_Delay(ms);
+#elif defined(SPC584B_DIS)
+  osalThreadDelayMilliseconds(ms);
+#endif
+}
+
+/*
+ * @brief  platform specific initialization (platform dependent)
+ */
+static void platform_init(void *handle)
+{
+#if defined(STEVAL_MKI109V3)
+  TIM3->CCR1 = PWM_3V3;
+  TIM3->CCR2 = PWM_3V3;
+  HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_1);
+  HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_2);
+  HAL_Delay(1000);
+
+#elif defined(NUCLEO_H503RB)
+  i3c_set_bus_frequency(handle, 1000000);
+  i3c_rstdaa(handle);
+  i3c_setdasa(handle, LSM6DSV16X_I2C_ADD_L, &i3c_dyn_addr, 1);
+  i3c_set_bus_frequency(handle, 12500000);
+
+#endif
+}
@@ -0,0 +1,598 @@
+/*
+ ******************************************************************************
+ * @file    lsm6dsv16x_fifo_drain.c
+ * @author  Sensors Software Solution Team
+ * @brief   This file show how to drain the whole FIFO with a single bus
+ *          transaction, on STM32 boards and on Linux (i2c-dev / spidev).
+ *
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2020 STMicroelectronics.
+ * All rights reserved.</center></h2>
+ *
+ * This software component is licensed by ST under BSD 3-Clause license,
+ * the "License"; You may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at:
+ *                        opensource.org/licenses/BSD-3-Clause
+ *
+ ******************************************************************************
+ */
+
+/*
+ * This example was developed using the following STMicroelectronics
+ * evaluation boards:
+ *
+ * - STEVAL_MKI109V3 +
+ * - NUCLEO_F401RE + X-NUCLEO-IKS01A3
+ * - DISCOVERY_SPC584B +
+ * - NUCLEO_H503RB + X-NUCLEO-IKS4A1
+ * - Linux host (e.g. Raspberry Pi) + STEVAL-MKI227KA adapter
+ *
+ * Used interfaces:
+ *
+ * STEVAL_MKI109V3    - Host side:   USB (Virtual COM)
+ *                    - Sensor side: SPI(Default) / I2C(supported)
+ *
+ * NUCLEO_STM32F401RE - Host side: UART(COM) to USB bridge
+ *                    - Sensor side: I2C(Default) / SPI(supported)
+ *
+ * DISCOVERY_SPC584B  - Host side: UART(COM) to USB bridge
+ *                    - Sensor side: I2C(Default) / SPI(supported)
+ *
+ * NUCLEO_STM32H503RG - Host side: UART(COM) to USB bridge
+ *                    - Sensor side: I3C(Default)
+ *
+ * LINUX_I2C_DEV      - Host side:   stdout
+ *                    - Sensor side: /dev/i2c-N (I2C_RDWR, SMBus fallback)
+ *
+ * LINUX_SPIDEV       - Host side:   stdout
+ *                    - Sensor side: /dev/spidevB.C (SPI_IOC_MESSAGE)
+ *
+ * Linux builds need _prj_Linux/linux_platform.c and _prj_Linux in the
+ * include path (see _prj_Linux/README.md).
+ *
+ * If you need to run this example on a different hardware platform a
+ * modification of the functions: `platform_write`, `platform_read`,
+ * `tx_com` and 'platform_init' is required.
+ *
+ */
+
+/* STMicroelectronics evaluation boards definition
+ *
+ * Please uncomment ONLY the evaluation boards in use.
+ * If a different hardware is used please comment all
+ * following target board and redefine yours.
+ */
+
+//#define STEVAL_MKI109V3  /* little endian */
+//#define NUCLEO_F401RE    /* little endian */
+//#define SPC584B_DIS      /* big endian */
+//#define LINUX_I2C_DEV    /* little endian */
+//#define LINUX_SPIDEV     /* little endian */
+
+/* ATTENTION: By default the driver is little endian. If you need switch
+ *            to big endian please see "Endianness definitions" in the
+ *            header file of the driver (_reg.h).
+ */
+
+#if defined(STEVAL_MKI109V3)
+/* MKI109V3: Define communication interface */
+#define SENSOR_BUS hspi2
+/* MKI109V3: Vdd and Vddio power supply values */
+#define PWM_3V3 915
+
+#elif defined(NUCLEO_F401RE)
+/* NUCLEO_F401RE: Define communication interface */
+#define SENSOR_BUS hi2c1
+
+#elif defined(SPC584B_DIS)
+/* DISCOVERY_SPC584B: Define communication interface */
+#define SENSOR_BUS I2CD1
+
+#elif defined(NUCLEO_H503RB)
+/* NUCLEO_H503RB: Define communication interface */
+#define SENSOR_BUS hi3c1
+
+#elif defined(LINUX_I2C_DEV) || defined(LINUX_SPIDEV)
+/* Linux: Define communication interface (see linux_bus below) */
+#define SENSOR_BUS linux_bus
+#if defined(LINUX_I2C_DEV)
+#define LINUX_BUS_DEV "/dev/i2c-1"
+#else
+#define LINUX_BUS_DEV "/dev/spidev0.0"
+#endif
+/* Linux: SPI clock [Hz] */
+#define LINUX_SPI_HZ 10000000
+
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include <stdio.h>
+#include "lsm6dsv16x_reg.h"
+
+#if defined(NUCLEO_F401RE)
+#include "stm32f4xx_hal.h"
+#include "usart.h"
+#include "gpio.h"
+#include "i2c.h"
+
+#elif defined(STEVAL_MKI109V3)
+#include "stm32f4xx_hal.h"
+#include "usbd_cdc_if.h"
+#include "gpio.h"
+#include "spi.h"
+#include "tim.h"
+
+#elif defined(SPC584B_DIS)
+#include "components.h"
+
+#elif defined(NUCLEO_H503RB)
+#include "usart.h"
+#include "i3c.h"
+#include "i3c_api.h"
+#include <stdio.h>
+
+static uint8_t i3c_dyn_addr = 0x0A;
+
+#elif defined(LINUX_I2C_DEV) || defined(LINUX_SPIDEV)
+#include <stdlib.h>
+#include "linux_platform.h"
+
+/* Linux character device bus, FIFO slots of 7 bytes (TAG + 6 bytes) */
+static linux_bus_t linux_bus = LINUX_BUS_INIT(LINUX_BUS_DEV, LSM6DSV16X_I2C_ADD_L >> 1,
+                                               LINUX_SPI_HZ,
+                                               LSM6DSV16X_FIFO_DATA_OUT_TAG, 7);
+
+/* Bus transactions already counted */
+static uint32_t linux_xfers;
+#endif
+
+/* Private macro -------------------------------------------------------------*/
+/*
+ * Select FIFO samples watermark, max value is 511
+ * in FIFO are stored acc, gyro and timestamp samples
+ */
+#define BOOT_TIME         10
+#define FIFO_WATERMARK    128
+
+/* FIFO slots read at most per drain, 7 bytes each (TAG + 6 bytes) */
+#define FIFO_MAX          512
+#define FIFO_SLOT_LEN     7
+
+/* Watermark polling period [ms] (FIFO_WATERMARK slots take ~67 ms) */
+#define POLL_MS           10
+
+/* Drains between two reports */
+#define REPORT_DRAINS     100
+
+/* Uncomment to read the FIFO one slot per transaction (reference) */
+//#define DRAIN_BASELINE
+
+/* Private variables ---------------------------------------------------------*/
+static uint8_t whoamI;
+static uint8_t tx_buffer[1000];
+static uint8_t fifo_buf[FIFO_MAX * FIFO_SLOT_LEN];
+
+/* Bus transactions (one syscall each on Linux) and time spent in them */
+static uint32_t bus_xfers;
+static uint64_t bus_ns;
+
+static int16_t xl_last[3];
+static int16_t gy_last[3];
+static uint32_t ts_last;
+static uint32_t samples;
+
+/* Extern variables ----------------------------------------------------------*/
+
+/* Private functions ---------------------------------------------------------*/
+
+/*
+ *   WARNING:
+ *   Functions declare in this section are defined at the end of this file
+ *   and are strictly related to the hardware platform used.
+ *
+ */
+static int32_t platform_write(void *handle, uint8_t reg, const uint8_t *bufp,
+                              uint16_t len);
+static int32_t platform_read(void *handle, uint8_t reg, uint8_t *bufp,
+                             uint16_t len);
+static void tx_com( uint8_t *tx_buffer, uint16_t len );
+static void platform_delay(uint32_t ms);
+static void platform_init(void *handle);
+
+static uint64_t platform_time_ns(void);
+
+/*
+ * @brief  Stop on a bus error (a failed read leaves a stale buffer)
+ *
+ * @param  what      transaction that failed
+ *
+ */
+static void bus_error(const char *what)
+{
+#if defined(LINUX_I2C_DEV) || defined(LINUX_SPIDEV)
+  fprintf(stderr, "%s: bus error\n", what);
+  exit(1);
+#else
+  (void)what;
+  while (1);
+#endif
+}
+
+/*
+ * @brief  Decode one FIFO slot
+ *
+ * @param  tag       FIFO_DATA_OUT_TAG register value
+ * @param  data      FIFO_DATA_OUT_X_L .. FIFO_DATA_OUT_Z_H
+ *
+ */
+static void fifo_slot_decode(uint8_t tag, const uint8_t *data)
+{
+  int16_t *dst;
+  uint8_t i;
+
+  switch (tag >> 3) {
+  case LSM6DSV16X_XL_NC_TAG:
+    dst = xl_last;
+    break;
+  case LSM6DSV16X_GY_NC_TAG:
+    dst = gy_last;
+    break;
+  case LSM6DSV16X_TIMESTAMP_TAG:
+    ts_last = (uint32_t)data[0] | ((uint32_t)data[1] << 8) |
+              ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+    return;
+  default:
+    return;
+  }
+
+  for (i = 0; i < 3; i++)
+    dst[i] = (int16_t)((uint16_t)data[2 * i] | ((uint16_t)data[2 * i + 1] << 8));
+  samples++;
+}
+
+/*
+ * @brief  Read and decode num FIFO slots
+ *
+ * The FIFO output address rolls back from FIFO_DATA_OUT_Z_H to
+ * FIFO_DATA_OUT_TAG, so the whole drain is a single read of
+ * num * 7 bytes: one bus transaction, one ioctl() on Linux.
+ *
+ * @param  ctx       read / write interface definitions
+ * @param  num       number of slots to read
+ * @retval           number of slots read
+ *
+ */
+static uint16_t fifo_drain(stmdev_ctx_t *ctx, uint16_t num)
+{
+  uint16_t k;
+
+  if (num > FIFO_MAX)
+    num = FIFO_MAX;
+
+#if !defined(DRAIN_BASELINE)
+  if (lsm6dsv16x_read_reg(ctx, LSM6DSV16X_FIFO_DATA_OUT_TAG, fifo_buf,
+                          num * FIFO_SLOT_LEN) != 0)
+    bus_error("FIFO read");
+
+  for (k = 0; k < num; k++)
+    fifo_slot_decode(fifo_buf[k * FIFO_SLOT_LEN],
+                     &fifo_buf[k * FIFO_SLOT_LEN + 1]);
+#else
+  for (k = 0; k < num; k++) {
+    if (lsm6dsv16x_read_reg(ctx, LSM6DSV16X_FIFO_DATA_OUT_TAG, fifo_buf,
+                            FIFO_SLOT_LEN) != 0)
+      bus_error("FIFO read");
+    fifo_slot_decode(fifo_buf[0], &fifo_buf[1]);
+  }
+#endif
+
+  return num;
+}
+
+/* Main Example --------------------------------------------------------------*/
+void lsm6dsv16x_fifo_drain(void)
+{
+  lsm6dsv16x_fifo_status_t fifo_status;
+  stmdev_ctx_t dev_ctx;
+  lsm6dsv16x_reset_t rst;
+  uint32_t drains = 0, slots = 0;
+  uint64_t drain_ns = 0, t;
+
+  /* Initialize mems driver interface */
+  dev_ctx.write_reg = platform_write;
+  dev_ctx.read_reg = platform_read;
+  dev_ctx.mdelay = platform_delay;
+  dev_ctx.handle = &SENSOR_BUS;
+
+  /* Init test platform */
+  platform_init(dev_ctx.handle);
+  /* Wait sensor boot time */
+  platform_delay(BOOT_TIME);
+
+  /* Check device ID */
+  if (lsm6dsv16x_device_id_get(&dev_ctx, &whoamI) != 0)
+    bus_error("WHO_AM_I read");
+
+  if (whoamI != LSM6DSV16X_ID) {
+#if defined(LINUX_I2C_DEV) || defined(LINUX_SPIDEV)
+    fprintf(stderr, "WHO_AM_I 0x%02X, expected 0x%02X\n", whoamI,
+            LSM6DSV16X_ID);
+    exit(1);
+#else
+    while (1);
+#endif
+  }
+
+  /* Restore default configuration */
+  lsm6dsv16x_reset_set(&dev_ctx, LSM6DSV16X_RESTORE_CTRL_REGS);
+  do {
+    lsm6dsv16x_reset_get(&dev_ctx, &rst);
+  } while (rst != LSM6DSV16X_READY);
+
+  /* Enable Block Data Update */
+  lsm6dsv16x_block_data_update_set(&dev_ctx, PROPERTY_ENABLE);
+
+  /* Set full scale */
+  lsm6dsv16x_xl_full_scale_set(&dev_ctx, LSM6DSV16X_2g);
+  lsm6dsv16x_gy_full_scale_set(&dev_ctx, LSM6DSV16X_2000dps);
+
+  /*
+   * Set FIFO watermark (number of unread sensor data TAG + 6 bytes
+   * stored in FIFO) to FIFO_WATERMARK samples
+   */
+  lsm6dsv16x_fifo_watermark_set(&dev_ctx, FIFO_WATERMARK);
+  /* Set FIFO batch XL/Gyro ODR to 960Hz */
+  lsm6dsv16x_fifo_xl_batch_set(&dev_ctx, LSM6DSV16X_XL_BATCHED_AT_960Hz);
+  lsm6dsv16x_fifo_gy_batch_set(&dev_ctx, LSM6DSV16X_GY_BATCHED_AT_960Hz);
+
+  /* Set FIFO mode to Stream mode (aka Continuous Mode) */
+  lsm6dsv16x_fifo_mode_set(&dev_ctx, LSM6DSV16X_STREAM_MODE);
+
+  /* Set Output Data Rate */
+  lsm6dsv16x_xl_data_rate_set(&dev_ctx, LSM6DSV16X_ODR_AT_960Hz);
+  lsm6dsv16x_gy_data_rate_set(&dev_ctx, LSM6DSV16X_ODR_AT_960Hz);
+  lsm6dsv16x_fifo_timestamp_batch_set(&dev_ctx, LSM6DSV16X_TMSTMP_DEC_8);
+  lsm6dsv16x_timestamp_set(&dev_ctx, PROPERTY_ENABLE);
+
+  bus_xfers = 0;
+  bus_ns = 0;
+  samples = 0;
+
+  /* Wait samples */
+  while (1) {
+    /* Read watermark flag */
+    if (lsm6dsv16x_fifo_status_get(&dev_ctx, &fifo_status) != 0)
+      bus_error("FIFO status read");
+
+    if (fifo_status.fifo_th == 0) {
+      platform_delay(POLL_MS);
+      continue;
+    }
+
+    t = platform_time_ns();
+    slots += fifo_drain(&dev_ctx, fifo_status.fifo_level);
+    drain_ns += platform_time_ns() - t;
+
+    if (++drains % REPORT_DRAINS)
+      continue;
+
+    snprintf((char *)tx_buffer, sizeof(tx_buffer),
+             "TIMESTAMP %lu ACC [mg]:\t%4.2f\t%4.2f\t%4.2f\tGYR [mdps]:\t%4.2f\t%4.2f\t%4.2f\r\n",
+             (unsigned long)ts_last,
+             lsm6dsv16x_from_fs2_to_mg(xl_last[0]),
+             lsm6dsv16x_from_fs2_to_mg(xl_last[1]),
+             lsm6dsv16x_from_fs2_to_mg(xl_last[2]),
+             lsm6dsv16x_from_fs2000_to_mdps(gy_last[0]),
+             lsm6dsv16x_from_fs2000_to_mdps(gy_last[1]),
+             lsm6dsv16x_from_fs2000_to_mdps(gy_last[2]));
+    tx_com(tx_buffer, strlen((char const *)tx_buffer));
+
+    /* Status polls included: every bus transaction is one syscall */
+    snprintf((char *)tx_buffer, sizeof(tx_buffer),
+             "%lu slots/drain, %.3f bus transactions/sample, drain %lu us (bus %lu us)\r\n",
+             (unsigned long)(slots / REPORT_DRAINS),
+             samples ? (float_t)bus_xfers / (float_t)samples : 0.0f,
+             (unsigned long)(drain_ns / REPORT_DRAINS / 1000U),
+             (unsigned long)(bus_ns / REPORT_DRAINS / 1000U));
+    tx_com(tx_buffer, strlen((char const *)tx_buffer));
+
+    bus_xfers = 0;
+    bus_ns = 0;
+    samples = 0;
+    slots = 0;
+    drain_ns = 0;
+  }
+}
+
+/*
+ * @brief  Write generic device register (platform dependent)
+ *
+ * @param  handle    customizable argument. In this examples is used in
+ *                   order to select the correct sensor bus handler.
+ * @param  reg       register to write
+ * @param  bufp      pointer to data to write in register reg
+ * @param  len       number of consecutive register to write
+ *
+ */
+static int32_t platform_write(void *handle, uint8_t reg, const uint8_t *bufp,
+                              uint16_t len)
+{
+  uint64_t t = platform_time_ns();
+  int32_t ret = 0;
+
+#if defined(NUCLEO_F401RE)
+  HAL_I2C_Mem_Write(handle, LSM6DSV16X_I2C_ADD_L, reg,
+                    I2C_MEMADD_SIZE_8BIT, (uint8_t*) bufp, len, 1000);
+#elif defined(STEVAL_MKI109V3)
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_RESET);
+  HAL_SPI_Transmit(handle, &reg, 1, 1000);
+  HAL_SPI_Transmit(handle, (uint8_t*) bufp, len, 1000);
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_SET);
+#elif defined(SPC584B_DIS)
+  i2c_lld_write(handle,  LSM6DSV16X_I2C_ADD_H & 0xFE, reg, (uint8_t*) bufp, len);
+#elif defined(NUCLEO_H503RB)
+  i3c_write(handle, i3c_dyn_addr, reg, (uint8_t*) bufp, len);
+#elif defined(LINUX_I2C_DEV)
+  ret = linux_i2c_write(handle, reg, bufp, len);
+#elif defined(LINUX_SPIDEV)
+  ret = linux_spi_write(handle, reg, bufp, len);
+#endif
+
+  bus_ns += platform_time_ns() - t;
+#if defined(LINUX_I2C_DEV) || defined(LINUX_SPIDEV)
+  /* One transaction per ioctl(): SMBus adapters split long transfers */
+  bus_xfers += linux_bus.xfers - linux_xfers;
+  linux_xfers = linux_bus.xfers;
+#else
+  bus_xfers++;
+#endif
+
+  return ret;
+}
+
+/*
+ * @brief  Read generic device register (platform dependent)
+ *
+ * @param  handle    customizable argument. In this examples is used in
+ *                   order to select the correct sensor bus handler.
+ * @param  reg       register to read
+ * @param  bufp      pointer to buffer that store the data read
+ * @param  len       number of consecutive register to read
+ *
+ */
+static int32_t platform_read(void *handle, uint8_t reg, uint8_t *bufp,
+                             uint16_t len)
+{
+  uint64_t t = platform_time_ns();
+  int32_t ret = 0;
+
+#if defined(NUCLEO_F401RE)
+  HAL_I2C_Mem_Read(handle, LSM6DSV16X_I2C_ADD_L, reg,
+                   I2C_MEMADD_SIZE_8BIT, bufp, len, 1000);
+#elif defined(STEVAL_MKI109V3)
+  reg |= 0x80;
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_RESET);
+  HAL_SPI_Transmit(handle, &reg, 1, 1000);
+  HAL_SPI_Receive(handle, bufp, len, 1000);
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_SET);
+#elif defined(SPC584B_DIS)
+  i2c_lld_read(handle, LSM6DSV16X_I2C_ADD_H & 0xFE, reg, bufp, len);
+#elif defined(NUCLEO_H503RB)
+  i3c_read(handle, i3c_dyn_addr, reg, bufp, len);
+#elif defined(LINUX_I2C_DEV)
+  ret = linux_i2c_read(handle, reg, bufp, len);
+#elif defined(LINUX_SPIDEV)
+  ret = linux_spi_read(handle, reg, bufp, len);
+#endif
+
+  bus_ns += platform_time_ns() - t;
+#if defined(LINUX_I2C_DEV) || defined(LINUX_SPIDEV)
+  /* One transaction per ioctl(): SMBus adapters split long transfers */
+  bus_xfers += linux_bus.xfers - linux_xfers;
+  linux_xfers = linux_bus.xfers;
+#else
+  bus_xfers++;
+#endif
+
+  return ret;
+}
+
+/*
+ * @brief  Send buffer to console (platform dependent)
+ *
+ * @param  tx_buffer     buffer to transmit
+ * @param  len           number of byte to send
+ *
+ */
+static void tx_com(uint8_t *tx_buffer, uint16_t len)
+{
+#if defined(NUCLEO_F401RE)
+  HAL_UART_Transmit(&huart2, tx_buffer, len, 1000);
+#elif defined(STEVAL_MKI109V3)
+  CDC_Transmit_FS(tx_buffer, len);
+#elif defined(SPC584B_DIS)
+  sd_lld_write(&SD2, tx_buffer, len);
+#elif defined(NUCLEO_H503RB)
+  HAL_UART_Transmit(&huart3, tx_buffer, len, 1000);
+#elif defined(LINUX_I2C_DEV) || defined(LINUX_SPIDEV)
+  linux_tx_com(tx_buffer, len);
+#endif
+}
+
+/*
+ * @brief  platform specific delay (platform dependent)
+ *
+ * @param  ms        delay in ms
+ *
+ */
+static void platform_delay(uint32_t ms)
+{
+#if defined(NUCLEO_F401RE) || defined(STEVAL_MKI109V3) || defined(NUCLEO_H503RB)
+  HAL_Delay(ms);
+#elif defined(SPC584B_DIS)
+  osalThreadDelayMilliseconds(ms);
+#elif defined(LINUX_I2C_DEV) || defined(LINUX_SPIDEV)
+  linux_delay(ms);
+#endif
+}
+
+/*
+ * @brief  platform specific initialization (platform dependent)
+ */
+static void platform_init(void *handle)
+{
+#if defined(STEVAL_MKI109V3)
+  TIM3->CCR1 = PWM_3V3;
+  TIM3->CCR2 = PWM_3V3;
+  HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_1);
+  HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_2);
+  HAL_Delay(1000);
+
+#elif defined(NUCLEO_H503RB)
+  i3c_set_bus_frequency(handle, 1000000);
+  i3c_rstdaa(handle);
+  i3c_setdasa(handle, LSM6DSV16X_I2C_ADD_L, &i3c_dyn_addr, 1);
+  i3c_set_bus_frequency(handle, 12500000);
+
+#elif defined(LINUX_I2C_DEV)
+  linux_i2c_open(handle);
+
+#elif defined(LINUX_SPIDEV)
+  linux_spi_open(handle);
+
+#endif
+
+#if defined(NUCLEO_F401RE) || defined(STEVAL_MKI109V3)
+  /* Cycle counter used by platform_time_ns (Cortex-M DWT) */
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+}
+
+/*
+ * @brief  platform specific monotonic time (platform dependent)
+ *
+ * @retval           time [ns], 0 if not available
+ *
+ */
+static uint64_t platform_time_ns(void)
+{
+#if defined(LINUX_I2C_DEV) || defined(LINUX_SPIDEV)
+  return linux_time_ns();
+#elif defined(NUCLEO_F401RE) || defined(STEVAL_MKI109V3)
+  /* 64-bit extension of the cycle counter, called often enough */
+  static uint64_t cycles;
+  static uint32_t last;
+  uint32_t now = DWT->CYCCNT;
+
+  cycles += now - last;
+  last = now;
+  return (cycles * 1000U) / (SystemCoreClock / 1000000U);
+#else
+  return 0;
+#endif
+}
@@ -0,0 +1,744 @@
+/*
+ ******************************************************************************
+ * @file    lsm6dsv16x_fifo_irq_latency.c
+ * @author  Sensors Software Solution Team
+ * @brief   This file show how to service the FIFO threshold interrupt,
+ *          measuring the latency from the INT1 edge to the FIFO read.
+ *
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2020 STMicroelectronics.
+ * All rights reserved.</center></h2>
+ *
+ * This software component is licensed by ST under BSD 3-Clause license,
+ * the "License"; You may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at:
+ *                        opensource.org/licenses/BSD-3-Clause
+ *
+ ******************************************************************************
+ */
+
+/*
+ * This example was developed using the following STMicroelectronics
+ * evaluation boards:
+ *
+ * - STEVAL_MKI109V3 +
+ * - NUCLEO_F401RE + X-NUCLEO-IKS01A3
+ * - DISCOVERY_SPC584B +
+ * - NUCLEO_H503RB + X-NUCLEO-IKS4A1
+ * - Linux host (e.g. Raspberry Pi) + STEVAL-MKI227KA adapter
+ *
+ * Used interfaces:
+ *
+ * STEVAL_MKI109V3    - Host side:   USB (Virtual COM)
+ *                    - Sensor side: SPI(Default) / I2C(supported)
+ *
+ * NUCLEO_STM32F401RE - Host side: UART(COM) to USB bridge
+ *                    - Sensor side: I2C(Default) / SPI(supported)
+ *
+ * DISCOVERY_SPC584B  - Host side: UART(COM) to USB bridge
+ *                    - Sensor side: I2C(Default) / SPI(supported)
+ *
+ * NUCLEO_STM32H503RG - Host side: UART(COM) to USB bridge
+ *                    - Sensor side: I3C(Default)
+ *
+ * LINUX_I2C_DEV      - Host side:   stdout
+ *                    - Sensor side: /dev/i2c-N (I2C_RDWR, SMBus fallback)
+ *                    - INT1:        /dev/gpiochipN line events (epoll)
+ *
+ * LINUX_SPIDEV       - Host side:   stdout
+ *                    - Sensor side: /dev/spidevB.C (SPI_IOC_MESSAGE)
+ *                    - INT1:        /dev/gpiochipN line events (epoll)
+ *
+ * Linux builds need _prj_Linux/linux_platform.c and _prj_Linux in the
+ * include path (see _prj_Linux/README.md).
+ *
+ * On STM32 boards INT1 is an EXTI line: call
+ * lsm6dsv16x_fifo_irq_latency_handler from HAL_GPIO_EXTI_Callback.
+ * On Linux the handler is called by the event loop with the kernel
+ * timestamp of the edge.
+ *
+ * If you need to run this example on a different hardware platform a
+ * modification of the functions: `platform_write`, `platform_read`,
+ * `tx_com` and 'platform_init' is required.
+ *
+ */
+
+/* STMicroelectronics evaluation boards definition
+ *
+ * Please uncomment ONLY the evaluation boards in use.
+ * If a different hardware is used please comment all
+ * following target board and redefine yours.
+ */
+
+//#define STEVAL_MKI109V3  /* little endian */
+//#define NUCLEO_F401RE    /* little endian */
+//#define SPC584B_DIS      /* big endian */
+//#define LINUX_I2C_DEV    /* little endian */
+//#define LINUX_SPIDEV     /* little endian */
+
+/* ATTENTION: By default the driver is little endian. If you need switch
+ *            to big endian please see "Endianness definitions" in the
+ *            header file of the driver (_reg.h).
+ */
+
+#if defined(STEVAL_MKI109V3)
+/* MKI109V3: Define communication interface */
+#define SENSOR_BUS hspi2
+/* MKI109V3: Vdd and Vddio power supply values */
+#define PWM_3V3 915
+
+#elif defined(NUCLEO_F401RE)
+/* NUCLEO_F401RE: Define communication interface */
+#define SENSOR_BUS hi2c1
+
+#elif defined(SPC584B_DIS)
+/* DISCOVERY_SPC584B: Define communication interface */
+#define SENSOR_BUS I2CD1
+
+#elif defined(NUCLEO_H503RB)
+/* NUCLEO_H503RB: Define communication interface */
+#define SENSOR_BUS hi3c1
+
+#elif defined(LINUX_I2C_DEV) || defined(LINUX_SPIDEV)
+/* Linux: Define communication interface (see linux_bus below) */
+#define SENSOR_BUS linux_bus
+#if defined(LINUX_I2C_DEV)
+#define LINUX_BUS_DEV "/dev/i2c-1"
+#else
+#define LINUX_BUS_DEV "/dev/spidev0.0"
+#endif
+/* Linux: SPI clock [Hz] */
+#define LINUX_SPI_HZ 10000000
+/* Linux: GPIO chip and line offset wired to INT1 */
+#define LINUX_GPIO_CHIP "/dev/gpiochip0"
+#define LINUX_GPIO_LINE 17
+
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include <stdio.h>
+#include "lsm6dsv16x_reg.h"
+
+#if defined(NUCLEO_F401RE)
+#include "stm32f4xx_hal.h"
+#include "usart.h"
+#include "gpio.h"
+#include "i2c.h"
+
+#elif defined(STEVAL_MKI109V3)
+#include "stm32f4xx_hal.h"
+#include "usbd_cdc_if.h"
+#include "gpio.h"
+#include "spi.h"
+#include "tim.h"
+
+#elif defined(SPC584B_DIS)
+#include "components.h"
+
+#elif defined(NUCLEO_H503RB)
+#include "usart.h"
+#include "i3c.h"
+#include "i3c_api.h"
+#include <stdio.h>
+
+static uint8_t i3c_dyn_addr = 0x0A;
+
+#elif defined(LINUX_I2C_DEV) || defined(LINUX_SPIDEV)
+#include <stdlib.h>
+#include "linux_platform.h"
+
+/* Linux character device bus, FIFO slots of 7 bytes (TAG + 6 bytes) */
+static linux_bus_t linux_bus = LINUX_BUS_INIT(LINUX_BUS_DEV, LSM6DSV16X_I2C_ADD_L >> 1,
+                                               LINUX_SPI_HZ,
+                                               LSM6DSV16X_FIFO_DATA_OUT_TAG, 7);
+
+/* INT1: GPIO line requested for rising edge events */
+static linux_irq_t linux_irq;
+#endif
+
+/* Private macro -------------------------------------------------------------*/
+/*
+ * Select FIFO samples watermark, max value is 511
+ * in FIFO are stored acc, gyro and timestamp samples
+ */
+#define BOOT_TIME         10
+#define FIFO_WATERMARK    128
+
+/* FIFO slots read at most per drain, 7 bytes each (TAG + 6 bytes) */
+#define FIFO_MAX          512
+#define FIFO_SLOT_LEN     7
+
+/*
+ * The FIFO threshold interrupt is a level: if samples keep coming while
+ * the FIFO is drained the line never goes low and no new edge is seen.
+ * The FIFO is drained again (up to DRAIN_RETRY times) until the
+ * threshold flag is clear, then up to FLUSH_RETRY more times to recover
+ * the line (also done when no edge comes for IRQ_TIMEOUT_MS).
+ */
+#define DRAIN_RETRY       4
+#define FLUSH_RETRY       16
+
+/* Time without interrupt before a warning [ms] */
+#define IRQ_TIMEOUT_MS    1000
+
+/* Interrupts between two reports */
+#define REPORT_IRQS       100
+
+/* Private typedef -----------------------------------------------------------*/
+/* Interrupt to read latency statistics [ns] */
+typedef struct {
+  uint32_t irqs;
+  uint32_t drains;
+  uint32_t recover;           /* line left high, drained without edge */
+  uint64_t wake_sum;
+  uint64_t wake_max;
+  uint64_t read_sum;
+  uint64_t read_max;
+} irq_lat_t;
+
+/* Private variables ---------------------------------------------------------*/
+static uint8_t whoamI;
+static uint8_t tx_buffer[1000];
+static uint8_t fifo_buf[FIFO_MAX * FIFO_SLOT_LEN];
+
+static int16_t xl_last[3];
+static uint32_t samples;
+static irq_lat_t lat;
+
+/* Edges missed by the platform (Linux: line event sequence gaps) */
+static uint32_t irq_lost;
+
+/* Extern variables ----------------------------------------------------------*/
+
+/* Private functions ---------------------------------------------------------*/
+
+/*
+ *   WARNING:
+ *   Functions declare in this section are defined at the end of this file
+ *   and are strictly related to the hardware platform used.
+ *
+ */
+static int32_t platform_write(void *handle, uint8_t reg, const uint8_t *bufp,
+                              uint16_t len);
+static int32_t platform_read(void *handle, uint8_t reg, uint8_t *bufp,
+                             uint16_t len);
+static void tx_com( uint8_t *tx_buffer, uint16_t len );
+static void platform_delay(uint32_t ms);
+static void platform_init(void *handle);
+static int32_t platform_irq_wait(uint32_t timeout_ms);
+static uint64_t platform_irq_time_ns(void);
+static uint64_t platform_time_ns(void);
+static void platform_irq_disable(void);
+static void platform_irq_enable(void);
+
+static stmdev_ctx_t dev_ctx;
+static volatile uint8_t fifo_event = 0;
+static volatile uint64_t irq_ns;
+
+void lsm6dsv16x_fifo_irq_latency_handler(void)
+{
+  irq_ns = platform_irq_time_ns();
+  fifo_event = 1;
+}
+
+/*
+ * @brief  Stop on a bus error (a failed read leaves a stale buffer)
+ *
+ * @param  what      transaction that failed
+ *
+ */
+static void bus_error(const char *what)
+{
+#if defined(LINUX_I2C_DEV) || defined(LINUX_SPIDEV)
+  fprintf(stderr, "%s: bus error\n", what);
+  exit(1);
+#else
+  (void)what;
+  while (1);
+#endif
+}
+
+/*
+ * @brief  Decode one FIFO slot
+ *
+ * @param  tag       FIFO_DATA_OUT_TAG register value
+ * @param  data      FIFO_DATA_OUT_X_L .. FIFO_DATA_OUT_Z_H
+ *
+ */
+static void fifo_slot_decode(uint8_t tag, const uint8_t *data)
+{
+  uint8_t i;
+
+  switch (tag >> 3) {
+  case LSM6DSV16X_XL_NC_TAG:
+    for (i = 0; i < 3; i++)
+      xl_last[i] = (int16_t)((uint16_t)data[2 * i] |
+                             ((uint16_t)data[2 * i + 1] << 8));
+    samples++;
+    break;
+  case LSM6DSV16X_GY_NC_TAG:
+    samples++;
+    break;
+  default:
+    break;
+  }
+}
+
+/*
+ * @brief  Read and decode num FIFO slots in one bus transaction
+ *
+ * @param  ctx       read / write interface definitions
+ * @param  num       number of slots to read
+ *
+ */
+static void fifo_drain(stmdev_ctx_t *ctx, uint16_t num)
+{
+  uint16_t k;
+
+  if (num > FIFO_MAX)
+    num = FIFO_MAX;
+
+  if (lsm6dsv16x_read_reg(ctx, LSM6DSV16X_FIFO_DATA_OUT_TAG, fifo_buf,
+                          num * FIFO_SLOT_LEN) != 0)
+    bus_error("FIFO read");
+
+  for (k = 0; k < num; k++)
+    fifo_slot_decode(fifo_buf[k * FIFO_SLOT_LEN],
+                     &fifo_buf[k * FIFO_SLOT_LEN + 1]);
+}
+
+/*
+ * @brief  Drain the FIFO while the threshold flag is set
+ *
+ * @param  ctx       read / write interface definitions
+ * @param  rounds    max number of drains
+ * @retval           threshold flag after the last drain
+ *
+ */
+static uint8_t fifo_service(stmdev_ctx_t *ctx, uint8_t rounds)
+{
+  lsm6dsv16x_fifo_status_t fifo_status;
+  uint8_t i = 0;
+
+  do {
+    /* Read watermark flag */
+    if (lsm6dsv16x_fifo_status_get(ctx, &fifo_status) != 0)
+      bus_error("FIFO status read");
+
+    if (fifo_status.fifo_level) {
+      fifo_drain(ctx, fifo_status.fifo_level);
+      lat.drains++;
+    }
+  } while (fifo_status.fifo_th && ++i < rounds);
+
+  return fifo_status.fifo_th;
+}
+
+/* Main Example --------------------------------------------------------------*/
+void lsm6dsv16x_fifo_irq_latency(void)
+{
+  lsm6dsv16x_pin_int_route_t pin_int;
+  lsm6dsv16x_reset_t rst;
+
+  /* Initialize mems driver interface */
+  dev_ctx.write_reg = platform_write;
+  dev_ctx.read_reg = platform_read;
+  dev_ctx.mdelay = platform_delay;
+  dev_ctx.handle = &SENSOR_BUS;
+
+  /* Init test platform */
+  platform_init(dev_ctx.handle);
+  /* Wait sensor boot time */
+  platform_delay(BOOT_TIME);
+
+  /* Check device ID */
+  if (lsm6dsv16x_device_id_get(&dev_ctx, &whoamI) != 0)
+    bus_error("WHO_AM_I read");
+
+  if (whoamI != LSM6DSV16X_ID) {
+#if defined(LINUX_I2C_DEV) || defined(LINUX_SPIDEV)
+    fprintf(stderr, "WHO_AM_I 0x%02X, expected 0x%02X\n", whoamI,
+            LSM6DSV16X_ID);
+    exit(1);
+#else
+    while (1);
+#endif
+  }
+
+  /* Restore default configuration */
+  lsm6dsv16x_reset_set(&dev_ctx, LSM6DSV16X_RESTORE_CTRL_REGS);
+  do {
+    lsm6dsv16x_reset_get(&dev_ctx, &rst);
+  } while (rst != LSM6DSV16X_READY);
+
+  /* Enable Block Data Update */
+  lsm6dsv16x_block_data_update_set(&dev_ctx, PROPERTY_ENABLE);
+
+  /* Set full scale */
+  lsm6dsv16x_xl_full_scale_set(&dev_ctx, LSM6DSV16X_2g);
+  lsm6dsv16x_gy_full_scale_set(&dev_ctx, LSM6DSV16X_2000dps);
+
+  /*
+   * Set FIFO watermark (number of unread sensor data TAG + 6 bytes
+   * stored in FIFO) to FIFO_WATERMARK samples
+   */
+  lsm6dsv16x_fifo_watermark_set(&dev_ctx, FIFO_WATERMARK);
+  /* Set FIFO batch XL/Gyro ODR to 960Hz */
+  lsm6dsv16x_fifo_xl_batch_set(&dev_ctx, LSM6DSV16X_XL_BATCHED_AT_960Hz);
+  lsm6dsv16x_fifo_gy_batch_set(&dev_ctx, LSM6DSV16X_GY_BATCHED_AT_960Hz);
+  /* Set FIFO mode to Stream mode (aka Continuous Mode) */
+  lsm6dsv16x_fifo_mode_set(&dev_ctx, LSM6DSV16X_STREAM_MODE);
+
+#if defined(NUCLEO_H503RB)
+  /* if I3C is used then INT pin must be explicitly enabled */
+  lsm6dsv16x_i3c_int_en_set(&dev_ctx, 1);
+#endif
+
+  memset(&pin_int, 0, sizeof(pin_int));
+  pin_int.fifo_th = PROPERTY_ENABLE;
+  lsm6dsv16x_pin_int1_route_set(&dev_ctx, &pin_int);
+
+  /* Set Output Data Rate */
+  lsm6dsv16x_xl_data_rate_set(&dev_ctx, LSM6DSV16X_ODR_AT_960Hz);
+  lsm6dsv16x_gy_data_rate_set(&dev_ctx, LSM6DSV16X_ODR_AT_960Hz);
+
+  /* handle fifo events */
+  while (1) {
+    uint64_t edge, wake, read;
+    uint8_t event;
+
+    if (platform_irq_wait(IRQ_TIMEOUT_MS) != 0) {
+      /*
+       * An edge lost while INT1 was high leaves the line high for good:
+       * drain to bring the threshold flag, and the line, down
+       */
+      lat.recover++;
+      snprintf((char *)tx_buffer, sizeof(tx_buffer),
+               "no FIFO interrupt in %d ms, FIFO %s\r\n", IRQ_TIMEOUT_MS,
+               fifo_service(&dev_ctx, FLUSH_RETRY) ? "still above threshold" :
+                                                     "drained");
+      tx_com(tx_buffer, strlen((char const *)tx_buffer));
+      continue;
+    }
+
+    /* irq_ns is 64 bit: read it together with the flag, handler masked */
+    platform_irq_disable();
+    event = fifo_event;
+    fifo_event = 0;
+    edge = irq_ns;
+    platform_irq_enable();
+
+    if (event == 0)
+      continue;
+
+    wake = platform_time_ns() - edge;
+
+    if (fifo_service(&dev_ctx, DRAIN_RETRY)) {
+      /* Still above threshold: INT1 stays high and no edge would come */
+      lat.recover++;
+      fifo_service(&dev_ctx, FLUSH_RETRY);
+    }
+
+    read = platform_time_ns() - edge;
+
+    lat.wake_sum += wake;
+    lat.read_sum += read;
+    if (wake > lat.wake_max)
+      lat.wake_max = wake;
+    if (read > lat.read_max)
+      lat.read_max = read;
+
+    if (++lat.irqs < REPORT_IRQS)
+      continue;
+
+    snprintf((char *)tx_buffer, sizeof(tx_buffer),
+             "ACC [mg]:\t%4.2f\t%4.2f\t%4.2f\r\n",
+             lsm6dsv16x_from_fs2_to_mg(xl_last[0]),
+             lsm6dsv16x_from_fs2_to_mg(xl_last[1]),
+             lsm6dsv16x_from_fs2_to_mg(xl_last[2]));
+    tx_com(tx_buffer, strlen((char const *)tx_buffer));
+
+    /* Latencies from the interrupt edge: handler start, FIFO read done */
+    snprintf((char *)tx_buffer, sizeof(tx_buffer),
+             "%lu irqs (%lu lost), %lu drains (%lu recoveries), %lu samples, wake %lu/%lu us, read %lu/%lu us (mean/max)\r\n",
+             (unsigned long)lat.irqs, (unsigned long)irq_lost,
+             (unsigned long)lat.drains, (unsigned long)lat.recover,
+             (unsigned long)samples,
+             (unsigned long)(lat.wake_sum / lat.irqs / 1000U),
+             (unsigned long)(lat.wake_max / 1000U),
+             (unsigned long)(lat.read_sum / lat.irqs / 1000U),
+             (unsigned long)(lat.read_max / 1000U));
+    tx_com(tx_buffer, strlen((char const *)tx_buffer));
+
+    memset(&lat, 0, sizeof(lat));
+    irq_lost = 0;
+    samples = 0;
+  }
+}
+
+/*
+ * @brief  Write generic device register (platform dependent)
+ *
+ * @param  handle    customizable argument. In this examples is used in
+ *                   order to select the correct sensor bus handler.
+ * @param  reg       register to write
+ * @param  bufp      pointer to data to write in register reg
+ * @param  len       number of consecutive register to write
+ *
+ */
+static int32_t platform_write(void *handle, uint8_t reg, const uint8_t *bufp,
+                              uint16_t len)
+{
+  int32_t ret = 0;
+
+#if defined(NUCLEO_F401RE)
+  HAL_I2C_Mem_Write(handle, LSM6DSV16X_I2C_ADD_L, reg,
+                    I2C_MEMADD_SIZE_8BIT, (uint8_t*) bufp, len, 1000);
+#elif defined(STEVAL_MKI109V3)
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_RESET);
+  HAL_SPI_Transmit(handle, &reg, 1, 1000);
+  HAL_SPI_Transmit(handle, (uint8_t*) bufp, len, 1000);
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_SET);
+#elif defined(SPC584B_DIS)
+  i2c_lld_write(handle,  LSM6DSV16X_I2C_ADD_H & 0xFE, reg, (uint8_t*) bufp, len);
+#elif defined(NUCLEO_H503RB)
+  i3c_write(handle, i3c_dyn_addr, reg, (uint8_t*) bufp, len);
+#elif defined(LINUX_I2C_DEV)
+  ret = linux_i2c_write(handle, reg, bufp, len);
+#elif defined(LINUX_SPIDEV)
+  ret = linux_spi_write(handle, reg, bufp, len);
+#endif
+
+  return ret;
+}
+
+/*
+ * @brief  Read generic device register (platform dependent)
+ *
+ * @param  handle    customizable argument. In this examples is used in
+ *                   order to select the correct sensor bus handler.
+ * @param  reg       register to read
+ * @param  bufp      pointer to buffer that store the data read
+ * @param  len       number of consecutive register to read
+ *
+ */
+static int32_t platform_read(void *handle, uint8_t reg, uint8_t *bufp,
+                             uint16_t len)
+{
+  int32_t ret = 0;
+
+#if defined(NUCLEO_F401RE)
+  HAL_I2C_Mem_Read(handle, LSM6DSV16X_I2C_ADD_L, reg,
+                   I2C_MEMADD_SIZE_8BIT, bufp, len, 1000);
+#elif defined(STEVAL_MKI109V3)
+  reg |= 0x80;
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_RESET);
+  HAL_SPI_Transmit(handle, &reg, 1, 1000);
+  HAL_SPI_Receive(handle, bufp, len, 1000);
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_SET);
+#elif defined(SPC584B_DIS)
+  i2c_lld_read(handle, LSM6DSV16X_I2C_ADD_H & 0xFE, reg, bufp, len);
+#elif defined(NUCLEO_H503RB)
+  i3c_read(handle, i3c_dyn_addr, reg, bufp, len);
+#elif defined(LINUX_I2C_DEV)
+  ret = linux_i2c_read(handle, reg, bufp, len);
+#elif defined(LINUX_SPIDEV)
+  ret = linux_spi_read(handle, reg, bufp, len);
+#endif
+
+  return ret;
+}
+
+/*
+ * @brief  Send buffer to console (platform dependent)
+ *
+ * @param  tx_buffer     buffer to transmit
+ * @param  len           number of byte to send
+ *
+ */
+static void tx_com(uint8_t *tx_buffer, uint16_t len)
+{
+#if defined(NUCLEO_F401RE)
+  HAL_UART_Transmit(&huart2, tx_buffer, len, 1000);
+#elif defined(STEVAL_MKI109V3)
+  CDC_Transmit_FS(tx_buffer, len);
+#elif defined(SPC584B_DIS)
+  sd_lld_write(&SD2, tx_buffer, len);
+#elif defined(NUCLEO_H503RB)
+  HAL_UART_Transmit(&huart3, tx_buffer, len, 1000);
+#elif defined(LINUX_I2C_DEV) || defined(LINUX_SPIDEV)
+  linux_tx_com(tx_buffer, len);
+#endif
+}
+
+/*
+ * @brief  platform specific delay (platform dependent)
+ *
+ * @param  ms        delay in ms
+ *
+ */
+static void platform_delay(uint32_t ms)
+{
+#if defined(NUCLEO_F401RE) || defined(STEVAL_MKI109V3) || defined(NUCLEO_H503RB)
+  HAL_Delay(ms);
+#elif defined(SPC584B_DIS)
+  osalThreadDelayMilliseconds(ms);
+#elif defined(LINUX_I2C_DEV) || defined(LINUX_SPIDEV)
+  linux_delay(ms);
+#endif
+}
+
+/*
+ * @brief  platform specific initialization (platform dependent)
+ */
+static void platform_init(void *handle)
+{
+#if defined(STEVAL_MKI109V3)
+  TIM3->CCR1 = PWM_3V3;
+  TIM3->CCR2 = PWM_3V3;
+  HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_1);
+  HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_2);
+  HAL_Delay(1000);
+
+#elif defined(NUCLEO_H503RB)
+  i3c_set_bus_frequency(handle, 1000000);
+  i3c_rstdaa(handle);
+  i3c_setdasa(handle, LSM6DSV16X_I2C_ADD_L, &i3c_dyn_addr, 1);
+  i3c_set_bus_frequency(handle, 12500000);
+
+#elif defined(LINUX_I2C_DEV)
+  linux_i2c_open(handle);
+
+#elif defined(LINUX_SPIDEV)
+  linux_spi_open(handle);
+
+#endif
+
+#if defined(LINUX_I2C_DEV) || defined(LINUX_SPIDEV)
+  linux_irq_open(&linux_irq, LINUX_GPIO_CHIP, LINUX_GPIO_LINE,
+                 "lsm6dsv16x_int1");
+#endif
+
+#if defined(NUCLEO_F401RE) || defined(STEVAL_MKI109V3)
+  /* Cycle counter used by platform_time_ns (Cortex-M DWT) */
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+}
+
+/*
+ * @brief  platform specific monotonic time (platform dependent)
+ *
+ * @retval           time [ns], 0 if not available
+ *
+ */
+static uint64_t platform_time_ns(void)
+{
+#if defined(LINUX_I2C_DEV) || defined(LINUX_SPIDEV)
+  return linux_time_ns();
+#elif defined(NUCLEO_F401RE) || defined(STEVAL_MKI109V3)
+  /*
+   * 64-bit extension of the cycle counter, called often enough. Called
+   * from the handler too: the update is done with interrupts masked
+   * (PRIMASK restored, so it is safe in interrupt context)
+   */
+  static uint64_t cycles;
+  static uint32_t last;
+  uint32_t primask = __get_PRIMASK();
+  uint32_t now;
+  uint64_t t;
+
+  __disable_irq();
+  now = DWT->CYCCNT;
+  cycles += now - last;
+  last = now;
+  t = cycles;
+  __set_PRIMASK(primask);
+
+  return (t * 1000U) / (SystemCoreClock / 1000000U);
+#else
+  return 0;
+#endif
+}
+
+/*
+ * @brief  platform specific interrupt wait (platform dependent)
+ *
+ * On Linux the INT1 line events are read and the example handler is
+ * called for the last one. On other platforms the handler is called by
+ * the EXTI callback: STM32 boards wait for it, SPC584B returns
+ * immediately.
+ *
+ * @param  timeout_ms    max time to wait for an edge
+ * @retval               0 on event (or no wait), -1 on timeout
+ *
+ */
+static int32_t platform_irq_wait(uint32_t timeout_ms)
+{
+#if defined(LINUX_I2C_DEV) || defined(LINUX_SPIDEV)
+  uint32_t lost = linux_irq.lost;
+
+  if (linux_irq_wait(&linux_irq, timeout_ms) != 0)
+    return -1;
+
+  /* Kernel side sequence numbers reveal edges dropped by the buffer */
+  irq_lost += linux_irq.lost - lost;
+
+  /* Edges read in one wake up are serviced by a single drain */
+  lsm6dsv16x_fifo_irq_latency_handler();
+#elif defined(NUCLEO_F401RE) || defined(STEVAL_MKI109V3) || defined(NUCLEO_H503RB)
+  uint32_t t0 = HAL_GetTick();
+
+  while (fifo_event == 0)
+    if (HAL_GetTick() - t0 >= timeout_ms)
+      return -1;
+#else
+  (void)timeout_ms;
+#endif
+
+  return 0;
+}
+
+/*
+ * @brief  platform specific interrupt time (platform dependent)
+ *
+ * @retval           time of the last interrupt edge [ns]
+ *
+ */
+static uint64_t platform_irq_time_ns(void)
+{
+#if defined(LINUX_I2C_DEV) || defined(LINUX_SPIDEV)
+  /* CLOCK_MONOTONIC, as platform_time_ns */
+  return linux_irq.ns;
+#else
+  return platform_time_ns();
+#endif
+}
+
+/*
+ * @brief  platform specific interrupt masking (platform dependent)
+ *
+ * On Linux the handler runs in the main loop: nothing to mask.
+ *
+ */
+static void platform_irq_disable(void)
+{
+#if defined(NUCLEO_F401RE) || defined(STEVAL_MKI109V3) || defined(NUCLEO_H503RB)
+  __disable_irq();
+#elif defined(SPC584B_DIS)
+  osalSysLock();
+#endif
+}
+
+static void platform_irq_enable(void)
+{
+#if defined(NUCLEO_F401RE) || defined(STEVAL_MKI109V3) || defined(NUCLEO_H503RB)
+  __enable_irq();
+#elif defined(SPC584B_DIS)
+  osalSysUnlock();
+#endif
+}
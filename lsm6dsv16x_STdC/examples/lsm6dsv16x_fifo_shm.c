@@ -0,0 +1,870 @@
+/*
+ ******************************************************************************
+ * @file    lsm6dsv16x_fifo_shm.c
+ * @author  Sensors Software Solution Team
+ * @brief   This file show how to share the FIFO samples read by one process
+ *          with many reader processes through a POSIX shared memory ring.
+ *
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2020 STMicroelectronics.
+ * All rights reserved.</center></h2>
+ *
+ * This software component is licensed by ST under BSD 3-Clause license,
+ * the "License"; You may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at:
+ *                        opensource.org/licenses/BSD-3-Clause
+ *
+ ******************************************************************************
+ */
+
+/*
+ * This example was developed using the following STMicroelectronics
+ * evaluation boards:
+ *
+ * - Linux host (e.g. Raspberry Pi) + STEVAL-MKI227KA adapter
+ *
+ * Used interfaces:
+ *
+ * LINUX_I2C_DEV      - Host side:   stdout, POSIX shared memory
+ *                    - Sensor side: /dev/i2c-N (I2C_RDWR, SMBus fallback)
+ *
+ * LINUX_SPIDEV       - Host side:   stdout, POSIX shared memory
+ *                    - Sensor side: /dev/spidevB.C (SPI_IOC_MESSAGE)
+ *
+ * Linux builds need _prj_Linux/linux_platform.c and _prj_Linux in the
+ * include path (see _prj_Linux/README.md).
+ *
+ * The acquisition process runs lsm6dsv16x_fifo_shm, any number of
+ * processes (up to RING_READERS at a time) run lsm6dsv16x_fifo_shm_reader.
+ * lsm6dsv16x_fifo_shm_bench measures the ring alone, no sensor needed.
+ * Link with -lrt on older C libraries.
+ *
+ * If you need to run this example on a different hardware platform a
+ * modification of the functions: `platform_write`, `platform_read`,
+ * `tx_com` and 'platform_init' is required.
+ *
+ */
+
+/* STMicroelectronics evaluation boards definition
+ *
+ * Please uncomment ONLY the evaluation boards in use.
+ * If a different hardware is used please comment all
+ * following target board and redefine yours.
+ */
+
+//#define LINUX_I2C_DEV    /* little endian */
+//#define LINUX_SPIDEV     /* little endian */
+
+/* ATTENTION: By default the driver is little endian. If you need switch
+ *            to big endian please see "Endianness definitions" in the
+ *            header file of the driver (_reg.h).
+ */
+
+#if defined(LINUX_I2C_DEV) || defined(LINUX_SPIDEV)
+/* Linux: Define communication interface (see linux_bus below) */
+#define SENSOR_BUS linux_bus
+#if defined(LINUX_I2C_DEV)
+#define LINUX_BUS_DEV "/dev/i2c-1"
+#else
+#define LINUX_BUS_DEV "/dev/spidev0.0"
+#endif
+/* Linux: SPI clock [Hz] */
+#define LINUX_SPI_HZ 10000000
+
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include <stdio.h>
+#include <stddef.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include "lsm6dsv16x_reg.h"
+
+#if defined(LINUX_I2C_DEV) || defined(LINUX_SPIDEV)
+#include <stdlib.h>
+#include "linux_platform.h"
+
+/* Linux character device bus, FIFO slots of 7 bytes (TAG + 6 bytes) */
+static linux_bus_t linux_bus = LINUX_BUS_INIT(LINUX_BUS_DEV, LSM6DSV16X_I2C_ADD_L >> 1,
+                                               LINUX_SPI_HZ,
+                                               LSM6DSV16X_FIFO_DATA_OUT_TAG, 7);
+#endif
+
+/* Private macro -------------------------------------------------------------*/
+/*
+ * Select FIFO samples watermark, max value is 511
+ * in FIFO are stored acc, gyro and timestamp samples
+ */
+#define BOOT_TIME         10
+#define FIFO_WATERMARK    128
+
+/* FIFO slots read at most per drain, 7 bytes each (TAG + 6 bytes) */
+#define FIFO_MAX          512
+#define FIFO_SLOT_LEN     7
+
+/* Watermark / ring polling period [ms] */
+#define POLL_MS           10
+
+/* Shared memory object, ring length (power of 2) and reader slots */
+#define RING_NAME         "/lsm6dsv16x_fifo"
+#define RING_LEN          65536U
+#define RING_MASK         (RING_LEN - 1U)
+#define RING_READERS      8
+#define RING_MAGIC        0x4C534D36UL
+
+/* Benchmark: samples produced, producer batch, reader processes */
+#define BENCH_SAMPLES     200000000ULL
+#define BENCH_BATCH       FIFO_MAX
+#define BENCH_READERS     3
+
+/* Private typedef -----------------------------------------------------------*/
+/*
+ * Reader slot, published for the other processes (monitoring). pid is
+ * the owner, 0 while the slot is being taken or released: the slot of a
+ * reader that died without detaching is taken over by the next one.
+ */
+typedef struct {
+  _Alignas(64) _Atomic uint32_t used;
+  _Atomic uint32_t pid;
+  _Atomic uint64_t cursor;
+  _Atomic uint64_t samples;
+  _Atomic uint64_t overruns;
+} ring_reader_t;
+
+/*
+ * Sample ring in shared memory, one producer and many readers. Samples
+ * are stored as structure of arrays, so that a reader touches only the
+ * fields it uses, in place.
+ *
+ * The producer never waits for the readers: it moves claim forward
+ * before overwriting slots and head after the slots are written. A
+ * reader is never waited either: it checks against claim that the span
+ * it has just used was not overwritten meanwhile (overrun).
+ *
+ * The sample arrays are plain memory, read and written without atomics
+ * as a seqlock does: a reader may load a sample while the producer
+ * rewrites it and get a mix of old and new fields. Such values are never
+ * trusted: the fences order the slot accesses against claim, ring_release
+ * reports the span as overwritten and whatever was computed from it is
+ * dropped. Readers must only compute from the samples in place (no
+ * pointer or index taken from them) or copy them out first and use the
+ * copy after ring_release returned 0.
+ */
+typedef struct {
+  uint32_t magic;
+  uint32_t len;
+  _Atomic uint32_t closed;
+  _Alignas(64) _Atomic uint64_t claim;
+  _Alignas(64) _Atomic uint64_t head;
+  ring_reader_t reader[RING_READERS];
+  uint8_t tag[RING_LEN];
+  uint32_t ts[RING_LEN];
+  int16_t x[RING_LEN];
+  int16_t y[RING_LEN];
+  int16_t z[RING_LEN];
+} ring_t;
+
+/*
+ * The atomics are shared between processes: a lock based implementation
+ * would keep its lock in each process, not in the shared memory
+ */
+_Static_assert(ATOMIC_LLONG_LOCK_FREE == 2 && ATOMIC_INT_LOCK_FREE == 2,
+               "ring_t atomics must be lock-free to be shared");
+
+/* Reader handle, private to the reader process */
+typedef struct {
+  ring_t *ring;
+  ring_reader_t *slot;
+  uint64_t cursor;
+} ring_cursor_t;
+
+/* Private variables ---------------------------------------------------------*/
+static uint8_t whoamI;
+static uint8_t tx_buffer[1000];
+static uint8_t fifo_buf[FIFO_MAX * FIFO_SLOT_LEN];
+
+/* Extern variables ----------------------------------------------------------*/
+
+/* Private functions ---------------------------------------------------------*/
+
+/*
+ *   WARNING:
+ *   Functions declare in this section are defined at the end of this file
+ *   and are strictly related to the hardware platform used.
+ *
+ */
+static int32_t platform_write(void *handle, uint8_t reg, const uint8_t *bufp,
+                              uint16_t len);
+static int32_t platform_read(void *handle, uint8_t reg, uint8_t *bufp,
+                             uint16_t len);
+static void tx_com( uint8_t *tx_buffer, uint16_t len );
+static void platform_delay(uint32_t ms);
+static void platform_init(void *handle);
+static uint64_t platform_time_ns(void);
+
+/*
+ * @brief  Stop on a bus error (a failed read leaves a stale buffer)
+ *
+ * @param  what      transaction that failed
+ *
+ */
+static void bus_error(const char *what)
+{
+  fprintf(stderr, "%s: bus error\n", what);
+  exit(1);
+}
+
+/*
+ * @brief  Map the ring shared memory object
+ *
+ * @param  create    1: producer, create and reset the ring
+ *                   0: reader, map an existing ring
+ * @retval           ring, NULL on error
+ *
+ */
+static ring_t *ring_map(uint8_t create)
+{
+  ring_t *ring;
+  int fd;
+
+  fd = shm_open(RING_NAME, create ? (O_CREAT | O_RDWR) : O_RDWR, 0600);
+  if (fd < 0)
+    return NULL;
+
+  if (create && ftruncate(fd, sizeof(ring_t)) < 0) {
+    close(fd);
+    return NULL;
+  }
+
+  ring = mmap(NULL, sizeof(ring_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (ring == MAP_FAILED)
+    return NULL;
+
+  if (create) {
+    /* Samples are left as they are: head tells which ones are valid */
+    memset(ring, 0, offsetof(ring_t, tag));
+    ring->len = RING_LEN;
+    atomic_thread_fence(memory_order_release);
+    ring->magic = RING_MAGIC;
+  } else if (ring->magic != RING_MAGIC || ring->len != RING_LEN) {
+    munmap(ring, sizeof(ring_t));
+    return NULL;
+  }
+
+  return ring;
+}
+
+/*
+ * @brief  Start writing n samples
+ *
+ * @param  ring      ring
+ * @param  n         number of samples that will be written
+ * @retval           sequence number of the first sample
+ *
+ */
+static uint64_t ring_write_begin(ring_t *ring, uint32_t n)
+{
+  uint64_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+
+  atomic_store_explicit(&ring->claim, head + n, memory_order_relaxed);
+  /* claim is visible before any of the slots is overwritten */
+  atomic_thread_fence(memory_order_release);
+
+  return head;
+}
+
+/*
+ * @brief  Publish the n samples written after ring_write_begin
+ *
+ * @param  ring      ring
+ * @param  head      value returned by ring_write_begin
+ * @param  n         number of samples written
+ *
+ */
+static void ring_write_end(ring_t *ring, uint64_t head, uint32_t n)
+{
+  atomic_store_explicit(&ring->head, head + n, memory_order_release);
+}
+
+/*
+ * @brief  Take a reader slot whose owner process has died
+ *
+ * @param  slot      reader slot
+ * @param  pid       process taking the slot
+ * @retval           1 if the slot was taken
+ *
+ */
+static uint8_t ring_reclaim(ring_reader_t *slot, uint32_t pid)
+{
+  uint32_t owner = atomic_load(&slot->pid);
+
+  /* 0: being taken or released; EPERM: alive, other user */
+  if (!atomic_load(&slot->used) || owner == 0 ||
+      kill((pid_t)owner, 0) == 0 || errno != ESRCH)
+    return 0;
+
+  /* One of the processes finding it dead gets it */
+  return atomic_compare_exchange_strong(&slot->pid, &owner, pid);
+}
+
+/*
+ * @brief  Get a free reader slot; reading starts from the newest sample
+ *
+ * Slots left used by readers that died without ring_detach are taken
+ * over when no slot is free.
+ *
+ * @param  c         reader handle
+ * @param  ring      ring
+ * @retval           0 on success, -1 if all the slots are used
+ *
+ */
+static int32_t ring_attach(ring_cursor_t *c, ring_t *ring)
+{
+  uint32_t pid = (uint32_t)getpid();
+  ring_reader_t *slot = NULL;
+  uint32_t i;
+
+  for (i = 0; i < RING_READERS && slot == NULL; i++) {
+    uint32_t unused = 0;
+
+    if (atomic_compare_exchange_strong(&ring->reader[i].used, &unused, 1)) {
+      slot = &ring->reader[i];
+      atomic_store(&slot->pid, pid);
+    }
+  }
+
+  for (i = 0; i < RING_READERS && slot == NULL; i++)
+    if (ring_reclaim(&ring->reader[i], pid))
+      slot = &ring->reader[i];
+
+  if (slot == NULL)
+    return -1;
+
+  c->ring = ring;
+  c->slot = slot;
+  c->cursor = atomic_load_explicit(&ring->head, memory_order_acquire);
+  atomic_store(&slot->cursor, c->cursor);
+  atomic_store(&slot->samples, 0);
+  atomic_store(&slot->overruns, 0);
+
+  return 0;
+}
+
+/*
+ * @brief  Release the reader slot
+ *
+ * @param  c         reader handle
+ *
+ */
+static void ring_detach(ring_cursor_t *c)
+{
+  atomic_store(&c->slot->pid, 0);
+  atomic_store(&c->slot->used, 0);
+}
+
+/*
+ * @brief  Get the span of samples available to the reader
+ *
+ * The span is contiguous in the ring arrays, starting at index *idx.
+ * Samples are used in place, then ring_release tells if they were valid
+ * (they may be torn by the producer meanwhile, see ring_t).
+ *
+ * @param  c         reader handle
+ * @param  max       max number of samples
+ * @param  idx       index of the first sample in the ring arrays
+ * @retval           number of samples available
+ *
+ */
+static uint32_t ring_peek(ring_cursor_t *c, uint32_t max, uint32_t *idx)
+{
+  ring_t *ring = c->ring;
+  uint64_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+  uint64_t claim = atomic_load_explicit(&ring->claim, memory_order_relaxed);
+  uint64_t n;
+
+  /* Lapped by the producer: skip to the oldest sample still intact */
+  if (claim - c->cursor > RING_LEN) {
+    uint64_t lost = claim - RING_LEN - c->cursor;
+
+    atomic_fetch_add_explicit(&c->slot->overruns, lost, memory_order_relaxed);
+    c->cursor += lost;
+  }
+
+  n = head - c->cursor;
+  if (n > RING_LEN - (c->cursor & RING_MASK))
+    n = RING_LEN - (c->cursor & RING_MASK);
+  if (n > max)
+    n = max;
+
+  *idx = (uint32_t)(c->cursor & RING_MASK);
+
+  return (uint32_t)n;
+}
+
+/*
+ * @brief  Consume the n samples got with ring_peek
+ *
+ * @param  c         reader handle
+ * @param  n         number of samples used
+ * @retval           0 if the samples were valid, -1 if they have been
+ *                   overwritten while in use (results must be dropped)
+ *
+ */
+static int32_t ring_release(ring_cursor_t *c, uint32_t n)
+{
+  uint64_t claim;
+  int32_t ret = 0;
+
+  /* Slot reads are done before claim is checked */
+  atomic_thread_fence(memory_order_acquire);
+  claim = atomic_load_explicit(&c->ring->claim, memory_order_relaxed);
+
+  if (claim - c->cursor > RING_LEN) {
+    atomic_fetch_add_explicit(&c->slot->overruns, n, memory_order_relaxed);
+    ret = -1;
+  } else {
+    atomic_fetch_add_explicit(&c->slot->samples, n, memory_order_relaxed);
+  }
+
+  c->cursor += n;
+  atomic_store_explicit(&c->slot->cursor, c->cursor, memory_order_relaxed);
+
+  return ret;
+}
+
+/*
+ * @brief  Read num FIFO slots and publish the acc / gyro samples
+ *
+ * Timestamp slots are not stored: their value is given to the samples
+ * that follow.
+ *
+ * @param  ctx       read / write interface definitions
+ * @param  ring      ring
+ * @param  num       number of slots to read
+ * @param  ts        last timestamp seen, updated
+ * @retval           number of samples published
+ *
+ */
+static uint32_t fifo_publish(stmdev_ctx_t *ctx, ring_t *ring, uint16_t num,
+                             uint32_t *ts)
+{
+  uint64_t head;
+  uint32_t n = 0;
+  uint16_t k;
+
+  if (num > FIFO_MAX)
+    num = FIFO_MAX;
+
+  if (lsm6dsv16x_read_reg(ctx, LSM6DSV16X_FIFO_DATA_OUT_TAG, fifo_buf,
+                          num * FIFO_SLOT_LEN) != 0)
+    bus_error("FIFO read");
+
+  for (k = 0; k < num; k++) {
+    uint8_t tag = fifo_buf[k * FIFO_SLOT_LEN] >> 3;
+
+    if (tag == LSM6DSV16X_XL_NC_TAG || tag == LSM6DSV16X_GY_NC_TAG)
+      n++;
+  }
+
+  head = ring_write_begin(ring, n);
+  n = 0;
+
+  for (k = 0; k < num; k++) {
+    const uint8_t *d = &fifo_buf[k * FIFO_SLOT_LEN];
+    uint8_t tag = d[0] >> 3;
+    uint32_t i = (uint32_t)((head + n) & RING_MASK);
+
+    if (tag == LSM6DSV16X_TIMESTAMP_TAG) {
+      *ts = (uint32_t)d[1] | ((uint32_t)d[2] << 8) |
+            ((uint32_t)d[3] << 16) | ((uint32_t)d[4] << 24);
+      continue;
+    }
+
+    if (tag != LSM6DSV16X_XL_NC_TAG && tag != LSM6DSV16X_GY_NC_TAG)
+      continue;
+
+    ring->tag[i] = tag;
+    ring->ts[i] = *ts;
+    ring->x[i] = (int16_t)((uint16_t)d[1] | ((uint16_t)d[2] << 8));
+    ring->y[i] = (int16_t)((uint16_t)d[3] | ((uint16_t)d[4] << 8));
+    ring->z[i] = (int16_t)((uint16_t)d[5] | ((uint16_t)d[6] << 8));
+    n++;
+  }
+
+  ring_write_end(ring, head, n);
+
+  return n;
+}
+
+/*
+ * @brief  Benchmark reader process: check every sample it accepts
+ *
+ * @param  ring      ring
+ * @param  id        reader number
+ *
+ */
+static void bench_reader(ring_t *ring, uint32_t id)
+{
+  ring_cursor_t c;
+  uint64_t errors = 0, sum = 0;
+
+  if (ring_attach(&c, ring) != 0)
+    return;
+
+  while (1) {
+    uint64_t first, bad = 0;
+    uint32_t idx, n, j;
+
+    n = ring_peek(&c, RING_LEN, &idx);
+    if (n == 0) {
+      if (atomic_load(&ring->closed) && c.cursor == atomic_load(&ring->head))
+        break;
+      continue;
+    }
+
+    /* x holds the low bits of the sequence number */
+    first = c.cursor;
+    for (j = 0; j < n; j++) {
+      bad += (ring->x[idx + j] != (int16_t)(first + j));
+      sum += (uint16_t)ring->y[idx + j] + (uint16_t)ring->z[idx + j];
+    }
+
+    if (ring_release(&c, n) == 0)
+      errors += bad;
+  }
+
+  snprintf((char *)tx_buffer, sizeof(tx_buffer),
+           "reader %lu: %llu samples, %llu overruns, %llu errors (sum %llx)\r\n",
+           (unsigned long)id,
+           (unsigned long long)atomic_load(&c.slot->samples),
+           (unsigned long long)atomic_load(&c.slot->overruns),
+           (unsigned long long)errors, (unsigned long long)sum);
+  tx_com(tx_buffer, strlen((char const *)tx_buffer));
+  ring_detach(&c);
+}
+
+/* Main Example --------------------------------------------------------------*/
+/* Acquisition process: FIFO to shared memory ring */
+void lsm6dsv16x_fifo_shm(void)
+{
+  lsm6dsv16x_fifo_status_t fifo_status;
+  stmdev_ctx_t dev_ctx;
+  lsm6dsv16x_reset_t rst;
+  ring_t *ring;
+  uint32_t ts = 0;
+
+  /* Initialize mems driver interface */
+  dev_ctx.write_reg = platform_write;
+  dev_ctx.read_reg = platform_read;
+  dev_ctx.mdelay = platform_delay;
+  dev_ctx.handle = &SENSOR_BUS;
+
+  /* Init test platform */
+  platform_init(dev_ctx.handle);
+  /* Wait sensor boot time */
+  platform_delay(BOOT_TIME);
+
+  ring = ring_map(1);
+  if (ring == NULL)
+    exit(1);
+
+  /* Check device ID */
+  if (lsm6dsv16x_device_id_get(&dev_ctx, &whoamI) != 0)
+    bus_error("WHO_AM_I read");
+
+  if (whoamI != LSM6DSV16X_ID) {
+    fprintf(stderr, "WHO_AM_I 0x%02X, expected 0x%02X\n", whoamI,
+            LSM6DSV16X_ID);
+    exit(1);
+  }
+
+  /* Restore default configuration */
+  lsm6dsv16x_reset_set(&dev_ctx, LSM6DSV16X_RESTORE_CTRL_REGS);
+  do {
+    lsm6dsv16x_reset_get(&dev_ctx, &rst);
+  } while (rst != LSM6DSV16X_READY);
+
+  /* Enable Block Data Update */
+  lsm6dsv16x_block_data_update_set(&dev_ctx, PROPERTY_ENABLE);
+
+  /* Set full scale */
+  lsm6dsv16x_xl_full_scale_set(&dev_ctx, LSM6DSV16X_2g);
+  lsm6dsv16x_gy_full_scale_set(&dev_ctx, LSM6DSV16X_2000dps);
+
+  /*
+   * Set FIFO watermark (number of unread sensor data TAG + 6 bytes
+   * stored in FIFO) to FIFO_WATERMARK samples
+   */
+  lsm6dsv16x_fifo_watermark_set(&dev_ctx, FIFO_WATERMARK);
+  /* Set FIFO batch XL/Gyro ODR to 960Hz */
+  lsm6dsv16x_fifo_xl_batch_set(&dev_ctx, LSM6DSV16X_XL_BATCHED_AT_960Hz);
+  lsm6dsv16x_fifo_gy_batch_set(&dev_ctx, LSM6DSV16X_GY_BATCHED_AT_960Hz);
+
+  /* Set FIFO mode to Stream mode (aka Continuous Mode) */
+  lsm6dsv16x_fifo_mode_set(&dev_ctx, LSM6DSV16X_STREAM_MODE);
+
+  /* Set Output Data Rate */
+  lsm6dsv16x_xl_data_rate_set(&dev_ctx, LSM6DSV16X_ODR_AT_960Hz);
+  lsm6dsv16x_gy_data_rate_set(&dev_ctx, LSM6DSV16X_ODR_AT_960Hz);
+  lsm6dsv16x_fifo_timestamp_batch_set(&dev_ctx, LSM6DSV16X_TMSTMP_DEC_1);
+  lsm6dsv16x_timestamp_set(&dev_ctx, PROPERTY_ENABLE);
+
+  snprintf((char *)tx_buffer, sizeof(tx_buffer),
+           "publishing to shm %s (%u samples)\r\n", RING_NAME, RING_LEN);
+  tx_com(tx_buffer, strlen((char const *)tx_buffer));
+
+  while (1) {
+    /* Read watermark flag */
+    if (lsm6dsv16x_fifo_status_get(&dev_ctx, &fifo_status) != 0)
+      bus_error("FIFO status read");
+
+    if (fifo_status.fifo_th == 0) {
+      platform_delay(POLL_MS);
+      continue;
+    }
+
+    fifo_publish(&dev_ctx, ring, fifo_status.fifo_level, &ts);
+  }
+}
+
+/* Reader process: mean acceleration once per second */
+void lsm6dsv16x_fifo_shm_reader(void)
+{
+  ring_cursor_t c;
+  ring_t *ring;
+  int32_t sum[3] = { 0 };
+  uint32_t num = 0;
+  uint64_t t0;
+
+  ring = ring_map(0);
+  if (ring == NULL || ring_attach(&c, ring) != 0)
+    exit(1);
+
+  t0 = platform_time_ns();
+
+  while (1) {
+    int32_t s[3] = { 0 };
+    uint32_t idx, n, i, k = 0;
+
+    n = ring_peek(&c, RING_LEN, &idx);
+    if (n == 0) {
+      platform_delay(POLL_MS);
+      continue;
+    }
+
+    for (i = idx; i < idx + n; i++) {
+      if (ring->tag[i] != LSM6DSV16X_XL_NC_TAG)
+        continue;
+      s[0] += ring->x[i];
+      s[1] += ring->y[i];
+      s[2] += ring->z[i];
+      k++;
+    }
+
+    if (ring_release(&c, n) == 0) {
+      sum[0] += s[0];
+      sum[1] += s[1];
+      sum[2] += s[2];
+      num += k;
+    }
+
+    if (platform_time_ns() - t0 < 1000000000ULL || num == 0)
+      continue;
+
+    snprintf((char *)tx_buffer, sizeof(tx_buffer),
+             "ACC [mg]:\t%4.2f\t%4.2f\t%4.2f\t(%lu samples, %llu overruns)\r\n",
+             lsm6dsv16x_from_fs2_to_mg((int16_t)(sum[0] / (int32_t)num)),
+             lsm6dsv16x_from_fs2_to_mg((int16_t)(sum[1] / (int32_t)num)),
+             lsm6dsv16x_from_fs2_to_mg((int16_t)(sum[2] / (int32_t)num)),
+             (unsigned long)num,
+             (unsigned long long)atomic_load(&c.slot->overruns));
+    tx_com(tx_buffer, strlen((char const *)tx_buffer));
+
+    memset(sum, 0, sizeof(sum));
+    num = 0;
+    t0 = platform_time_ns();
+  }
+}
+
+/*
+ * Ring benchmark, no sensor: BENCH_READERS reader processes check every
+ * sample they accept while this process publishes BENCH_SAMPLES samples
+ * as fast as it can.
+ */
+void lsm6dsv16x_fifo_shm_bench(void)
+{
+  ring_t *ring;
+  uint64_t seq, t;
+  pid_t pid[BENCH_READERS];
+  uint32_t i;
+
+  ring = ring_map(1);
+  if (ring == NULL)
+    exit(1);
+
+  for (i = 0; i < BENCH_READERS; i++) {
+    pid[i] = fork();
+    if (pid[i] != 0)
+      continue;
+
+    bench_reader(ring, i);
+    _exit(0);
+  }
+
+  /* Start when all the readers are attached */
+  do {
+    uint32_t used = 0;
+
+    for (i = 0; i < RING_READERS; i++)
+      used += atomic_load(&ring->reader[i].used);
+    if (used == BENCH_READERS)
+      break;
+    platform_delay(1);
+  } while (1);
+
+  t = platform_time_ns();
+
+  for (seq = 0; seq < BENCH_SAMPLES; seq += BENCH_BATCH) {
+    uint64_t head = ring_write_begin(ring, BENCH_BATCH);
+    uint32_t j;
+
+    for (j = 0; j < BENCH_BATCH; j++) {
+      uint32_t k = (uint32_t)((head + j) & RING_MASK);
+
+      ring->tag[k] = LSM6DSV16X_XL_NC_TAG;
+      ring->ts[k] = (uint32_t)(head + j);
+      ring->x[k] = (int16_t)(head + j);
+      ring->y[k] = (int16_t)j;
+      ring->z[k] = (int16_t)~j;
+    }
+
+    ring_write_end(ring, head, BENCH_BATCH);
+  }
+
+  t = platform_time_ns() - t;
+  atomic_store(&ring->closed, 1);
+
+  snprintf((char *)tx_buffer, sizeof(tx_buffer),
+           "producer: %llu samples in %llu ms, %.1f Msamples/s\r\n",
+           (unsigned long long)BENCH_SAMPLES,
+           (unsigned long long)(t / 1000000U),
+           (double)BENCH_SAMPLES * 1000.0 / (double)t);
+  tx_com(tx_buffer, strlen((char const *)tx_buffer));
+
+  for (i = 0; i < BENCH_READERS; i++)
+    waitpid(pid[i], NULL, 0);
+
+  munmap(ring, sizeof(ring_t));
+  shm_unlink(RING_NAME);
+}
+
+/*
+ * @brief  Write generic device register (platform dependent)
+ *
+ * @param  handle    customizable argument. In this examples is used in
+ *                   order to select the correct sensor bus handler.
+ * @param  reg       register to write
+ * @param  bufp      pointer to data to write in register reg
+ * @param  len       number of consecutive register to write
+ *
+ */
+static int32_t platform_write(void *handle, uint8_t reg, const uint8_t *bufp,
+                              uint16_t len)
+{
+  int32_t ret = 0;
+
+#if defined(LINUX_I2C_DEV)
+  ret = linux_i2c_write(handle, reg, bufp, len);
+#elif defined(LINUX_SPIDEV)
+  ret = linux_spi_write(handle, reg, bufp, len);
+#endif
+
+  return ret;
+}
+
+/*
+ * @brief  Read generic device register (platform dependent)
+ *
+ * @param  handle    customizable argument. In this examples is used in
+ *                   order to select the correct sensor bus handler.
+ * @param  reg       register to read
+ * @param  bufp      pointer to buffer that store the data read
+ * @param  len       number of consecutive register to read
+ *
+ */
+static int32_t platform_read(void *handle, uint8_t reg, uint8_t *bufp,
+                             uint16_t len)
+{
+  int32_t ret = 0;
+
+#if defined(LINUX_I2C_DEV)
+  ret = linux_i2c_read(handle, reg, bufp, len);
+#elif defined(LINUX_SPIDEV)
+  ret = linux_spi_read(handle, reg, bufp, len);
+#endif
+
+  return ret;
+}
+
+/*
+ * @brief  Send buffer to console (platform dependent)
+ *
+ * @param  tx_buffer     buffer to transmit
+ * @param  len           number of byte to send
+ *
+ */
+static void tx_com(uint8_t *tx_buffer, uint16_t len)
+{
+#if defined(LINUX_I2C_DEV) || defined(LINUX_SPIDEV)
+  linux_tx_com(tx_buffer, len);
+#endif
+}
+
+/*
+ * @brief  platform specific delay (platform dependent)
+ *
+ * @param  ms        delay in ms
+ *
+ */
+static void platform_delay(uint32_t ms)
+{
+#if defined(LINUX_I2C_DEV) || defined(LINUX_SPIDEV)
+  linux_delay(ms);
+#endif
+}
+
+/*
+ * @brief  platform specific initialization (platform dependent)
+ */
+static void platform_init(void *handle)
+{
+#if defined(LINUX_I2C_DEV)
+  linux_i2c_open(handle);
+
+#elif defined(LINUX_SPIDEV)
+  linux_spi_open(handle);
+
+#endif
+}
+
+/*
+ * @brief  platform specific monotonic time (platform dependent)
+ *
+ * @retval           time [ns]
+ *
+ */
+static uint64_t platform_time_ns(void)
+{
+  return linux_time_ns();
+}
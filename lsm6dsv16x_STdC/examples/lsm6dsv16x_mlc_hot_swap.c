@@ -0,0 +1,570 @@
+/*
+ ******************************************************************************
+ * @file    mlc_hot_swap.c
+ * @author  Sensors Software Solution Team
+ * @brief   This file shows how to switch between MLC configurations at runtime
+ *          by writing only the registers that differ.
+ *
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2021 STMicroelectronics.
+ * All rights reserved.</center></h2>
+ *
+ * This software component is licensed by ST under BSD 3-Clause license,
+ * the "License"; You may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at:
+ *                        opensource.org/licenses/BSD-3-Clause
+ *
+ ******************************************************************************
+ */
+
+/*
+ * This example was developed using the following STMicroelectronics
+ * evaluation boards:
+ *
+ * - STEVAL_MKI109V3 +
+ * - NUCLEO_F401RE + X-NUCLEO-IKS01A3
+ * - DISCOVERY_SPC584B +
+ * - NUCLEO_H503RB + X-NUCLEO-IKS4A1
+ *
+ * Used interfaces:
+ *
+ * STEVAL_MKI109V3    - Host side:   USB (Virtual COM)
+ *                    - Sensor side: SPI(Default) / I2C(supported)
+ *
+ * NUCLEO_STM32F401RE - Host side: UART(COM) to USB bridge
+ *                    - Sensor side: I2C(Default) / SPI(supported)
+ *
+ * DISCOVERY_SPC584B  - Host side: UART(COM) to USB bridge
+ *                    - Sensor side: I2C(Default) / SPI(supported)
+ *
+ * NUCLEO_STM32H503RG - Host side: UART(COM) to USB bridge
+ *                    - Sensor side: I3C(Default)
+ *
+ * If you need to run this example on a different hardware platform a
+ * modification of the functions: `platform_write`, `platform_read`,
+ * `tx_com` and 'platform_init' is required.
+ *
+ */
+
+/* STMicroelectronics evaluation boards definition
+ *
+ * Please uncomment ONLY the evaluation boards in use.
+ * If a different hardware is used please comment all
+ * following target board and redefine yours.
+ */
+
+//#define STEVAL_MKI109V3  /* little endian */
+//#define NUCLEO_F401RE    /* little endian */
+//#define SPC584B_DIS      /* big endian */
+
+/* ATTENTION: By default the driver is little endian. If you need switch
+ *            to big endian please see "Endianness definitions" in the
+ *            header file of the driver (_reg.h).
+ */
+
+#if defined(STEVAL_MKI109V3)
+/* MKI109V3: Define communication interface */
+#define SENSOR_BUS hspi2
+/* MKI109V3: Vdd and Vddio power supply values */
+#define PWM_3V3 915
+
+#elif defined(NUCLEO_F401RE)
+/* NUCLEO_F401RE: Define communication interface */
+#define SENSOR_BUS hi2c1
+
+#elif defined(SPC584B_DIS)
+/* DISCOVERY_SPC584B: Define communication interface */
+#define SENSOR_BUS I2CD1
+
+#elif defined(NUCLEO_H503RB)
+/* NUCLEO_H503RB: Define communication interface */
+#define SENSOR_BUS hi3c1
+
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include <stdio.h>
+#include "lsm6dsv16x_gym_activity_recognition_left.h"
+#include "lsm6dsv16x_gym_activity_recognition_right.h"
+#include "lsm6dsv16x_reg.h"
+
+#if defined(NUCLEO_F401RE)
+#include "stm32f4xx_hal.h"
+#include "usart.h"
+#include "gpio.h"
+#include "i2c.h"
+
+#elif defined(STEVAL_MKI109V3)
+#include "stm32f4xx_hal.h"
+#include "usbd_cdc_if.h"
+#include "gpio.h"
+#include "spi.h"
+#include "tim.h"
+
+#elif defined(SPC584B_DIS)
+#include "components.h"
+
+#elif defined(NUCLEO_H503RB)
+#include "usart.h"
+#include "i3c.h"
+#include "i3c_api.h"
+#include <stdio.h>
+
+static uint8_t i3c_dyn_addr = 0x0A;
+#endif
+
+/* Private macro -------------------------------------------------------------*/
+#define    BOOT_TIME            10 //ms
+
+/* Max number of lines in a delta script */
+#define    DELTA_MAX            2048
+
+/* Embedded functions register bank and advanced pages */
+#define    EMB_FUNC_REG_ACCESS  0x80U
+#define    PAGE_NUM             16
+
+/* Private typedef -----------------------------------------------------------*/
+/*
+ * Shadow of the device registers written through UCF scripts: main and
+ * embedded functions banks, plus the advanced pages reached through
+ * PAGE_SEL / PAGE_ADDRESS / PAGE_VALUE. A location is known only once
+ * it has been written.
+ */
+typedef struct {
+  uint8_t main[128];
+  uint8_t emb[128];
+  uint8_t page[PAGE_NUM][256];
+  uint8_t main_known[128 / 8];
+  uint8_t emb_known[128 / 8];
+  uint8_t page_known[PAGE_NUM][256 / 8];
+} ucf_shadow_t;
+
+/* Write script moving the device from one configuration to another */
+typedef struct {
+  ucf_line_t line[DELTA_MAX];
+  uint16_t len;
+} ucf_delta_t;
+
+/* Private variables ---------------------------------------------------------*/
+static uint8_t whoamI;
+static uint8_t tx_buffer[1000];
+static ucf_shadow_t shadow;
+static ucf_delta_t delta_to_left;
+static ucf_delta_t delta_to_right;
+
+/* Extern variables ----------------------------------------------------------*/
+
+/* Private functions ---------------------------------------------------------*/
+/*
+ *   WARNING:
+ *   Functions declare in this section are defined at the end of this file
+ *   and are strictly related to the hardware platform used.
+ *
+ */
+static int32_t platform_write(void *handle, uint8_t reg, const uint8_t *bufp,
+                              uint16_t len);
+static int32_t platform_read(void *handle, uint8_t reg, uint8_t *bufp,
+                             uint16_t len);
+static void tx_com( uint8_t *tx_buffer, uint16_t len );
+static void platform_delay(uint32_t ms);
+static void platform_init(void *handle);
+
+
+static stmdev_ctx_t dev_ctx;
+static volatile uint8_t mlc_event = 0;
+static volatile uint8_t swap_request = 0;
+
+#if defined(NUCLEO_F401RE) || defined(STEVAL_MKI109V3)
+/* Cycle counter used to measure the sensing gap (Cortex-M DWT) */
+static void cycles_init(void)
+{
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+static uint32_t cycles_get(void)
+{
+  return DWT->CYCCNT;
+}
+
+static uint32_t cycles_to_us(uint32_t cycles)
+{
+  return cycles / (SystemCoreClock / 1000000U);
+}
+#else
+static void cycles_init(void) {}
+static uint32_t cycles_get(void) { return 0; }
+static uint32_t cycles_to_us(uint32_t cycles) { return cycles; }
+#endif
+
+/*
+ * MLC interrupt: the MLC output is read in the main loop, as reading it
+ * switches register bank and would corrupt a delta being applied.
+ */
+void lsm6dsv16x_mlc_hot_swap_handler(void)
+{
+  mlc_event = 1;
+}
+
+/* Context switch request (e.g. user button) */
+void lsm6dsv16x_mlc_hot_swap_request_handler(void)
+{
+  swap_request = 1;
+}
+
+/*
+ * @brief  Compare a write with the shadow and update it
+ *
+ * @param  val       shadow location
+ * @param  known     known bitmap of the shadow area
+ * @param  idx       location index
+ * @param  data      value to write
+ * @retval           1 if the device already holds data, 0 otherwise
+ *
+ */
+static uint8_t shadow_update(uint8_t *val, uint8_t *known, uint16_t idx,
+                             uint8_t data)
+{
+  uint8_t mask = (uint8_t)(1U << (idx & 7U));
+  uint8_t same = ((known[idx >> 3] & mask) && val[idx] == data) ? 1 : 0;
+
+  val[idx] = data;
+  known[idx >> 3] |= mask;
+
+  return same;
+}
+
+/*
+ * @brief  Build the delta script bringing the shadowed device to a UCF
+ *
+ * The UCF is walked in order, keeping track of the register bank and of
+ * the page pointer, and every write whose location already holds the
+ * value is dropped. Bank and page selection, PAGE_RW and EMB_FUNC_INIT
+ * writes are always kept, so the sequencing of the UCF (disable,
+ * program, enable) is preserved. When page writes have been dropped,
+ * PAGE_ADDRESS is written again before the next page write.
+ *
+ * On return the shadow describes the device after the delta is applied.
+ *
+ * @param  s         shadow of the device
+ * @param  ucf       target configuration
+ * @param  n         number of lines in the configuration
+ * @param  d         delta script
+ * @retval           0 on success, -1 if the delta does not fit
+ *
+ */
+static int32_t ucf_delta_build(ucf_shadow_t *s, const ucf_line_t *ucf,
+                               uint32_t n, ucf_delta_t *d)
+{
+  uint8_t emb_bank = 0;
+  uint8_t page = 0, page_addr = 0;
+  uint8_t page_sync = 1;
+  uint8_t skip;
+  uint32_t i;
+
+  d->len = 0;
+
+  for (i = 0; i < n; i++) {
+    uint8_t addr = ucf[i].address;
+    uint8_t data = ucf[i].data;
+
+    skip = 0;
+    if (addr == LSM6DSV16X_FUNC_CFG_ACCESS) {
+      emb_bank = (data & EMB_FUNC_REG_ACCESS) ? 1 : 0;
+    } else if (!emb_bank) {
+      skip = shadow_update(s->main, s->main_known, addr & 0x7FU, data);
+    } else if (addr == LSM6DSV16X_PAGE_SEL) {
+      page = (data >> 4) % PAGE_NUM;
+    } else if (addr == LSM6DSV16X_PAGE_ADDRESS) {
+      page_addr = data;
+      page_sync = 1;
+    } else if (addr == LSM6DSV16X_PAGE_VALUE) {
+      skip = shadow_update(s->page[page], s->page_known[page], page_addr,
+                           data);
+      if (skip) {
+        page_sync = 0;
+      } else if (!page_sync) {
+        /* Re-align the device auto-incremented page pointer */
+        if (d->len >= DELTA_MAX)
+          return -1;
+        d->line[d->len].address = LSM6DSV16X_PAGE_ADDRESS;
+        d->line[d->len].data = page_addr;
+        d->len++;
+        page_sync = 1;
+      }
+      page_addr++;
+    } else if (addr != LSM6DSV16X_PAGE_RW &&
+               addr != LSM6DSV16X_EMB_FUNC_INIT_A &&
+               addr != LSM6DSV16X_EMB_FUNC_INIT_B) {
+      skip = shadow_update(s->emb, s->emb_known, addr & 0x7FU, data);
+    }
+
+    if (skip)
+      continue;
+
+    if (d->len >= DELTA_MAX)
+      return -1;
+    d->line[d->len].address = addr;
+    d->line[d->len].data = data;
+    d->len++;
+  }
+
+  return 0;
+}
+
+/*
+ * @brief  Apply a delta script
+ *
+ * @param  ctx       read / write interface definitions
+ * @param  d         delta script
+ * @retval           interface status (MANDATORY: return 0 -> no Error)
+ *
+ */
+static int32_t ucf_delta_apply(stmdev_ctx_t *ctx, const ucf_delta_t *d)
+{
+  int32_t ret = 0;
+  uint16_t i;
+
+  for (i = 0; i < d->len && ret == 0; i++)
+    ret = lsm6dsv16x_write_reg(ctx, d->line[i].address,
+                               (uint8_t *)&d->line[i].data, 1);
+
+  return ret;
+}
+
+/* Main Example --------------------------------------------------------------*/
+void lsm6dsv16x_mlc_hot_swap(void)
+{
+  ucf_delta_t *full = &delta_to_left; /* scratch until deltas are built */
+  const ucf_delta_t *next;
+  lsm6dsv16x_reset_t rst;
+  uint8_t gym_event_catched = 0;
+  uint8_t right = 1;
+  uint32_t gap;
+
+  /* Initialize mems driver interface */
+  dev_ctx.write_reg = platform_write;
+  dev_ctx.read_reg = platform_read;
+  dev_ctx.mdelay = platform_delay;
+  dev_ctx.handle = &SENSOR_BUS;
+
+  /* Init test platform */
+  platform_init(dev_ctx.handle);
+  /* Wait sensor boot time */
+  platform_delay(BOOT_TIME);
+  /* Check device ID */
+  lsm6dsv16x_device_id_get(&dev_ctx, &whoamI);
+
+  if (whoamI != LSM6DSV16X_ID)
+    while (1);
+
+  /* Restore default configuration */
+  lsm6dsv16x_reset_set(&dev_ctx, LSM6DSV16X_RESTORE_CTRL_REGS);
+  do {
+    lsm6dsv16x_reset_get(&dev_ctx, &rst);
+  } while (rst != LSM6DSV16X_READY);
+
+#if defined(NUCLEO_H503RB)
+  /* if I3C is used then INT pin must be explicitly enabled */
+  lsm6dsv16x_i3c_int_en_set(&dev_ctx, 1);
+#endif
+
+  cycles_init();
+
+  /*
+   * Full load of the right wrist configuration (nothing known yet, so the
+   * delta is the whole UCF), then precompute the two swap deltas. The
+   * shadow ends up describing the right wrist configuration again.
+   */
+  if (ucf_delta_build(&shadow, lsm6dsv16x_gym_activity_recognition_right,
+                      sizeof(lsm6dsv16x_gym_activity_recognition_right) /
+                      sizeof(ucf_line_t), full) != 0)
+    while (1);
+  ucf_delta_apply(&dev_ctx, full);
+
+  if (ucf_delta_build(&shadow, lsm6dsv16x_gym_activity_recognition_left,
+                      sizeof(lsm6dsv16x_gym_activity_recognition_left) /
+                      sizeof(ucf_line_t), &delta_to_left) != 0 ||
+      ucf_delta_build(&shadow, lsm6dsv16x_gym_activity_recognition_right,
+                      sizeof(lsm6dsv16x_gym_activity_recognition_right) /
+                      sizeof(ucf_line_t), &delta_to_right) != 0)
+    while (1);
+
+  snprintf((char *)tx_buffer, sizeof(tx_buffer),
+           "delta to left %d/%d lines, to right %d/%d lines\r\n",
+           delta_to_left.len,
+           (int)(sizeof(lsm6dsv16x_gym_activity_recognition_left) / sizeof(ucf_line_t)),
+           delta_to_right.len,
+           (int)(sizeof(lsm6dsv16x_gym_activity_recognition_right) / sizeof(ucf_line_t)));
+  tx_com(tx_buffer, strlen((char const *)tx_buffer));
+
+  /* wait forever (MLC event and swap request flagged in irq handlers) */
+  while (1) {
+    if (mlc_event) {
+      lsm6dsv16x_all_sources_t status;
+      lsm6dsv16x_mlc_out_t mlc_out;
+
+      mlc_event = 0;
+      lsm6dsv16x_all_sources_get(&dev_ctx, &status);
+
+      if (status.mlc1) {
+        lsm6dsv16x_mlc_out_get(&dev_ctx, &mlc_out);
+        gym_event_catched = mlc_out.mlc1_src;
+      }
+    }
+
+    /* Bus used only by this loop: no bank switch while the delta is written */
+    if (swap_request) {
+      swap_request = 0;
+      next = right ? &delta_to_left : &delta_to_right;
+
+      /* MLC output is not valid while the delta is written */
+      gap = cycles_get();
+      ucf_delta_apply(&dev_ctx, next);
+      gap = cycles_to_us(cycles_get() - gap);
+      right ^= 1;
+
+      snprintf((char *)tx_buffer, sizeof(tx_buffer),
+               "%s wrist configuration, %d writes, sensing gap %lu us\r\n",
+               right ? "right" : "left", next->len, (unsigned long)gap);
+      tx_com(tx_buffer, strlen((char const *)tx_buffer));
+    }
+
+    if (gym_event_catched != 0x0) {
+      switch(gym_event_catched) {
+      case 4:
+        snprintf((char *)tx_buffer, sizeof(tx_buffer), "biceps curl event\r\n");
+        tx_com(tx_buffer, strlen((char const *)tx_buffer));
+        break;
+      case 8:
+        snprintf((char *)tx_buffer, sizeof(tx_buffer), "Lateral raises event\r\n");
+        tx_com(tx_buffer, strlen((char const *)tx_buffer));
+        break;
+      case 12:
+        snprintf((char *)tx_buffer, sizeof(tx_buffer), "Squats event\r\n");
+        tx_com(tx_buffer, strlen((char const *)tx_buffer));
+        break;
+      }
+      gym_event_catched = 0;
+    }
+  }
+}
+
+/*
+ * @brief  Write generic device register (platform dependent)
+ *
+ * @param  handle    customizable argument. In this examples is used in
+ *                   order to select the correct sensor bus handler.
+ * @param  reg       register to write
+ * @param  bufp      pointer to data to write in register reg
+ * @param  len       number of consecutive register to write
+ *
+ */
+static int32_t platform_write(void *handle, uint8_t reg, const uint8_t *bufp,
+                              uint16_t len)
+{
+#if defined(NUCLEO_F401RE)
+  HAL_I2C_Mem_Write(handle, LSM6DSV16X_I2C_ADD_L, reg,
+                    I2C_MEMADD_SIZE_8BIT, (uint8_t*) bufp, len, 1000);
+#elif defined(STEVAL_MKI109V3)
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_RESET);
+  HAL_SPI_Transmit(handle, &reg, 1, 1000);
+  HAL_SPI_Transmit(handle, (uint8_t*) bufp, len, 1000);
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_SET);
+#elif defined(SPC584B_DIS)
+  i2c_lld_write(handle,  LSM6DSV16X_I2C_ADD_L & 0xFE, reg, (uint8_t*) bufp, len);
+#elif defined(NUCLEO_H503RB)
+  i3c_write(handle, i3c_dyn_addr, reg, (uint8_t*) bufp, len);
+#endif
+  return 0;
+}
+
+/*
+ * @brief  Read generic device register (platform dependent)
+ *
+ * @param  handle    customizable argument. In this examples is used in
+ *                   order to select the correct sensor bus handler.
+ * @param  reg       register to read
+ * @param  bufp      pointer to buffer that store the data read
+ * @param  len       number of consecutive register to read
+ *
+ */
+static int32_t platform_read(void *handle, uint8_t reg, uint8_t *bufp,
+                             uint16_t len)
+{
+#if defined(NUCLEO_F401RE)
+  HAL_I2C_Mem_Read(handle, LSM6DSV16X_I2C_ADD_L, reg,
+                   I2C_MEMADD_SIZE_8BIT, bufp, len, 1000);
+#elif defined(STEVAL_MKI109V3)
+  reg |= 0x80;
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_RESET);
+  HAL_SPI_Transmit(handle, &reg, 1, 1000);
+  HAL_SPI_Receive(handle, bufp, len, 1000);
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_SET);
+#elif defined(SPC584B_DIS)
+  i2c_lld_read(handle, LSM6DSV16X_I2C_ADD_L & 0xFE, reg, bufp, len);
+#elif defined(NUCLEO_H503RB)
+  i3c_read(handle, i3c_dyn_addr, reg, bufp, len);
+#endif
+  return 0;
+}
+
+/*
+ * @brief  platform specific outputs on terminal (platform dependent)
+ *
+ * @param  tx_buffer     buffer to transmit
+ * @param  len           number of byte to send
+ *
+ */
+static void tx_com(uint8_t *tx_buffer, uint16_t len)
+{
+#if defined(NUCLEO_F401RE)
+  HAL_UART_Transmit(&huart2, tx_buffer, len, 1000);
+#elif defined(STEVAL_MKI109V3)
+  CDC_Transmit_FS(tx_buffer, len);
+#elif defined(SPC584B_DIS)
+  sd_lld_write(&SD2, tx_buffer, len);
+#elif defined(NUCLEO_H503RB)
+  HAL_UART_Transmit(&huart3, tx_buffer, len, 1000);
+#endif
+}
+
+/*
+ * @brief  platform specific delay (platform dependent)
+ *
+ * @param  ms        delay in ms
+ *
+ */
+static void platform_delay(uint32_t ms)
+{
+#if defined(NUCLEO_F401RE) || defined(STEVAL_MKI109V3) || defined(NUCLEO_H503RB)
+  HAL_Delay(ms);
+#elif defined(SPC584B_DIS)
+  osalThreadDelayMilliseconds(ms);
+#endif
+}
+
+/*
+ * @brief  platform specific initialization (platform dependent)
+ */
+static void platform_init(void *handle)
+{
+#if defined(STEVAL_MKI109V3)
+  TIM3->CCR1 = PWM_3V3;
+  TIM3->CCR2 = PWM_3V3;
+  HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_1);
+  HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_2);
+  HAL_Delay(1000);
+
+#elif defined(NUCLEO_H503RB)
+  i3c_set_bus_frequency(handle, 1000000);
+  i3c_rstdaa(handle);
+  i3c_setdasa(handle, LSM6DSV16X_I2C_ADD_L, &i3c_dyn_addr, 1);
+  i3c_set_bus_frequency(handle, 12500000);
+
+#endif
+}
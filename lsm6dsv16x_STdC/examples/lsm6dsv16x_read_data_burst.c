@@ -0,0 +1,440 @@
+/*
+ ******************************************************************************
+ * @file    read_data_burst.c
+ * @author  Sensors Software Solution Team
+ * @brief   This file shows how to read status and data in a single
+ *          bus transaction.
+ *
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2021 STMicroelectronics.
+ * All rights reserved.</center></h2>
+ *
+ * This software component is licensed by ST under BSD 3-Clause license,
+ * the "License"; You may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at:
+ *                        opensource.org/licenses/BSD-3-Clause
+ *
+ ******************************************************************************
+ */
+
+/*
+ * This example was developed using the following STMicroelectronics
+ * evaluation boards:
+ *
+ * - STEVAL_MKI109V3 +
+ * - NUCLEO_F401RE + X-NUCLEO-IKS01A3
+ * - DISCOVERY_SPC584B +
+ * - NUCLEO_H503RB + X-NUCLEO-IKS4A1
+ *
+ * Used interfaces:
+ *
+ * STEVAL_MKI109V3    - Host side:   USB (Virtual COM)
+ *                    - Sensor side: SPI(Default) / I2C(supported)
+ *
+ * NUCLEO_STM32F401RE - Host side: UART(COM) to USB bridge
+ *                    - Sensor side: I2C(Default) / SPI(supported)
+ *
+ * DISCOVERY_SPC584B  - Host side: UART(COM) to USB bridge
+ *                    - Sensor side: I2C(Default) / SPI(supported)
+ *
+ * NUCLEO_STM32H503RG - Host side: UART(COM) to USB bridge
+ *                    - Sensor side: I3C(Default)
+ *
+ * If you need to run this example on a different hardware platform a
+ * modification of the functions: `platform_write`, `platform_read`,
+ * `tx_com` and 'platform_init' is required.
+ *
+ */
+
+/* STMicroelectronics evaluation boards definition
+ *
+ * Please uncomment ONLY the evaluation boards in use.
+ * If a different hardware is used please comment all
+ * following target board and redefine yours.
+ */
+
+//#define STEVAL_MKI109V3  /* little endian */
+//#define NUCLEO_F401RE    /* little endian */
+//#define SPC584B_DIS      /* big endian */
+
+/* ATTENTION: By default the driver is little endian. If you need switch
+ *            to big endian please see "Endianness definitions" in the
+ *            header file of the driver (_reg.h).
+ */
+
+#if defined(STEVAL_MKI109V3)
+/* MKI109V3: Define communication interface */
+#define SENSOR_BUS hspi2
+/* MKI109V3: Vdd and Vddio power supply values */
+#define PWM_3V3 915
+
+#elif defined(NUCLEO_F401RE)
+/* NUCLEO_F401RE: Define communication interface */
+#define SENSOR_BUS hi2c1
+
+#elif defined(SPC584B_DIS)
+/* DISCOVERY_SPC584B: Define communication interface */
+#define SENSOR_BUS I2CD1
+
+#elif defined(NUCLEO_H503RB)
+/* NUCLEO_H503RB: Define communication interface */
+#define SENSOR_BUS hi3c1
+
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include <stdio.h>
+#include "lsm6dsv16x_reg.h"
+
+#if defined(NUCLEO_F401RE)
+#include "stm32f4xx_hal.h"
+#include "usart.h"
+#include "gpio.h"
+#include "i2c.h"
+
+#elif defined(STEVAL_MKI109V3)
+#include "stm32f4xx_hal.h"
+#include "usbd_cdc_if.h"
+#include "gpio.h"
+#include "spi.h"
+#include "tim.h"
+
+#elif defined(SPC584B_DIS)
+#include "components.h"
+
+#elif defined(NUCLEO_H503RB)
+#include "usart.h"
+#include "i3c.h"
+#include "i3c_api.h"
+#include <stdio.h>
+
+static uint8_t i3c_dyn_addr = 0x0A;
+#endif
+
+/* Private macro -------------------------------------------------------------*/
+#define    BOOT_TIME            10 //ms
+
+/* Status and outputs: STATUS_REG (0x1E) up to OUTZ_H_A (0x2D) */
+#define    BURST_LEN            16
+
+/* Number of samples between two bus transaction reports */
+#define    REPORT_SAMPLES       100
+
+/* Uncomment to poll with separate status and data reads (reference) */
+//#define BURST_BASELINE
+
+/* Private typedef -----------------------------------------------------------*/
+/* Status and outputs read in one transaction, only flagged channels
+ * are fresh */
+typedef struct {
+  lsm6dsv16x_data_ready_t drdy;
+  int16_t temperature;
+  int16_t angular_rate[3];
+  int16_t acceleration[3];
+} data_burst_t;
+
+/* Private variables ---------------------------------------------------------*/
+static data_burst_t burst;
+static double_t acceleration_mg[3];
+static double_t angular_rate_mdps[3];
+static double_t temperature_degC;
+static uint8_t whoamI;
+static uint8_t tx_buffer[1000];
+static uint32_t bus_reads = 0;
+
+static lsm6dsv16x_filt_settling_mask_t filt_settling_mask;
+
+/* Extern variables ----------------------------------------------------------*/
+
+/* Private functions ---------------------------------------------------------*/
+
+/*
+ *   WARNING:
+ *   Functions declare in this section are defined at the end of this file
+ *   and are strictly related to the hardware platform used.
+ *
+ */
+static int32_t platform_write(void *handle, uint8_t reg, const uint8_t *bufp,
+                              uint16_t len);
+static int32_t platform_read(void *handle, uint8_t reg, uint8_t *bufp,
+                             uint16_t len);
+static void tx_com( uint8_t *tx_buffer, uint16_t len );
+static void platform_delay(uint32_t ms);
+static void platform_init(void *handle);
+
+
+#if !defined(BURST_BASELINE)
+/*
+ * @brief  Read status and all outputs in one auto-increment transaction
+ *
+ * @param  ctx       read / write interface definitions
+ * @param  val       data ready flags and raw outputs
+ * @retval           interface status (MANDATORY: return 0 -> no Error)
+ *
+ */
+static int32_t data_burst_get(stmdev_ctx_t *ctx, data_burst_t *val)
+{
+  uint8_t buff[BURST_LEN];
+  int32_t ret;
+  uint8_t i;
+
+  ret = lsm6dsv16x_read_reg(ctx, LSM6DSV16X_STATUS_REG, buff, BURST_LEN);
+  if (ret != 0)
+    return ret;
+
+  val->drdy.drdy_xl = buff[0] & 0x01U;
+  val->drdy.drdy_gy = (buff[0] >> 1) & 0x01U;
+  val->drdy.drdy_temp = (buff[0] >> 2) & 0x01U;
+
+  /* OUT_TEMP_L (0x20) */
+  val->temperature = (int16_t)buff[3];
+  val->temperature = (val->temperature * 256) + (int16_t)buff[2];
+
+  for (i = 0; i < 3; i++) {
+    /* OUTX_L_G (0x22) */
+    val->angular_rate[i] = (int16_t)buff[5 + 2 * i];
+    val->angular_rate[i] = (val->angular_rate[i] * 256) +
+                           (int16_t)buff[4 + 2 * i];
+    /* OUTX_L_A (0x28) */
+    val->acceleration[i] = (int16_t)buff[11 + 2 * i];
+    val->acceleration[i] = (val->acceleration[i] * 256) +
+                           (int16_t)buff[10 + 2 * i];
+  }
+
+  return ret;
+}
+#endif
+
+/* Main Example --------------------------------------------------------------*/
+void lsm6dsv16x_read_data_burst(void)
+{
+  lsm6dsv16x_reset_t rst;
+  stmdev_ctx_t dev_ctx;
+  uint32_t samples = 0, data_reads = 0;
+  /* Initialize mems driver interface */
+  dev_ctx.write_reg = platform_write;
+  dev_ctx.read_reg = platform_read;
+  dev_ctx.mdelay = platform_delay;
+  dev_ctx.handle = &SENSOR_BUS;
+
+  /* Init test platform */
+  platform_init(dev_ctx.handle);
+  /* Wait sensor boot time */
+  platform_delay(BOOT_TIME);
+
+  /* Check device ID */
+  lsm6dsv16x_device_id_get(&dev_ctx, &whoamI);
+
+  if (whoamI != LSM6DSV16X_ID)
+    while (1);
+
+  /* Restore default configuration */
+  lsm6dsv16x_reset_set(&dev_ctx, LSM6DSV16X_RESTORE_CTRL_REGS);
+  do {
+    lsm6dsv16x_reset_get(&dev_ctx, &rst);
+  } while (rst != LSM6DSV16X_READY);
+
+  /* Enable Block Data Update */
+  lsm6dsv16x_block_data_update_set(&dev_ctx, PROPERTY_ENABLE);
+  /* Set Output Data Rate */
+  lsm6dsv16x_xl_data_rate_set(&dev_ctx, LSM6DSV16X_ODR_AT_7Hz5);
+  lsm6dsv16x_gy_data_rate_set(&dev_ctx, LSM6DSV16X_ODR_AT_15Hz);
+  /* Set full scale */
+  lsm6dsv16x_xl_full_scale_set(&dev_ctx, LSM6DSV16X_2g);
+  lsm6dsv16x_gy_full_scale_set(&dev_ctx, LSM6DSV16X_2000dps);
+  /* Configure filtering chain */
+  filt_settling_mask.drdy = PROPERTY_ENABLE;
+  filt_settling_mask.irq_xl = PROPERTY_ENABLE;
+  filt_settling_mask.irq_g = PROPERTY_ENABLE;
+  lsm6dsv16x_filt_settling_mask_set(&dev_ctx, filt_settling_mask);
+  lsm6dsv16x_filt_gy_lp1_set(&dev_ctx, PROPERTY_ENABLE);
+  lsm6dsv16x_filt_gy_lp1_bandwidth_set(&dev_ctx, LSM6DSV16X_GY_ULTRA_LIGHT);
+  lsm6dsv16x_filt_xl_lp2_set(&dev_ctx, PROPERTY_ENABLE);
+  lsm6dsv16x_filt_xl_lp2_bandwidth_set(&dev_ctx, LSM6DSV16X_XL_STRONG);
+
+  /* Read samples in polling mode (no int) */
+  while (1) {
+    uint32_t reads = bus_reads;
+
+#if defined(BURST_BASELINE)
+    lsm6dsv16x_flag_data_ready_get(&dev_ctx, &burst.drdy);
+    if (burst.drdy.drdy_xl)
+      lsm6dsv16x_acceleration_raw_get(&dev_ctx, burst.acceleration);
+    if (burst.drdy.drdy_gy)
+      lsm6dsv16x_angular_rate_raw_get(&dev_ctx, burst.angular_rate);
+    if (burst.drdy.drdy_temp)
+      lsm6dsv16x_temperature_raw_get(&dev_ctx, &burst.temperature);
+#else
+    data_burst_get(&dev_ctx, &burst);
+#endif
+
+    if (!burst.drdy.drdy_xl && !burst.drdy.drdy_gy && !burst.drdy.drdy_temp)
+      continue;
+
+    data_reads += bus_reads - reads;
+
+    if (burst.drdy.drdy_xl) {
+      acceleration_mg[0] =
+        lsm6dsv16x_from_fs2_to_mg(burst.acceleration[0]);
+      acceleration_mg[1] =
+        lsm6dsv16x_from_fs2_to_mg(burst.acceleration[1]);
+      acceleration_mg[2] =
+        lsm6dsv16x_from_fs2_to_mg(burst.acceleration[2]);
+      snprintf((char *)tx_buffer, sizeof(tx_buffer),
+              "Acceleration [mg]:%4.2f\t%4.2f\t%4.2f\r\n",
+              acceleration_mg[0], acceleration_mg[1], acceleration_mg[2]);
+      tx_com(tx_buffer, strlen((char const *)tx_buffer));
+    }
+
+    if (burst.drdy.drdy_gy) {
+      angular_rate_mdps[0] =
+        lsm6dsv16x_from_fs2000_to_mdps(burst.angular_rate[0]);
+      angular_rate_mdps[1] =
+        lsm6dsv16x_from_fs2000_to_mdps(burst.angular_rate[1]);
+      angular_rate_mdps[2] =
+        lsm6dsv16x_from_fs2000_to_mdps(burst.angular_rate[2]);
+      snprintf((char *)tx_buffer, sizeof(tx_buffer),
+              "Angular rate [mdps]:%4.2f\t%4.2f\t%4.2f\r\n",
+              angular_rate_mdps[0], angular_rate_mdps[1], angular_rate_mdps[2]);
+      tx_com(tx_buffer, strlen((char const *)tx_buffer));
+    }
+
+    if (burst.drdy.drdy_temp) {
+      temperature_degC = lsm6dsv16x_from_lsb_to_celsius(burst.temperature);
+      snprintf((char *)tx_buffer, sizeof(tx_buffer),
+              "Temperature [degC]:%6.2f\r\n", temperature_degC);
+      tx_com(tx_buffer, strlen((char const *)tx_buffer));
+    }
+
+    if (++samples == REPORT_SAMPLES) {
+      snprintf((char *)tx_buffer, sizeof(tx_buffer),
+               "%lu samples: %lu.%02lu bus reads per sample\r\n",
+               (unsigned long)samples,
+               (unsigned long)(data_reads / samples),
+               (unsigned long)((data_reads * 100U / samples) % 100U));
+      tx_com(tx_buffer, strlen((char const *)tx_buffer));
+      samples = 0;
+      data_reads = 0;
+    }
+  }
+}
+
+/*
+ * @brief  Write generic device register (platform dependent)
+ *
+ * @param  handle    customizable argument. In this examples is used in
+ *                   order to select the correct sensor bus handler.
+ * @param  reg       register to write
+ * @param  bufp      pointer to data to write in register reg
+ * @param  len       number of consecutive register to write
+ *
+ */
+static int32_t platform_write(void *handle, uint8_t reg, const uint8_t *bufp,
+                              uint16_t len)
+{
+#if defined(NUCLEO_F401RE)
+  HAL_I2C_Mem_Write(handle, LSM6DSV16X_I2C_ADD_L, reg,
+                    I2C_MEMADD_SIZE_8BIT, (uint8_t*) bufp, len, 1000);
+#elif defined(STEVAL_MKI109V3)
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_RESET);
+  HAL_SPI_Transmit(handle, &reg, 1, 1000);
+  HAL_SPI_Transmit(handle, (uint8_t*) bufp, len, 1000);
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_SET);
+#elif defined(SPC584B_DIS)
+  i2c_lld_write(handle,  LSM6DSV16X_I2C_ADD_L & 0xFE, reg, (uint8_t*) bufp, len);
+#elif defined(NUCLEO_H503RB)
+  i3c_write(handle, i3c_dyn_addr, reg, (uint8_t*) bufp, len);
+#endif
+  return 0;
+}
+
+/*
+ * @brief  Read generic device register (platform dependent)
+ *
+ * @param  handle    customizable argument. In this examples is used in
+ *                   order to select the correct sensor bus handler.
+ * @param  reg       register to read
+ * @param  bufp      pointer to buffer that store the data read
+ * @param  len       number of consecutive register to read
+ *
+ */
+static int32_t platform_read(void *handle, uint8_t reg, uint8_t *bufp,
+                             uint16_t len)
+{
+  bus_reads++;
+
+#if defined(NUCLEO_F401RE)
+  HAL_I2C_Mem_Read(handle, LSM6DSV16X_I2C_ADD_L, reg,
+                   I2C_MEMADD_SIZE_8BIT, bufp, len, 1000);
+#elif defined(STEVAL_MKI109V3)
+  reg |= 0x80;
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_RESET);
+  HAL_SPI_Transmit(handle, &reg, 1, 1000);
+  HAL_SPI_Receive(handle, bufp, len, 1000);
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_SET);
+#elif defined(SPC584B_DIS)
+  i2c_lld_read(handle, LSM6DSV16X_I2C_ADD_L & 0xFE, reg, bufp, len);
+#elif defined(NUCLEO_H503RB)
+  i3c_read(handle, i3c_dyn_addr, reg, bufp, len);
+#endif
+  return 0;
+}
+
+/*
+ * @brief  platform specific outputs on terminal (platform dependent)
+ *
+ * @param  tx_buffer     buffer to transmit
+ * @param  len           number of byte to send
+ *
+ */
+static void tx_com(uint8_t *tx_buffer, uint16_t len)
+{
+#if defined(NUCLEO_F401RE)
+  HAL_UART_Transmit(&huart2, tx_buffer, len, 1000);
+#elif defined(STEVAL_MKI109V3)
+  CDC_Transmit_FS(tx_buffer, len);
+#elif defined(SPC584B_DIS)
+  sd_lld_write(&SD2, tx_buffer, len);
+#elif defined(NUCLEO_H503RB)
+  HAL_UART_Transmit(&huart3, tx_buffer, len, 1000);
+#endif
+}
+
+/*
+ * @brief  platform specific delay (platform dependent)
+ *
+ * @param  ms        delay in ms
+ *
+ */
+static void platform_delay(uint32_t ms)
+{
+#if defined(NUCLEO_F401RE) || defined(STEVAL_MKI109V3) || defined(NUCLEO_H503RB)
+  HAL_Delay(ms);
+#elif defined(SPC584B_DIS)
+  osalThreadDelayMilliseconds(ms);
+#endif
+}
+
+/*
+ * @brief  platform specific initialization (platform dependent)
+ */
+static void platform_init(void *handle)
+{
+#if defined(STEVAL_MKI109V3)
+  TIM3->CCR1 = PWM_3V3;
+  TIM3->CCR2 = PWM_3V3;
+  HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_1);
+  HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_2);
+  HAL_Delay(1000);
+
+#elif defined(NUCLEO_H503RB)
+  i3c_set_bus_frequency(handle, 1000000);
+  i3c_rstdaa(handle);
+  i3c_setdasa(handle, LSM6DSV16X_I2C_ADD_L, &i3c_dyn_addr, 1);
+  i3c_set_bus_frequency(handle, 12500000);
+
+#endif
+}
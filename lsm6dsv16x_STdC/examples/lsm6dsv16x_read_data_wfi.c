@@ -0,0 +1,522 @@
+/*
+ ******************************************************************************
+ * @file    read_data_wfi.c
+ * @author  Sensors Software Solution Team
+ * @brief   This file shows how to sleep (WFI) between samples.
+ *
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2021 STMicroelectronics.
+ * All rights reserved.</center></h2>
+ *
+ * This software component is licensed by ST under BSD 3-Clause license,
+ * the "License"; You may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at:
+ *                        opensource.org/licenses/BSD-3-Clause
+ *
+ ******************************************************************************
+ */
+
+/*
+ * This example was developed using the following STMicroelectronics
+ * evaluation boards:
+ *
+ * - STEVAL_MKI109V3 +
+ * - NUCLEO_F401RE + X-NUCLEO-IKS01A3
+ * - DISCOVERY_SPC584B +
+ * - NUCLEO_H503RB + X-NUCLEO-IKS4A1
+ *
+ * Used interfaces:
+ *
+ * STEVAL_MKI109V3    - Host side:   USB (Virtual COM)
+ *                    - Sensor side: SPI(Default) / I2C(supported)
+ *
+ * NUCLEO_STM32F401RE - Host side: UART(COM) to USB bridge
+ *                    - Sensor side: I2C(Default) / SPI(supported)
+ *
+ * DISCOVERY_SPC584B  - Host side: UART(COM) to USB bridge
+ *                    - Sensor side: I2C(Default) / SPI(supported)
+ *
+ * NUCLEO_STM32H503RG - Host side: UART(COM) to USB bridge
+ *                    - Sensor side: I3C(Default)
+ *
+ * If you need to run this example on a different hardware platform a
+ * modification of the functions: `platform_write`, `platform_read`,
+ * `tx_com` and 'platform_init' is required.
+ *
+ */
+
+/* STMicroelectronics evaluation boards definition
+ *
+ * Please uncomment ONLY the evaluation boards in use.
+ * If a different hardware is used please comment all
+ * following target board and redefine yours.
+ */
+
+//#define STEVAL_MKI109V3  /* little endian */
+//#define NUCLEO_F401RE    /* little endian */
+//#define SPC584B_DIS      /* big endian */
+
+/* ATTENTION: By default the driver is little endian. If you need switch
+ *            to big endian please see "Endianness definitions" in the
+ *            header file of the driver (_reg.h).
+ */
+
+#if defined(STEVAL_MKI109V3)
+/* MKI109V3: Define communication interface */
+#define SENSOR_BUS hspi2
+/* MKI109V3: Vdd and Vddio power supply values */
+#define PWM_3V3 915
+
+#elif defined(NUCLEO_F401RE)
+/* NUCLEO_F401RE: Define communication interface */
+#define SENSOR_BUS hi2c1
+
+#elif defined(SPC584B_DIS)
+/* DISCOVERY_SPC584B: Define communication interface */
+#define SENSOR_BUS I2CD1
+
+#elif defined(NUCLEO_H503RB)
+/* NUCLEO_H503RB: Define communication interface */
+#define SENSOR_BUS hi3c1
+
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include <stdio.h>
+#include "lsm6dsv16x_reg.h"
+
+#if defined(NUCLEO_F401RE)
+#include "stm32f4xx_hal.h"
+#include "usart.h"
+#include "gpio.h"
+#include "i2c.h"
+#include "tim.h"
+
+#elif defined(STEVAL_MKI109V3)
+#include "stm32f4xx_hal.h"
+#include "usbd_cdc_if.h"
+#include "gpio.h"
+#include "spi.h"
+#include "tim.h"
+
+#elif defined(SPC584B_DIS)
+#include "components.h"
+
+#elif defined(NUCLEO_H503RB)
+#include "usart.h"
+#include "i3c.h"
+#include "i3c_api.h"
+#include <stdio.h>
+
+static uint8_t i3c_dyn_addr = 0x0A;
+#endif
+
+/* Private macro -------------------------------------------------------------*/
+#define    BOOT_TIME            10 //ms
+
+/* Wake-up source between two samples */
+#define    WAKE_DRDY            0 /* pulsed data ready on INT1 */
+#define    WAKE_TIMER           1 /* platform timer calibrated to the ODR */
+#define    WAKE_POLL            2 /* no sleep, as read_data_polling (reference) */
+
+#define    WAKE_MODE            WAKE_DRDY
+
+/* No periodic timer is set up on these boards: the example would never wake */
+#if (WAKE_MODE == WAKE_TIMER) && (defined(NUCLEO_H503RB) || defined(SPC584B_DIS))
+#error "WAKE_TIMER needs platform_timer_start() for this board"
+#endif
+
+/* Accelerometer ODR (must match the odr_set value below) */
+#define    XL_ODR_HZ            15.0f
+
+/* Number of samples between two reports */
+#define    REPORT_SAMPLES       150
+
+/* Private variables ---------------------------------------------------------*/
+static lsm6dsv16x_filt_settling_mask_t filt_settling_mask;
+static int16_t data_raw_acceleration[3];
+static double_t acceleration_mg[3];
+static uint8_t whoamI;
+static uint8_t tx_buffer[1000];
+static uint32_t bus_xfers = 0;
+
+/* Extern variables ----------------------------------------------------------*/
+
+/* Private functions ---------------------------------------------------------*/
+/*
+ *   WARNING:
+ *   Functions declare in this section are defined at the end of this file
+ *   and are strictly related to the hardware platform used.
+ *
+ */
+static int32_t platform_write(void *handle, uint8_t reg, const uint8_t *bufp,
+                              uint16_t len);
+static int32_t platform_read(void *handle, uint8_t reg, uint8_t *bufp,
+                             uint16_t len);
+static void tx_com( uint8_t *tx_buffer, uint16_t len );
+static void platform_delay(uint32_t ms);
+static void platform_init(void *handle);
+
+#if (WAKE_MODE != WAKE_POLL)
+static void platform_sleep(volatile uint8_t *event);
+#endif
+#if (WAKE_MODE == WAKE_TIMER)
+static void platform_timer_start(uint32_t period_us);
+#endif
+
+static stmdev_ctx_t dev_ctx;
+static volatile uint8_t wake_event = 0;
+
+#if defined(NUCLEO_F401RE) || defined(STEVAL_MKI109V3)
+/* Cycle counter used for the CPU duty cycle (Cortex-M DWT) */
+static void cycles_init(void)
+{
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+static uint32_t cycles_get(void)
+{
+  return DWT->CYCCNT;
+}
+
+static uint32_t cycles_per_s(void)
+{
+  return SystemCoreClock;
+}
+#else
+static void cycles_init(void) {}
+static uint32_t cycles_get(void) { return 0; }
+static uint32_t cycles_per_s(void) { return 0; }
+#endif
+
+/* INT1 data ready handler */
+void lsm6dsv16x_read_data_wfi_handler(void)
+{
+  wake_event = 1;
+}
+
+/* Timer handler  --------------------------------------------------------*/
+void lsm6dsv16x_read_data_wfi_handler_timer(void)
+{
+  wake_event = 1;
+}
+
+/* Main Example --------------------------------------------------------------*/
+void lsm6dsv16x_read_data_wfi(void)
+{
+  lsm6dsv16x_pin_int_route_t pin_int;
+  lsm6dsv16x_data_ready_t drdy;
+  lsm6dsv16x_reset_t rst;
+  uint32_t samples = 0, missed = 0, xfers;
+  uint32_t wake, active = 0;
+  float_t odr;
+  int8_t freq_fine;
+
+  /* Initialize mems driver interface */
+  dev_ctx.write_reg = platform_write;
+  dev_ctx.read_reg = platform_read;
+  dev_ctx.mdelay = platform_delay;
+  dev_ctx.handle = &SENSOR_BUS;
+
+  /* Init test platform */
+  platform_init(dev_ctx.handle);
+  /* Wait sensor boot time */
+  platform_delay(BOOT_TIME);
+  /* Check device ID */
+  lsm6dsv16x_device_id_get(&dev_ctx, &whoamI);
+
+  if (whoamI != LSM6DSV16X_ID)
+    while (1);
+
+  /* Restore default configuration */
+  lsm6dsv16x_reset_set(&dev_ctx, LSM6DSV16X_RESTORE_CTRL_REGS);
+  do {
+    lsm6dsv16x_reset_get(&dev_ctx, &rst);
+  } while (rst != LSM6DSV16X_READY);
+
+  /* Enable Block Data Update */
+  lsm6dsv16x_block_data_update_set(&dev_ctx, PROPERTY_ENABLE);
+
+#if defined(NUCLEO_H503RB)
+  /* if I3C is used then INT pin must be explicitly enabled */
+  lsm6dsv16x_i3c_int_en_set(&dev_ctx, 1);
+#endif
+
+#if (WAKE_MODE == WAKE_DRDY)
+  /* Pulsed data ready: one edge per sample, no status read needed */
+  lsm6dsv16x_data_ready_mode_set(&dev_ctx, LSM6DSV16X_DRDY_PULSED);
+  memset(&pin_int, 0, sizeof(pin_int));
+  pin_int.drdy_xl = PROPERTY_ENABLE;
+  lsm6dsv16x_pin_int1_route_set(&dev_ctx, &pin_int);
+#else
+  (void)pin_int;
+#endif
+
+  /* Set Output Data Rate */
+  lsm6dsv16x_xl_data_rate_set(&dev_ctx, LSM6DSV16X_ODR_AT_15Hz);
+  /* Set full scale */
+  lsm6dsv16x_xl_full_scale_set(&dev_ctx, LSM6DSV16X_2g);
+
+  /* Configure filtering chain */
+  filt_settling_mask.drdy = PROPERTY_ENABLE;
+  filt_settling_mask.irq_xl = PROPERTY_ENABLE;
+  filt_settling_mask.irq_g = PROPERTY_ENABLE;
+  lsm6dsv16x_filt_settling_mask_set(&dev_ctx, filt_settling_mask);
+  lsm6dsv16x_filt_xl_lp2_set(&dev_ctx, PROPERTY_ENABLE);
+  lsm6dsv16x_filt_xl_lp2_bandwidth_set(&dev_ctx, LSM6DSV16X_XL_STRONG);
+
+  /*
+   * Actual ODR from the internal oscillator trimming: each FREQ_FINE
+   * LSB is 0.13% of the nominal frequency.
+   */
+  lsm6dsv16x_odr_cal_reg_get(&dev_ctx, &freq_fine);
+  odr = XL_ODR_HZ * (1.0f + 0.0013f * freq_fine);
+
+  snprintf((char *)tx_buffer, sizeof(tx_buffer),
+           "mode %d, actual ODR %.3f Hz\r\n", WAKE_MODE, odr);
+  tx_com(tx_buffer, strlen((char const *)tx_buffer));
+
+#if (WAKE_MODE == WAKE_TIMER)
+  /*
+   * The timer and the sensor run on different clocks: the residual
+   * drift shows up as wake-ups without new data (missed).
+   */
+  platform_timer_start((uint32_t)(1000000.0f / odr));
+#endif
+
+  cycles_init();
+  bus_xfers = 0;
+  wake = cycles_get();
+
+  while (1) {
+#if (WAKE_MODE == WAKE_POLL)
+    lsm6dsv16x_flag_data_ready_get(&dev_ctx, &drdy);
+    if (!drdy.drdy_xl)
+      continue;
+#else
+    /* Account the CPU time up to here, then sleep until next sample */
+    active += cycles_get() - wake;
+    platform_sleep(&wake_event);
+    wake = cycles_get();
+    wake_event = 0;
+
+#if (WAKE_MODE == WAKE_TIMER)
+    lsm6dsv16x_flag_data_ready_get(&dev_ctx, &drdy);
+    if (!drdy.drdy_xl) {
+      missed++;
+      continue;
+    }
+#else
+    (void)drdy;
+#endif
+#endif
+
+    /* Read acceleration field data */
+    lsm6dsv16x_acceleration_raw_get(&dev_ctx, data_raw_acceleration);
+
+    if (++samples < REPORT_SAMPLES)
+      continue;
+
+#if (WAKE_MODE == WAKE_POLL)
+    active = cycles_get() - wake;
+#else
+    active += cycles_get() - wake;
+#endif
+    xfers = bus_xfers;
+
+    acceleration_mg[0] = lsm6dsv16x_from_fs2_to_mg(data_raw_acceleration[0]);
+    acceleration_mg[1] = lsm6dsv16x_from_fs2_to_mg(data_raw_acceleration[1]);
+    acceleration_mg[2] = lsm6dsv16x_from_fs2_to_mg(data_raw_acceleration[2]);
+
+    /* Elapsed time is samples / ODR, the cycle counter may stop in sleep */
+    snprintf((char *)tx_buffer, sizeof(tx_buffer),
+             "Acceleration [mg]:%4.2f\t%4.2f\t%4.2f\r\n"
+             "%lu samples: CPU duty %.3f%%, %lu.%02lu bus xfers/sample, %lu missed\r\n",
+             acceleration_mg[0], acceleration_mg[1], acceleration_mg[2],
+             (unsigned long)samples,
+             cycles_per_s() ?
+             100.0f * active / (cycles_per_s() * (samples / odr)) : 0.0f,
+             (unsigned long)(xfers / samples),
+             (unsigned long)((xfers * 100U / samples) % 100U),
+             (unsigned long)missed);
+    tx_com(tx_buffer, strlen((char const *)tx_buffer));
+
+    /* Report time is not accounted */
+    samples = 0;
+    missed = 0;
+    active = 0;
+    bus_xfers = 0;
+    wake = cycles_get();
+  }
+}
+
+/*
+ * @brief  Write generic device register (platform dependent)
+ *
+ * @param  handle    customizable argument. In this examples is used in
+ *                   order to select the correct sensor bus handler.
+ * @param  reg       register to write
+ * @param  bufp      pointer to data to write in register reg
+ * @param  len       number of consecutive register to write
+ *
+ */
+static int32_t platform_write(void *handle, uint8_t reg, const uint8_t *bufp,
+                              uint16_t len)
+{
+  bus_xfers++;
+
+#if defined(NUCLEO_F401RE)
+  HAL_I2C_Mem_Write(handle, LSM6DSV16X_I2C_ADD_L, reg,
+                    I2C_MEMADD_SIZE_8BIT, (uint8_t*) bufp, len, 1000);
+#elif defined(STEVAL_MKI109V3)
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_RESET);
+  HAL_SPI_Transmit(handle, &reg, 1, 1000);
+  HAL_SPI_Transmit(handle, (uint8_t*) bufp, len, 1000);
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_SET);
+#elif defined(SPC584B_DIS)
+  i2c_lld_write(handle,  LSM6DSV16X_I2C_ADD_L & 0xFE, reg, (uint8_t*) bufp, len);
+#elif defined(NUCLEO_H503RB)
+  i3c_write(handle, i3c_dyn_addr, reg, (uint8_t*) bufp, len);
+#endif
+  return 0;
+}
+
+/*
+ * @brief  Read generic device register (platform dependent)
+ *
+ * @param  handle    customizable argument. In this examples is used in
+ *                   order to select the correct sensor bus handler.
+ * @param  reg       register to read
+ * @param  bufp      pointer to buffer that store the data read
+ * @param  len       number of consecutive register to read
+ *
+ */
+static int32_t platform_read(void *handle, uint8_t reg, uint8_t *bufp,
+                             uint16_t len)
+{
+  bus_xfers++;
+
+#if defined(NUCLEO_F401RE)
+  HAL_I2C_Mem_Read(handle, LSM6DSV16X_I2C_ADD_L, reg,
+                   I2C_MEMADD_SIZE_8BIT, bufp, len, 1000);
+#elif defined(STEVAL_MKI109V3)
+  reg |= 0x80;
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_RESET);
+  HAL_SPI_Transmit(handle, &reg, 1, 1000);
+  HAL_SPI_Receive(handle, bufp, len, 1000);
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_SET);
+#elif defined(SPC584B_DIS)
+  i2c_lld_read(handle, LSM6DSV16X_I2C_ADD_L & 0xFE, reg, bufp, len);
+#elif defined(NUCLEO_H503RB)
+  i3c_read(handle, i3c_dyn_addr, reg, bufp, len);
+#endif
+  return 0;
+}
+
+/*
+ * @brief  platform specific outputs on terminal (platform dependent)
+ *
+ * @param  tx_buffer     buffer to transmit
+ * @param  len           number of byte to send
+ *
+ */
+static void tx_com(uint8_t *tx_buffer, uint16_t len)
+{
+#if defined(NUCLEO_F401RE)
+  HAL_UART_Transmit(&huart2, tx_buffer, len, 1000);
+#elif defined(STEVAL_MKI109V3)
+  CDC_Transmit_FS(tx_buffer, len);
+#elif defined(SPC584B_DIS)
+  sd_lld_write(&SD2, tx_buffer, len);
+#elif defined(NUCLEO_H503RB)
+  HAL_UART_Transmit(&huart3, tx_buffer, len, 1000);
+#endif
+}
+
+/*
+ * @brief  platform specific delay (platform dependent)
+ *
+ * @param  ms        delay in ms
+ *
+ */
+static void platform_delay(uint32_t ms)
+{
+#if defined(NUCLEO_F401RE) || defined(STEVAL_MKI109V3) || defined(NUCLEO_H503RB)
+  HAL_Delay(ms);
+#elif defined(SPC584B_DIS)
+  osalThreadDelayMilliseconds(ms);
+#endif
+}
+
+/*
+ * @brief  platform specific initialization (platform dependent)
+ */
+static void platform_init(void *handle)
+{
+#if defined(STEVAL_MKI109V3)
+  TIM3->CCR1 = PWM_3V3;
+  TIM3->CCR2 = PWM_3V3;
+  HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_1);
+  HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_2);
+  HAL_Delay(1000);
+
+#elif defined(NUCLEO_H503RB)
+  i3c_set_bus_frequency(handle, 1000000);
+  i3c_rstdaa(handle);
+  i3c_setdasa(handle, LSM6DSV16X_I2C_ADD_L, &i3c_dyn_addr, 1);
+  i3c_set_bus_frequency(handle, 12500000);
+
+#endif
+}
+
+#if (WAKE_MODE != WAKE_POLL)
+/*
+ * @brief  platform specific sleep until event (platform dependent)
+ *
+ * @param  event     flag set by the wake-up interrupt handler
+ *
+ */
+static void platform_sleep(volatile uint8_t *event)
+{
+#if defined(NUCLEO_F401RE) || defined(STEVAL_MKI109V3) || defined(NUCLEO_H503RB)
+  /* SysTick would wake the core every ms */
+  HAL_SuspendTick();
+  /* An interrupt raised after the check still ends WFI */
+  __disable_irq();
+  if (!*event)
+    __WFI();
+  __enable_irq();
+  HAL_ResumeTick();
+#else
+  while (!*event);
+#endif
+}
+#endif
+
+#if (WAKE_MODE == WAKE_TIMER)
+/*
+ * @brief  platform specific periodic timer (platform dependent)
+ *
+ *         The timer interrupt must call
+ *         lsm6dsv16x_read_data_wfi_handler_timer().
+ *
+ * @param  period_us     timer period in us
+ *
+ */
+static void platform_timer_start(uint32_t period_us)
+{
+#if defined(NUCLEO_F401RE) || defined(STEVAL_MKI109V3)
+  /* TIM2 counter clock set to 1 MHz */
+  __HAL_TIM_SET_AUTORELOAD(&htim2, period_us - 1);
+  HAL_TIM_Base_Start_IT(&htim2);
+#else
+  /* Start here a periodic timer of the platform in use */
+  (void)period_us;
+#endif
+}
+#endif
@@ -0,0 +1,505 @@
+/*
+ ******************************************************************************
+ * @file    lsm6dsv16x_timestamp_sync.c
+ * @author  Sensors Software Solution Team
+ * @brief   This file show how to map sensor timestamps to the MCU time base
+ *
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2021 STMicroelectronics.
+ * All rights reserved.</center></h2>
+ *
+ * This software component is licensed by ST under BSD 3-Clause license,
+ * the "License"; You may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at:
+ *                        opensource.org/licenses/BSD-3-Clause
+ *
+ ******************************************************************************
+ */
+
+/*
+ * This example was developed using the following STMicroelectronics
+ * evaluation boards:
+ *
+ * - STEVAL_MKI109V3 +
+ * - NUCLEO_F401RE + X-NUCLEO-IKS01A3
+ * - DISCOVERY_SPC584B +
+ * - NUCLEO_H503RB + X-NUCLEO-IKS4A1
+ *
+ * Used interfaces:
+ *
+ * STEVAL_MKI109V3    - Host side:   USB (Virtual COM)
+ *                    - Sensor side: SPI(Default) / I2C(supported)
+ *
+ * NUCLEO_STM32F401RE - Host side: UART(COM) to USB bridge
+ *                    - Sensor side: I2C(Default) / SPI(supported)
+ *
+ * DISCOVERY_SPC584B  - Host side: UART(COM) to USB bridge
+ *                    - Sensor side: I2C(Default) / SPI(supported)
+ *
+ * NUCLEO_STM32H503RG - Host side: UART(COM) to USB bridge
+ *                    - Sensor side: I3C(Default)
+ *
+ * If you need to run this example on a different hardware platform a
+ * modification of the functions: `platform_write`, `platform_read`,
+ * `tx_com` and 'platform_init' is required.
+ *
+ */
+
+/* STMicroelectronics evaluation boards definition
+ *
+ * Please uncomment ONLY the evaluation boards in use.
+ * If a different hardware is used please comment all
+ * following target board and redefine yours.
+ */
+
+//#define STEVAL_MKI109V3  /* little endian */
+//#define NUCLEO_F401RE    /* little endian */
+//#define SPC584B_DIS      /* big endian */
+
+/* ATTENTION: By default the driver is little endian. If you need switch
+ *            to big endian please see "Endianness definitions" in the
+ *            header file of the driver (_reg.h).
+ */
+
+#if defined(STEVAL_MKI109V3)
+/* MKI109V3: Define communication interface */
+#define SENSOR_BUS hspi2
+/* MKI109V3: Vdd and Vddio power supply values */
+#define PWM_3V3 915
+
+#elif defined(NUCLEO_F401RE)
+/* NUCLEO_F401RE: Define communication interface */
+#define SENSOR_BUS hi2c1
+
+#elif defined(SPC584B_DIS)
+/* DISCOVERY_SPC584B: Define communication interface */
+#define SENSOR_BUS I2CD1
+
+#elif defined(NUCLEO_H503RB)
+/* NUCLEO_H503RB: Define communication interface */
+#define SENSOR_BUS hi3c1
+
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include <stdio.h>
+#include "lsm6dsv16x_reg.h"
+#include "clk_sync.h"
+
+#if defined(NUCLEO_F401RE)
+#include "stm32f4xx_hal.h"
+#include "usart.h"
+#include "gpio.h"
+#include "i2c.h"
+
+#elif defined(STEVAL_MKI109V3)
+#include "stm32f4xx_hal.h"
+#include "usbd_cdc_if.h"
+#include "gpio.h"
+#include "spi.h"
+#include "tim.h"
+
+#elif defined(SPC584B_DIS)
+#include "components.h"
+
+#elif defined(NUCLEO_H503RB)
+#include "usart.h"
+#include "i3c.h"
+#include "i3c_api.h"
+#include <stdio.h>
+
+static uint8_t i3c_dyn_addr = 0x0A;
+#endif
+
+/* Private macro -------------------------------------------------------------*/
+#define    BOOT_TIME         10 //ms
+
+/* Accelerometer ODR / BDR [Hz] */
+#define    XL_ODR_HZ         120.0f
+
+/* FIFO watermark: 16 accelerometer samples, each with its timestamp */
+#define    FIFO_WATERMARK    32
+
+/* Samples between two reports */
+#define    REPORT_SAMPLES    1200
+
+/*
+ * Uncomment to print the trace replayed by _prj_Linux/clk_sync_replay:
+ * "sync,<mcu_hz>,<ts_lsb_ns>,<odr_hz>" once, then every MCU capture as
+ * "y,<mcu_ticks>" and every sample as "x,<sensor_ts>" in the order they
+ * reach the pairing
+ */
+//#define    SYNC_TRACE
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+static uint8_t whoamI;
+static uint8_t tx_buffer[1000];
+
+static clk_sync_ring_t irq;
+static clk_sync_t sync;
+
+#if defined(SYNC_TRACE)
+static uint16_t irq_traced;
+#endif
+
+/* Extern variables ----------------------------------------------------------*/
+
+/* Private functions ---------------------------------------------------------*/
+/*
+ *   WARNING:
+ *   Functions declare in this section are defined at the end of this file
+ *   and are strictly related to the hardware platform used.
+ *
+ */
+static int32_t platform_write(void *handle, uint8_t reg, const uint8_t *bufp,
+                              uint16_t len);
+static int32_t platform_read(void *handle, uint8_t reg, uint8_t *bufp,
+                             uint16_t len);
+static void tx_com( uint8_t *tx_buffer, uint16_t len );
+static void platform_delay(uint32_t ms);
+static void platform_init(void *handle);
+
+
+static stmdev_ctx_t dev_ctx;
+
+#if defined(NUCLEO_F401RE) || defined(STEVAL_MKI109V3)
+/* Cycle counter used as MCU time base (Cortex-M DWT) */
+static void cycles_init(void)
+{
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+static uint32_t cycles_get(void)
+{
+  return DWT->CYCCNT;
+}
+
+static uint32_t cycles_per_s(void)
+{
+  return SystemCoreClock;
+}
+#else
+static void cycles_init(void) {}
+static uint32_t cycles_get(void) { return 0; }
+static uint32_t cycles_per_s(void) { return 1; }
+#endif
+
+/*
+ * @brief  MCU time extended to 64 bit (called at least once per
+ *         counter wrap, i.e. on every data ready)
+ *
+ */
+static uint64_t mcu_time_get(void)
+{
+  static uint32_t last;
+  static uint64_t high;
+  uint32_t now = cycles_get();
+
+  if (now < last)
+    high += 1ULL << 32;
+  last = now;
+
+  return high | now;
+}
+
+/*
+ * @brief  Sensor timestamp extended to 64 bit
+ *
+ */
+static uint64_t sensor_time_ext(uint32_t ts)
+{
+  static uint32_t last;
+  static uint64_t high;
+
+  if (ts < last)
+    high += 1ULL << 32;
+  last = ts;
+
+  return high | ts;
+}
+
+void lsm6dsv16x_timestamp_sync_handler(void)
+{
+  /* MCU capture of the data ready edge, matched later to the sample */
+  clk_sync_capture(&irq, mcu_time_get());
+}
+
+#if defined(SYNC_TRACE)
+/*
+ * @brief  Print the captures queued since the last call and the sample
+ *
+ * @param  x         sensor timestamp of the sample [LSB]
+ *
+ */
+static void sync_trace(uint64_t x)
+{
+  uint16_t head = irq.head;
+
+  if ((uint16_t)(head - irq_traced) > CLK_SYNC_RING)
+    irq_traced = head - CLK_SYNC_RING;
+
+  for (; irq_traced != head; irq_traced++) {
+    snprintf((char *)tx_buffer, sizeof(tx_buffer), "y,%llu\r\n",
+             (unsigned long long)irq.time[irq_traced % CLK_SYNC_RING]);
+    tx_com(tx_buffer, strlen((char const *)tx_buffer));
+  }
+
+  snprintf((char *)tx_buffer, sizeof(tx_buffer), "x,%llu\r\n",
+           (unsigned long long)x);
+  tx_com(tx_buffer, strlen((char const *)tx_buffer));
+}
+#endif
+
+/* Main Example --------------------------------------------------------------*/
+void lsm6dsv16x_timestamp_sync(void)
+{
+  lsm6dsv16x_fifo_status_t fifo_status;
+  lsm6dsv16x_pin_int_route_t pin_int;
+  lsm6dsv16x_reset_t rst;
+  uint32_t samples = 0, slips = 0;
+  uint64_t x = 0;
+  double b_nom, half;
+
+  /* Initialize mems driver interface */
+  dev_ctx.write_reg = platform_write;
+  dev_ctx.read_reg = platform_read;
+  dev_ctx.mdelay = platform_delay;
+  dev_ctx.handle = &SENSOR_BUS;
+
+  /* Init test platform */
+  platform_init(dev_ctx.handle);
+  /* Wait sensor boot time */
+  platform_delay(BOOT_TIME);
+  /* Check device ID */
+  lsm6dsv16x_device_id_get(&dev_ctx, &whoamI);
+
+  if (whoamI != LSM6DSV16X_ID)
+    while (1);
+
+  /* Restore default configuration */
+  lsm6dsv16x_reset_set(&dev_ctx, LSM6DSV16X_RESTORE_CTRL_REGS);
+  do {
+    lsm6dsv16x_reset_get(&dev_ctx, &rst);
+  } while (rst != LSM6DSV16X_READY);
+
+  /* Enable Block Data Update */
+  lsm6dsv16x_block_data_update_set(&dev_ctx, PROPERTY_ENABLE);
+
+#if defined(NUCLEO_H503RB)
+  /* if I3C is used then INT pin must be explicitly enabled */
+  lsm6dsv16x_i3c_int_en_set(&dev_ctx, 1);
+#endif
+
+  /* Pulsed data ready: one edge per sample, captured by the handler */
+  lsm6dsv16x_data_ready_mode_set(&dev_ctx, LSM6DSV16X_DRDY_PULSED);
+  memset(&pin_int, 0, sizeof(pin_int));
+  pin_int.drdy_xl = PROPERTY_ENABLE;
+  lsm6dsv16x_pin_int1_route_set(&dev_ctx, &pin_int);
+
+  /* Each accelerometer sample batched together with its timestamp */
+  lsm6dsv16x_fifo_watermark_set(&dev_ctx, FIFO_WATERMARK);
+  lsm6dsv16x_fifo_xl_batch_set(&dev_ctx, LSM6DSV16X_XL_BATCHED_AT_120Hz);
+  lsm6dsv16x_fifo_timestamp_batch_set(&dev_ctx, LSM6DSV16X_TMSTMP_DEC_1);
+  lsm6dsv16x_fifo_mode_set(&dev_ctx, LSM6DSV16X_STREAM_MODE);
+  lsm6dsv16x_timestamp_set(&dev_ctx, PROPERTY_ENABLE);
+
+  cycles_init();
+  b_nom = (double)cycles_per_s() * lsm6dsv16x_from_lsb_to_nsec(1) / 1.0e9;
+  half = (double)cycles_per_s() / XL_ODR_HZ / 2.0;
+
+#if defined(SYNC_TRACE)
+  snprintf((char *)tx_buffer, sizeof(tx_buffer), "sync,%lu,%.1f,%.1f\r\n",
+           (unsigned long)cycles_per_s(), lsm6dsv16x_from_lsb_to_nsec(1),
+           XL_ODR_HZ);
+  tx_com(tx_buffer, strlen((char const *)tx_buffer));
+#endif
+
+  /* Set full scale and Output Data Rate */
+  lsm6dsv16x_xl_full_scale_set(&dev_ctx, LSM6DSV16X_2g);
+  lsm6dsv16x_xl_data_rate_set(&dev_ctx, LSM6DSV16X_ODR_AT_120Hz);
+
+  while (1) {
+    uint16_t num;
+
+    /* Read watermark flag */
+    lsm6dsv16x_fifo_status_get(&dev_ctx, &fifo_status);
+
+    if (fifo_status.fifo_th == 0)
+      continue;
+
+    num = fifo_status.fifo_level;
+
+    while (num--) {
+      lsm6dsv16x_fifo_out_raw_t f_data;
+      int16_t *datax = (int16_t *)&f_data.data[0];
+      int16_t *datay = (int16_t *)&f_data.data[2];
+      int16_t *dataz = (int16_t *)&f_data.data[4];
+      uint32_t *ts = (uint32_t *)&f_data.data[0];
+
+      /* Read FIFO sensor value */
+      lsm6dsv16x_fifo_out_raw_get(&dev_ctx, &f_data);
+
+      switch (f_data.tag) {
+      case LSM6DSV16X_TIMESTAMP_TAG:
+        x = sensor_time_ext(*ts);
+        break;
+
+      case LSM6DSV16X_XL_NC_TAG:
+#if defined(SYNC_TRACE)
+        sync_trace(x);
+#endif
+        slips += clk_sync_pair(&sync, &irq, x, half, b_nom);
+
+        if (++samples % REPORT_SAMPLES)
+          break;
+
+        snprintf((char *)tx_buffer, sizeof(tx_buffer),
+                 "t %llu us ACC [mg]:\t%4.2f\t%4.2f\t%4.2f\r\n",
+                 (unsigned long long)clk_sync_ticks_to_us(clk_sync_map(&sync, x),
+                                                          cycles_per_s()),
+                 lsm6dsv16x_from_fs2_to_mg(*datax),
+                 lsm6dsv16x_from_fs2_to_mg(*datay),
+                 lsm6dsv16x_from_fs2_to_mg(*dataz));
+        tx_com(tx_buffer, strlen((char const *)tx_buffer));
+
+        snprintf((char *)tx_buffer, sizeof(tx_buffer),
+                 "skew %+.1f ppm, residual rms %.2f us max %.2f us, slips %lu\r\n",
+                 (sync.b / b_nom - 1.0) * 1.0e6,
+                 sync.res_n ? sqrt(sync.res_sum2 / sync.res_n) * 1.0e6 /
+                              cycles_per_s() : 0.0,
+                 sync.res_max * 1.0e6 / cycles_per_s(),
+                 (unsigned long)slips);
+        tx_com(tx_buffer, strlen((char const *)tx_buffer));
+        sync.res_sum2 = 0.0;
+        sync.res_max = 0.0;
+        sync.res_n = 0;
+        break;
+
+      default:
+        break;
+      }
+    }
+  }
+}
+
+/*
+ * @brief  Write generic device register (platform dependent)
+ *
+ * @param  handle    customizable argument. In this examples is used in
+ *                   order to select the correct sensor bus handler.
+ * @param  reg       register to write
+ * @param  bufp      pointer to data to write in register reg
+ * @param  len       number of consecutive register to write
+ *
+ */
+static int32_t platform_write(void *handle, uint8_t reg, const uint8_t *bufp,
+                              uint16_t len)
+{
+#if defined(NUCLEO_F401RE)
+  HAL_I2C_Mem_Write(handle, LSM6DSV16X_I2C_ADD_L, reg,
+                    I2C_MEMADD_SIZE_8BIT, (uint8_t*) bufp, len, 1000);
+#elif defined(STEVAL_MKI109V3)
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_RESET);
+  HAL_SPI_Transmit(handle, &reg, 1, 1000);
+  HAL_SPI_Transmit(handle, (uint8_t*) bufp, len, 1000);
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_SET);
+#elif defined(SPC584B_DIS)
+  i2c_lld_write(handle,  LSM6DSV16X_I2C_ADD_L & 0xFE, reg, (uint8_t*) bufp, len);
+#elif defined(NUCLEO_H503RB)
+  i3c_write(handle, i3c_dyn_addr, reg, (uint8_t*) bufp, len);
+#endif
+  return 0;
+}
+
+/*
+ * @brief  Read generic device register (platform dependent)
+ *
+ * @param  handle    customizable argument. In this examples is used in
+ *                   order to select the correct sensor bus handler.
+ * @param  reg       register to read
+ * @param  bufp      pointer to buffer that store the data read
+ * @param  len       number of consecutive register to read
+ *
+ */
+static int32_t platform_read(void *handle, uint8_t reg, uint8_t *bufp,
+                             uint16_t len)
+{
+#if defined(NUCLEO_F401RE)
+  HAL_I2C_Mem_Read(handle, LSM6DSV16X_I2C_ADD_L, reg,
+                   I2C_MEMADD_SIZE_8BIT, bufp, len, 1000);
+#elif defined(STEVAL_MKI109V3)
+  reg |= 0x80;
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_RESET);
+  HAL_SPI_Transmit(handle, &reg, 1, 1000);
+  HAL_SPI_Receive(handle, bufp, len, 1000);
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_SET);
+#elif defined(SPC584B_DIS)
+  i2c_lld_read(handle, LSM6DSV16X_I2C_ADD_L & 0xFE, reg, bufp, len);
+#elif defined(NUCLEO_H503RB)
+  i3c_read(handle, i3c_dyn_addr, reg, bufp, len);
+#endif
+  return 0;
+}
+
+/*
+ * @brief  platform specific outputs on terminal (platform dependent)
+ *
+ * @param  tx_buffer     buffer to transmit
+ * @param  len           number of byte to send
+ *
+ */
+static void tx_com(uint8_t *tx_buffer, uint16_t len)
+{
+#if defined(NUCLEO_F401RE)
+  HAL_UART_Transmit(&huart2, tx_buffer, len, 1000);
+#elif defined(STEVAL_MKI109V3)
+  CDC_Transmit_FS(tx_buffer, len);
+#elif defined(SPC584B_DIS)
+  sd_lld_write(&SD2, tx_buffer, len);
+#elif defined(NUCLEO_H503RB)
+  HAL_UART_Transmit(&huart3, tx_buffer, len, 1000);
+#endif
+}
+
+/*
+ * @brief  platform specific delay (platform dependent)
+ *
+ * @param  ms        delay in ms
+ *
+ */
+static void platform_delay(uint32_t ms)
+{
+#if defined(NUCLEO_F401RE) || defined(STEVAL_MKI109V3) || defined(NUCLEO_H503RB)
+  HAL_Delay(ms);
+#elif defined(SPC584B_DIS)
+  osalThreadDelayMilliseconds(ms);
+#endif
+}
+
+/*
+ * @brief  platform specific initialization (platform dependent)
+ */
+static void platform_init(void *handle)
+{
+#if defined(STEVAL_MKI109V3)
+  TIM3->CCR1 = PWM_3V3;
+  TIM3->CCR2 = PWM_3V3;
+  HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_1);
+  HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_2);
+  HAL_Delay(1000);
+
+#elif defined(NUCLEO_H503RB)
+  i3c_set_bus_frequency(handle, 1000000);
+  i3c_rstdaa(handle);
+  i3c_setdasa(handle, LSM6DSV16X_I2C_ADD_L, &i3c_dyn_addr, 1);
+  i3c_set_bus_frequency(handle, 12500000);
+
+#endif
+}
@@ -0,0 +1,800 @@
+/*
+ ******************************************************************************
+ * @file    ucf_packed.c
+ * @author  Sensors Software Solution Team
+ * @brief   This file shows how to store MLC / FSM configurations in a
+ *          packed format and load them with a streaming decoder.
+ *
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2021 STMicroelectronics.
+ * All rights reserved.</center></h2>
+ *
+ * This software component is licensed by ST under BSD 3-Clause license,
+ * the "License"; You may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at:
+ *                        opensource.org/licenses/BSD-3-Clause
+ *
+ ******************************************************************************
+ */
+
+/*
+ * This example was developed using the following STMicroelectronics
+ * evaluation boards:
+ *
+ * - STEVAL_MKI109V3 +
+ * - NUCLEO_F401RE + X-NUCLEO-IKS01A3
+ * - DISCOVERY_SPC584B +
+ * - NUCLEO_H503RB + X-NUCLEO-IKS4A1
+ *
+ * Used interfaces:
+ *
+ * STEVAL_MKI109V3    - Host side:   USB (Virtual COM)
+ *                    - Sensor side: SPI(Default) / I2C(supported)
+ *
+ * NUCLEO_STM32F401RE - Host side: UART(COM) to USB bridge
+ *                    - Sensor side: I2C(Default) / SPI(supported)
+ *
+ * DISCOVERY_SPC584B  - Host side: UART(COM) to USB bridge
+ *                    - Sensor side: I2C(Default) / SPI(supported)
+ *
+ * NUCLEO_STM32H503RG - Host side: UART(COM) to USB bridge
+ *                    - Sensor side: I3C(Default)
+ *
+ * If you need to run this example on a different hardware platform a
+ * modification of the functions: `platform_write`, `platform_read`,
+ * `tx_com` and 'platform_init' is required.
+ *
+ */
+
+/* STMicroelectronics evaluation boards definition
+ *
+ * Please uncomment ONLY the evaluation boards in use.
+ * If a different hardware is used please comment all
+ * following target board and redefine yours.
+ */
+
+//#define STEVAL_MKI109V3  /* little endian */
+//#define NUCLEO_F401RE    /* little endian */
+//#define SPC584B_DIS      /* big endian */
+
+/* ATTENTION: By default the driver is little endian. If you need switch
+ *            to big endian please see "Endianness definitions" in the
+ *            header file of the driver (_reg.h).
+ */
+
+#if defined(STEVAL_MKI109V3)
+/* MKI109V3: Define communication interface */
+#define SENSOR_BUS hspi2
+/* MKI109V3: Vdd and Vddio power supply values */
+#define PWM_3V3 915
+
+#elif defined(NUCLEO_F401RE)
+/* NUCLEO_F401RE: Define communication interface */
+#define SENSOR_BUS hi2c1
+
+#elif defined(SPC584B_DIS)
+/* DISCOVERY_SPC584B: Define communication interface */
+#define SENSOR_BUS I2CD1
+
+#elif defined(NUCLEO_H503RB)
+/* NUCLEO_H503RB: Define communication interface */
+#define SENSOR_BUS hi3c1
+
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include <stdio.h>
+#include "lsm6dsv16x_four_d.h"
+#include "lsm6dsv16x_glance_detection.h"
+#include "lsm6dsv16x_gym_activity_recognition_left.h"
+#include "lsm6dsv16x_gym_activity_recognition_right.h"
+#include "lsm6dsv16x_reg.h"
+
+#if defined(NUCLEO_F401RE)
+#include "stm32f4xx_hal.h"
+#include "usart.h"
+#include "gpio.h"
+#include "i2c.h"
+
+#elif defined(STEVAL_MKI109V3)
+#include "stm32f4xx_hal.h"
+#include "usbd_cdc_if.h"
+#include "gpio.h"
+#include "spi.h"
+#include "tim.h"
+
+#elif defined(SPC584B_DIS)
+#include "components.h"
+
+#elif defined(NUCLEO_H503RB)
+#include "usart.h"
+#include "i3c.h"
+#include "i3c_api.h"
+#include <stdio.h>
+
+static uint8_t i3c_dyn_addr = 0x0A;
+#endif
+
+/* Private macro -------------------------------------------------------------*/
+#define    BOOT_TIME            10 //ms
+
+/* Uncomment to dump the packed configurations as C arrays on tx_com */
+//#define UCF_PACK_EXPORT
+
+/* Packed stream tokens (see ucf_pack) */
+#define    TAG_RUN              0x00U /* 0x00..0x7F: run of 1..128 groups */
+#define    TAG_DEF              0x80U /* 0x80..0x87: pattern of 1..8 columns */
+#define    TAG_LIT              0xC0U /* 0xC0..0xFF: 1..64 literal lines */
+
+#define    RUN_MAX              128
+#define    LIT_MAX              64
+#define    PAT_COLS             8
+#define    PAT_MAX              32
+
+/* Column modes of a pattern */
+#define    COL_VAR              0U    /* one data byte per group */
+#define    COL_CONST            1U    /* same data in every group */
+#define    COL_INC              2U    /* data incremented by one per group */
+
+/* Size of the buffer receiving a packed configuration */
+#define    PACK_MAX             4096
+
+/* Private typedef -----------------------------------------------------------*/
+/*
+ * Address pattern: a group of up to PAT_COLS register writes repeated
+ * with the same addresses, e.g. PAGE_SEL / PAGE_ADDRESS / PAGE_VALUE.
+ * Patterns are defined once in the stream and referenced by index.
+ */
+typedef struct {
+  uint8_t k;
+  uint8_t addr[PAT_COLS];
+  uint16_t modes;                /* 2 bits per column */
+} ucf_pat_t;
+
+typedef struct {
+  ucf_pat_t pat[PAT_MAX];
+  uint8_t num;
+} ucf_dict_t;
+
+/* Register writer fed by the decoder */
+typedef int32_t (*ucf_write_t)(void *arg, uint8_t address, uint8_t data);
+
+typedef struct {
+  const char *name;
+  const ucf_line_t *ucf;
+  uint32_t len;
+} ucf_conf_t;
+
+/* Verification writer state */
+typedef struct {
+  const ucf_line_t *ucf;
+  uint32_t len;
+  uint32_t pos;
+} ucf_check_t;
+
+/* Private variables ---------------------------------------------------------*/
+static uint8_t whoamI;
+static uint8_t tx_buffer[1000];
+static uint8_t packed[PACK_MAX];
+static ucf_dict_t dict;
+
+/* Configurations to report, the last one is loaded in the device */
+static const ucf_conf_t conf[] = {
+  {
+    "four_d", lsm6dsv16x_four_d,
+    sizeof(lsm6dsv16x_four_d) / sizeof(ucf_line_t)
+  },
+  {
+    "glance_detection", lsm6dsv16x_glance_detection,
+    sizeof(lsm6dsv16x_glance_detection) / sizeof(ucf_line_t)
+  },
+  {
+    "gym_activity_recognition_left", lsm6dsv16x_gym_activity_recognition_left,
+    sizeof(lsm6dsv16x_gym_activity_recognition_left) / sizeof(ucf_line_t)
+  },
+  {
+    "gym_activity_recognition_right", lsm6dsv16x_gym_activity_recognition_right,
+    sizeof(lsm6dsv16x_gym_activity_recognition_right) / sizeof(ucf_line_t)
+  },
+};
+
+/* Extern variables ----------------------------------------------------------*/
+
+/* Private functions ---------------------------------------------------------*/
+/*
+ *   WARNING:
+ *   Functions declare in this section are defined at the end of this file
+ *   and are strictly related to the hardware platform used.
+ *
+ */
+static int32_t platform_write(void *handle, uint8_t reg, const uint8_t *bufp,
+                              uint16_t len);
+static int32_t platform_read(void *handle, uint8_t reg, uint8_t *bufp,
+                             uint16_t len);
+static void tx_com( uint8_t *tx_buffer, uint16_t len );
+static void platform_delay(uint32_t ms);
+static void platform_init(void *handle);
+
+
+static stmdev_ctx_t dev_ctx;
+static volatile uint8_t mlc_event = 0;
+
+#if defined(NUCLEO_F401RE) || defined(STEVAL_MKI109V3)
+/* Cycle counter used to time the decoder (Cortex-M DWT) */
+static void cycles_init(void)
+{
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+static uint32_t cycles_get(void)
+{
+  return DWT->CYCCNT;
+}
+#else
+static void cycles_init(void) {}
+static uint32_t cycles_get(void) { return 0; }
+#endif
+
+/*
+ * MLC interrupt: the MLC output is read in the main loop, as reading it
+ * switches register bank and would corrupt the configuration being
+ * written from the packed stream.
+ */
+void lsm6dsv16x_ucf_packed_handler(void)
+{
+  mlc_event = 1;
+}
+
+/*
+ * @brief  Get the column modes of k columns over c groups starting at i
+ *
+ * @param  ucf       configuration
+ * @param  i         first line
+ * @param  k         number of columns
+ * @param  c         number of groups
+ * @param  var       number of COL_VAR columns (out)
+ * @retval           column modes, 2 bits per column
+ *
+ */
+static uint16_t pat_modes(const ucf_line_t *ucf, uint32_t i, uint8_t k,
+                          uint32_t c, uint8_t *var)
+{
+  uint16_t modes = 0;
+  uint32_t g;
+  uint8_t j, mode;
+
+  *var = 0;
+  for (j = 0; j < k; j++) {
+    uint8_t d0 = ucf[i + j].data;
+    uint8_t is_const = 1, is_inc = 1;
+
+    for (g = 1; g < c; g++) {
+      uint8_t d = ucf[i + g * k + j].data;
+
+      if (d != d0)
+        is_const = 0;
+      if (d != (uint8_t)(d0 + g))
+        is_inc = 0;
+    }
+
+    mode = is_const ? COL_CONST : (is_inc ? COL_INC : COL_VAR);
+    if (mode == COL_VAR)
+      (*var)++;
+    modes |= (uint16_t)mode << (2U * j);
+  }
+
+  return modes;
+}
+
+/*
+ * @brief  Look up a pattern in the dictionary
+ *
+ * @retval           pattern index, -1 if not found
+ *
+ */
+static int32_t dict_find(const ucf_dict_t *d, const ucf_line_t *ucf,
+                         uint8_t k, uint16_t modes)
+{
+  uint8_t p, j;
+
+  for (p = 0; p < d->num; p++) {
+    if (d->pat[p].k != k || d->pat[p].modes != modes)
+      continue;
+
+    for (j = 0; j < k && d->pat[p].addr[j] == ucf[j].address; j++);
+
+    if (j == k)
+      return p;
+  }
+
+  return -1;
+}
+
+/*
+ * @brief  Pack a configuration (converter)
+ *
+ * The stream is a sequence of tokens:
+ *
+ *  - DEF  0x80 | (k - 1), k addresses, column modes (2 bytes LE):
+ *         defines the next pattern of the dictionary
+ *  - RUN  (c - 1), pattern index, one start byte per CONST / INC column,
+ *         then c groups of one byte per VAR column
+ *  - LIT  0xC0 | (n - 1), n address / data pairs
+ *
+ * Lines are covered greedily by the run that writes the most lines per
+ * stream byte; lines no run packs below two bytes each go to literals.
+ *
+ * @param  ucf       configuration
+ * @param  n         number of lines
+ * @param  out       packed stream
+ * @param  max       size of out
+ * @retval           stream length, -1 if it does not fit in out
+ *
+ */
+static int32_t ucf_pack(const ucf_line_t *ucf, uint32_t n, uint8_t *out,
+                        uint32_t max)
+{
+  uint32_t i = 0, len = 0, lit = 0, lit_pos = 0;
+
+  dict.num = 0;
+
+  while (i < n) {
+    uint32_t best_lines = 1, best_cost = 2, best_c = 0; /* literal */
+    uint8_t best_k = 0;
+    uint8_t k, j, var;
+    uint16_t modes;
+    int32_t p = -1;
+
+    /* Best run starting at line i */
+    for (k = 1; k <= PAT_COLS && i + k <= n; k++) {
+      uint8_t is_const[PAT_COLS], is_inc[PAT_COLS];
+      uint16_t last = 0xFFFFU;
+      uint32_t c, cost;
+
+      memset(is_const, 1, sizeof(is_const));
+      memset(is_inc, 1, sizeof(is_inc));
+
+      for (c = 1; c <= RUN_MAX && i + c * k <= n; c++) {
+        const ucf_line_t *grp = &ucf[i + (c - 1) * k];
+
+        var = 0;
+        modes = 0;
+        for (j = 0; j < k; j++) {
+          if (grp[j].address != ucf[i + j].address)
+            break;
+          if (grp[j].data != ucf[i + j].data)
+            is_const[j] = 0;
+          if (grp[j].data != (uint8_t)(ucf[i + j].data + c - 1))
+            is_inc[j] = 0;
+          if (is_const[j])
+            modes |= (uint16_t)COL_CONST << (2U * j);
+          else if (is_inc[j])
+            modes |= (uint16_t)COL_INC << (2U * j);
+          else
+            var++;
+        }
+        if (j < k)
+          break;
+
+        /* Modes only change a few times along the run */
+        if (modes != last) {
+          last = modes;
+          p = dict_find(&dict, &ucf[i], k, modes);
+        }
+
+        cost = 2 + (k - var) + c * var;
+        if (p < 0) {
+          if (dict.num == PAT_MAX)
+            continue;
+          cost += 3 + k;
+        }
+
+        /* lines / cost > best_lines / best_cost */
+        if (c * k * best_cost > best_lines * cost) {
+          best_lines = c * k;
+          best_cost = cost;
+          best_k = k;
+          best_c = c;
+        }
+      }
+    }
+
+    if (best_k == 0) {
+      /* Literal line */
+      if (lit == 0) {
+        if (len + 1 > max)
+          return -1;
+        lit_pos = len++;
+      }
+      if (len + 2 > max)
+        return -1;
+      out[len++] = ucf[i].address;
+      out[len++] = ucf[i].data;
+      out[lit_pos] = (uint8_t)(TAG_LIT | lit);
+      if (++lit == LIT_MAX)
+        lit = 0;
+      i++;
+      continue;
+    }
+
+    lit = 0;
+    modes = pat_modes(ucf, i, best_k, best_c, &var);
+    if (len + best_cost > max)
+      return -1;
+
+    p = dict_find(&dict, &ucf[i], best_k, modes);
+    if (p < 0) {
+      p = dict.num++;
+      dict.pat[p].k = best_k;
+      dict.pat[p].modes = modes;
+      out[len++] = (uint8_t)(TAG_DEF | (best_k - 1));
+      for (j = 0; j < best_k; j++) {
+        dict.pat[p].addr[j] = ucf[i + j].address;
+        out[len++] = ucf[i + j].address;
+      }
+      out[len++] = (uint8_t)modes;
+      out[len++] = (uint8_t)(modes >> 8);
+    }
+
+    out[len++] = (uint8_t)(TAG_RUN | (best_c - 1));
+    out[len++] = (uint8_t)p;
+    for (j = 0; j < best_k; j++)
+      if (((modes >> (2U * j)) & 3U) != COL_VAR)
+        out[len++] = ucf[i + j].data;
+    for (; best_c > 0; best_c--, i += best_k)
+      for (j = 0; j < best_k; j++)
+        if (((modes >> (2U * j)) & 3U) == COL_VAR)
+          out[len++] = ucf[i + j].data;
+  }
+
+  return (int32_t)len;
+}
+
+/*
+ * @brief  Decode a packed configuration, line by line
+ *
+ * Lines are passed to the writer as soon as they are decoded, in the
+ * order of the original configuration: no line buffer is needed, only
+ * the pattern dictionary.
+ *
+ * @param  p         packed stream
+ * @param  len       stream length
+ * @param  write     register writer
+ * @param  arg       writer argument
+ * @retval           0 on success, -1 on a corrupted stream or write error
+ *
+ */
+static int32_t ucf_unpack(const uint8_t *p, uint32_t len, ucf_write_t write,
+                          void *arg)
+{
+  const uint8_t *end = p + len;
+  uint8_t val[PAT_COLS];
+  uint8_t tag, n, j, mode;
+  ucf_pat_t *pat;
+
+  dict.num = 0;
+
+  while (p < end) {
+    tag = *p++;
+
+    if (tag >= TAG_LIT) {
+      n = (tag & 0x3FU) + 1U;
+      if (end - p < 2 * n)
+        return -1;
+      for (; n > 0; n--, p += 2)
+        if (write(arg, p[0], p[1]) != 0)
+          return -1;
+    } else if (tag >= TAG_DEF) {
+      n = (tag & 0x3FU) + 1U;
+      if (n > PAT_COLS || dict.num == PAT_MAX || end - p < n + 2)
+        return -1;
+      pat = &dict.pat[dict.num++];
+      pat->k = n;
+      memcpy(pat->addr, p, n);
+      p += n;
+      pat->modes = (uint16_t)p[0] | ((uint16_t)p[1] << 8);
+      p += 2;
+    } else {
+      n = tag + 1U;
+      if (p == end || *p >= dict.num)
+        return -1;
+      pat = &dict.pat[*p++];
+      for (j = 0; j < pat->k; j++) {
+        if (((pat->modes >> (2U * j)) & 3U) == COL_VAR)
+          continue;
+        if (p == end)
+          return -1;
+        val[j] = *p++;
+      }
+      for (; n > 0; n--) {
+        for (j = 0; j < pat->k; j++) {
+          mode = (pat->modes >> (2U * j)) & 3U;
+          if (mode == COL_VAR) {
+            if (p == end)
+              return -1;
+            val[j] = *p++;
+          }
+          if (write(arg, pat->addr[j], val[j]) != 0)
+            return -1;
+          if (mode == COL_INC)
+            val[j]++;
+        }
+      }
+    }
+  }
+
+  return 0;
+}
+
+/* Writer comparing the decoded lines with the original configuration */
+static int32_t ucf_check_write(void *arg, uint8_t address, uint8_t data)
+{
+  ucf_check_t *chk = (ucf_check_t *)arg;
+
+  if (chk->pos == chk->len || chk->ucf[chk->pos].address != address ||
+      chk->ucf[chk->pos].data != data)
+    return -1;
+
+  chk->pos++;
+
+  return 0;
+}
+
+/* Writer feeding the device */
+static int32_t ucf_device_write(void *arg, uint8_t address, uint8_t data)
+{
+  return lsm6dsv16x_write_reg((stmdev_ctx_t *)arg, address, &data, 1);
+}
+
+#if defined(UCF_PACK_EXPORT)
+/* Dump a packed stream as a C array to be stored in flash */
+static void ucf_export(const char *name, const uint8_t *p, uint32_t len)
+{
+  uint32_t i;
+
+  snprintf((char *)tx_buffer, sizeof(tx_buffer),
+           "const uint8_t lsm6dsv16x_%s_packed[%lu] = {", name,
+           (unsigned long)len);
+  tx_com(tx_buffer, strlen((char const *)tx_buffer));
+
+  for (i = 0; i < len; i++) {
+    snprintf((char *)tx_buffer, sizeof(tx_buffer), "%s0x%02X,",
+             (i % 12) ? " " : "\r\n  ", p[i]);
+    tx_com(tx_buffer, strlen((char const *)tx_buffer));
+  }
+
+  snprintf((char *)tx_buffer, sizeof(tx_buffer), "\r\n};\r\n");
+  tx_com(tx_buffer, strlen((char const *)tx_buffer));
+}
+#endif
+
+/* Main Example --------------------------------------------------------------*/
+void lsm6dsv16x_ucf_packed(void)
+{
+  lsm6dsv16x_reset_t rst;
+  uint8_t gym_event_catched = 0;
+  ucf_check_t chk;
+  int32_t len = 0;
+  uint32_t cycles;
+  uint8_t i;
+
+  /* Initialize mems driver interface */
+  dev_ctx.write_reg = platform_write;
+  dev_ctx.read_reg = platform_read;
+  dev_ctx.mdelay = platform_delay;
+  dev_ctx.handle = &SENSOR_BUS;
+
+  /* Init test platform */
+  platform_init(dev_ctx.handle);
+  /* Wait sensor boot time */
+  platform_delay(BOOT_TIME);
+  /* Check device ID */
+  lsm6dsv16x_device_id_get(&dev_ctx, &whoamI);
+
+  if (whoamI != LSM6DSV16X_ID)
+    while (1);
+
+  /* Restore default configuration */
+  lsm6dsv16x_reset_set(&dev_ctx, LSM6DSV16X_RESTORE_CTRL_REGS);
+  do {
+    lsm6dsv16x_reset_get(&dev_ctx, &rst);
+  } while (rst != LSM6DSV16X_READY);
+
+#if defined(NUCLEO_H503RB)
+  /* if I3C is used then INT pin must be explicitly enabled */
+  lsm6dsv16x_i3c_int_en_set(&dev_ctx, 1);
+#endif
+
+  cycles_init();
+
+  /* Flash size report: pack, check the round trip and time the decoder */
+  for (i = 0; i < sizeof(conf) / sizeof(ucf_conf_t); i++) {
+    len = ucf_pack(conf[i].ucf, conf[i].len, packed, sizeof(packed));
+    if (len < 0) {
+      snprintf((char *)tx_buffer, sizeof(tx_buffer),
+               "%s: packed stream exceeds %d bytes\r\n", conf[i].name,
+               PACK_MAX);
+      tx_com(tx_buffer, strlen((char const *)tx_buffer));
+      while (1);
+    }
+
+    chk.ucf = conf[i].ucf;
+    chk.len = conf[i].len;
+    chk.pos = 0;
+    cycles = cycles_get();
+    if (ucf_unpack(packed, len, ucf_check_write, &chk) != 0 ||
+        chk.pos != chk.len)
+      while (1);
+    cycles = cycles_get() - cycles;
+
+    snprintf((char *)tx_buffer, sizeof(tx_buffer),
+             "%s: %lu lines, %lu -> %ld bytes (%lu%%), %u patterns, decode %lu cycles\r\n",
+             conf[i].name, (unsigned long)conf[i].len,
+             (unsigned long)(conf[i].len * sizeof(ucf_line_t)), (long)len,
+             (unsigned long)(100U * len / (conf[i].len * sizeof(ucf_line_t))),
+             dict.num, (unsigned long)cycles);
+    tx_com(tx_buffer, strlen((char const *)tx_buffer));
+
+#if defined(UCF_PACK_EXPORT)
+    ucf_export(conf[i].name, packed, len);
+#endif
+  }
+
+  /* Start Machine Learning Core configuration from the packed stream */
+  if (ucf_unpack(packed, len, ucf_device_write, &dev_ctx) != 0)
+    while (1);
+
+  /* wait forever (MLC event flagged in irq handler) */
+  while (1) {
+    if (mlc_event) {
+      lsm6dsv16x_all_sources_t status;
+      lsm6dsv16x_mlc_out_t mlc_out;
+
+      mlc_event = 0;
+      lsm6dsv16x_all_sources_get(&dev_ctx, &status);
+
+      if (status.mlc1) {
+        lsm6dsv16x_mlc_out_get(&dev_ctx, &mlc_out);
+        gym_event_catched = mlc_out.mlc1_src;
+      }
+    }
+
+    if (gym_event_catched != 0x0) {
+      switch(gym_event_catched) {
+      case 4:
+        snprintf((char *)tx_buffer, sizeof(tx_buffer), "biceps curl event\r\n");
+        tx_com(tx_buffer, strlen((char const *)tx_buffer));
+        break;
+      case 8:
+        snprintf((char *)tx_buffer, sizeof(tx_buffer), "Lateral raises event\r\n");
+        tx_com(tx_buffer, strlen((char const *)tx_buffer));
+        break;
+      case 12:
+        snprintf((char *)tx_buffer, sizeof(tx_buffer), "Squats event\r\n");
+        tx_com(tx_buffer, strlen((char const *)tx_buffer));
+        break;
+      }
+      gym_event_catched = 0;
+    }
+  }
+}
+
+/*
+ * @brief  Write generic device register (platform dependent)
+ *
+ * @param  handle    customizable argument. In this examples is used in
+ *                   order to select the correct sensor bus handler.
+ * @param  reg       register to write
+ * @param  bufp      pointer to data to write in register reg
+ * @param  len       number of consecutive register to write
+ *
+ */
+static int32_t platform_write(void *handle, uint8_t reg, const uint8_t *bufp,
+                              uint16_t len)
+{
+#if defined(NUCLEO_F401RE)
+  HAL_I2C_Mem_Write(handle, LSM6DSV16X_I2C_ADD_L, reg,
+                    I2C_MEMADD_SIZE_8BIT, (uint8_t*) bufp, len, 1000);
+#elif defined(STEVAL_MKI109V3)
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_RESET);
+  HAL_SPI_Transmit(handle, &reg, 1, 1000);
+  HAL_SPI_Transmit(handle, (uint8_t*) bufp, len, 1000);
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_SET);
+#elif defined(SPC584B_DIS)
+  i2c_lld_write(handle,  LSM6DSV16X_I2C_ADD_L & 0xFE, reg, (uint8_t*) bufp, len);
+#elif defined(NUCLEO_H503RB)
+  i3c_write(handle, i3c_dyn_addr, reg, (uint8_t*) bufp, len);
+#endif
+  return 0;
+}
+
+/*
+ * @brief  Read generic device register (platform dependent)
+ *
+ * @param  handle    customizable argument. In this examples is used in
+ *                   order to select the correct sensor bus handler.
+ * @param  reg       register to read
+ * @param  bufp      pointer to buffer that store the data read
+ * @param  len       number of consecutive register to read
+ *
+ */
+static int32_t platform_read(void *handle, uint8_t reg, uint8_t *bufp,
+                             uint16_t len)
+{
+#if defined(NUCLEO_F401RE)
+  HAL_I2C_Mem_Read(handle, LSM6DSV16X_I2C_ADD_L, reg,
+                   I2C_MEMADD_SIZE_8BIT, bufp, len, 1000);
+#elif defined(STEVAL_MKI109V3)
+  reg |= 0x80;
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_RESET);
+  HAL_SPI_Transmit(handle, &reg, 1, 1000);
+  HAL_SPI_Receive(handle, bufp, len, 1000);
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_SET);
+#elif defined(SPC584B_DIS)
+  i2c_lld_read(handle, LSM6DSV16X_I2C_ADD_L & 0xFE, reg, bufp, len);
+#elif defined(NUCLEO_H503RB)
+  i3c_read(handle, i3c_dyn_addr, reg, bufp, len);
+#endif
+  return 0;
+}
+
+/*
+ * @brief  platform specific outputs on terminal (platform dependent)
+ *
+ * @param  tx_buffer     buffer to transmit
+ * @param  len           number of byte to send
+ *
+ */
+static void tx_com(uint8_t *tx_buffer, uint16_t len)
+{
+#if defined(NUCLEO_F401RE)
+  HAL_UART_Transmit(&huart2, tx_buffer, len, 1000);
+#elif defined(STEVAL_MKI109V3)
+  CDC_Transmit_FS(tx_buffer, len);
+#elif defined(SPC584B_DIS)
+  sd_lld_write(&SD2, tx_buffer, len);
+#elif defined(NUCLEO_H503RB)
+  HAL_UART_Transmit(&huart3, tx_buffer, len, 1000);
+#endif
+}
+
+/*
+ * @brief  platform specific delay (platform dependent)
+ *
+ * @param  ms        delay in ms
+ *
+ */
+static void platform_delay(uint32_t ms)
+{
+#if defined(NUCLEO_F401RE) || defined(STEVAL_MKI109V3) || defined(NUCLEO_H503RB)
+  HAL_Delay(ms);
+#elif defined(SPC584B_DIS)
+  osalThreadDelayMilliseconds(ms);
+#endif
+}
+
+/*
+ * @brief  platform specific initialization (platform dependent)
+ */
+static void platform_init(void *handle)
+{
+#if defined(STEVAL_MKI109V3)
+  TIM3->CCR1 = PWM_3V3;
+  TIM3->CCR2 = PWM_3V3;
+  HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_1);
+  HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_2);
+  HAL_Delay(1000);
+
+#elif defined(NUCLEO_H503RB)
+  i3c_set_bus_frequency(handle, 1000000);
+  i3c_rstdaa(handle);
+  i3c_setdasa(handle, LSM6DSV16X_I2C_ADD_L, &i3c_dyn_addr, 1);
+  i3c_set_bus_frequency(handle, 12500000);
+
+#endif
+}
@@ -0,0 +1,617 @@
+/*
+ ******************************************************************************
+ * @file    st1vafe3bx_vafe_fifo_frames.c
+ * @author  Sensors Software Solution Team
+ * @brief   This file shows how to batch vAFE and accelerometer data in FIFO
+ *          and turn them into decimated, notch filtered and motion tagged
+ *          biopotential frames.
+ *
+ *          Accelerometer and vAFE share each FIFO slot, so both must run:
+ *          the vAFE-only mode of st1vafe3bx_read_fifo.c
+ *          (st1vafe3bx_enter_vafe_only) powers the accelerometer down and
+ *          could not tag frames with motion. The example therefore does
+ *          not enter it and runs at ST1VAFE3BX_800Hz_HP, the highest ODR of
+ *          the combined mode; the CPU load reported is the one at that rate.
+ *
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2023 STMicroelectronics.
+ * All rights reserved.</center></h2>
+ *
+ * This software component is licensed by ST under BSD 3-Clause license,
+ * the "License"; You may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at:
+ *                        opensource.org/licenses/BSD-3-Clause
+ *
+ ******************************************************************************
+ */
+
+/*
+ * This example was developed using the following STMicroelectronics
+ * evaluation boards:
+ *
+ * - STEVAL_MKI109V3 + STEVAL-
+ * - NUCLEO_F401RE + STEVAL-
+ * - DISCOVERY_SPC584B + STEVAL-
+ *
+ * and STM32CubeMX tool with STM32CubeF4 MCU Package
+ *
+ * Used interfaces:
+ *
+ * STEVAL_MKI109V3    - Host side:   USB (Virtual COM)
+ *                    - Sensor side: SPI(Default) / I2C(supported)
+ *
+ * NUCLEO_STM32F411RE - Host side: UART(COM) to USB bridge
+ *                    - Sensor side: I2C(Default) / SPI(supported)
+ *
+ * DISCOVERY_SPC584B  - Host side: UART(COM) to USB bridge
+ *                    - Sensor side: I2C(Default) / SPI(supported)
+ *
+ * If you need to run this example on a different hardware platform a
+ * modification of the functions: `platform_write`, `platform_read`,
+ * `tx_com` and 'platform_init' is required.
+ *
+ */
+
+/* STMicroelectronics evaluation boards definition
+ *
+ * Please uncomment ONLY the evaluation boards in use.
+ * If a different hardware is used please comment all
+ * following target board and redefine yours.
+ */
+
+//#define STEVAL_MKI109V3  /* little endian */
+//#define NUCLEO_F401RE    /* little endian */
+//#define SPC584B_DIS      /* big endian */
+
+/* ATTENTION: By default the driver is little endian. If you need switch
+ *            to big endian please see "Endianness definitions" in the
+ *            header file of the driver (_reg.h).
+ */
+
+
+#if defined(STEVAL_MKI109V3)
+/* MKI109V3: Define communication interface */
+#define SENSOR_BUS hspi2
+/* MKI109V3: Vdd and Vddio power supply values */
+#define PWM_3V3 915
+
+#elif defined(NUCLEO_F401RE)
+/* NUCLEO_F401RE: Define communication interface */
+#define SENSOR_BUS hi2c1
+
+#elif defined(SPC584B_DIS)
+/* DISCOVERY_SPC584B: Define communication interface */
+#define SENSOR_BUS I2CD1
+
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include <stdio.h>
+#include "st1vafe3bx_reg.h"
+
+#if defined(NUCLEO_F401RE)
+#include "stm32f4xx_hal.h"
+#include "usart.h"
+#include "gpio.h"
+#include "i2c.h"
+
+#elif defined(STEVAL_MKI109V3)
+#include "stm32f4xx_hal.h"
+#include "usbd_cdc_if.h"
+#include "gpio.h"
+#include "spi.h"
+#include "tim.h"
+
+#elif defined(SPC584B_DIS)
+#include "components.h"
+#endif
+
+/* Private macro -------------------------------------------------------------*/
+#define    BOOT_TIME         10 //ms
+
+/* FIFO depth and slot size (TAG + 6 data byte) */
+#define    FIFO_DEPTH        128
+#define    FIFO_SLOT_LEN     7
+
+/* Output data rate (ODR_HZ must match md.odr) */
+#define    ODR_HZ            800
+
+/* Timestamp LSB is 10 us */
+#define    TS_TICK_PER_S     100000UL
+
+/* FIFO_STATUS1 flags */
+#define    FIFO_OVR_IA       0x40U
+
+/* Two halfband stages: 800 Hz -> 400 Hz -> 200 Hz */
+#define    DEC_FACTOR        4
+#define    FRAME_ODR_HZ      (ODR_HZ / DEC_FACTOR)
+
+/*
+ * Mains notch at FRAME_ODR_HZ (pole radius 0.95, unity gain at DC),
+ * Q14 coefficients. Define NOTCH_60HZ for 60 Hz mains.
+ */
+#if defined(NOTCH_60HZ)
+#define    NOTCH_B0          15585
+#define    NOTCH_B1          9632
+#define    NOTCH_A1          9620
+#define    NOTCH_A2          14787
+#else
+#define    NOTCH_B0          15585
+#define    NOTCH_B1          0
+#define    NOTCH_A1          0
+#define    NOTCH_A2          14787
+#endif
+
+/* Accelerometer activity (12 bit LSB over a frame) flagging motion */
+#define    MOTION_TH         64
+
+/* Max number of frames produced by a FIFO drain */
+#define    FRAME_LEN         (FIFO_DEPTH / DEC_FACTOR + 1)
+
+/* Private typedef -----------------------------------------------------------*/
+/*
+ * Halfband decimator by 2, taps [-1 0 9 16 9 0 -1] / 32.
+ * z[] holds the last 7 input samples, z[0] the most recent one.
+ */
+typedef struct {
+  int32_t z[7];
+  uint8_t phase;
+} hb_dec_t;
+
+/* Direct form I biquad, Q14 coefficients */
+typedef struct {
+  int32_t x1, x2;
+  int32_t y1, y2;
+} notch_t;
+
+/*
+ * Biopotential frame: vAFE sample after decimation and notch (12 bit LSB,
+ * 2 fractional bit), accelerometer activity over the frame and motion
+ * flag. ts is in 10 us LSB.
+ */
+typedef struct {
+  uint32_t ts;
+  int32_t bio_q2;
+  uint16_t motion;
+  uint8_t moving;
+} bio_frame_t;
+
+/* Private variables ---------------------------------------------------------*/
+static uint8_t tx_buffer[1000];
+static uint8_t fifo_raw[FIFO_DEPTH * FIFO_SLOT_LEN];
+static bio_frame_t frame[FRAME_LEN];
+static hb_dec_t hb1, hb2;
+static notch_t notch;
+static uint32_t ts_next;
+static int16_t xl_prev[3];
+static uint32_t motion_acc;
+
+/* Extern variables ----------------------------------------------------------*/
+
+/* Private functions ---------------------------------------------------------*/
+
+/*
+ *   WARNING:
+ *   Functions declare in this section are defined at the end of this file
+ *   and are strictly related to the hardware platform used.
+ *
+ */
+static int32_t platform_write(void *handle, uint8_t reg, const uint8_t *bufp,
+                              uint16_t len);
+static int32_t platform_read(void *handle, uint8_t reg, uint8_t *bufp,
+                             uint16_t len);
+static void tx_com( uint8_t *tx_buffer, uint16_t len );
+static void platform_delay(uint32_t ms);
+static void platform_init(void);
+
+#define NUM_FIFO_ENTRY  64 /* 80 ms at 800 Hz */
+
+static stmdev_ctx_t dev_ctx;
+static st1vafe3bx_md_t md;
+static st1vafe3bx_fifo_mode_t fifo_mode;
+static st1vafe3bx_ah_bio_config_t cfg;
+static volatile uint8_t fifo_wtm_event = 0;
+
+static int32_t fifo_frames_get(stmdev_ctx_t *ctx, bio_frame_t *f,
+                               uint16_t *len, uint8_t *ovr);
+
+#if defined(NUCLEO_F401RE) || defined(STEVAL_MKI109V3)
+/* Cycle counter used to benchmark the filter chain (Cortex-M DWT) */
+static void cycles_init(void)
+{
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+static uint32_t cycles_get(void)
+{
+  return DWT->CYCCNT;
+}
+
+static uint32_t cycles_per_s(void)
+{
+  return SystemCoreClock;
+}
+#else
+static void cycles_init(void) {}
+static uint32_t cycles_get(void) { return 0; }
+static uint32_t cycles_per_s(void) { return 1; }
+#endif
+
+void st1vafe3bx_vafe_fifo_frames_handler(void)
+{
+  fifo_wtm_event = 1;
+}
+
+/* Main Example --------------------------------------------------------------*/
+void st1vafe3bx_vafe_fifo_frames(void)
+{
+  st1vafe3bx_pin_int_route_t int_route;
+  st1vafe3bx_status_t status;
+  uint8_t id;
+
+  /* Initialize mems driver interface */
+  dev_ctx.write_reg = platform_write;
+  dev_ctx.read_reg = platform_read;
+  dev_ctx.mdelay = platform_delay;
+  dev_ctx.handle = &SENSOR_BUS;
+
+  /* Initialize platform specific hardware */
+  platform_init();
+
+  /* Wait sensor boot time */
+  platform_delay(BOOT_TIME);
+
+  st1vafe3bx_exit_deep_power_down(&dev_ctx);
+
+  /* Check device ID */
+  st1vafe3bx_device_id_get(&dev_ctx, &id);
+  if (id != ST1VAFE3BX_ID)
+    while(1);
+
+  /* Restore default configuration */
+  st1vafe3bx_init_set(&dev_ctx, ST1VAFE3BX_RESET);
+  do {
+    st1vafe3bx_status_get(&dev_ctx, &status);
+  } while (status.sw_reset);
+
+  /* Batch accelerometer and vAFE in the same FIFO slot at full ODR */
+  fifo_mode.watermark = NUM_FIFO_ENTRY;
+  fifo_mode.operation = ST1VAFE3BX_STREAM_MODE;
+  fifo_mode.batch.dec_ts = ST1VAFE3BX_DEC_TS_32;
+  fifo_mode.batch.bdr_xl = ST1VAFE3BX_BDR_ODR;
+  fifo_mode.xl_only = 0;
+  st1vafe3bx_fifo_mode_set(&dev_ctx, fifo_mode);
+
+  /* Enable BIO (fully differential, gain 2, Zin 100Mohm) */
+  cfg.mode = ST1VAFE3BX_DIFFERENTIAL_MODE;
+  st1vafe3bx_ah_bio_config_set(&dev_ctx, cfg);
+
+  /* Set bdu and if_inc recommended for driver usage */
+  st1vafe3bx_init_set(&dev_ctx, ST1VAFE3BX_SENSOR_ONLY_ON);
+
+  st1vafe3bx_timestamp_set(&dev_ctx, PROPERTY_ENABLE);
+
+  /* Configure interrupt pins */
+  int_route.fifo_th   = PROPERTY_ENABLE;
+  st1vafe3bx_pin_int_route_set(&dev_ctx, &int_route);
+
+  /*
+   * Set Output Data Rate: highest ODR with accelerometer and vAFE both on
+   * (vAFE-only mode is not entered, see file header)
+   */
+  md.odr = ST1VAFE3BX_800Hz_HP;
+  md.bw = ST1VAFE3BX_BW_VAFE_90Hz;
+  st1vafe3bx_mode_set(&dev_ctx, &md);
+
+  cycles_init();
+
+  /* wait forever (FIFO frames read with irq) */
+  while (1) {
+    uint32_t cycles, load;
+    uint16_t len, i;
+    uint8_t ovr;
+
+    if (fifo_wtm_event == 0)
+      continue;
+
+    fifo_wtm_event = 0;
+
+    cycles = cycles_get();
+    if (fifo_frames_get(&dev_ctx, frame, &len, &ovr) != 0)
+      continue;
+    cycles = cycles_get() - cycles;
+
+    /*
+     * CPU load (per mille) of bus transfer plus filter chain, against
+     * the time it takes the sensor to produce the drained samples.
+     */
+    load = (uint32_t)(((uint64_t)cycles * 1000U * FRAME_ODR_HZ) /
+                      ((uint64_t)cycles_per_s() * (len ? len : 1)));
+
+    snprintf((char *)tx_buffer, sizeof(tx_buffer),
+             "-- %d frames%s (%lu cycles, load %lu/1000)\r\n", len,
+             ovr ? " (overrun)" : "", (unsigned long)cycles,
+             (unsigned long)load);
+    tx_com(tx_buffer, strlen((char const *)tx_buffer));
+
+    for (i = 0; i < len; i++) {
+      snprintf((char *)tx_buffer, sizeof(tx_buffer), "%lu\t%ld\t%u%s\r\n",
+               (unsigned long)frame[i].ts, (long)frame[i].bio_q2,
+               frame[i].motion, frame[i].moving ? "\tmotion" : "");
+      tx_com(tx_buffer, strlen((char const *)tx_buffer));
+    }
+  }
+}
+
+/*
+ * @brief  Push one sample into a halfband decimator by 2
+ *
+ * @param  f         decimator state
+ * @param  x         input sample
+ * @param  y         output sample (valid only when 1 is returned)
+ * @retval           1 when an output sample is produced, 0 otherwise
+ *
+ */
+static uint8_t hb_dec_push(hb_dec_t *f, int32_t x, int32_t *y)
+{
+  uint8_t i;
+
+  for (i = 6; i > 0; i--)
+    f->z[i] = f->z[i - 1];
+  f->z[0] = x;
+
+  f->phase ^= 1U;
+  if (f->phase)
+    return 0;
+
+  *y = (16 * f->z[3] + 9 * (f->z[2] + f->z[4]) - (f->z[0] + f->z[6])) >> 5;
+
+  return 1;
+}
+
+/*
+ * @brief  Notch filter one sample
+ *
+ * Input is a 12 bit sample with 2 fractional bit, so that the Q14
+ * products never overflow 32 bit.
+ *
+ * @param  f         filter state
+ * @param  x         input sample
+ * @retval           filtered sample
+ *
+ */
+static int32_t notch_run(notch_t *f, int32_t x)
+{
+  int32_t y;
+
+  y = (NOTCH_B0 * (x + f->x2) + NOTCH_B1 * f->x1 -
+       NOTCH_A1 * f->y1 - NOTCH_A2 * f->y2) >> 14;
+
+  f->x2 = f->x1;
+  f->x1 = x;
+  f->y2 = f->y1;
+  f->y1 = y;
+
+  return y;
+}
+
+/*
+ * @brief  Feed one vAFE + accelerometer sample into the filter chain
+ *
+ * Accelerometer activity (L1 norm of the sample to sample change) is
+ * accumulated over the samples that make up a frame.
+ *
+ * @param  bio       12 bit vAFE sample
+ * @param  xl        12 bit X, Y, Z accelerometer sample
+ * @param  ts        sample timestamp (10 us LSB)
+ * @param  f         output frame (valid only when 1 is returned)
+ * @retval           1 when a frame is produced, 0 otherwise
+ *
+ */
+static uint8_t bio_chain_push(int16_t bio, const int16_t *xl, uint32_t ts,
+                              bio_frame_t *f)
+{
+  int32_t y1, y2;
+  uint8_t i;
+
+  for (i = 0; i < 3; i++) {
+    int32_t d = xl[i] - xl_prev[i];
+
+    motion_acc += (uint32_t)(d < 0 ? -d : d);
+    xl_prev[i] = xl[i];
+  }
+
+  if (hb_dec_push(&hb1, (int32_t)bio * 4, &y1) == 0)
+    return 0;
+
+  if (hb_dec_push(&hb2, y1, &y2) == 0)
+    return 0;
+
+  f->ts = ts;
+  f->bio_q2 = notch_run(&notch, y2);
+  f->motion = (motion_acc > 0xFFFFU) ? 0xFFFFU : (uint16_t)motion_acc;
+  f->moving = (motion_acc > MOTION_TH) ? 1 : 0;
+  motion_acc = 0;
+
+  return 1;
+}
+
+/*
+ * @brief  Drain the whole FIFO in a single burst and produce frames
+ *
+ * FIFO_STATUS1 (flags) and FIFO_STATUS2 (level) are read in a single
+ * transaction, then all the slots are read with one burst starting from
+ * FIFO_DATA_OUT_TAG. TIMESTAMP slots re-anchor the timebase and the
+ * other samples are timestamped 1 / ODR apart.
+ *
+ * @param  ctx       read / write interface definitions
+ * @param  f         output frames
+ * @param  len       number of frames produced
+ * @param  ovr       FIFO overrun flag
+ * @retval           interface status (MANDATORY: return 0 -> no Error)
+ *
+ */
+static int32_t fifo_frames_get(stmdev_ctx_t *ctx, bio_frame_t *f,
+                               uint16_t *len, uint8_t *ovr)
+{
+  const uint32_t period = TS_TICK_PER_S / ODR_HZ;
+  const uint8_t *slot;
+  uint8_t status[2];
+  uint16_t level, i;
+  int16_t xl[3], bio;
+  int32_t ret;
+
+  *len = 0;
+  *ovr = 0;
+
+  ret = st1vafe3bx_read_reg(ctx, ST1VAFE3BX_FIFO_STATUS1, status, 2);
+  if (ret != 0)
+    return ret;
+
+  *ovr = (status[0] & FIFO_OVR_IA) ? 1 : 0;
+  level = (status[1] > FIFO_DEPTH) ? FIFO_DEPTH : status[1];
+  if (level == 0U)
+    return ret;
+
+  ret = st1vafe3bx_read_reg(ctx, ST1VAFE3BX_FIFO_DATA_OUT_TAG, fifo_raw,
+                            level * FIFO_SLOT_LEN);
+  if (ret != 0)
+    return ret;
+
+  for (i = 0; i < level; i++) {
+    slot = &fifo_raw[i * FIFO_SLOT_LEN];
+
+    switch (slot[0] >> 3) {
+    case ST1VAFE3BX_XL_AND_AH_VAFE1_TAG:
+      /* 12 bit X, Y, Z and vAFE */
+      xl[0] = (int16_t)(((uint16_t)slot[2] << 12) |
+                        ((uint16_t)slot[1] << 4)) >> 4;
+      xl[1] = (int16_t)(((uint16_t)slot[3] << 8) |
+                        ((uint16_t)slot[2] & 0xF0U)) >> 4;
+      xl[2] = (int16_t)(((uint16_t)slot[5] << 12) |
+                        ((uint16_t)slot[4] << 4)) >> 4;
+      bio = (int16_t)(((uint16_t)slot[6] << 8) |
+                      ((uint16_t)slot[5] & 0xF0U)) >> 4;
+
+      if (bio_chain_push(bio, xl, ts_next, &f[*len]))
+        (*len)++;
+      ts_next += period;
+      break;
+    case ST1VAFE3BX_TIMESTAMP_CFG_CHG_TAG:
+      ts_next = (uint32_t)slot[3] | ((uint32_t)slot[4] << 8) |
+                ((uint32_t)slot[5] << 16) | ((uint32_t)slot[6] << 24);
+      break;
+    default:
+      break;
+    }
+  }
+
+  return ret;
+}
+
+/*
+ * @brief  Write generic device register (platform dependent)
+ *
+ * @param  handle    customizable argument. In this examples is used in
+ *                   order to select the correct sensor bus handler.
+ * @param  reg       register to write
+ * @param  bufp      pointer to data to write in register reg
+ * @param  len       number of consecutive register to write
+ *
+ */
+static int32_t platform_write(void *handle, uint8_t reg,
+                              const uint8_t *bufp, uint16_t len)
+{
+#if defined(NUCLEO_F401RE)
+  HAL_I2C_Mem_Write(handle, ST1VAFE3BX_I2C_ADD_L, reg,
+                    I2C_MEMADD_SIZE_8BIT, (uint8_t*) bufp, len, 1000);
+#elif defined(STEVAL_MKI109V3)
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_RESET);
+  HAL_SPI_Transmit(handle, &reg, 1, 1000);
+  HAL_SPI_Transmit(handle, (uint8_t*) bufp, len, 1000);
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_SET);
+#elif defined(SPC584B_DIS)
+  i2c_lld_write(handle,  ST1VAFE3BX_I2C_ADD_L & 0xFE, reg, (uint8_t*) bufp, len);
+#endif
+  return 0;
+}
+
+/*
+ * @brief  Read generic device register (platform dependent)
+ *
+ * @param  handle    customizable argument. In this examples is used in
+ *                   order to select the correct sensor bus handler.
+ * @param  reg       register to read
+ * @param  bufp      pointer to buffer that store the data read
+ * @param  len       number of consecutive register to read
+ *
+ */
+static int32_t platform_read(void *handle, uint8_t reg, uint8_t *bufp,
+                             uint16_t len)
+{
+#if defined(NUCLEO_F401RE)
+  HAL_I2C_Mem_Read(handle, ST1VAFE3BX_I2C_ADD_L, reg,
+                   I2C_MEMADD_SIZE_8BIT, bufp, len, 1000);
+#elif defined(STEVAL_MKI109V3)
+  reg |= 0x80;
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_RESET);
+  HAL_SPI_Transmit(handle, &reg, 1, 1000);
+  HAL_SPI_Receive(handle, bufp, len, 1000);
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_SET);
+#elif defined(SPC584B_DIS)
+  i2c_lld_read(handle, ST1VAFE3BX_I2C_ADD_L & 0xFE, reg, bufp, len);
+#endif
+  return 0;
+}
+
+/*
+ * @brief  Send buffer to console (platform dependent)
+ *
+ * @param  tx_buffer     buffer to transmit
+ * @param  len           number of byte to send
+ *
+ */
+static void tx_com(uint8_t *tx_buffer, uint16_t len)
+{
+#if defined(NUCLEO_F401RE)
+  HAL_UART_Transmit(&huart2, tx_buffer, len, 1000);
+#elif defined(STEVAL_MKI109V3)
+  CDC_Transmit_FS(tx_buffer, len);
+#elif defined(SPC584B_DIS)
+  sd_lld_write(&SD2, tx_buffer, len);
+#endif
+}
+
+/*
+ * @brief  platform specific delay (platform dependent)
+ *
+ * @param  ms        delay in ms
+ *
+ */
+static void platform_delay(uint32_t ms)
+{
+#if defined(NUCLEO_F401RE) | defined(STEVAL_MKI109V3)
+  HAL_Delay(ms);
+#elif defined(SPC584B_DIS)
+  osalThreadDelayMilliseconds(ms);
+#endif
+}
+
+/*
+ * @brief  platform specific initialization (platform dependent)
+ */
+static void platform_init(void)
+{
+#if defined(STEVAL_MKI109V3)
+  TIM3->CCR1 = PWM_3V3;
+  TIM3->CCR2 = PWM_3V3;
+  HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_1);
+  HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_2);
+  HAL_Delay(1000);
+#endif
+}
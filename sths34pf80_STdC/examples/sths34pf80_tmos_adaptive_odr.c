@@ -0,0 +1,530 @@
+/*
+ ******************************************************************************
+ * @file    sths34pf80_tmos_adaptive_odr.c
+ * @author  AME MEMS Applications Team
+ * @brief   This file shows how to adapt ODR and averaging to presence and
+ *          motion events to trade power against detection latency.
+ *
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2021 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software component is licensed by ST under BSD 3-Clause license,
+ * the "License"; You may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at:
+ *                        opensource.org/licenses/BSD-3-Clause
+ *
+ ******************************************************************************
+ */
+
+/*
+ * This example was developed using the following STMicroelectronics
+ * evaluation boards:
+ *
+ * - STEVAL_MKI109V3
+ * - NUCLEO_F401RE
+ * - DISCOVERY_SPC584B
+ *
+ * and STM32CubeMX tool with STM32CubeF4 MCU Package
+ *
+ * Used interfaces:
+ *
+ * STEVAL_MKI109V3    - Host side:   USB (Virtual COM)
+ *                    - Sensor side: SPI(Default) / I2C(supported)
+ *
+ * NUCLEO_STM32F401RE - Host side: UART(COM) to USB bridge
+ *                    - I2C(Default) / SPI(N/A)
+ *
+ * DISCOVERY_SPC584B  - Host side: UART(COM) to USB bridge
+ *                    - Sensor side: I2C(Default) / SPI(supported)
+ *
+ * If you need to run this example on a different hardware platform a
+ * modification of the functions: `platform_write`, `platform_read`,
+ * `tx_com` and 'platform_init' is required.
+ *
+ */
+
+/* STMicroelectronics evaluation boards definition
+ *
+ * Please uncomment ONLY the evaluation boards in use.
+ * If a different hardware is used please comment all
+ * following target board and redefine yours.
+ */
+
+//#define STEVAL_MKI109V3  /* little endian */
+//#define NUCLEO_F401RE    /* little endian */
+//#define SPC584B_DIS      /* big endian */
+
+/* ATTENTION: By default the driver is little endian. If you need switch
+ *            to big endian please see "Endianness definitions" in the
+ *            header file of the driver (_reg.h).
+ */
+
+#if defined(STEVAL_MKI109V3)
+/* MKI109V3: Define communication interface */
+#define SENSOR_BUS hspi2
+/* MKI109V3: Vdd and Vddio power supply values at 1V8 */
+#define PWM_1V8 500  /* ((1.8 / 3.6) * htim3.Init.Period) */
+
+#elif defined(NUCLEO_F401RE)
+/* NUCLEO_F401RE: Define communication interface */
+#define SENSOR_BUS hi2c1
+
+#elif defined(SPC584B_DIS)
+/* DISCOVERY_SPC584B: Define communication interface */
+#define SENSOR_BUS I2CD1
+
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include <stdio.h>
+#include "sths34pf80_reg.h"
+
+#if defined(NUCLEO_F401RE)
+#include "stm32f4xx_hal.h"
+#include "usart.h"
+#include "gpio.h"
+#include "i2c.h"
+
+#elif defined(STEVAL_MKI109V3)
+#include "stm32f4xx_hal.h"
+#include "usbd_cdc_if.h"
+#include "gpio.h"
+#include "spi.h"
+#include "tim.h"
+
+#elif defined(SPC584B_DIS)
+#include "components.h"
+#endif
+
+/* Private macro -------------------------------------------------------------*/
+#define    BOOT_TIME         10 //ms
+
+// Period of the platform timer calling the timer handler [ms]
+#define    TICK_MS           10
+
+// Time without presence nor motion before stepping one level down [s]
+#define    RELAX_TIME        10
+
+#define    LEVEL_NUM         3
+
+/* Private types ---------------------------------------------------------*/
+// Operating level: ODR / averaging pair and its TMOS conversion rate
+typedef struct
+{
+  sths34pf80_odr_t odr;
+  sths34pf80_avg_tobject_num_t avg;
+  uint16_t conv_per_s;      // ODR * AVG_TMOS, the sensor current scales with it
+} level_cfg_t;
+
+// Power / latency controller. It never touches the bus, so that it can
+// be fed with flags replayed from a recorded trace as well.
+typedef struct
+{
+  uint8_t level;
+  uint32_t last_activity;   // tick of the last presence / motion flag
+  uint32_t level_start;     // tick of the last level change
+  uint32_t wake_tick;       // tick of the first motion seen at level 0
+  uint8_t waking;
+
+  // statistics
+  uint32_t residency[LEVEL_NUM];
+  uint32_t latency_sum;
+  uint16_t latency_num;
+} odr_ctrl_t;
+
+/* Private variables ---------------------------------------------------------*/
+static uint8_t tx_buffer[1000];
+static stmdev_ctx_t dev_ctx;
+static volatile uint8_t wakeup_thread = 0;
+static volatile uint32_t tick = 0;
+
+static const level_cfg_t level_cfg[LEVEL_NUM] =
+{
+  { STHS34PF80_ODR_AT_1Hz,  STHS34PF80_AVG_TMOS_2,  1 * 2 },
+  { STHS34PF80_ODR_AT_4Hz,  STHS34PF80_AVG_TMOS_8,  4 * 8 },
+  { STHS34PF80_ODR_AT_15Hz, STHS34PF80_AVG_TMOS_32, 15 * 32 },
+};
+
+static odr_ctrl_t ctrl;
+
+/* Extern variables ----------------------------------------------------------*/
+
+/* Private functions ---------------------------------------------------------*/
+/*
+ *   WARNING:
+ *   Functions declare in this section are defined at the end of this file
+ *   and are strictly related to the hardware platform used.
+ *
+ */
+static int32_t platform_write(void *handle, uint8_t reg, const uint8_t *bufp,
+                              uint16_t len);
+static int32_t platform_read(void *handle, uint8_t reg, uint8_t *bufp,
+                             uint16_t len);
+static void tx_com(uint8_t *tx_buffer, uint16_t len);
+static void platform_delay(uint32_t ms);
+static void platform_init(void);
+
+
+static uint8_t odr_ctrl_step(odr_ctrl_t *c, uint8_t pres, uint8_t mot,
+                             uint32_t now);
+static void odr_ctrl_report(odr_ctrl_t *c, uint32_t now);
+static void level_apply(uint8_t level);
+
+/* Timer handler  --------------------------------------------------------*/
+void sths34pf80_tmos_adaptive_odr_handler_timer(void)
+{
+  tick++;
+}
+
+/* Interrupt handler  --------------------------------------------------------*/
+void sths34pf80_tmos_adaptive_odr_handler_interrupt(void)
+{
+  wakeup_thread = 1;
+}
+
+/* Main Example --------------------------------------------------------------*/
+void sths34pf80_tmos_adaptive_odr(void)
+{
+  uint8_t whoami;
+  uint8_t presence = 0;
+  uint8_t motion = 0;
+
+  /* Initialize mems driver interface */
+  dev_ctx.write_reg = platform_write;
+  dev_ctx.read_reg = platform_read;
+  dev_ctx.mdelay = platform_delay;
+  dev_ctx.handle = &SENSOR_BUS;
+
+  /* Initialize platform specific hardware */
+  platform_init();
+
+  /* Wait sensor boot time */
+  platform_delay(BOOT_TIME);
+
+  /* Check device ID */
+  sths34pf80_device_id_get(&dev_ctx, &whoami);
+  if (whoami != STHS34PF80_ID)
+    while (1);
+
+  sths34pf80_avg_tambient_num_set(&dev_ctx, STHS34PF80_AVG_T_8);
+
+  /* Set BDU */
+  sths34pf80_block_data_update_set(&dev_ctx, 1);
+
+  sths34pf80_presence_threshold_set(&dev_ctx, 200);
+  sths34pf80_presence_hysteresis_set(&dev_ctx, 20);
+  sths34pf80_motion_threshold_set(&dev_ctx, 300);
+  sths34pf80_motion_hysteresis_set(&dev_ctx, 30);
+
+  /* Interrupt on presence and motion flag changes */
+  sths34pf80_int_or_set(&dev_ctx, STHS34PF80_INT_MOTION_PRESENCE);
+  sths34pf80_route_int_set(&dev_ctx, STHS34PF80_INT_OR);
+
+  /* Start at the lowest ODR and averaging */
+  level_apply(0);
+
+  while (1)
+  {
+    sths34pf80_func_status_t func_status;
+    uint32_t now;
+    uint8_t level;
+
+    /*
+     * Flags are read once per interrupt; the relax timeout is checked
+     * on every timer tick, so the loop sleeps (WFI on STM32 boards) in
+     * between.
+     */
+    if (wakeup_thread)
+    {
+      wakeup_thread = 0;
+
+      sths34pf80_func_status_get(&dev_ctx, &func_status);
+
+      if (func_status.pres_flag != presence)
+      {
+        presence = func_status.pres_flag;
+        snprintf((char *)tx_buffer, sizeof(tx_buffer), "%s of Presence\r\n",
+                 presence ? "Start" : "End");
+        tx_com(tx_buffer, strlen((char const *)tx_buffer));
+      }
+
+      motion = func_status.mot_flag;
+    }
+
+    now = tick;
+    level = odr_ctrl_step(&ctrl, presence, motion, now);
+
+    if (level != ctrl.level)
+    {
+      ctrl.residency[ctrl.level] += now - ctrl.level_start;
+      ctrl.level_start = now;
+      ctrl.level = level;
+      level_apply(level);
+
+      snprintf((char *)tx_buffer, sizeof(tx_buffer), "Level %d\r\n", level);
+      tx_com(tx_buffer, strlen((char const *)tx_buffer));
+
+      /* Embedded algorithms restarted: flags start from 0 again */
+      presence = 0;
+      motion = 0;
+
+      if (level == 0)
+        odr_ctrl_report(&ctrl, now);
+    }
+
+#if defined(NUCLEO_F401RE) || defined(STEVAL_MKI109V3)
+    /*
+     * Sleep until the next timer tick or sensor interrupt (an interrupt
+     * just before WFI is handled at the next tick, TICK_MS later)
+     */
+    __WFI();
+#endif
+  }
+}
+
+/*
+ * @brief  Update the controller with the current presence / motion flags
+ *
+ * Motion escalates one level, presence goes straight to the top level.
+ * The level steps down by one after RELAX_TIME without any flag. The
+ * detection latency is the time from the first motion seen at level 0
+ * to the presence flag.
+ *
+ * @param  c         controller state
+ * @param  pres      presence flag
+ * @param  mot       motion flag
+ * @param  now       current time [tick]
+ * @retval           requested level
+ *
+ */
+static uint8_t odr_ctrl_step(odr_ctrl_t *c, uint8_t pres, uint8_t mot,
+                             uint32_t now)
+{
+  uint8_t level = c->level;
+
+  if (pres || mot)
+  {
+    c->last_activity = now;
+
+    if (mot && c->level == 0 && !c->waking)
+    {
+      c->waking = 1;
+      c->wake_tick = now;
+    }
+
+    if (pres && c->waking)
+    {
+      c->waking = 0;
+      c->latency_sum += now - c->wake_tick;
+      c->latency_num++;
+    }
+
+    if (pres)
+      level = LEVEL_NUM - 1;
+    else if (c->level < LEVEL_NUM - 1)
+      level = c->level + 1;
+  }
+  else if (c->level > 0 &&
+           now - c->last_activity >= (RELAX_TIME * 1000) / TICK_MS &&
+           now - c->level_start >= (RELAX_TIME * 1000) / TICK_MS)
+  {
+    level = c->level - 1;
+  }
+
+  if (level == 0)
+    c->waking = 0;
+
+  return level;
+}
+
+/*
+ * @brief  Print level residency, mean TMOS conversion rate (proportional
+ *         to the average supply current) and mean detection latency
+ *
+ * @param  c         controller state
+ * @param  now       current time [tick]
+ *
+ */
+static void odr_ctrl_report(odr_ctrl_t *c, uint32_t now)
+{
+  uint32_t total = 0;
+  uint32_t conv = 0;
+  uint8_t i;
+
+  for (i = 0; i < LEVEL_NUM; i++)
+  {
+    total += c->residency[i];
+    conv += c->residency[i] * level_cfg[i].conv_per_s;
+  }
+
+  if (total == 0)
+    return;
+
+  snprintf((char *)tx_buffer, sizeof(tx_buffer),
+           "t %lu s, level residency %lu/%lu/%lu s, %lu conv/s, latency %lu ms\r\n",
+           (unsigned long)(now * TICK_MS / 1000),
+           (unsigned long)(c->residency[0] * TICK_MS / 1000),
+           (unsigned long)(c->residency[1] * TICK_MS / 1000),
+           (unsigned long)(c->residency[2] * TICK_MS / 1000),
+           (unsigned long)(conv / total),
+           (unsigned long)(c->latency_num ?
+                           c->latency_sum * TICK_MS / c->latency_num : 0));
+  tx_com(tx_buffer, strlen((char const *)tx_buffer));
+}
+
+/*
+ * @brief  Program ODR and averaging of a level
+ *
+ * The sensor is put in power-down while the averaging is changed, then
+ * the embedded algorithms are restarted at the new ODR.
+ *
+ * @param  level     level to apply
+ *
+ */
+static void level_apply(uint8_t level)
+{
+  sths34pf80_odr_set(&dev_ctx, STHS34PF80_ODR_OFF);
+  sths34pf80_avg_tobject_num_set(&dev_ctx, level_cfg[level].avg);
+  sths34pf80_algo_reset(&dev_ctx);
+  sths34pf80_odr_set(&dev_ctx, level_cfg[level].odr);
+}
+
+/*
+ * @brief  Write generic device register (platform dependent)
+ *
+ * @param  handle    customizable argument. In this examples is used in
+ *                   order to select the correct sensor bus handler.
+ * @param  reg       register to write
+ * @param  bufp      pointer to data to write in register reg
+ * @param  len       number of consecutive register to write
+ *
+ */
+static int32_t platform_write(void *handle, uint8_t reg, const uint8_t *bufp,
+                              uint16_t len)
+{
+#if defined(NUCLEO_F401RE)
+  HAL_I2C_Mem_Write(handle, STHS34PF80_I2C_ADD, reg,
+                    I2C_MEMADD_SIZE_8BIT, (uint8_t *)bufp, len, 1000);
+#elif defined(STEVAL_MKI109V3)
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_RESET);
+  HAL_SPI_Transmit(handle, &reg, 1, 1000);
+  HAL_SPI_Transmit(handle, (uint8_t *)bufp, len, 1000);
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_SET);
+#elif defined(SPC584B_DIS)
+  i2c_lld_write(handle,  STHS34PF80_I2C_ADD & 0xFE, reg, (uint8_t *)bufp, len);
+#endif
+  return 0;
+}
+
+#if defined(STEVAL_MKI109V3)
+static void SPI_3W_Read(SPI_HandleTypeDef *xSpiHandle, uint8_t *val)
+{
+  __disable_irq();
+
+  __HAL_SPI_ENABLE(xSpiHandle);
+  __asm("dsb\n");
+  __asm("dsb\n");
+  __HAL_SPI_DISABLE(xSpiHandle);
+
+  __enable_irq();
+
+  while ((xSpiHandle->Instance->SR & SPI_FLAG_RXNE) != SPI_FLAG_RXNE);
+  /* read the received data */
+  *val = *(__IO uint8_t *) &xSpiHandle->Instance->DR;
+  while ((xSpiHandle->Instance->SR & SPI_FLAG_BSY) == SPI_FLAG_BSY);
+}
+
+static void SPI_3W_Receive(uint8_t *pBuffer, uint16_t nBytesToRead)
+{
+  __HAL_SPI_DISABLE(&hspi2);
+  SPI_1LINE_RX(&hspi2);
+
+  for (uint16_t i = 0; i < nBytesToRead; i++)
+  {
+    SPI_3W_Read(&hspi2, pBuffer++);
+  }
+
+  SPI_1LINE_TX(&hspi2);
+  __HAL_SPI_ENABLE(&hspi2);
+}
+#endif
+
+/*
+ * @brief  Read generic device register (platform dependent)
+ *
+ * @param  handle    customizable argument. In this examples is used in
+ *                   order to select the correct sensor bus handler.
+ * @param  reg       register to read
+ * @param  bufp      pointer to buffer that store the data read
+ * @param  len       number of consecutive register to read
+ *
+ */
+static int32_t platform_read(void *handle, uint8_t reg, uint8_t *bufp,
+                             uint16_t len)
+{
+#if defined(NUCLEO_F401RE)
+  HAL_I2C_Mem_Read(handle, STHS34PF80_I2C_ADD, reg,
+                   I2C_MEMADD_SIZE_8BIT, bufp, len, 1000);
+#elif defined(STEVAL_MKI109V3)
+  reg |= 0x80;
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_RESET);
+  HAL_SPI_Transmit(handle, &reg, 1, 1000);
+  //HAL_SPI_Receive(handle, bufp, len, 1000);
+  SPI_3W_Receive(bufp, len);
+  HAL_GPIO_WritePin(CS_up_GPIO_Port, CS_up_Pin, GPIO_PIN_SET);
+#elif defined(SPC584B_DIS)
+  i2c_lld_read(handle, STHS34PF80_I2C_ADD & 0xFE, reg, bufp, len);
+#endif
+  return 0;
+}
+
+/*
+ * @brief  Write generic device register (platform dependent)
+ *
+ * @param  tx_buffer     buffer to trasmit
+ * @param  len           number of byte to send
+ *
+ */
+static void tx_com(uint8_t *tx_buffer, uint16_t len)
+{
+#if defined(NUCLEO_F401RE)
+  HAL_UART_Transmit(&huart2, tx_buffer, len, 1000);
+#elif defined(STEVAL_MKI109V3)
+  CDC_Transmit_FS(tx_buffer, len);
+#elif defined(SPC584B_DIS)
+  sd_lld_write(&SD2, tx_buffer, len);
+#endif
+}
+
+/*
+ * @brief  platform specific delay (platform dependent)
+ *
+ * @param  ms        delay in ms
+ *
+ */
+static void platform_delay(uint32_t ms)
+{
+#if defined(NUCLEO_F401RE) | defined(STEVAL_MKI109V3)
+  HAL_Delay(ms);
+#elif defined(SPC584B_DIS)
+  osalThreadDelayMilliseconds(ms);
+#endif
+}
+
+/*
+ * @brief  platform specific initialization (platform dependent)
+ */
+static void platform_init(void)
+{
+#if defined(STEVAL_MKI109V3)
+  TIM3->CCR1 = PWM_1V8;
+  TIM3->CCR2 = PWM_1V8;
+  HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_1);
+  HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_2);
+  HAL_Delay(1000);
+#endif
+}
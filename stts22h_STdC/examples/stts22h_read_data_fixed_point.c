@@ -0,0 +1,341 @@
+/*
+ ******************************************************************************
+ * @file    read_data_fixed_point.c
+ * @author  Sensors Software Solution Team
+ * @brief   This file shows how to convert data with fixed-point math only.
+ *
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2021 STMicroelectronics.
+ * All rights reserved.</center></h2>
+ *
+ * This software component is licensed by ST under BSD 3-Clause license,
+ * the "License"; You may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at:
+ *                        opensource.org/licenses/BSD-3-Clause
+ *
+ ******************************************************************************
+ */
+
+/*
+ * This example was developed using the following STMicroelectronics
+ * evaluation boards:
+ *
+ * - NUCLEO_F401RE + X_STEVAL-MKI200V1K
+ * - DISCOVERY_SPC584B + STEVAL-MKI200V1K
+ *
+ * Used interfaces:
+ *
+ * NUCLEO_STM32F401RE - Host side: UART(COM) to USB bridge
+ *                    - I2C(Default) / SPI(supported)
+ *
+ * DISCOVERY_SPC584B  - Host side: UART(COM) to USB bridge
+ *                    - Sensor side: I2C(Default) / SPI(supported)
+ *
+ * If you need to run this example on a different hardware platform a
+ * modification of the functions: `platform_write`, `platform_read`,
+ * `tx_com` and 'platform_init' is required.
+ *
+ */
+
+/* STMicroelectronics evaluation boards definition
+ *
+ * Please uncomment ONLY the evaluation boards in use.
+ * If a different hardware is used please comment all
+ * following target board and redefine yours.
+ */
+
+//#define NUCLEO_F401RE    /* little endian */
+//#define SPC584B_DIS      /* big endian */
+
+/* ATTENTION: By default the driver is little endian. If you need switch
+ *            to big endian please see "Endianness definitions" in the
+ *            header file of the driver (_reg.h).
+ */
+
+#if defined(NUCLEO_F401RE)
+/* NUCLEO_F401RE: Define communication interface */
+#define SENSOR_BUS hi2c1
+
+#elif defined(SPC584B_DIS)
+/* DISCOVERY_SPC584B: Define communication interface */
+#define SENSOR_BUS I2CD1
+
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include <stdio.h>
+#include "stts22h_reg.h"
+
+#if defined(NUCLEO_F401RE)
+#include "stm32f4xx_hal.h"
+#include "usart.h"
+#include "gpio.h"
+#include "i2c.h"
+
+#elif defined(SPC584B_DIS)
+#include "components.h"
+#endif
+
+/* Private macro -------------------------------------------------------------*/
+/* Number of samples converted in one batch */
+#define    BATCH_LEN         10
+
+/* Uncomment to compare fixed-point results with the float reference */
+//#define CONV_CHECK
+
+/* Private variables ---------------------------------------------------------*/
+static int16_t raw_temperature[BATCH_LEN];
+static int32_t temperature_q16[BATCH_LEN];
+static uint8_t whoamI;
+static uint8_t tx_buffer[1000];
+
+/* Extern variables ----------------------------------------------------------*/
+
+/* Private functions ---------------------------------------------------------*/
+/*
+ *   WARNING:
+ *   Functions declare in this section are defined at the end of this file
+ *   and are strictly related to the hardware platform used.
+ *
+ */
+static int32_t platform_write(void *handle, uint8_t reg, const uint8_t *bufp,
+                              uint16_t len);
+static int32_t platform_read(void *handle, uint8_t reg, uint8_t *bufp,
+                             uint16_t len);
+static void tx_com( uint8_t *tx_buffer, uint16_t len );
+static void platform_delay(uint32_t ms);
+static void platform_init(void);
+
+/*
+ * Convert a batch of raw temperature samples in degC (Q16.16 fixed-point).
+ *
+ * Sensitivity is 100 LSB/degC: Q16 = raw * 65536 / 100 = raw * 655.36,
+ * computed as (raw * 41943) / 64 (relative error 1e-6).
+ */
+static void temp_raw_to_q16(const int16_t *x, int32_t *y, uint16_t len)
+{
+  uint16_t i;
+
+  for (i = 0; i < len; i++)
+    y[i] = ((int32_t)x[i] * 41943L + 32L) >> 6;
+}
+
+#if defined(CONV_CHECK)
+/*
+ * Return max distance (in Q16 LSB) between fixed-point and the float
+ * conversion of the driver
+ */
+static int32_t conv_check(const int16_t *x, const int32_t *y, uint16_t len)
+{
+  int32_t err, max_err = 0;
+  uint16_t i;
+
+  for (i = 0; i < len; i++) {
+    err = y[i] - (int32_t)(stts22h_from_lsb_to_celsius(x[i]) * 65536.0f);
+    err = (err < 0) ? -err : err;
+    max_err = (err > max_err) ? err : max_err;
+  }
+
+  return max_err;
+}
+#endif /* CONV_CHECK */
+
+#if defined(NUCLEO_F401RE)
+/* Cycle counter used to benchmark the conversion (Cortex-M DWT) */
+static void cycles_init(void)
+{
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+static uint32_t cycles_get(void)
+{
+  return DWT->CYCCNT;
+}
+#else
+static void cycles_init(void) {}
+static uint32_t cycles_get(void) { return 0; }
+#endif
+
+/* Main Example --------------------------------------------------------------*/
+void stts22h_read_data_fixed_point(void)
+{
+  uint16_t cnt = 0;
+  uint32_t cycles;
+  uint16_t i;
+
+  /* Initialize mems driver interface */
+  stmdev_ctx_t dev_ctx;
+  dev_ctx.write_reg = platform_write;
+  dev_ctx.read_reg = platform_read;
+  dev_ctx.mdelay = platform_delay;
+  dev_ctx.handle = &SENSOR_BUS;
+
+  /* Init test platform */
+  platform_init();
+
+  /* Check device ID */
+  stts22h_dev_id_get(&dev_ctx, &whoamI);
+
+  if (whoamI != STTS22H_ID)
+    while (1); /* manage here device not found */
+
+  /*
+   * Set Output Data Rate
+   * WARNING: this function can reset the device configuration.
+   */
+  stts22h_temp_data_rate_set(&dev_ctx, STTS22H_1Hz);
+
+  /* Enable interrupt on high(=49.5 degC)/low(=2.5 degC) temperature. */
+  //float_t temperature_high_limit = 49.5f;
+  //stts22h_temp_trshld_high_set(&dev_ctx, (int8_t)(temperature_high_limit / 0.64f) + 64 );
+
+  //float_t temperature_low_limit = 2.5f;
+  //stts22h_temp_trshld_low_set(&dev_ctx, (int8_t)(temperature_low_limit / 0.64f) + 64 );
+
+  cycles_init();
+
+  /* Read samples in polling mode */
+  while (1) {
+    /*
+     * Read output only if not busy
+     * WARNING: _flag_data_ready_get works only when the device is in single
+     *          mode or with data rate set at 1Hz (this function use the busy
+     *          bit in status register please see the DS for details)
+     */
+    uint8_t flag;
+    stts22h_temp_flag_data_ready_get(&dev_ctx, &flag);
+
+    if (flag) {
+      /* Read temperature data */
+      stts22h_temperature_raw_get(&dev_ctx, &raw_temperature[cnt]);
+
+      if (++cnt < BATCH_LEN)
+        continue;
+
+      /* Convert the whole batch with integer math only */
+      cycles = cycles_get();
+      temp_raw_to_q16(raw_temperature, temperature_q16, BATCH_LEN);
+      cycles = cycles_get() - cycles;
+
+      for (i = 0; i < BATCH_LEN; i++) {
+        /* Hundredths of degC */
+        int32_t temp_c = (temperature_q16[i] * 100L) >> 16;
+        int32_t temp_abs = (temp_c < 0) ? -temp_c : temp_c;
+
+        snprintf((char *)tx_buffer, sizeof(tx_buffer),
+                 "Temperature [degC]:%s%ld.%02ld\r\n", (temp_c < 0) ? "-" : "",
+                 (long)(temp_abs / 100), (long)(temp_abs % 100));
+        tx_com(tx_buffer, strlen((char const *)tx_buffer));
+      }
+
+      snprintf((char *)tx_buffer, sizeof(tx_buffer),
+               "Conversion [cycles/sample]:%lu\r\n",
+               (unsigned long)(cycles / BATCH_LEN));
+      tx_com(tx_buffer, strlen((char const *)tx_buffer));
+
+#if defined(CONV_CHECK)
+      snprintf((char *)tx_buffer, sizeof(tx_buffer),
+               "Max error vs float [Q16 LSB]: temp %ld\r\n",
+               (long)conv_check(raw_temperature, temperature_q16, BATCH_LEN));
+      tx_com(tx_buffer, strlen((char const *)tx_buffer));
+#endif /* CONV_CHECK */
+
+      cnt = 0;
+    }
+  }
+}
+
+/*
+ * @brief  Write generic device register (platform dependent)
+ *
+ * @param  handle    customizable argument. In this examples is used in
+ *                   order to select the correct sensor bus handler.
+ * @param  reg       register to write
+ * @param  bufp      pointer to data to write in register reg
+ * @param  len       number of consecutive register to write
+ *
+ */
+static int32_t platform_write(void *handle, uint8_t reg, const uint8_t *bufp,
+                              uint16_t len)
+{
+#if defined(NUCLEO_F401RE)
+  HAL_I2C_Mem_Write(handle, STTS22H_I2C_ADD_H, reg,
+                    I2C_MEMADD_SIZE_8BIT, (uint8_t*) bufp, len, 1000);
+#elif defined(SPC584B_DIS)
+  i2c_lld_write(handle,  STTS22H_I2C_ADD_H & 0xFE, reg, (uint8_t*) bufp, len);
+#endif
+  return 0;
+}
+
+/*
+ * @brief  Read generic device register (platform dependent)
+ *
+ * @param  handle    customizable argument. In this examples is used in
+ *                   order to select the correct sensor bus handler.
+ * @param  reg       register to read
+ * @param  bufp      pointer to buffer that store the data read
+ * @param  len       number of consecutive register to read
+ *
+ */
+static int32_t platform_read(void *handle, uint8_t reg, uint8_t *bufp,
+                             uint16_t len)
+{
+#if defined(NUCLEO_F401RE)
+  HAL_I2C_Mem_Read(handle, STTS22H_I2C_ADD_H, reg,
+                   I2C_MEMADD_SIZE_8BIT, bufp, len, 1000);
+#elif defined(SPC584B_DIS)
+  i2c_lld_read(handle, STTS22H_I2C_ADD_H & 0xFE, reg, bufp, len);
+#endif
+  return 0;
+}
+
+/*
+ * @brief  Send buffer to console (platform dependent)
+ *
+ * @param  tx_buffer     buffer to transmit
+ * @param  len           number of byte to send
+ *
+ */
+static void tx_com(uint8_t *tx_buffer, uint16_t len)
+{
+#if defined(NUCLEO_F401RE)
+  HAL_UART_Transmit(&huart2, tx_buffer, len, 1000);
+#elif defined(SPC584B_DIS)
+  sd_lld_write(&SD2, tx_buffer, len);
+#endif
+}
+
+/*
+ * @brief  platform specific delay (platform dependent)
+ *
+ * @param  ms        delay in ms
+ *
+ */
+static void platform_delay(uint32_t ms)
+{
+#if defined(NUCLEO_F401RE)
+  HAL_Delay(ms);
+#elif defined(SPC584B_DIS)
+  osalThreadDelayMilliseconds(ms);
+#endif
+}
+
+/*
+ * @brief  platform specific initialization (platform dependent)
+ */
+static void platform_init(void)
+{
+#if defined(STEVAL_MKI109V3)
+  TIM3->CCR1 = PWM_3V3;
+  TIM3->CCR2 = PWM_3V3;
+  HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_1);
+  HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_2);
+  HAL_Delay(1000);
+#endif
+}
+